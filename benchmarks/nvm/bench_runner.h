@@ -0,0 +1,132 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BENCHMARKS_V2_BENCH_RUNNER_H
+#define NVM_CORE_BENCHMARKS_V2_BENCH_RUNNER_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace nvm {
+namespace bench {
+
+/// @brief Keep the compiler from dropping a computed value.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const T* sink;
+  sink = &value;
+#endif
+}
+
+/// @brief Memory barrier for the compiler, used after writes to a buffer.
+inline void ClobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : : "memory");
+#endif
+}
+
+/// @brief Minimal timing loop. Each case is calibrated to run at least
+/// min_time, then the best of a few repetitions is reported as ns/op and
+/// GB/s.
+class Runner {
+ private:
+  std::string filter_;
+  double min_time_s_;
+  int repetitions_;
+  size_t cases_;
+
+  template <typename TFunc>
+  static double TimeIterations(TFunc& fn, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+      fn();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count();
+  }
+
+ public:
+  Runner() : filter_(), min_time_s_(0.05), repetitions_(3), cases_(0) {}
+
+  /// @brief Accepts "--filter=<substring>", "--min-time=<seconds>" and
+  /// "--repetitions=<n>".
+  Runner(int argc, char** argv) : Runner() {
+    for (int i = 1; i < argc; ++i) {
+      const char* arg = argv[i];
+      if (std::strncmp(arg, "--filter=", 9) == 0) {
+        filter_ = arg + 9;
+      } else if (std::strncmp(arg, "--min-time=", 11) == 0) {
+        min_time_s_ = std::atof(arg + 11);
+      } else if (std::strncmp(arg, "--repetitions=", 14) == 0) {
+        repetitions_ = std::max(1, std::atoi(arg + 14));
+      }
+    }
+  }
+
+  void PrintHeader() const {
+    std::printf("%-44s %10s %12s %12s %10s\n", "benchmark", "bytes",
+                "iterations", "ns/op", "GB/s");
+  }
+
+  /// @brief Time fn, one call processes items operations over bytes bytes.
+  template <typename TFunc>
+  void Run(const std::string& name, size_t bytes, size_t items, TFunc fn) {
+    if (!filter_.empty() && name.find(filter_) == std::string::npos) {
+      return;
+    }
+    ++cases_;
+
+    uint64_t iterations = 1;
+    double elapsed = TimeIterations(fn, iterations);
+    while (elapsed < min_time_s_ && iterations < (uint64_t(1) << 40)) {
+      double scale = elapsed > 0 ? (min_time_s_ * 1.4) / elapsed : 100.0;
+      scale = std::min(std::max(scale, 2.0), 100.0);
+      iterations = static_cast<uint64_t>(iterations * scale);
+      elapsed = TimeIterations(fn, iterations);
+    }
+
+    double best = elapsed;
+    for (int r = 1; r < repetitions_; ++r) {
+      best = std::min(best, TimeIterations(fn, iterations));
+    }
+
+    double ops = static_cast<double>(iterations) * (items ? items : 1);
+    double ns_per_op = best * 1e9 / ops;
+    double gbps = static_cast<double>(bytes) * iterations / best / 1e9;
+    std::printf("%-44s %10zu %12llu %12.3f %10.3f\n", name.c_str(), bytes,
+                static_cast<unsigned long long>(iterations), ns_per_op, gbps);
+  }
+
+  size_t Cases() const {
+    return cases_;
+  }
+};
+
+}  // namespace bench
+}  // namespace nvm
+
+#endif  // NVM_CORE_BENCHMARKS_V2_BENCH_RUNNER_H
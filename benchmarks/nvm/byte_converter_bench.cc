@@ -0,0 +1,290 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_runner.h"
+#include "nvm/bytes/byte.h"
+#include "nvm/bytes/checked_span.h"
+
+using namespace nvm;
+
+namespace {
+
+const size_t kBufferSizes[] = {64, 4 * 1024, 256 * 1024};
+
+std::vector<uint8_t> RandomBytes(size_t size) {
+  std::mt19937 rng(42);
+  std::vector<uint8_t> out(size);
+  for (auto& b : out) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return out;
+}
+
+// Decode dispatch, the byte.h decoders are named per type.
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType, uint8_t& out) {
+  out = bytes::ToUint8(p, n, r);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType, int8_t& out) {
+  out = bytes::ToInt8(p, n, r);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, uint16_t& out) {
+  out = bytes::ToUint16(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, int16_t& out) {
+  out = bytes::ToInt16(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, uint32_t& out) {
+  out = bytes::ToUint32(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, int32_t& out) {
+  out = bytes::ToInt32(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, uint64_t& out) {
+  out = bytes::ToUint64(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, int64_t& out) {
+  out = bytes::ToInt64(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, float& out) {
+  out = bytes::ToFloat(p, n, r, e);
+}
+inline void Decode(const uint8_t* p, size_t n, bytes::ByteOpResult& r,
+                   bytes::EndianessType e, double& out) {
+  out = bytes::ToDouble(p, n, r, e);
+}
+
+const char* EndianName(bytes::EndianessType e) {
+  return e == bytes::EndianessType::BigEndian ? "be" : "le";
+}
+
+/// Encode and decode buffer_size / sizeof(T) scalars per iteration.
+template <typename T>
+void BenchScalar(bench::Runner& runner, const char* type_name) {
+  for (auto endian :
+       {bytes::EndianessType::LittleEndian, bytes::EndianessType::BigEndian}) {
+    for (size_t size : kBufferSizes) {
+      const size_t count = size / sizeof(T);
+      const size_t used = count * sizeof(T);
+      auto src = RandomBytes(used);
+      std::vector<T> values(count);
+      for (size_t i = 0; i < count; ++i) {
+        bytes::ByteOpResult r = bytes::ByteOpResult::None;
+        Decode(src.data() + i * sizeof(T), sizeof(T), r, endian, values[i]);
+      }
+      std::vector<uint8_t> dest(used);
+
+      std::string suffix = std::string(type_name) + "/" + EndianName(endian) +
+                           "/" + std::to_string(size);
+
+      runner.Run("encode/" + suffix, used, count, [&]() {
+        bytes::ByteOpResult r = bytes::ByteOpResult::None;
+        uint8_t* out = dest.data();
+        for (size_t i = 0; i < count; ++i) {
+          r = bytes::ToBytes(values[i], out + i * sizeof(T), sizeof(T),
+                             endian);
+        }
+        bench::DoNotOptimize(r);
+        bench::ClobberMemory();
+      });
+
+      runner.Run("decode/" + suffix, used, count, [&]() {
+        bytes::ByteOpResult r = bytes::ByteOpResult::None;
+        const uint8_t* in = src.data();
+        for (size_t i = 0; i < count; ++i) {
+          T value;
+          Decode(in + i * sizeof(T), sizeof(T), r, endian, value);
+          bench::DoNotOptimize(value);
+        }
+        bench::DoNotOptimize(r);
+      });
+    }
+  }
+}
+
+void BenchBool(bench::Runner& runner) {
+  for (size_t size : kBufferSizes) {
+    std::vector<uint8_t> dest(size);
+    runner.Run("encode/bool/" + std::to_string(size), size, size, [&]() {
+      bytes::ByteOpResult r = bytes::ByteOpResult::None;
+      for (size_t i = 0; i < size; ++i) {
+        r = bytes::ToBytes((i & 1) != 0, dest.data() + i, 1);
+      }
+      bench::DoNotOptimize(r);
+      bench::ClobberMemory();
+    });
+  }
+}
+
+void BenchString(bench::Runner& runner) {
+  for (size_t size : kBufferSizes) {
+    std::string value(size, 'x');
+    std::vector<uint8_t> buffer(size);
+    runner.Run("encode/string/" + std::to_string(size), size, 1, [&]() {
+      auto r = bytes::ToBytes(value, buffer.data(), buffer.size());
+      bench::DoNotOptimize(r);
+      bench::ClobberMemory();
+    });
+    runner.Run("decode/string/" + std::to_string(size), size, 1, [&]() {
+      bytes::ByteOpResult r = bytes::ByteOpResult::None;
+      auto s = bytes::ToAsciiString(buffer.data(), buffer.size(), r);
+      bench::DoNotOptimize(s);
+    });
+  }
+}
+
+void BenchCopyAndChecksum(bench::Runner& runner) {
+  for (size_t size : kBufferSizes) {
+    auto src = RandomBytes(size);
+    std::vector<uint8_t> dest(size);
+    std::string n = std::to_string(size);
+
+    runner.Run("CopyBytes/" + n, size, 1, [&]() {
+      auto r = bytes::CopyBytes(src.data(), dest.data(), size);
+      bench::DoNotOptimize(r);
+      bench::ClobberMemory();
+    });
+
+    runner.Run("Crc16IBM/" + n, size, 1, [&]() {
+      bytes::ByteOpResult r = bytes::ByteOpResult::None;
+      auto crc = bytes::Crc16IBM(src.data(), size, r);
+      bench::DoNotOptimize(crc);
+    });
+
+    for (auto endian : {bytes::EndianessType::LittleEndian,
+                        bytes::EndianessType::BigEndian}) {
+      runner.Run(std::string("Crc16CCITT/") + EndianName(endian) + "/" + n,
+                 size, 1, [&]() {
+                   bytes::ByteOpResult r = bytes::ByteOpResult::None;
+                   auto crc = bytes::Crc16CCITT(src.data(), size, r, endian);
+                   bench::DoNotOptimize(crc);
+                 });
+    }
+  }
+}
+
+void BenchHexString(bench::Runner& runner) {
+  static const char kDigits[] = "0123456789abcdef";
+  for (size_t size : kBufferSizes) {
+    auto src = RandomBytes(size);
+    std::string hex;
+    hex.reserve(size * 2);
+    for (auto b : src) {
+      hex += kDigits[b >> 4];
+      hex += kDigits[b & 0x0F];
+    }
+
+    // throughput counts the decoded bytes
+    runner.Run("ToBytesFromHexString/" + std::to_string(size), size, size,
+               [&]() {
+                 auto v = bytes::ToBytesFromHexString<uint8_t>(hex);
+                 bench::DoNotOptimize(v);
+               });
+  }
+}
+
+/// A 24 byte record of mixed fields, decoded field by field with the
+/// checked converters versus one CheckSpan and unchecked reads.
+void BenchRecord(bench::Runner& runner) {
+  constexpr size_t kRecord = 24;
+  const auto endian = bytes::EndianessType::BigEndian;
+  for (size_t size : kBufferSizes) {
+    const size_t count = size / kRecord;
+    auto src = RandomBytes(count * kRecord);
+    std::string n = std::to_string(size);
+
+    runner.Run("record/per-field/" + n, count * kRecord, count, [&]() {
+      bytes::ByteOpResult r = bytes::ByteOpResult::None;
+      uint64_t sum = 0;
+      for (size_t i = 0; i < count; ++i) {
+        const uint8_t* p = src.data() + i * kRecord;
+        sum += bytes::ToUint32(p, kRecord, r, endian);
+        sum += bytes::ToUint16(p + 4, kRecord - 4, r, endian);
+        sum += bytes::ToUint16(p + 6, kRecord - 6, r, endian);
+        sum += bytes::ToUint64(p + 8, kRecord - 8, r, endian);
+        sum += bytes::ToInt32(p + 16, kRecord - 16, r, endian);
+        sum += bytes::ToUint32(p + 20, kRecord - 20, r, endian);
+      }
+      bench::DoNotOptimize(sum);
+      bench::DoNotOptimize(r);
+    });
+
+    runner.Run("record/checked-span/" + n, count * kRecord, count, [&]() {
+      bytes::ByteOpResult r = bytes::ByteOpResult::None;
+      uint64_t sum = 0;
+      auto records =
+          bytes::CheckSpanArray<kRecord>(src.data(), src.size(), count, r,
+                                         endian);
+      for (size_t i = 0; records && i < count; ++i) {
+        auto rec = (*records)[i];
+        sum += rec.Get<uint32_t, 0>();
+        sum += rec.Get<uint16_t, 4>();
+        sum += rec.Get<uint16_t, 6>();
+        sum += rec.Get<uint64_t, 8>();
+        sum += rec.Get<int32_t, 16>();
+        sum += rec.Get<uint32_t, 20>();
+      }
+      bench::DoNotOptimize(sum);
+      bench::DoNotOptimize(r);
+    });
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::Runner runner(argc, argv);
+  runner.PrintHeader();
+
+  BenchScalar<uint8_t>(runner, "uint8");
+  BenchScalar<int8_t>(runner, "int8");
+  BenchScalar<uint16_t>(runner, "uint16");
+  BenchScalar<int16_t>(runner, "int16");
+  BenchScalar<uint32_t>(runner, "uint32");
+  BenchScalar<int32_t>(runner, "int32");
+  BenchScalar<uint64_t>(runner, "uint64");
+  BenchScalar<int64_t>(runner, "int64");
+  BenchScalar<float>(runner, "float");
+  BenchScalar<double>(runner, "double");
+  BenchBool(runner);
+  BenchString(runner);
+  BenchCopyAndChecksum(runner);
+  BenchHexString(runner);
+  BenchRecord(runner);
+
+  if (runner.Cases() == 0) {
+    std::fprintf(stderr, "no benchmark matches the filter\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench_runner.h"
+#include "nvm/bytes/byte.h"
+#include "nvm/bytes/hash.h"
+
+using namespace nvm;
+
+namespace {
+
+const size_t kKeySizes[] = {8, 16, 32, 64, 256, 4 * 1024, 256 * 1024};
+
+/// Short keys are hashed in batches so the loop overhead stays small.
+constexpr size_t kBatch = 64;
+
+std::vector<std::string> MakeKeys(size_t size, size_t count) {
+  std::mt19937 rng(17);
+  std::vector<std::string> keys(count);
+  for (auto& key : keys) {
+    key.resize(size);
+    for (auto& c : key) {
+      c = static_cast<char>('a' + rng() % 26);
+    }
+  }
+  return keys;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::Runner runner(argc, argv);
+  runner.PrintHeader();
+
+  for (size_t size : kKeySizes) {
+    const size_t count = size <= 256 ? kBatch : 1;
+    auto keys = MakeKeys(size, count);
+    const size_t bytes_per_iter = size * count;
+    std::string n = std::to_string(size);
+
+    runner.Run("std::hash<string>/" + n, bytes_per_iter, count, [&]() {
+      std::hash<std::string> hasher;
+      for (const auto& key : keys) {
+        bench::DoNotOptimize(hasher(key));
+      }
+    });
+
+    runner.Run("Hash64/" + n, bytes_per_iter, count, [&]() {
+      for (const auto& key : keys) {
+        bench::DoNotOptimize(bytes::Hash64(key.data(), key.size()));
+      }
+    });
+
+    runner.Run("Hash128/" + n, bytes_per_iter, count, [&]() {
+      for (const auto& key : keys) {
+        bench::DoNotOptimize(bytes::Hash128(key.data(), key.size()));
+      }
+    });
+
+    runner.Run("Hasher64/" + n, bytes_per_iter, count, [&]() {
+      for (const auto& key : keys) {
+        bytes::Hasher64 hasher;
+        hasher.Update(key.data(), key.size());
+        bench::DoNotOptimize(hasher.Digest());
+      }
+    });
+
+    runner.Run("Crc32C/" + n, bytes_per_iter, count, [&]() {
+      bytes::ByteOpResult err;
+      for (const auto& key : keys) {
+        bench::DoNotOptimize(bytes::Crc32C(key.data(), key.size(), err));
+      }
+    });
+  }
+
+  if (runner.Cases() == 0) {
+    std::fprintf(stderr, "no benchmark matches the filter\n");
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench_runner.h"
+#include "nvm/sqlbuilder/nv_select_builder.h"
+#include "nvm/sqlbuilder/parameter_buffer.h"
+#include "nvm/sqlbuilder/query_cache.h"
+#include "nvm/sqlbuilder/static_select.h"
+
+using namespace nvm;
+
+namespace {
+
+using NvSelect = sqlbuilder::NvSelect<>;
+using RecordKey = sqlbuilder::RecordKey;
+using SqlOperator = sqlbuilder::SqlOperator;
+
+/// A typical listing query: 3 joins, IN list, range and ordering.
+void BuildListing(NvSelect& select, const std::vector<int32_t>& companies,
+                  const std::string& name) {
+  // clang-format off
+  select
+    .Field<int32_t>("equipment_id", "e")
+    .Field<std::string>("code", "e", "equipment_code")
+    .Field<std::string>("name", "c", "company_name")
+    .Field<std::string>("name", "s", "service_name")
+    .Field<std::string>("username", "u", "add_username")
+    .From()
+      .AddTable("equipment", "e")
+    .EndFromTableBlock()
+    .Join()
+      .InnerJoin(
+        RecordKey("equipment", "service_id", "e"),
+        RecordKey("services", "service_id", "s"))
+      .InnerJoin(
+        RecordKey("services", "company_id", "s"),
+        RecordKey("company", "company_id", "c"))
+      .LeftJoin(
+        RecordKey("equipment", "add_by", "e"),
+        RecordKey("users", "user_id", "u"))
+    .EndJoinBlock()
+    .Where()
+      .AddConditionIn("c.company_id", companies)
+      .And()
+      .AddConditionBetween<int32_t>("e.status", 0, 1)
+      .And()
+      .AddCondition("e.name", SqlOperator::kLike, name)
+    .EndWhereBlock()
+    .OrderBy()
+      .Asc("name", "c")
+      .Asc("code", "e")
+    .EndOrderByBlock();
+  // clang-format on
+}
+
+/// BuildListing with the text fixed at compile time.
+// clang-format off
+constexpr auto kStaticListing =
+    sqlbuilder::StaticSelect<>()
+        .Field<int32_t>("equipment_id", "e")
+        .Field<std::string>("code", "e", "equipment_code")
+        .Field<std::string>("name", "c", "company_name")
+        .Field<std::string>("name", "s", "service_name")
+        .Field<std::string>("username", "u", "add_username")
+        .From("equipment", "e")
+        .InnerJoin(
+            sqlbuilder::StaticKey("equipment", "service_id", "e"),
+            sqlbuilder::StaticKey("services", "service_id", "s"))
+        .InnerJoin(
+            sqlbuilder::StaticKey("services", "company_id", "s"),
+            sqlbuilder::StaticKey("company", "company_id", "c"))
+        .LeftJoin(
+            sqlbuilder::StaticKey("equipment", "add_by", "e"),
+            sqlbuilder::StaticKey("users", "user_id", "u"))
+        .AddConditionIn<int32_t, 6>("c.company_id")
+        .And()
+        .AddConditionBetween<int32_t>("e.status")
+        .And()
+        .AddCondition<std::string>("e.name", SqlOperator::kLike)
+        .Asc("name", "c")
+        .Asc("code", "e");
+// clang-format on
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  bench::Runner runner(argc, argv);
+  runner.PrintHeader();
+
+  const std::vector<int32_t> companies = {1, 2, 3, 5, 8, 13};
+  const std::string name = "dozer%";
+
+  NvSelect select;
+  BuildListing(select, companies, name);
+  const size_t sql_size = select.GenerateQuery().size();
+
+  runner.Run("GenerateQuery/compact", sql_size, 1, [&]() {
+    bench::DoNotOptimize(select.GenerateQuery());
+  });
+
+  runner.Run("GenerateQuery/pretty", sql_size, 1, [&]() {
+    bench::DoNotOptimize(select.GenerateQuery(true));
+  });
+
+  runner.Run("build+GenerateQuery", sql_size, 1, [&]() {
+    NvSelect s;
+    BuildListing(s, companies, name);
+    bench::DoNotOptimize(s.GenerateQuery());
+    bench::DoNotOptimize(s.Values());
+  });
+
+  auto arena = std::make_shared<sqlbuilder::QueryArena>();
+  runner.Run("build+GenerateQuery/reused arena", sql_size, 1, [&]() {
+    {
+      NvSelect s(arena);
+      BuildListing(s, companies, name);
+      bench::DoNotOptimize(s.GenerateQuery());
+      bench::DoNotOptimize(s.Values());
+    }
+    arena->Reset();
+  });
+
+  sqlbuilder::ParameterBuffer params;
+  runner.Run("ParameterBuffer::Assign", sql_size, 1, [&]() {
+    params.Assign(*select.Values());
+    bench::DoNotOptimize(params.Values());
+  });
+
+  runner.Run("ShapeKey", sql_size, 1,
+             [&]() { bench::DoNotOptimize(select.ShapeKey()); });
+
+  runner.Run("Fingerprint", sql_size, 1,
+             [&]() { bench::DoNotOptimize(select.Fingerprint()); });
+
+  sqlbuilder::QueryShapeCache<> cache(64);
+  runner.Run("build+QueryShapeCache::Acquire", sql_size, 1, [&]() {
+    NvSelect s;
+    BuildListing(s, companies, name);
+    bench::DoNotOptimize(cache.Acquire(s));
+    bench::DoNotOptimize(s.Values());
+  });
+
+  auto frozen = select.Freeze();
+  runner.Run("FrozenSelect::Instantiate", sql_size, 1, [&]() {
+    auto query = frozen->Instantiate();
+    query.values[0] = companies[1];
+    bench::DoNotOptimize(query.Sql());
+    bench::DoNotOptimize(query.values);
+  });
+
+  if (kStaticListing.Sql() != select.GenerateQuery()) {
+    std::fprintf(stderr, "static listing differs from the builder\n");
+    return 1;
+  }
+  runner.Run("StaticSelect::Bind", sql_size, 1, [&]() {
+    auto values =
+        kStaticListing.Bind(companies[0], companies[1], companies[2],
+                            companies[3], companies[4], companies[5], 0, 1,
+                            name);
+    bench::DoNotOptimize(kStaticListing.Sql());
+    bench::DoNotOptimize(values);
+  });
+
+  if (runner.Cases() == 0) {
+    std::fprintf(stderr, "no benchmark matches the filter\n");
+    return 1;
+  }
+  return 0;
+}
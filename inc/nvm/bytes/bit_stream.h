@@ -0,0 +1,403 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_BIT_STREAM_H
+#define NVM_CORE_BYTES_V2_BIT_STREAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/bytes/details/internal_bit_unpack.h"
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/macro.h"
+#include "nvm/span.h"
+
+namespace nvm {
+namespace bytes {
+
+enum class BitOrder : uint8_t {
+  /// @brief First field occupies the most significant bits of a byte.
+  MsbFirst = 0,
+  /// @brief First field occupies the least significant bits of a byte.
+  LsbFirst = 1,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(BitOrder)
+
+/// @brief Reads n-bit fields from a byte span. Bits are pulled into a 64-bit
+/// cache eight bytes at a time, a field read is a shift and a mask.
+/// Reading past the end returns 0 and clears IsSuccess(), the flag is sticky.
+class BitReader {
+ private:
+  const uint8_t* pos_;
+  const uint8_t* end_;
+  const uint8_t* begin_;
+  uint64_t cache_;
+  // valid bits in cache_, bits after them are already the next stream bits
+  unsigned bits_;
+  BitOrder order_;
+  bool is_success_;
+
+  void Refill() noexcept {
+    if (end_ - pos_ >= 8) {
+      if (order_ == BitOrder::MsbFirst) {
+        cache_ |= details::unchecked::Load<uint64_t>(pos_, true) >> bits_;
+      } else {
+        cache_ |= details::unchecked::Load<uint64_t>(pos_, false) << bits_;
+      }
+      pos_ += (63 - bits_) >> 3;
+      bits_ |= 56;
+      return;
+    }
+
+    while (bits_ <= 56 && pos_ < end_) {
+      if (order_ == BitOrder::MsbFirst) {
+        cache_ |= static_cast<uint64_t>(*pos_) << (56 - bits_);
+      } else {
+        cache_ |= static_cast<uint64_t>(*pos_) << bits_;
+      }
+      ++pos_;
+      bits_ += 8;
+    }
+  }
+
+  uint64_t Take(unsigned n, bool consume) noexcept {
+    if (n == 0) {
+      return 0;
+    }
+    if (bits_ < n) {
+      Refill();
+      if (bits_ < n) {
+        is_success_ = false;
+        return 0;
+      }
+    }
+
+    uint64_t value;
+    if (order_ == BitOrder::MsbFirst) {
+      value = cache_ >> (64 - n);
+      if (consume) {
+        cache_ = n == 64 ? 0 : cache_ << n;
+      }
+    } else {
+      value = n == 64 ? cache_ : cache_ & ((uint64_t(1) << n) - 1);
+      if (consume) {
+        cache_ = n == 64 ? 0 : cache_ >> n;
+      }
+    }
+
+    if (consume) {
+      bits_ -= n;
+    }
+    return value;
+  }
+
+ public:
+  explicit BitReader(const Span<const uint8_t>& data,
+                     BitOrder order = BitOrder::MsbFirst) noexcept
+                  : pos_(data.Data()),
+                    end_(data.Data() + data.Size()),
+                    begin_(data.Data()),
+                    cache_(0),
+                    bits_(0),
+                    order_(order),
+                    is_success_(true) {}
+
+  bool IsSuccess() const noexcept {
+    return is_success_;
+  }
+
+  BitOrder Order() const noexcept {
+    return order_;
+  }
+
+  /// @brief Bits consumed since the beginning of the span.
+  size_t BitPosition() const noexcept {
+    return static_cast<size_t>(pos_ - begin_) * 8 - bits_;
+  }
+
+  size_t BitsRemaining() const noexcept {
+    return static_cast<size_t>(end_ - pos_) * 8 + bits_;
+  }
+
+  /// @brief Read an unsigned field.
+  /// @param n field width, 0 to 64
+  uint64_t Read(unsigned n) noexcept {
+    if (n <= 56) {
+      return Take(n, true);
+    }
+
+    // the cache guarantees 56 bits after a refill, split wide fields
+    if (order_ == BitOrder::MsbFirst) {
+      uint64_t hi = Take(n - 32, true);
+      return (hi << 32) | Take(32, true);
+    }
+    uint64_t lo = Take(32, true);
+    return lo | (Take(n - 32, true) << 32);
+  }
+
+  /// @brief Read a two's complement field and sign extend it.
+  int64_t ReadSigned(unsigned n) noexcept {
+    uint64_t value = Read(n);
+    if (n == 0 || n == 64) {
+      return static_cast<int64_t>(value);
+    }
+    uint64_t sign = uint64_t(1) << (n - 1);
+    return static_cast<int64_t>((value ^ sign) - sign);
+  }
+
+  bool ReadBool() noexcept {
+    return Take(1, true) != 0;
+  }
+
+  /// @brief Look at the next n bits without consuming them.
+  /// @param n field width, 0 to 56
+  uint64_t Peek(unsigned n) noexcept {
+    return Take(n, false);
+  }
+
+  /// @brief Skip n bits.
+  BitReader& Skip(size_t n) noexcept {
+    while (n > 0 && is_success_) {
+      unsigned step = n > 56 ? 56 : static_cast<unsigned>(n);
+      Take(step, true);
+      n -= step;
+    }
+    return *this;
+  }
+
+  /// @brief Drop the bits left in the current byte.
+  BitReader& AlignToByte() noexcept {
+    return Skip((8 - BitPosition() % 8) % 8);
+  }
+};
+
+/// @brief Writes n-bit fields into a byte span through a 64-bit accumulator,
+/// whole bytes are stored eight at a time when the span has room.
+/// Writing past the end clears IsSuccess(), the flag is sticky. Call
+/// Finish() to flush the last partial byte.
+class BitWriter {
+ private:
+  uint8_t* pos_;
+  uint8_t* end_;
+  uint8_t* begin_;
+  uint64_t acc_;
+  unsigned bits_;
+  BitOrder order_;
+  bool is_success_;
+
+  /// @param exact store only the whole bytes, the final flush must not
+  /// touch what follows the written data
+  void FlushBytes(bool exact) noexcept {
+    unsigned whole = bits_ >> 3;
+    if (whole == 0) {
+      return;
+    }
+    if (static_cast<size_t>(end_ - pos_) < whole) {
+      is_success_ = false;
+      return;
+    }
+
+    if (!exact && end_ - pos_ >= 8) {
+      // store all eight, only whole bytes count as written. A flush from
+      // Put() runs with more than 64 bits pending, so the bytes stored past
+      // the whole ones are rewritten before Finish() returns.
+      details::unchecked::Store<uint64_t>(acc_, pos_,
+                                          order_ == BitOrder::MsbFirst);
+    } else {
+      for (unsigned i = 0; i < whole; ++i) {
+        pos_[i] = order_ == BitOrder::MsbFirst
+                      ? static_cast<uint8_t>(acc_ >> (56 - 8 * i))
+                      : static_cast<uint8_t>(acc_ >> (8 * i));
+      }
+    }
+
+    pos_ += whole;
+    unsigned shift = whole * 8;
+    if (order_ == BitOrder::MsbFirst) {
+      acc_ = shift == 64 ? 0 : acc_ << shift;
+    } else {
+      acc_ = shift == 64 ? 0 : acc_ >> shift;
+    }
+    bits_ -= shift;
+  }
+
+  void Put(uint64_t value, unsigned n) noexcept {
+    if (bits_ + n > 64) {
+      FlushBytes(false);
+      if (!is_success_) {
+        return;
+      }
+    }
+
+    if (n < 64) {
+      value &= (uint64_t(1) << n) - 1;
+    }
+    if (order_ == BitOrder::MsbFirst) {
+      acc_ |= value << (64 - bits_ - n);
+    } else {
+      acc_ |= value << bits_;
+    }
+    bits_ += n;
+  }
+
+ public:
+  explicit BitWriter(const Span<uint8_t>& dest,
+                     BitOrder order = BitOrder::MsbFirst) noexcept
+                  : pos_(dest.Data()),
+                    end_(dest.Data() + dest.Size()),
+                    begin_(dest.Data()),
+                    acc_(0),
+                    bits_(0),
+                    order_(order),
+                    is_success_(true) {}
+
+  bool IsSuccess() const noexcept {
+    return is_success_;
+  }
+
+  BitOrder Order() const noexcept {
+    return order_;
+  }
+
+  /// @brief Bits written so far, including the ones not flushed yet.
+  size_t BitPosition() const noexcept {
+    return static_cast<size_t>(pos_ - begin_) * 8 + bits_;
+  }
+
+  /// @brief Write the low n bits of value.
+  /// @param n field width, 0 to 64
+  BitWriter& Write(uint64_t value, unsigned n) noexcept {
+    if (n == 0 || !is_success_) {
+      return *this;
+    }
+    if (BitPosition() + n > static_cast<size_t>(end_ - begin_) * 8) {
+      is_success_ = false;
+      return *this;
+    }
+
+    if (n <= 56) {
+      Put(value, n);
+    } else if (order_ == BitOrder::MsbFirst) {
+      Put(value >> 32, n - 32);
+      Put(value, 32);
+    } else {
+      Put(value, 32);
+      Put(value >> 32, n - 32);
+    }
+    return *this;
+  }
+
+  BitWriter& WriteBool(bool value) noexcept {
+    return Write(value ? 1 : 0, 1);
+  }
+
+  /// @brief Pad with zero bits up to the next byte boundary.
+  BitWriter& AlignToByte() noexcept {
+    return Write(0, static_cast<unsigned>((8 - BitPosition() % 8) % 8));
+  }
+
+  /// @brief Flush everything, the last byte is zero padded.
+  /// @return bytes written into the span
+  size_t Finish() noexcept {
+    AlignToByte();
+    FlushBytes(true);
+    return static_cast<size_t>(pos_ - begin_);
+  }
+};
+
+/// @brief Unpack count fields of bits width into dest.
+/// 12-bit fields take a vectorized path (SSSE3/NEON) where available.
+/// @tparam TVal uint8_t, uint16_t, uint32_t or uint64_t
+/// @param src
+/// @param bits field width, 1 to sizeof(TVal) * 8
+/// @param dest must hold count elements
+/// @param count
+/// @param order
+/// @return SizeMismatch when src is shorter than count * bits
+template <typename TVal>
+ByteOpResult UnpackBits(const Span<const uint8_t>& src, unsigned bits,
+                        TVal* dest, size_t count,
+                        BitOrder order = BitOrder::MsbFirst) noexcept {
+  static_assert(std::is_unsigned<TVal>::value && std::is_integral<TVal>::value,
+                "TVal must be an unsigned integer");
+
+  if (!dest || (!src.Data() && count > 0)) {
+    return ByteOpResult::Nullptr;
+  }
+  if (bits == 0 || bits > sizeof(TVal) * 8) {
+    return ByteOpResult::SizeMismatch;
+  }
+  if (src.Size() < (count * bits + 7) / 8) {
+    return ByteOpResult::SizeMismatch;
+  }
+
+  if constexpr (std::is_same<TVal, uint16_t>::value) {
+    if (bits == 12) {
+      if (order == BitOrder::MsbFirst) {
+        details::bits::Unpack12Msb(src.Data(), dest, count);
+      } else {
+        details::bits::Unpack12Lsb(src.Data(), dest, count);
+      }
+      return ByteOpResult::Ok;
+    }
+  }
+
+  BitReader reader(src, order);
+  for (size_t i = 0; i < count; ++i) {
+    dest[i] = static_cast<TVal>(reader.Read(bits));
+  }
+  return ByteOpResult::Ok;
+}
+
+/// @brief Pack count values as bits wide fields, the last byte is zero
+/// padded.
+/// @param written bytes written into dest
+/// @return SizeMismatch when dest is too small
+template <typename TVal>
+ByteOpResult PackBits(const TVal* src, size_t count, unsigned bits,
+                      const Span<uint8_t>& dest, size_t& written,
+                      BitOrder order = BitOrder::MsbFirst) noexcept {
+  static_assert(std::is_unsigned<TVal>::value && std::is_integral<TVal>::value,
+                "TVal must be an unsigned integer");
+
+  written = 0;
+  if (!src && count > 0) {
+    return ByteOpResult::Nullptr;
+  }
+  if (bits == 0 || bits > sizeof(TVal) * 8 ||
+      dest.Size() < (count * bits + 7) / 8) {
+    return ByteOpResult::SizeMismatch;
+  }
+
+  BitWriter writer(dest, order);
+  for (size_t i = 0; i < count; ++i) {
+    writer.Write(src[i], bits);
+  }
+  written = writer.Finish();
+  return writer.IsSuccess() ? ByteOpResult::Ok : ByteOpResult::SizeMismatch;
+}
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_BIT_STREAM_H
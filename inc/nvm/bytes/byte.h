@@ -22,6 +22,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
@@ -29,6 +30,8 @@
 #include "nvm/strings/utf8string.h"
 #include "nvm/bytes/details/internal_byte_ch.h"
 #include "nvm/bytes/details/internal_byte_u8.h"
+#include "nvm/bytes/details/internal_crc32c.h"
+#include "nvm/bytes/varint.h"
 namespace nvm {
 namespace bytes {
 
@@ -52,7 +55,7 @@ inline EndianessType HostEndianess() {
 /// @param size
 /// @return
 template <typename T>
-ByteOpResult CopyBytes(const T* src, const T* dest,
+ByteOpResult CopyBytes(const T* src, T* dest,
                        const size_t& size) noexcept {
   static_assert(std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
                 "T can only be char or uint8_t");
@@ -103,8 +106,20 @@ ByteOpResult ToBytes(
       return result;
     }
   } else if constexpr (std::is_same<TVal, strings::Utf8String>::value) {
-    // execute method for Utf8Str
-    return ByteOpResult::None;
+    // execute method for Utf8Str, validity is known since construction
+    if (!dest) {
+      return ByteOpResult::Nullptr;
+    }
+    if (!val.IsUtf8()) {
+      return ByteOpResult::None;
+    }
+    if (dest_size < val.Size()) {
+      return ByteOpResult::SizeMismatch;
+    }
+    if (val.Size() > 0) {
+      std::memcpy(dest, val.Data(), val.Size());
+    }
+    return ByteOpResult::Ok;
   } else if constexpr (std::is_same<TVal, bool>::value) {
     ByteOpResult result = ByteOpResult::None;
     if constexpr (std::is_same<TSeq, uint8_t>::value) {
@@ -138,10 +153,10 @@ ByteOpResult ToBytes(
   } else if constexpr (std::is_same<TVal, int8_t>::value) {
     ByteOpResult result = ByteOpResult::None;
     if constexpr (std::is_same<TSeq, uint8_t>::value) {
-      details::u8::EncodeInt8(&val, dest, dest_size, result, is_big_endian);
+      details::u8::EncodeInt8(val, dest, dest_size, result);
       return result;
     } else {
-      details::ch::EncodeInt8(&val, dest, dest_size, result, is_big_endian);
+      details::ch::EncodeInt8(val, dest, dest_size, result);
       return result;
     }
   } else if constexpr (std::is_same<TVal, int16_t>::value) {
@@ -175,10 +190,10 @@ ByteOpResult ToBytes(
   } else if constexpr (std::is_same<TVal, uint8_t>::value) {
     ByteOpResult result = ByteOpResult::None;
     if constexpr (std::is_same<TSeq, uint8_t>::value) {
-      details::u8::EncodeUInt8(&val, dest, dest_size, result, is_big_endian);
+      details::u8::EncodeUInt8(val, dest, dest_size, result);
       return result;
     } else {
-      details::ch::EncodeUInt8(&val, dest, dest_size, result, is_big_endian);
+      details::ch::EncodeUInt8(val, dest, dest_size, result);
       return result;
     }
   } else if constexpr (std::is_same<TVal, uint16_t>::value) {
@@ -439,7 +454,8 @@ std::string ToAsciiString(
   }
 };
 
-/// @brief
+/// @brief Copy bytes into a Utf8String, validating and counting codepoints in
+/// the same pass. Check IsUtf8() on the result.
 /// @tparam T char or uint8_t
 /// @param bytes
 /// @param size
@@ -449,7 +465,7 @@ strings::Utf8String ToUtf8String(const T* bytes, const size_t& size) noexcept {
   static_assert(std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
                 "T can only be char or uint8_t");
 
-  return std::move(strings::Utf8String::MakeUtf8StringUnchecked(bytes, size));
+  return strings::Utf8String::FromBytes(bytes, size);
 };
 
 /// @brief
@@ -533,6 +549,30 @@ uint16_t Crc16CCITT(const T* buffer, size_t size, ByteOpResult& err,
   return crc;
 }
 
+/// @brief CRC-32C (Castagnoli, iSCSI/ext4 polynomial). Chain calls by passing
+/// the previous result as crc.
+/// @tparam T char or uint8_t
+/// @param buffer
+/// @param size
+/// @param err
+/// @param crc 0 to start, previous result to continue
+/// @return
+template <typename T>
+uint32_t Crc32C(const T* buffer, size_t size, ByteOpResult& err,
+                uint32_t crc = 0) noexcept {
+  static_assert(std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
+                "T can only be char or uint8_t");
+
+  if (!buffer) {
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  err = ByteOpResult::Ok;
+  return details::crc32c::Extend(
+      crc, reinterpret_cast<const uint8_t*>(buffer), size);
+}
+
 /// @brief
 /// @tparam T char or uint8_t
 /// @param hex_str
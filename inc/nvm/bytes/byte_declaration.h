@@ -42,6 +42,8 @@ enum class ByteOpResult {
   Nullptr = 1,
   SizeMismatch = 2,
   None = 4,
+  Truncated = 8,
+  Overlong = 16,
 };
 
 NVM_ENUM_CLASS_DISPLAY_TRAIT(ByteOpResult)
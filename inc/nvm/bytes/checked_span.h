@@ -0,0 +1,272 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_CHECKED_SPAN_H
+#define NVM_CORE_BYTES_V2_CHECKED_SPAN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/bytes/struct_codec.h"
+#include "nvm/span.h"
+
+namespace nvm {
+namespace bytes {
+
+template <size_t N>
+class CheckedSpan;
+
+template <size_t N>
+class CheckedArray;
+
+template <size_t N>
+std::optional<CheckedSpan<N>> CheckSpan(
+    const uint8_t* buffer, size_t size, ByteOpResult& err,
+    EndianessType endianess = EndianessType::LittleEndian) noexcept;
+
+template <size_t N>
+std::optional<CheckedArray<N>> CheckSpanArray(
+    const uint8_t* buffer, size_t size, size_t count, ByteOpResult& err,
+    EndianessType endianess = EndianessType::LittleEndian) noexcept;
+
+/// @brief N bytes that are known to be readable. The only way to get one is
+/// CheckSpan() (or narrowing another CheckedSpan), which does the nullptr and
+/// length check once. Field reads afterwards are inline unchecked loads, and
+/// reads at compile-time offsets are verified against N by the compiler.
+///
+/// ```cxx
+/// bytes::ByteOpResult err;
+/// auto rec = bytes::CheckSpan<14>(buffer, size, err,
+///                                 bytes::EndianessType::BigEndian);
+/// if (rec) {
+///   auto id = rec->Get<uint32_t, 0>();
+///   auto flags = rec->Get<uint16_t, 4>();
+///   auto value = rec->Get<double, 6>();
+/// }
+/// ```
+/// The span does not own the bytes, keep the buffer alive while using it.
+/// @tparam N checked length in bytes
+template <size_t N>
+class CheckedSpan {
+ private:
+  const uint8_t* data_;
+  bool is_big_endian_;
+
+  constexpr CheckedSpan(const uint8_t* data, bool is_big_endian) noexcept
+                  : data_(data), is_big_endian_(is_big_endian) {}
+
+  template <size_t M>
+  friend class CheckedSpan;
+
+  template <size_t M>
+  friend class CheckedArray;
+
+  template <size_t M>
+  friend std::optional<CheckedSpan<M>> CheckSpan(
+      const uint8_t* buffer, size_t size, ByteOpResult& err,
+      EndianessType endianess) noexcept;
+
+  template <typename TLayout, size_t... I>
+  auto UnpackImpl(std::index_sequence<I...>) const {
+    constexpr auto offsets = details::codec::MakeOffsets<TLayout>(
+        std::index_sequence<I...>{});
+    static_assert(offsets[sizeof...(I)] <= N,
+                  "layout is larger than the checked span");
+    return std::make_tuple(
+        wire::FieldTraits<typename std::tuple_element<I, TLayout>::type>::
+            Decode(data_ + offsets[I], is_big_endian_)...);
+  }
+
+ public:
+  static constexpr size_t kSize = N;
+
+  /// @brief Read the field at a compile-time offset.
+  /// @tparam TField arithmetic type or a wire marker (wire::Be<T>,
+  /// wire::Le<T>, wire::FixedString<M>)
+  /// @tparam Offset byte offset, Offset + field size must not exceed N
+  template <typename TField, size_t Offset>
+  typename wire::FieldTraits<TField>::value_type Get() const {
+    static_assert(Offset + wire::FieldTraits<TField>::kSize <= N,
+                  "field lies outside the checked span");
+    return wire::FieldTraits<TField>::Decode(data_ + Offset, is_big_endian_);
+  }
+
+  /// @brief Read T at a runtime offset, for loops over repeated fields.
+  /// Nothing is checked, offset + sizeof(T) must not exceed N.
+  template <typename T>
+  T GetUnchecked(size_t offset) const noexcept {
+    return details::unchecked::Load<T>(data_ + offset, is_big_endian_);
+  }
+
+  /// @brief Decode consecutive fields starting at offset 0, the offsets are
+  /// computed at compile time.
+  /// @return std::tuple of the decoded values
+  template <typename... TFields>
+  auto Unpack() const {
+    return UnpackImpl<std::tuple<TFields...>>(
+        std::index_sequence_for<TFields...>{});
+  }
+
+  /// @brief Narrow to [Offset, Offset + M), checked at compile time.
+  template <size_t Offset, size_t M = N - Offset>
+  CheckedSpan<M> Sub() const noexcept {
+    static_assert(Offset <= N && M <= N - Offset,
+                  "sub span lies outside the checked span");
+    return CheckedSpan<M>(data_ + Offset, is_big_endian_);
+  }
+
+  const uint8_t* Data() const noexcept {
+    return data_;
+  }
+
+  static constexpr size_t Size() noexcept {
+    return N;
+  }
+
+  bool IsBigEndian() const noexcept {
+    return is_big_endian_;
+  }
+
+  Span<const uint8_t> ToSpan() const noexcept {
+    return Span<const uint8_t>(data_, N);
+  }
+};
+
+/// @brief count consecutive records of N bytes, validated with one length
+/// check for the whole run.
+template <size_t N>
+class CheckedArray {
+  static_assert(N > 0, "record size must be positive");
+
+ private:
+  const uint8_t* data_;
+  size_t count_;
+  bool is_big_endian_;
+
+  constexpr CheckedArray(const uint8_t* data, size_t count,
+                         bool is_big_endian) noexcept
+                  : data_(data), count_(count), is_big_endian_(is_big_endian) {}
+
+  template <size_t M>
+  friend std::optional<CheckedArray<M>> CheckSpanArray(
+      const uint8_t* buffer, size_t size, size_t count, ByteOpResult& err,
+      EndianessType endianess) noexcept;
+
+ public:
+  size_t Count() const noexcept {
+    return count_;
+  }
+
+  /// @brief Record i, not bounds checked, i must be less than Count().
+  CheckedSpan<N> operator[](size_t i) const noexcept {
+    return CheckedSpan<N>(data_ + i * N, is_big_endian_);
+  }
+
+  /// @throw std::out_of_range when i >= Count()
+  CheckedSpan<N> At(size_t i) const {
+    if (i >= count_) {
+      throw std::out_of_range("CheckedArray: Index out of bounds");
+    }
+    return (*this)[i];
+  }
+};
+
+/// @brief Validate that buffer holds at least N bytes.
+/// @param buffer
+/// @param size
+/// @param err Ok, Nullptr or SizeMismatch
+/// @param endianess byte order of the fields without Be/Le marker
+/// @return the checked span, std::nullopt when err is not Ok
+template <size_t N>
+std::optional<CheckedSpan<N>> CheckSpan(const uint8_t* buffer, size_t size,
+                                        ByteOpResult& err,
+                                        EndianessType endianess) noexcept {
+  if (!buffer) {
+    err = ByteOpResult::Nullptr;
+    return std::nullopt;
+  }
+  if (size < N) {
+    err = ByteOpResult::SizeMismatch;
+    return std::nullopt;
+  }
+
+  err = ByteOpResult::Ok;
+  return CheckedSpan<N>(buffer, endianess == EndianessType::BigEndian);
+}
+
+template <size_t N>
+std::optional<CheckedSpan<N>> CheckSpan(
+    const Span<const uint8_t>& span,
+    EndianessType endianess = EndianessType::LittleEndian) noexcept {
+  ByteOpResult err;
+  return CheckSpan<N>(span.Data(), span.Size(), err, endianess);
+}
+
+/// @brief Validate count records of N bytes at once.
+/// @param err Ok, Nullptr or SizeMismatch
+/// @return the checked records, std::nullopt when err is not Ok
+template <size_t N>
+std::optional<CheckedArray<N>> CheckSpanArray(
+    const uint8_t* buffer, size_t size, size_t count, ByteOpResult& err,
+    EndianessType endianess) noexcept {
+  if (!buffer && count > 0) {
+    err = ByteOpResult::Nullptr;
+    return std::nullopt;
+  }
+  if (count > size / N) {
+    err = ByteOpResult::SizeMismatch;
+    return std::nullopt;
+  }
+
+  err = ByteOpResult::Ok;
+  return CheckedArray<N>(buffer, count,
+                         endianess == EndianessType::BigEndian);
+}
+
+/// @brief Every whole record of N bytes in span, a trailing partial record is
+/// ignored.
+template <size_t N>
+std::optional<CheckedArray<N>> CheckSpanArray(
+    const Span<const uint8_t>& span,
+    EndianessType endianess = EndianessType::LittleEndian) noexcept {
+  ByteOpResult err;
+  return CheckSpanArray<N>(span.Data(), span.Size(), span.Size() / N, err,
+                           endianess);
+}
+
+/// @brief Checked span sized for one RecordCodec<T> record.
+template <typename T>
+using CheckedRecord = CheckedSpan<RecordCodec<T>::kRecordSize>;
+
+/// @brief Decode a RecordCodec<T> record from an already checked span.
+template <typename T>
+T DecodeRecord(const CheckedRecord<T>& span) {
+  return RecordCodec<T>::DecodeUnchecked(span.Data(), span.IsBigEndian());
+}
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_CHECKED_SPAN_H
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/bytes/details/internal_bit_unpack.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <tmmintrin.h>
+#define NVM_BITS_HAS_SSSE3 1
+#define NVM_BITS_TARGET_SSSE3 __attribute__((target("ssse3")))
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NVM_BITS_HAS_NEON 1
+#endif
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace bits {
+
+namespace {
+
+// Eight samples come from twelve bytes, every lane of the shuffle picks the
+// two bytes holding one sample as a little endian uint16_t.
+#if defined(NVM_BITS_HAS_SSSE3)
+
+NVM_BITS_TARGET_SSSE3 void Unpack12x8Msb(const uint8_t* src,
+                                          uint16_t* dest) noexcept {
+  const __m128i shuffle =
+      _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m128i even = _mm_setr_epi16(-1, 0, -1, 0, -1, 0, -1, 0);
+  const __m128i odd =
+      _mm_setr_epi16(0, 0x0FFF, 0, 0x0FFF, 0, 0x0FFF, 0, 0x0FFF);
+
+  __m128i v = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), shuffle);
+  __m128i r = _mm_or_si128(_mm_and_si128(_mm_srli_epi16(v, 4), even),
+                           _mm_and_si128(v, odd));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), r);
+}
+
+NVM_BITS_TARGET_SSSE3 void Unpack12x8Lsb(const uint8_t* src,
+                                          uint16_t* dest) noexcept {
+  const __m128i shuffle =
+      _mm_setr_epi8(0, 1, 1, 2, 3, 4, 4, 5, 6, 7, 7, 8, 9, 10, 10, 11);
+  const __m128i even =
+      _mm_setr_epi16(0x0FFF, 0, 0x0FFF, 0, 0x0FFF, 0, 0x0FFF, 0);
+  const __m128i odd = _mm_setr_epi16(0, -1, 0, -1, 0, -1, 0, -1);
+
+  __m128i v = _mm_shuffle_epi8(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), shuffle);
+  __m128i r = _mm_or_si128(_mm_and_si128(v, even),
+                           _mm_and_si128(_mm_srli_epi16(v, 4), odd));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), r);
+}
+
+#elif defined(NVM_BITS_HAS_NEON)
+
+inline void Unpack12x8Msb(const uint8_t* src, uint16_t* dest) noexcept {
+  static const uint8_t kShuffle[16] = {1, 0, 2,  1, 4,  3, 5,  4,
+                                       7, 6, 8,  7, 10, 9, 11, 10};
+  static const uint16_t kEven[8] = {0xFFFF, 0, 0xFFFF, 0,
+                                    0xFFFF, 0, 0xFFFF, 0};
+  static const uint16_t kOdd[8] = {0, 0x0FFF, 0, 0x0FFF,
+                                   0, 0x0FFF, 0, 0x0FFF};
+
+  uint16x8_t v = vreinterpretq_u16_u8(
+      vqtbl1q_u8(vld1q_u8(src), vld1q_u8(kShuffle)));
+  uint16x8_t r = vorrq_u16(vandq_u16(vshrq_n_u16(v, 4), vld1q_u16(kEven)),
+                           vandq_u16(v, vld1q_u16(kOdd)));
+  vst1q_u16(dest, r);
+}
+
+inline void Unpack12x8Lsb(const uint8_t* src, uint16_t* dest) noexcept {
+  static const uint8_t kShuffle[16] = {0, 1, 1, 2, 3, 4,  4,  5,
+                                       6, 7, 7, 8, 9, 10, 10, 11};
+  static const uint16_t kEven[8] = {0x0FFF, 0, 0x0FFF, 0,
+                                    0x0FFF, 0, 0x0FFF, 0};
+  static const uint16_t kOdd[8] = {0, 0xFFFF, 0, 0xFFFF,
+                                   0, 0xFFFF, 0, 0xFFFF};
+
+  uint16x8_t v = vreinterpretq_u16_u8(
+      vqtbl1q_u8(vld1q_u8(src), vld1q_u8(kShuffle)));
+  uint16x8_t r = vorrq_u16(vandq_u16(v, vld1q_u16(kEven)),
+                           vandq_u16(vshrq_n_u16(v, 4), vld1q_u16(kOdd)));
+  vst1q_u16(dest, r);
+}
+
+#endif
+
+/// The x86 kernels are compiled for SSSE3 regardless of -march, pick them
+/// only when the CPU has it.
+inline bool HasVectorUnpack() noexcept {
+#if defined(NVM_BITS_HAS_SSSE3)
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+#elif defined(NVM_BITS_HAS_NEON)
+  return true;
+#else
+  return false;
+#endif
+}
+
+}  // namespace
+
+void Unpack12Msb(const uint8_t* src, uint16_t* dest, size_t count) noexcept {
+  size_t i = 0;
+
+#if defined(NVM_BITS_HAS_SSSE3) || defined(NVM_BITS_HAS_NEON)
+  // the vector load reads 16 bytes but uses 12, keep it inside the input
+  size_t bytes = (count * 12 + 7) / 8;
+  if (HasVectorUnpack()) {
+    for (; i + 8 <= count && (i / 2) * 3 + 16 <= bytes; i += 8) {
+      Unpack12x8Msb(src + (i / 2) * 3, dest + i);
+    }
+  }
+#endif
+
+  for (; i + 2 <= count; i += 2) {
+    const uint8_t* p = src + (i / 2) * 3;
+    dest[i] = static_cast<uint16_t>((p[0] << 4) | (p[1] >> 4));
+    dest[i + 1] = static_cast<uint16_t>(((p[1] & 0x0F) << 8) | p[2]);
+  }
+
+  if (i < count) {
+    const uint8_t* p = src + (i / 2) * 3;
+    dest[i] = static_cast<uint16_t>((p[0] << 4) | (p[1] >> 4));
+  }
+}
+
+void Unpack12Lsb(const uint8_t* src, uint16_t* dest, size_t count) noexcept {
+  size_t i = 0;
+
+#if defined(NVM_BITS_HAS_SSSE3) || defined(NVM_BITS_HAS_NEON)
+  size_t bytes = (count * 12 + 7) / 8;
+  if (HasVectorUnpack()) {
+    for (; i + 8 <= count && (i / 2) * 3 + 16 <= bytes; i += 8) {
+      Unpack12x8Lsb(src + (i / 2) * 3, dest + i);
+    }
+  }
+#endif
+
+  for (; i + 2 <= count; i += 2) {
+    const uint8_t* p = src + (i / 2) * 3;
+    dest[i] = static_cast<uint16_t>(p[0] | ((p[1] & 0x0F) << 8));
+    dest[i + 1] = static_cast<uint16_t>((p[1] >> 4) | (p[2] << 4));
+  }
+
+  if (i < count) {
+    const uint8_t* p = src + (i / 2) * 3;
+    dest[i] = static_cast<uint16_t>(p[0] | ((p[1] & 0x0F) << 8));
+  }
+}
+
+}  // namespace bits
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
@@ -0,0 +1,43 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_DETAILS_V2_INTERNAL_BIT_UNPACK_H
+#define NVM_CORE_BYTES_DETAILS_V2_INTERNAL_BIT_UNPACK_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace bits {
+
+/// @brief Unpack count 12-bit samples stored MSB first, two samples in three
+/// bytes. src must hold (count * 12 + 7) / 8 bytes.
+void Unpack12Msb(const uint8_t* src, uint16_t* dest, size_t count) noexcept;
+
+/// @brief Unpack count 12-bit samples stored LSB first.
+void Unpack12Lsb(const uint8_t* src, uint16_t* dest, size_t count) noexcept;
+
+}  // namespace bits
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_DETAILS_V2_INTERNAL_BIT_UNPACK_H
@@ -118,7 +118,7 @@ void EncodeUInt16(const uint16_t* value, char* buffer, size_t size,
     return;
   }
 
-  if (size < 4) {
+  if (size < 2) {
     err = ByteOpResult::SizeMismatch;
     return;
   }
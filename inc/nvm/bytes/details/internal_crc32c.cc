@@ -0,0 +1,135 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/bytes/details/internal_crc32c.h"
+
+#include <cstring>
+
+#include "nvm/bytes/details/internal_byte_u8.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define NVM_CRC32C_HAS_SSE42 1
+#endif
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace crc32c {
+
+namespace {
+
+constexpr uint32_t kPolynomial = 0x82F63B78;  // reflected 0x1EDC6F41
+
+struct Tables {
+  uint32_t t[8][256];
+
+  Tables() noexcept {
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t crc = i;
+      for (int k = 0; k < 8; ++k) {
+        crc = (crc & 1) ? (crc >> 1) ^ kPolynomial : crc >> 1;
+      }
+      t[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; ++i) {
+      for (int k = 1; k < 8; ++k) {
+        t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+      }
+    }
+  }
+};
+
+const Tables& GetTables() noexcept {
+  static const Tables tables;
+  return tables;
+}
+
+#if defined(NVM_CRC32C_HAS_SSE42)
+
+__attribute__((target("sse4.2"))) uint32_t ExtendSse42(
+    uint32_t crc, const uint8_t* data, size_t size) noexcept {
+  uint64_t c = ~crc;
+  while (size > 0 && (reinterpret_cast<uintptr_t>(data) & 7) != 0) {
+    c = _mm_crc32_u8(static_cast<uint32_t>(c), *data++);
+    --size;
+  }
+  while (size >= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    c = _mm_crc32_u64(c, word);
+    data += 8;
+    size -= 8;
+  }
+  while (size > 0) {
+    c = _mm_crc32_u8(static_cast<uint32_t>(c), *data++);
+    --size;
+  }
+  return ~static_cast<uint32_t>(c);
+}
+
+inline bool HasSse42() noexcept {
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+
+#endif  // NVM_CRC32C_HAS_SSE42
+
+}  // namespace
+
+uint32_t ExtendPortable(uint32_t crc, const uint8_t* data,
+                        size_t size) noexcept {
+  const auto& t = GetTables().t;
+  uint32_t c = ~crc;
+
+#if NVM_HOST_ENDIAN == ENDIANESS_LITTLE_ENDIAN
+  while (size >= 8) {
+    uint32_t lo;
+    uint32_t hi;
+    std::memcpy(&lo, data, 4);
+    std::memcpy(&hi, data + 4, 4);
+    lo ^= c;
+    c = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^
+        t[4][lo >> 24] ^ t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+        t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    data += 8;
+    size -= 8;
+  }
+#endif
+
+  while (size > 0) {
+    c = t[0][(c ^ *data++) & 0xFF] ^ (c >> 8);
+    --size;
+  }
+  return ~c;
+}
+
+uint32_t Extend(uint32_t crc, const uint8_t* data, size_t size) noexcept {
+#if defined(NVM_CRC32C_HAS_SSE42)
+  if (HasSse42()) {
+    return ExtendSse42(crc, data, size);
+  }
+#endif
+  return ExtendPortable(crc, data, size);
+}
+
+}  // namespace crc32c
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
@@ -0,0 +1,45 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_DETAILS_V2_INTERNAL_CRC32C_H
+#define NVM_CORE_BYTES_DETAILS_V2_INTERNAL_CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace crc32c {
+
+/// @brief Extend a CRC-32C (Castagnoli) value. Pass 0 to start, the result of
+/// a previous call to continue. Uses the SSE4.2 crc32 instruction when the
+/// CPU has it, slicing-by-8 tables otherwise.
+uint32_t Extend(uint32_t crc, const uint8_t* data, size_t size) noexcept;
+
+/// @brief Table driven implementation, exposed for tests.
+uint32_t ExtendPortable(uint32_t crc, const uint8_t* data,
+                        size_t size) noexcept;
+
+}  // namespace crc32c
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_DETAILS_V2_INTERNAL_CRC32C_H
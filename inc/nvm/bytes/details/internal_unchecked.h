@@ -0,0 +1,112 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_DETAILS_V2_INTERNAL_UNCHECKED_H
+#define NVM_CORE_BYTES_DETAILS_V2_INTERNAL_UNCHECKED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "nvm/bytes/details/internal_byte_u8.h"
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace unchecked {
+
+/// Loads and stores without size or nullptr checks, for callers that already
+/// validated the whole range once. Everything is inline so a record decoder
+/// compiles down to plain loads and bswaps.
+
+template <typename T>
+using UIntOf = typename std::conditional<
+    sizeof(T) == 1, uint8_t,
+    typename std::conditional<
+        sizeof(T) == 2, uint16_t,
+        typename std::conditional<sizeof(T) == 4, uint32_t,
+                                  uint64_t>::type>::type>::type;
+
+inline uint8_t ByteSwap(uint8_t v) noexcept {
+  return v;
+}
+
+inline uint16_t ByteSwap(uint16_t v) noexcept {
+  return __builtin_bswap16(v);
+}
+
+inline uint32_t ByteSwap(uint32_t v) noexcept {
+  return __builtin_bswap32(v);
+}
+
+inline uint64_t ByteSwap(uint64_t v) noexcept {
+  return __builtin_bswap64(v);
+}
+
+/// @brief True when a value stored with the requested byte order has to be
+/// swapped on this host.
+inline constexpr bool NeedSwap(bool is_big_endian) noexcept {
+#if NVM_HOST_ENDIAN == ENDIANESS_LITTLE_ENDIAN
+  return is_big_endian;
+#else
+  return !is_big_endian;
+#endif
+}
+
+/// @brief Read T from buffer, buffer must hold sizeof(T) bytes.
+template <typename T>
+inline T Load(const uint8_t* buffer, bool is_big_endian) noexcept {
+  static_assert(std::is_arithmetic<T>::value, "T must be arithmetic");
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+                    sizeof(T) == 8,
+                "T must be 1, 2, 4 or 8 bytes");
+  using U = UIntOf<T>;
+  U raw;
+  std::memcpy(&raw, buffer, sizeof(U));
+  if (NeedSwap(is_big_endian)) {
+    raw = ByteSwap(raw);
+  }
+  T value;
+  std::memcpy(&value, &raw, sizeof(T));
+  return value;
+}
+
+/// @brief Write value into buffer, buffer must hold sizeof(T) bytes.
+template <typename T>
+inline void Store(const T& value, uint8_t* buffer, bool is_big_endian) noexcept {
+  static_assert(std::is_arithmetic<T>::value, "T must be arithmetic");
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+                    sizeof(T) == 8,
+                "T must be 1, 2, 4 or 8 bytes");
+  using U = UIntOf<T>;
+  U raw;
+  std::memcpy(&raw, &value, sizeof(U));
+  if (NeedSwap(is_big_endian)) {
+    raw = ByteSwap(raw);
+  }
+  std::memcpy(buffer, &raw, sizeof(U));
+}
+
+}  // namespace unchecked
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_DETAILS_V2_INTERNAL_UNCHECKED_H
@@ -0,0 +1,277 @@
+/*
+ *  Copyright (c) 2023 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/bytes/details/internal_varint.h"
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace varint {
+
+namespace {
+
+/// Scalar decoder, used near the end of the buffer where an 8-byte load
+/// could run past it.
+uint64_t DecodeVarUInt64Slow(const uint8_t* buffer, size_t size,
+                             size_t& consumed, ByteOpResult& err) noexcept {
+  uint64_t value = 0;
+  size_t limit = size < kMaxVarint64Size ? size : kMaxVarint64Size;
+
+  for (size_t i = 0; i < limit; ++i) {
+    uint8_t b = buffer[i];
+    if (i == kMaxVarint64Size - 1 && b > 1) {
+      // 10th byte may only carry the top bit of a 64-bit value
+      consumed = 0;
+      err = ByteOpResult::Overlong;
+      return 0;
+    }
+
+    value |= static_cast<uint64_t>(b & 0x7F) << (7 * i);
+    if (!(b & 0x80)) {
+      consumed = i + 1;
+      err = ByteOpResult::Ok;
+      return value;
+    }
+  }
+
+  consumed = 0;
+  err = limit == kMaxVarint64Size ? ByteOpResult::Overlong
+                                  : ByteOpResult::Truncated;
+  return 0;
+}
+
+#if NVM_HOST_ENDIAN == ENDIANESS_LITTLE_ENDIAN
+/// Squeeze the 7-bit payload of up to 8 little-endian groups into 56 bits.
+inline uint64_t CompactGroups(uint64_t word) noexcept {
+  word &= 0x7F7F7F7F7F7F7F7FULL;
+  word = ((word & 0x7F007F007F007F00ULL) >> 1) |
+         (word & 0x007F007F007F007FULL);
+  word = ((word & 0x3FFF00003FFF0000ULL) >> 2) |
+         (word & 0x00003FFF00003FFFULL);
+  word = ((word & 0x0FFFFFFF00000000ULL) >> 4) |
+         (word & 0x000000000FFFFFFFULL);
+  return word;
+}
+
+/// Fast decoder, caller guarantees at least kMaxVarint64Size readable bytes.
+/// One 8-byte load locates the terminator, no per-byte branches for values
+/// up to 56 bits.
+uint64_t DecodeVarUInt64Fast(const uint8_t* buffer, size_t& consumed,
+                             ByteOpResult& err) noexcept {
+  uint64_t word;
+  std::memcpy(&word, buffer, sizeof(word));
+
+  uint64_t stops = ~word & 0x8080808080808080ULL;
+  if (stops) {
+    int len = (__builtin_ctzll(stops) >> 3) + 1;
+    uint64_t mask = len == 8 ? ~0ULL : ((1ULL << (len * 8)) - 1);
+    consumed = static_cast<size_t>(len);
+    err = ByteOpResult::Ok;
+    return CompactGroups(word & mask);
+  }
+
+  uint64_t value = CompactGroups(word);
+  uint8_t b8 = buffer[8];
+  value |= static_cast<uint64_t>(b8 & 0x7F) << 56;
+  if (!(b8 & 0x80)) {
+    consumed = 9;
+    err = ByteOpResult::Ok;
+    return value;
+  }
+
+  uint8_t b9 = buffer[9];
+  if (b9 > 1) {
+    consumed = 0;
+    err = ByteOpResult::Overlong;
+    return 0;
+  }
+
+  value |= static_cast<uint64_t>(b9) << 63;
+  consumed = 10;
+  err = ByteOpResult::Ok;
+  return value;
+}
+#endif
+
+}  // namespace
+
+size_t EncodeVarUInt64(uint64_t value, uint8_t* buffer, size_t size,
+                       ByteOpResult& err) noexcept {
+  if (!buffer) {
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  size_t needed = VarintSize(value);
+  if (size < needed) {
+    err = ByteOpResult::SizeMismatch;
+    return 0;
+  }
+
+  size_t i = 0;
+  while (value >= 0x80) {
+    buffer[i++] = static_cast<uint8_t>(value | 0x80);
+    value >>= 7;
+  }
+  buffer[i++] = static_cast<uint8_t>(value);
+
+  err = ByteOpResult::Ok;
+  return i;
+}
+
+size_t EncodeVarUInt32(uint32_t value, uint8_t* buffer, size_t size,
+                       ByteOpResult& err) noexcept {
+  return EncodeVarUInt64(value, buffer, size, err);
+}
+
+uint64_t DecodeVarUInt64(const uint8_t* buffer, size_t size, size_t& consumed,
+                         ByteOpResult& err) noexcept {
+  if (!buffer) {
+    consumed = 0;
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  if (size == 0) {
+    consumed = 0;
+    err = ByteOpResult::Truncated;
+    return 0;
+  }
+
+  // Single byte values are by far the most common, skip everything else.
+  if (!(buffer[0] & 0x80)) {
+    consumed = 1;
+    err = ByteOpResult::Ok;
+    return buffer[0];
+  }
+
+#if NVM_HOST_ENDIAN == ENDIANESS_LITTLE_ENDIAN
+  if (size >= kMaxVarint64Size) {
+    return DecodeVarUInt64Fast(buffer, consumed, err);
+  }
+#endif
+
+  return DecodeVarUInt64Slow(buffer, size, consumed, err);
+}
+
+uint32_t DecodeVarUInt32(const uint8_t* buffer, size_t size, size_t& consumed,
+                         ByteOpResult& err) noexcept {
+  uint64_t value = DecodeVarUInt64(buffer, size, consumed, err);
+  if (err != ByteOpResult::Ok) {
+    return 0;
+  }
+
+  if (consumed > kMaxVarint32Size || value > UINT32_MAX) {
+    consumed = 0;
+    err = ByteOpResult::Overlong;
+    return 0;
+  }
+
+  return static_cast<uint32_t>(value);
+}
+
+size_t EncodeVarUInt64Array(const uint64_t* values, size_t count,
+                            uint8_t* buffer, size_t size,
+                            ByteOpResult& err) noexcept {
+  if (!values || !buffer) {
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    offset += EncodeVarUInt64(values[i], buffer + offset, size - offset, err);
+    if (err != ByteOpResult::Ok) {
+      return offset;
+    }
+  }
+
+  err = ByteOpResult::Ok;
+  return offset;
+}
+
+size_t EncodeVarInt64Array(const int64_t* values, size_t count,
+                           uint8_t* buffer, size_t size,
+                           ByteOpResult& err) noexcept {
+  if (!values || !buffer) {
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  size_t offset = 0;
+  for (size_t i = 0; i < count; ++i) {
+    offset += EncodeVarUInt64(ZigZagEncode64(values[i]), buffer + offset,
+                              size - offset, err);
+    if (err != ByteOpResult::Ok) {
+      return offset;
+    }
+  }
+
+  err = ByteOpResult::Ok;
+  return offset;
+}
+
+size_t DecodeVarUInt64Array(const uint8_t* buffer, size_t size,
+                            uint64_t* values, size_t count,
+                            ByteOpResult& err) noexcept {
+  if (!values || !buffer) {
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  size_t offset = 0;
+  size_t consumed = 0;
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = DecodeVarUInt64(buffer + offset, size - offset, consumed, err);
+    if (err != ByteOpResult::Ok) {
+      return offset;
+    }
+    offset += consumed;
+  }
+
+  err = ByteOpResult::Ok;
+  return offset;
+}
+
+size_t DecodeVarInt64Array(const uint8_t* buffer, size_t size, int64_t* values,
+                           size_t count, ByteOpResult& err) noexcept {
+  if (!values || !buffer) {
+    err = ByteOpResult::Nullptr;
+    return 0;
+  }
+
+  size_t offset = 0;
+  size_t consumed = 0;
+  for (size_t i = 0; i < count; ++i) {
+    values[i] = ZigZagDecode64(
+        DecodeVarUInt64(buffer + offset, size - offset, consumed, err));
+    if (err != ByteOpResult::Ok) {
+      return offset;
+    }
+    offset += consumed;
+  }
+
+  err = ByteOpResult::Ok;
+  return offset;
+}
+
+}  // namespace varint
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
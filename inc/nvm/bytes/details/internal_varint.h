@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2023 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_DETAILS_V2_INTERNAL_VARINT_H
+#define NVM_CORE_BYTES_DETAILS_V2_INTERNAL_VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/bytes/details/internal_byte_u8.h"
+
+namespace nvm {
+namespace bytes {
+namespace details {
+namespace varint {
+
+/// @brief Maximum encoded size of a 64-bit LEB128 value.
+constexpr size_t kMaxVarint64Size = 10;
+
+/// @brief Maximum encoded size of a 32-bit LEB128 value.
+constexpr size_t kMaxVarint32Size = 5;
+
+/// @brief Map signed to unsigned so small magnitudes stay small,
+/// 0 -> 0, -1 -> 1, 1 -> 2, -2 -> 3 and so on.
+constexpr uint64_t ZigZagEncode64(int64_t value) noexcept {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+constexpr int64_t ZigZagDecode64(uint64_t value) noexcept {
+  return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+constexpr uint32_t ZigZagEncode32(int32_t value) noexcept {
+  return (static_cast<uint32_t>(value) << 1) ^
+         static_cast<uint32_t>(value >> 31);
+}
+
+constexpr int32_t ZigZagDecode32(uint32_t value) noexcept {
+  return static_cast<int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+/// @brief Number of bytes needed to encode value as LEB128.
+constexpr size_t VarintSize(uint64_t value) noexcept {
+  size_t n = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++n;
+  }
+  return n;
+}
+
+size_t EncodeVarUInt64(uint64_t value, uint8_t* buffer, size_t size,
+                       ByteOpResult& err) noexcept;
+
+size_t EncodeVarUInt32(uint32_t value, uint8_t* buffer, size_t size,
+                       ByteOpResult& err) noexcept;
+
+uint64_t DecodeVarUInt64(const uint8_t* buffer, size_t size, size_t& consumed,
+                         ByteOpResult& err) noexcept;
+
+uint32_t DecodeVarUInt32(const uint8_t* buffer, size_t size, size_t& consumed,
+                         ByteOpResult& err) noexcept;
+
+size_t EncodeVarUInt64Array(const uint64_t* values, size_t count,
+                            uint8_t* buffer, size_t size,
+                            ByteOpResult& err) noexcept;
+
+size_t EncodeVarInt64Array(const int64_t* values, size_t count,
+                           uint8_t* buffer, size_t size,
+                           ByteOpResult& err) noexcept;
+
+size_t DecodeVarUInt64Array(const uint8_t* buffer, size_t size,
+                            uint64_t* values, size_t count,
+                            ByteOpResult& err) noexcept;
+
+size_t DecodeVarInt64Array(const uint8_t* buffer, size_t size, int64_t* values,
+                           size_t count, ByteOpResult& err) noexcept;
+
+}  // namespace varint
+}  // namespace details
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_DETAILS_V2_INTERNAL_VARINT_H
@@ -0,0 +1,155 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_ENDIAN_OVERLAY_H
+#define NVM_CORE_BYTES_V2_ENDIAN_OVERLAY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/span.h"
+
+namespace nvm {
+namespace bytes {
+
+/// @brief Packed scalar stored in a fixed byte order. It is only sizeof(T)
+/// bytes with alignment 1, so a struct made of these maps a wire header byte
+/// for byte. Reading compiles to one unaligned load plus a bswap when the
+/// byte order differs from the host.
+/// @tparam T integer or floating point type of 1, 2, 4 or 8 bytes
+/// @tparam IsBigEndian byte order in memory
+template <typename T, bool IsBigEndian>
+class EndianValue {
+  static_assert(std::is_arithmetic<T>::value, "T must be arithmetic");
+  static_assert(sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 ||
+                    sizeof(T) == 8,
+                "T must be 1, 2, 4 or 8 bytes, long double is not supported");
+
+ private:
+  uint8_t bytes_[sizeof(T)];
+
+ public:
+  using value_type = T;
+
+  EndianValue() noexcept = default;
+
+  // cppcheck-suppress noExplicitConstructor
+  EndianValue(T value) noexcept {
+    Set(value);
+  }
+
+  T Get() const noexcept {
+    return details::unchecked::Load<T>(bytes_, IsBigEndian);
+  }
+
+  void Set(T value) noexcept {
+    details::unchecked::Store<T>(value, bytes_, IsBigEndian);
+  }
+
+  operator T() const noexcept {
+    return Get();
+  }
+
+  EndianValue& operator=(T value) noexcept {
+    Set(value);
+    return *this;
+  }
+
+  /// @brief Raw bytes in wire order.
+  const uint8_t* Bytes() const noexcept {
+    return bytes_;
+  }
+};
+
+template <typename T>
+using BigEndian = EndianValue<T, true>;
+
+template <typename T>
+using LittleEndian = EndianValue<T, false>;
+
+/// @brief True when T can be laid over raw bytes: no padding can appear, so
+/// every member must itself have alignment 1 (EndianValue, uint8_t, arrays
+/// of those).
+template <typename T>
+struct IsOverlayable
+    : std::integral_constant<bool, std::is_standard_layout<T>::value &&
+                                       std::is_trivially_copyable<T>::value &&
+                                       alignof(T) == 1> {};
+
+/// @brief View bytes [offset, offset + sizeof(T)) as T without copying.
+/// @tparam T overlay struct, see IsOverlayable
+/// @param bytes
+/// @param offset
+/// @return nullptr when the span is too short
+template <typename T>
+const T* Overlay(const Span<const uint8_t>& bytes, size_t offset = 0) noexcept {
+  static_assert(IsOverlayable<T>::value,
+                "T must be standard layout with alignment 1, build it from "
+                "BigEndian<>/LittleEndian<> and uint8_t members");
+  if (!bytes.Data() || offset > bytes.Size() ||
+      bytes.Size() - offset < sizeof(T)) {
+    return nullptr;
+  }
+  return reinterpret_cast<const T*>(bytes.Data() + offset);
+}
+
+/// @brief Writable overlay, assignments go straight into the buffer.
+template <typename T>
+T* Overlay(const Span<uint8_t>& bytes, size_t offset = 0) noexcept {
+  static_assert(IsOverlayable<T>::value,
+                "T must be standard layout with alignment 1, build it from "
+                "BigEndian<>/LittleEndian<> and uint8_t members");
+  if (!bytes.Data() || offset > bytes.Size() ||
+      bytes.Size() - offset < sizeof(T)) {
+    return nullptr;
+  }
+  return reinterpret_cast<T*>(bytes.Data() + offset);
+}
+
+/// @brief View as many whole T records as fit in bytes, trailing bytes are
+/// ignored.
+template <typename T>
+Span<const T> OverlayArray(const Span<const uint8_t>& bytes) noexcept {
+  static_assert(IsOverlayable<T>::value,
+                "T must be standard layout with alignment 1, build it from "
+                "BigEndian<>/LittleEndian<> and uint8_t members");
+  if (!bytes.Data()) {
+    return Span<const T>();
+  }
+  return Span<const T>(reinterpret_cast<const T*>(bytes.Data()),
+                       bytes.Size() / sizeof(T));
+}
+
+template <typename T>
+Span<T> OverlayArray(const Span<uint8_t>& bytes) noexcept {
+  static_assert(IsOverlayable<T>::value,
+                "T must be standard layout with alignment 1, build it from "
+                "BigEndian<>/LittleEndian<> and uint8_t members");
+  if (!bytes.Data()) {
+    return Span<T>();
+  }
+  return Span<T>(reinterpret_cast<T*>(bytes.Data()), bytes.Size() / sizeof(T));
+}
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_ENDIAN_OVERLAY_H
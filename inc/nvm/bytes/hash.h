@@ -0,0 +1,349 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_HASH_H
+#define NVM_CORE_BYTES_V2_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/span.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+namespace nvm {
+namespace bytes {
+
+namespace details {
+namespace hash {
+
+/// Multiply-mix construction of wyhash (public domain). Not cryptographic.
+/// Output is stable across platforms, input words are read little-endian.
+
+constexpr uint64_t kSecret[4] = {0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+                                 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+
+/// Seed offset of the second 128-bit lane.
+constexpr uint64_t kSecondLane = 0x9e3779b97f4a7c15ULL;
+
+inline void Mum(uint64_t& a, uint64_t& b) noexcept {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t r = static_cast<__uint128_t>(a) * b;
+  a = static_cast<uint64_t>(r);
+  b = static_cast<uint64_t>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+  a = _umul128(a, b, &b);
+#else
+  uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<uint32_t>(a),
+           lb = static_cast<uint32_t>(b);
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32);
+  uint64_t c = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  c += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+  a = lo;
+  b = hi;
+#endif
+}
+
+inline uint64_t Mix(uint64_t a, uint64_t b) noexcept {
+  Mum(a, b);
+  return a ^ b;
+}
+
+inline uint64_t Read8(const uint8_t* p) noexcept {
+  return unchecked::Load<uint64_t>(p, false);
+}
+
+inline uint64_t Read4(const uint8_t* p) noexcept {
+  return unchecked::Load<uint32_t>(p, false);
+}
+
+inline uint64_t Read3(const uint8_t* p, size_t k) noexcept {
+  return (static_cast<uint64_t>(p[0]) << 16) |
+         (static_cast<uint64_t>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+inline uint64_t InitSeed(uint64_t seed) noexcept {
+  return seed ^ Mix(seed ^ kSecret[0], kSecret[1]);
+}
+
+/// One 48 byte round over three independent lanes.
+inline void Round48(const uint8_t* p, uint64_t& seed, uint64_t& see1,
+                    uint64_t& see2) noexcept {
+  seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+  see1 = Mix(Read8(p + 16) ^ kSecret[2], Read8(p + 24) ^ see1);
+  see2 = Mix(Read8(p + 32) ^ kSecret[3], Read8(p + 40) ^ see2);
+}
+
+/// Hash the last 1 to 48 bytes ending at p + i, at least 16 bytes before p
+/// must be readable when the input was longer than 48 bytes.
+inline uint64_t Tail(const uint8_t* p, size_t i, uint64_t seed,
+                     uint64_t len) noexcept {
+  while (i > 16) {
+    seed = Mix(Read8(p) ^ kSecret[1], Read8(p + 8) ^ seed);
+    i -= 16;
+    p += 16;
+  }
+  uint64_t a = Read8(p + i - 16) ^ kSecret[1];
+  uint64_t b = Read8(p + i - 8) ^ seed;
+  Mum(a, b);
+  return Mix(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+}
+
+inline uint64_t Hash(const uint8_t* p, size_t len, uint64_t seed) noexcept {
+  seed = InitSeed(seed);
+  if (len <= 16) {
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len >= 4) {
+      size_t step = (len >> 3) << 2;
+      a = (Read4(p) << 32) | Read4(p + step);
+      b = (Read4(p + len - 4) << 32) | Read4(p + len - 4 - step);
+    } else if (len > 0) {
+      a = Read3(p, len);
+    }
+    a ^= kSecret[1];
+    b ^= seed;
+    Mum(a, b);
+    return Mix(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+  }
+
+  size_t i = len;
+  if (i > 48) {
+    uint64_t see1 = seed;
+    uint64_t see2 = seed;
+    do {
+      Round48(p, seed, see1, see2);
+      p += 48;
+      i -= 48;
+    } while (i > 48);
+    seed ^= see1 ^ see2;
+  }
+  return Tail(p, i, seed, len);
+}
+
+}  // namespace hash
+}  // namespace details
+
+/// @brief 128-bit hash value.
+struct Hash128Value {
+  uint64_t low;
+  uint64_t high;
+
+  bool operator==(const Hash128Value& other) const noexcept {
+    return low == other.low && high == other.high;
+  }
+
+  bool operator!=(const Hash128Value& other) const noexcept {
+    return !(*this == other);
+  }
+};
+
+/// @brief Fast non-cryptographic 64-bit hash (wyhash construction). Use it
+/// for hash tables, cache keys, fingerprints and sharding, never for
+/// anything security related.
+/// @param data
+/// @param size
+/// @param seed
+/// @return
+inline uint64_t Hash64(const void* data, size_t size,
+                       uint64_t seed = 0) noexcept {
+  return details::hash::Hash(static_cast<const uint8_t*>(data), size, seed);
+}
+
+inline uint64_t Hash64(const Span<const uint8_t>& data,
+                       uint64_t seed = 0) noexcept {
+  return Hash64(data.Data(), data.Size(), seed);
+}
+
+inline uint64_t Hash64(const std::string& data, uint64_t seed = 0) noexcept {
+  return Hash64(data.data(), data.size(), seed);
+}
+
+/// @brief 128-bit variant, two independently seeded 64-bit lanes. Use it
+/// where 64 bits give too many collisions, e.g. content addressed keys over
+/// billions of items.
+inline Hash128Value Hash128(const void* data, size_t size,
+                            uint64_t seed = 0) noexcept {
+  auto p = static_cast<const uint8_t*>(data);
+  return Hash128Value{
+      details::hash::Hash(p, size, seed),
+      details::hash::Hash(p, size, seed ^ details::hash::kSecondLane)};
+}
+
+inline Hash128Value Hash128(const Span<const uint8_t>& data,
+                            uint64_t seed = 0) noexcept {
+  return Hash128(data.Data(), data.Size(), seed);
+}
+
+inline Hash128Value Hash128(const std::string& data,
+                            uint64_t seed = 0) noexcept {
+  return Hash128(data.data(), data.size(), seed);
+}
+
+/// @brief Streaming form of Hash64, the digest equals Hash64 over all bytes
+/// passed to Update() no matter how they were split.
+class Hasher64 {
+ private:
+  uint64_t seed_;
+  uint64_t state_;
+  uint64_t see1_;
+  uint64_t see2_;
+  uint64_t total_;
+  // [0, 16) last processed bytes, [16, 16 + pending_) unprocessed bytes
+  uint8_t buffer_[16 + 48];
+  size_t pending_;
+
+ public:
+  explicit Hasher64(uint64_t seed = 0) noexcept {
+    Reset(seed);
+  }
+
+  void Reset(uint64_t seed = 0) noexcept {
+    seed_ = seed;
+    state_ = details::hash::InitSeed(seed);
+    see1_ = state_;
+    see2_ = state_;
+    total_ = 0;
+    pending_ = 0;
+  }
+
+  Hasher64& Update(const void* data, size_t size) noexcept {
+    auto p = static_cast<const uint8_t*>(data);
+    if (size == 0) {
+      return *this;
+    }
+    total_ += size;
+
+    uint8_t* pending = buffer_ + 16;
+    if (pending_ > 0) {
+      // a full block is only processed once more input is known to follow
+      size_t take = 48 - pending_;
+      if (size <= take) {
+        std::memcpy(pending + pending_, p, size);
+        pending_ += size;
+        return *this;
+      }
+      std::memcpy(pending + pending_, p, take);
+      details::hash::Round48(pending, state_, see1_, see2_);
+      std::memcpy(buffer_, pending + 32, 16);
+      p += take;
+      size -= take;
+      pending_ = 0;
+    }
+
+    if (size > 48) {
+      do {
+        details::hash::Round48(p, state_, see1_, see2_);
+        p += 48;
+        size -= 48;
+      } while (size > 48);
+      std::memcpy(buffer_, p - 16, 16);
+    }
+
+    std::memcpy(pending, p, size);
+    pending_ = size;
+    return *this;
+  }
+
+  Hasher64& Update(const Span<const uint8_t>& data) noexcept {
+    return Update(data.Data(), data.Size());
+  }
+
+  Hasher64& Update(const std::string& data) noexcept {
+    return Update(data.data(), data.size());
+  }
+
+  /// @brief Hash of everything so far, the hasher can keep going.
+  uint64_t Digest() const noexcept {
+    if (total_ <= 48) {
+      return details::hash::Hash(buffer_ + 16, pending_, seed_);
+    }
+    return details::hash::Tail(buffer_ + 16, pending_,
+                               state_ ^ see1_ ^ see2_, total_);
+  }
+};
+
+/// @brief Streaming form of Hash128.
+class Hasher128 {
+ private:
+  Hasher64 low_;
+  Hasher64 high_;
+
+ public:
+  explicit Hasher128(uint64_t seed = 0) noexcept
+                  : low_(seed), high_(seed ^ details::hash::kSecondLane) {}
+
+  void Reset(uint64_t seed = 0) noexcept {
+    low_.Reset(seed);
+    high_.Reset(seed ^ details::hash::kSecondLane);
+  }
+
+  Hasher128& Update(const void* data, size_t size) noexcept {
+    low_.Update(data, size);
+    high_.Update(data, size);
+    return *this;
+  }
+
+  Hasher128& Update(const Span<const uint8_t>& data) noexcept {
+    return Update(data.Data(), data.Size());
+  }
+
+  Hasher128& Update(const std::string& data) noexcept {
+    return Update(data.data(), data.size());
+  }
+
+  Hash128Value Digest() const noexcept {
+    return Hash128Value{low_.Digest(), high_.Digest()};
+  }
+};
+
+/// @brief std::hash compatible functor, e.g.
+/// std::unordered_map<std::string, V, bytes::BytesHash>.
+struct BytesHash {
+  using is_transparent = void;
+
+  size_t operator()(const std::string& value) const noexcept {
+    return static_cast<size_t>(Hash64(value.data(), value.size()));
+  }
+
+  size_t operator()(const char* value) const noexcept {
+    return static_cast<size_t>(Hash64(value, std::strlen(value)));
+  }
+
+  size_t operator()(const Span<const uint8_t>& value) const noexcept {
+    return static_cast<size_t>(Hash64(value.Data(), value.Size()));
+  }
+
+  size_t operator()(const Span<const char>& value) const noexcept {
+    return static_cast<size_t>(Hash64(value.Data(), value.Size()));
+  }
+};
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_HASH_H
@@ -0,0 +1,309 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/bytes/lz_block.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace nvm {
+namespace bytes {
+
+namespace {
+
+constexpr int kHashLog = 14;
+constexpr uint32_t kEmpty = 0xFFFFFFFF;
+constexpr size_t kMinMatch = 4;
+// format rules: the last 5 bytes are literals, the last match starts at
+// least 12 bytes before the end
+constexpr size_t kLastLiterals = 5;
+constexpr size_t kMatchFindLimit = 12;
+constexpr int kSkipTrigger = 6;
+
+inline uint32_t Read32(const uint8_t* p) noexcept {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t HashPosition(const uint8_t* p) noexcept {
+  return (Read32(p) * 2654435761U) >> (32 - kHashLog);
+}
+
+inline size_t CountMatch(const uint8_t* a, const uint8_t* b,
+                         const uint8_t* limit) noexcept {
+  const uint8_t* start = a;
+  while (a + 8 <= limit) {
+    uint64_t x;
+    uint64_t y;
+    std::memcpy(&x, a, 8);
+    std::memcpy(&y, b, 8);
+    uint64_t diff = x ^ y;
+    if (diff) {
+#if defined(__GNUC__) || defined(__clang__)
+      // first differing byte, input bytes are compared in memory order
+      if (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__) {
+        return static_cast<size_t>(a - start) + (__builtin_ctzll(diff) >> 3);
+      }
+#endif
+      break;
+    }
+    a += 8;
+    b += 8;
+  }
+  while (a < limit && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return static_cast<size_t>(a - start);
+}
+
+/// Write a length continuation (255 runs), returns false when out of room.
+inline bool WriteLength(size_t length, uint8_t*& op,
+                        const uint8_t* oend) noexcept {
+  while (length >= 255) {
+    if (op >= oend) {
+      return false;
+    }
+    *op++ = 255;
+    length -= 255;
+  }
+  if (op >= oend) {
+    return false;
+  }
+  *op++ = static_cast<uint8_t>(length);
+  return true;
+}
+
+/// Emit literals [anchor, anchor + literals) with the token, the match part
+/// of the token is filled in by the caller.
+inline uint8_t* WriteLiterals(const uint8_t* anchor, size_t literals,
+                              uint8_t*& op, const uint8_t* oend) noexcept {
+  if (op >= oend) {
+    return nullptr;
+  }
+  uint8_t* token = op++;
+  if (literals >= 15) {
+    *token = 15 << 4;
+    if (!WriteLength(literals - 15, op, oend)) {
+      return nullptr;
+    }
+  } else {
+    *token = static_cast<uint8_t>(literals << 4);
+  }
+  if (static_cast<size_t>(oend - op) < literals) {
+    return nullptr;
+  }
+  if (literals > 0) {
+    std::memcpy(op, anchor, literals);
+  }
+  op += literals;
+  return token;
+}
+
+}  // namespace
+
+LzCompressor::LzCompressor() : table_(size_t(1) << kHashLog, kEmpty) {}
+
+size_t LzCompressor::Compress(const uint8_t* src, size_t size, uint8_t* dest,
+                              size_t capacity, size_t prefix) noexcept {
+  if (!dest || (!src && size > 0)) {
+    return 0;
+  }
+  if (prefix > kLzMaxDistance) {
+    prefix = kLzMaxDistance;
+  }
+
+  const uint8_t* base = src - prefix;
+  const uint8_t* ip = src;
+  const uint8_t* anchor = src;
+  const uint8_t* const iend = src + size;
+  uint8_t* op = dest;
+  const uint8_t* const oend = dest + capacity;
+  uint32_t* table = table_.data();
+
+  std::fill(table_.begin(), table_.end(), kEmpty);
+
+  if (size >= kMatchFindLimit + 1) {
+    const uint8_t* const mflimit = iend - kMatchFindLimit;
+    const uint8_t* const matchlimit = iend - kLastLiterals;
+
+    // history positions, the last ones may read into src which is fine
+    for (size_t i = 0; i < prefix; ++i) {
+      table[HashPosition(base + i)] = static_cast<uint32_t>(i);
+    }
+
+    while (true) {
+      const uint8_t* match = nullptr;
+      unsigned search = 1u << kSkipTrigger;
+
+      // find a match, stepping faster through incompressible data
+      while (true) {
+        if (ip > mflimit) {
+          goto last_literals;
+        }
+        uint32_t h = HashPosition(ip);
+        uint32_t candidate = table[h];
+        table[h] = static_cast<uint32_t>(ip - base);
+        if (candidate != kEmpty) {
+          const uint8_t* ref = base + candidate;
+          if (static_cast<size_t>(ip - ref) <= kLzMaxDistance &&
+              Read32(ref) == Read32(ip)) {
+            match = ref;
+            break;
+          }
+        }
+        ip += search++ >> kSkipTrigger;
+      }
+
+      // extend backwards over equal bytes
+      while (ip > anchor && match > base && ip[-1] == match[-1]) {
+        --ip;
+        --match;
+      }
+
+      uint8_t* token =
+          WriteLiterals(anchor, static_cast<size_t>(ip - anchor), op, oend);
+      if (!token || oend - op < 2) {
+        return 0;
+      }
+
+      size_t offset = static_cast<size_t>(ip - match);
+      *op++ = static_cast<uint8_t>(offset);
+      *op++ = static_cast<uint8_t>(offset >> 8);
+
+      size_t length =
+          kMinMatch + CountMatch(ip + kMinMatch, match + kMinMatch, matchlimit);
+      size_t code = length - kMinMatch;
+      if (code >= 15) {
+        *token |= 15;
+        if (!WriteLength(code - 15, op, oend)) {
+          return 0;
+        }
+      } else {
+        *token |= static_cast<uint8_t>(code);
+      }
+
+      ip += length;
+      anchor = ip;
+      if (ip > mflimit) {
+        break;
+      }
+      table[HashPosition(ip - 2)] = static_cast<uint32_t>(ip - 2 - base);
+    }
+  }
+
+last_literals:
+  if (!WriteLiterals(anchor, static_cast<size_t>(iend - anchor), op, oend)) {
+    return 0;
+  }
+  return static_cast<size_t>(op - dest);
+}
+
+ByteOpResult LzDecompress(const uint8_t* src, size_t size, uint8_t* dest,
+                          size_t capacity, size_t& written,
+                          size_t prefix) noexcept {
+  written = 0;
+  if (!src || (!dest && capacity > 0)) {
+    return ByteOpResult::Nullptr;
+  }
+
+  const uint8_t* ip = src;
+  const uint8_t* const iend = src + size;
+  uint8_t* op = dest;
+  uint8_t* const oend = dest + capacity;
+  const uint8_t* const lowest = dest - prefix;
+
+  while (true) {
+    if (ip >= iend) {
+      return ByteOpResult::Truncated;
+    }
+    unsigned token = *ip++;
+
+    size_t literals = token >> 4;
+    if (literals == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend) {
+          return ByteOpResult::Truncated;
+        }
+        b = *ip++;
+        literals += b;
+      } while (b == 255);
+    }
+    if (static_cast<size_t>(iend - ip) < literals) {
+      return ByteOpResult::Truncated;
+    }
+    if (static_cast<size_t>(oend - op) < literals) {
+      return ByteOpResult::SizeMismatch;
+    }
+    if (literals > 0) {
+      std::memcpy(op, ip, literals);
+    }
+    ip += literals;
+    op += literals;
+
+    if (ip == iend) {
+      // the last sequence carries literals only
+      break;
+    }
+
+    if (iend - ip < 2) {
+      return ByteOpResult::Truncated;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    if (offset == 0 || offset > static_cast<size_t>(op - lowest)) {
+      return ByteOpResult::None;
+    }
+
+    size_t length = token & 15;
+    if (length == 15) {
+      uint8_t b;
+      do {
+        if (ip >= iend) {
+          return ByteOpResult::Truncated;
+        }
+        b = *ip++;
+        length += b;
+      } while (b == 255);
+    }
+    length += kMinMatch;
+    if (static_cast<size_t>(oend - op) < length) {
+      return ByteOpResult::SizeMismatch;
+    }
+
+    const uint8_t* match = op - offset;
+    if (offset >= length) {
+      std::memcpy(op, match, length);
+      op += length;
+    } else {
+      // overlapping copy repeats the last offset bytes
+      for (size_t i = 0; i < length; ++i) {
+        *op++ = *match++;
+      }
+    }
+  }
+
+  written = static_cast<size_t>(op - dest);
+  return ByteOpResult::Ok;
+}
+
+}  // namespace bytes
+}  // namespace nvm
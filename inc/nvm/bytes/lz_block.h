@@ -0,0 +1,80 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_LZ_BLOCK_H
+#define NVM_CORE_BYTES_V2_LZ_BLOCK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "nvm/bytes/byte_declaration.h"
+
+namespace nvm {
+namespace bytes {
+
+/// @brief Largest distance a match may reach back.
+constexpr size_t kLzMaxDistance = 65535;
+
+/// @brief Worst case compressed size of size input bytes.
+inline size_t LzCompressBound(size_t size) noexcept {
+  return size + size / 255 + 16;
+}
+
+/// @brief Block compressor producing the LZ4 block format (token, literals,
+/// 16-bit little-endian offset, match length). Greedy hash-chain free
+/// matching, tuned for speed over ratio. Keep one instance per thread and
+/// reuse it, the hash table is allocated once.
+class LzCompressor {
+ private:
+  std::vector<uint32_t> table_;
+
+ public:
+  LzCompressor();
+
+  /// @brief Compress src into dest.
+  /// @param src input, the prefix bytes right before src are history that
+  /// matches may reference (linked blocks)
+  /// @param size
+  /// @param dest
+  /// @param capacity
+  /// @param prefix history bytes readable before src, at most
+  /// kLzMaxDistance are used
+  /// @return compressed size, 0 when dest is too small (store the block raw)
+  size_t Compress(const uint8_t* src, size_t size, uint8_t* dest,
+                  size_t capacity, size_t prefix = 0) noexcept;
+};
+
+/// @brief Decompress one block.
+/// @param src
+/// @param size
+/// @param dest
+/// @param capacity
+/// @param written decompressed bytes
+/// @param prefix history bytes readable before dest, used by linked blocks
+/// @return Ok, Nullptr, Truncated when the input ends inside a sequence,
+/// SizeMismatch when the output does not fit, None on an invalid offset
+ByteOpResult LzDecompress(const uint8_t* src, size_t size, uint8_t* dest,
+                          size_t capacity, size_t& written,
+                          size_t prefix = 0) noexcept;
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_LZ_BLOCK_H
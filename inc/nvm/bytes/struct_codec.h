@@ -0,0 +1,363 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_STRUCT_CODEC_H
+#define NVM_CORE_BYTES_V2_STRUCT_CODEC_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/struct_mapper.h"
+
+namespace nvm {
+namespace bytes {
+
+/// @brief Wire field markers for RecordCodec layouts. Plain arithmetic types
+/// in a layout use the endianess passed to the codec, these override it or
+/// describe fields that have no direct C++ counterpart.
+namespace wire {
+
+/// @brief T stored big endian regardless of the record endianess.
+template <typename T>
+struct Be {};
+
+/// @brief T stored little endian regardless of the record endianess.
+template <typename T>
+struct Le {};
+
+/// @brief N bytes of text, NUL padded. Decodes into std::string without the
+/// padding, encoding truncates to N bytes.
+template <size_t N>
+struct FixedString {};
+
+/// @brief Describes how one layout entry is laid out on the wire.
+template <typename TField, typename = void>
+struct FieldTraits;
+
+template <typename T>
+struct FieldTraits<T, std::enable_if_t<std::is_arithmetic<T>::value &&
+                                       !std::is_same<T, bool>::value>> {
+  using value_type = T;
+  static constexpr size_t kSize = sizeof(T);
+
+  static value_type Decode(const uint8_t* p, bool is_big_endian) noexcept {
+    return details::unchecked::Load<T>(p, is_big_endian);
+  }
+
+  static void Encode(const value_type& v, uint8_t* p,
+                     bool is_big_endian) noexcept {
+    details::unchecked::Store<T>(v, p, is_big_endian);
+  }
+};
+
+template <>
+struct FieldTraits<bool> {
+  using value_type = bool;
+  static constexpr size_t kSize = 1;
+
+  static value_type Decode(const uint8_t* p, bool) noexcept {
+    return *p != 0;
+  }
+
+  static void Encode(const value_type& v, uint8_t* p, bool) noexcept {
+    *p = v ? 1 : 0;
+  }
+};
+
+template <typename T>
+struct FieldTraits<Be<T>> {
+  using value_type = T;
+  static constexpr size_t kSize = sizeof(T);
+
+  static value_type Decode(const uint8_t* p, bool) noexcept {
+    return details::unchecked::Load<T>(p, true);
+  }
+
+  static void Encode(const value_type& v, uint8_t* p, bool) noexcept {
+    details::unchecked::Store<T>(v, p, true);
+  }
+};
+
+template <typename T>
+struct FieldTraits<Le<T>> {
+  using value_type = T;
+  static constexpr size_t kSize = sizeof(T);
+
+  static value_type Decode(const uint8_t* p, bool) noexcept {
+    return details::unchecked::Load<T>(p, false);
+  }
+
+  static void Encode(const value_type& v, uint8_t* p, bool) noexcept {
+    details::unchecked::Store<T>(v, p, false);
+  }
+};
+
+template <size_t N>
+struct FieldTraits<FixedString<N>> {
+  using value_type = std::string;
+  static constexpr size_t kSize = N;
+
+  static value_type Decode(const uint8_t* p, bool) {
+    auto end = static_cast<const uint8_t*>(std::memchr(p, 0, N));
+    return std::string(reinterpret_cast<const char*>(p),
+                       end ? static_cast<size_t>(end - p) : N);
+  }
+
+  static void Encode(const value_type& v, uint8_t* p, bool) noexcept {
+    size_t n = v.size() < N ? v.size() : N;
+    std::memcpy(p, v.data(), n);
+    std::memset(p + n, 0, N - n);
+  }
+};
+
+}  // namespace wire
+
+namespace details {
+namespace codec {
+
+template <typename T, typename = void>
+struct HasWireTypes : std::false_type {};
+
+template <typename T>
+struct HasWireTypes<T, std::void_t<typename T::wire_types>> : std::true_type {
+};
+
+template <typename T, typename = void>
+struct HasTypes : std::false_type {};
+
+template <typename T>
+struct HasTypes<T, std::void_t<typename T::types>> : std::true_type {};
+
+template <typename T, typename = void>
+struct HasTie : std::false_type {};
+
+template <typename T>
+struct HasTie<T, std::void_t<decltype(std::declval<const T&>().Tie())>>
+    : std::true_type {};
+
+/// wire_types when declared, otherwise the mapper types tuple.
+template <typename T, bool = HasWireTypes<T>::value>
+struct LayoutOf {
+  using type = typename T::wire_types;
+};
+
+template <typename T>
+struct LayoutOf<T, false> {
+  using type = typename T::types;
+};
+
+/// Member type of field I, falls back to the decoded wire type.
+template <typename T, typename TLayout, size_t I, bool = HasTypes<T>::value>
+struct MemberOf {
+  using type = typename std::tuple_element<I, typename T::types>::type;
+};
+
+template <typename T, typename TLayout, size_t I>
+struct MemberOf<T, TLayout, I, false> {
+  using type = typename wire::FieldTraits<
+      typename std::tuple_element<I, TLayout>::type>::value_type;
+};
+
+template <typename TLayout, size_t... I>
+constexpr std::array<size_t, sizeof...(I) + 1> MakeOffsets(
+    std::index_sequence<I...>) {
+  constexpr size_t sizes[] = {
+      wire::FieldTraits<typename std::tuple_element<I, TLayout>::type>::kSize...,
+      0};
+  std::array<size_t, sizeof...(I) + 1> offsets{};
+  for (size_t i = 0; i < sizeof...(I); ++i) {
+    offsets[i + 1] = offsets[i] + sizes[i];
+  }
+  return offsets;
+}
+
+}  // namespace codec
+}  // namespace details
+
+/// @brief Whole-record binary codec generated from the struct layout.
+///
+/// T declares its wire layout with `using wire_types = std::tuple<...>` or,
+/// when the wire matches the members, reuses the `types` tuple consumed by
+/// mapper::MakeStructFromTuple. Decoding builds T by aggregate
+/// initialization, converting each wire value with mapper::TypeCaster when
+/// both tuples are present. Encoding needs `auto Tie() const` returning
+/// std::tie of the members in layout order.
+///
+/// Offsets and the record size are compile-time constants, a record costs a
+/// single bounds check and the fields are plain loads.
+/// @tparam T aggregate record type
+template <typename T>
+class RecordCodec {
+ public:
+  using layout = typename details::codec::LayoutOf<T>::type;
+
+  static constexpr size_t kFieldCount = std::tuple_size<layout>::value;
+
+ private:
+  using Indices = std::make_index_sequence<kFieldCount>;
+
+  static constexpr std::array<size_t, kFieldCount + 1> kOffsets =
+      details::codec::MakeOffsets<layout>(Indices{});
+
+  template <size_t I>
+  using Field = wire::FieldTraits<typename std::tuple_element<I, layout>::type>;
+
+  template <size_t I>
+  using Member = typename details::codec::MemberOf<T, layout, I>::type;
+
+  template <size_t... I>
+  static T DecodeImpl(const uint8_t* p, bool is_big_endian,
+                      std::index_sequence<I...>) {
+    return T{mapper::TypeCaster<typename Field<I>::value_type, Member<I>>::Cast(
+        Field<I>::Decode(p + kOffsets[I], is_big_endian))...};
+  }
+
+  template <typename TTuple, size_t... I>
+  static void EncodeImpl(const TTuple& values, uint8_t* p, bool is_big_endian,
+                         std::index_sequence<I...>) {
+    (Field<I>::Encode(
+         static_cast<typename Field<I>::value_type>(std::get<I>(values)),
+         p + kOffsets[I], is_big_endian),
+     ...);
+  }
+
+ public:
+  /// @brief Bytes per encoded record.
+  static constexpr size_t kRecordSize = kOffsets[kFieldCount];
+
+  /// @brief Byte offset of field I inside a record.
+  static constexpr size_t Offset(size_t i) {
+    return kOffsets[i];
+  }
+
+  /// @brief Decode one record, buffer must hold kRecordSize bytes.
+  static T DecodeUnchecked(const uint8_t* buffer, bool is_big_endian) {
+    return DecodeImpl(buffer, is_big_endian, Indices{});
+  }
+
+  /// @brief Encode one record, buffer must hold kRecordSize bytes.
+  static void EncodeUnchecked(const T& record, uint8_t* buffer,
+                              bool is_big_endian) {
+    static_assert(details::codec::HasTie<T>::value,
+                  "T needs `auto Tie() const` returning std::tie(members...)");
+    EncodeImpl(record.Tie(), buffer, is_big_endian, Indices{});
+  }
+
+  /// @brief Decode one record.
+  /// @param buffer
+  /// @param size
+  /// @param out
+  /// @param endianess byte order of the fields without Be/Le marker
+  /// @return SizeMismatch when size < kRecordSize
+  static ByteOpResult Decode(
+      const uint8_t* buffer, size_t size, T& out,
+      EndianessType endianess = EndianessType::LittleEndian) {
+    if (!buffer) {
+      return ByteOpResult::Nullptr;
+    }
+    if (size < kRecordSize) {
+      return ByteOpResult::SizeMismatch;
+    }
+
+    out = DecodeUnchecked(buffer, endianess == EndianessType::BigEndian);
+    return ByteOpResult::Ok;
+  }
+
+  /// @brief Encode one record.
+  /// @return SizeMismatch when size < kRecordSize
+  static ByteOpResult Encode(
+      const T& record, uint8_t* buffer, size_t size,
+      EndianessType endianess = EndianessType::LittleEndian) {
+    if (!buffer) {
+      return ByteOpResult::Nullptr;
+    }
+    if (size < kRecordSize) {
+      return ByteOpResult::SizeMismatch;
+    }
+
+    EncodeUnchecked(record, buffer, endianess == EndianessType::BigEndian);
+    return ByteOpResult::Ok;
+  }
+
+  /// @brief Decode count consecutive records and append them to out. The
+  /// range is checked once for the whole array.
+  /// @return SizeMismatch when size < count * kRecordSize, out is untouched
+  static ByteOpResult DecodeArray(
+      const uint8_t* buffer, size_t size, size_t count, std::vector<T>& out,
+      EndianessType endianess = EndianessType::LittleEndian) {
+    if (!buffer && count > 0) {
+      return ByteOpResult::Nullptr;
+    }
+    if (kRecordSize != 0 && count > size / kRecordSize) {
+      return ByteOpResult::SizeMismatch;
+    }
+
+    bool is_big_endian = endianess == EndianessType::BigEndian;
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; ++i) {
+      out.push_back(DecodeUnchecked(buffer + i * kRecordSize, is_big_endian));
+    }
+    return ByteOpResult::Ok;
+  }
+
+  /// @brief Decode every whole record in buffer, a trailing partial record
+  /// is left alone.
+  /// @param consumed bytes decoded, a multiple of kRecordSize
+  static ByteOpResult DecodeArray(
+      const uint8_t* buffer, size_t size, std::vector<T>& out,
+      size_t& consumed,
+      EndianessType endianess = EndianessType::LittleEndian) {
+    size_t count = kRecordSize != 0 ? size / kRecordSize : 0;
+    auto result = DecodeArray(buffer, size, count, out, endianess);
+    consumed = result == ByteOpResult::Ok ? count * kRecordSize : 0;
+    return result;
+  }
+
+  /// @brief Append count records to out, out grows once.
+  static ByteOpResult EncodeArray(
+      const T* records, size_t count, std::vector<uint8_t>& out,
+      EndianessType endianess = EndianessType::LittleEndian) {
+    if (!records && count > 0) {
+      return ByteOpResult::Nullptr;
+    }
+
+    bool is_big_endian = endianess == EndianessType::BigEndian;
+    size_t base = out.size();
+    out.resize(base + count * kRecordSize);
+    for (size_t i = 0; i < count; ++i) {
+      EncodeUnchecked(records[i], out.data() + base + i * kRecordSize,
+                      is_big_endian);
+    }
+    return ByteOpResult::Ok;
+  }
+};
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_STRUCT_CODEC_H
@@ -0,0 +1,216 @@
+/*
+ *  Copyright (c) 2023 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_BYTES_V2_VARINT_H
+#define NVM_CORE_BYTES_V2_VARINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/bytes/details/internal_varint.h"
+
+namespace nvm {
+namespace bytes {
+
+using details::varint::kMaxVarint32Size;
+using details::varint::kMaxVarint64Size;
+using details::varint::VarintSize;
+using details::varint::ZigZagDecode32;
+using details::varint::ZigZagDecode64;
+using details::varint::ZigZagEncode32;
+using details::varint::ZigZagEncode64;
+
+/// @brief Encode integer as LEB128 varint. Signed types are zigzag encoded
+/// first, so small negative numbers stay short.
+/// @tparam TVal int32_t, int64_t, uint32_t or uint64_t
+/// @tparam TSeq char or uint8_t
+/// @param val
+/// @param dest
+/// @param dest_size
+/// @param written number of bytes written into dest
+/// @return
+template <typename TVal, typename TSeq>
+ByteOpResult ToVarintBytes(const TVal& val, TSeq* dest,
+                           const size_t& dest_size, size_t& written) noexcept {
+  static_assert(
+      std::is_same<TSeq, char>::value || std::is_same<TSeq, uint8_t>::value,
+      "T can only be char or uint8_t");
+  static_assert(
+      std::is_same<TVal, int32_t>::value ||
+          std::is_same<TVal, int64_t>::value ||
+          std::is_same<TVal, uint32_t>::value ||
+          std::is_same<TVal, uint64_t>::value,
+      "TVal can only be int32_t, int64_t, uint32_t or uint64_t");
+
+  auto result = ByteOpResult::None;
+  auto buffer = reinterpret_cast<uint8_t*>(dest);
+
+  if constexpr (std::is_same<TVal, int32_t>::value) {
+    written = details::varint::EncodeVarUInt32(ZigZagEncode32(val), buffer,
+                                               dest_size, result);
+  } else if constexpr (std::is_same<TVal, int64_t>::value) {
+    written = details::varint::EncodeVarUInt64(ZigZagEncode64(val), buffer,
+                                               dest_size, result);
+  } else if constexpr (std::is_same<TVal, uint32_t>::value) {
+    written =
+        details::varint::EncodeVarUInt32(val, buffer, dest_size, result);
+  } else {
+    written =
+        details::varint::EncodeVarUInt64(val, buffer, dest_size, result);
+  }
+
+  return result;
+}
+
+/// @brief Decode unsigned LEB128 varint.
+/// @tparam T char or uint8_t
+/// @param bytes
+/// @param size
+/// @param consumed number of bytes read, 0 on failure
+/// @param result Truncated if input ends mid-value, Overlong if the encoding
+/// does not fit into 64-bit.
+/// @return
+template <typename T>
+uint64_t ToVarUint64(const T* bytes, const size_t& size, size_t& consumed,
+                     ByteOpResult& result) noexcept {
+  static_assert(std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
+                "T can only be char or uint8_t");
+
+  return details::varint::DecodeVarUInt64(
+      reinterpret_cast<const uint8_t*>(bytes), size, consumed, result);
+}
+
+/// @brief Decode unsigned LEB128 varint.
+/// @tparam T char or uint8_t
+/// @param bytes
+/// @param size
+/// @param consumed number of bytes read, 0 on failure
+/// @param result Truncated if input ends mid-value, Overlong if the encoding
+/// does not fit into 32-bit.
+/// @return
+template <typename T>
+uint32_t ToVarUint32(const T* bytes, const size_t& size, size_t& consumed,
+                     ByteOpResult& result) noexcept {
+  static_assert(std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
+                "T can only be char or uint8_t");
+
+  return details::varint::DecodeVarUInt32(
+      reinterpret_cast<const uint8_t*>(bytes), size, consumed, result);
+}
+
+/// @brief Decode zigzag signed LEB128 varint.
+/// @tparam T char or uint8_t
+/// @param bytes
+/// @param size
+/// @param consumed
+/// @param result
+/// @return
+template <typename T>
+int64_t ToVarInt64(const T* bytes, const size_t& size, size_t& consumed,
+                   ByteOpResult& result) noexcept {
+  return ZigZagDecode64(ToVarUint64(bytes, size, consumed, result));
+}
+
+/// @brief Decode zigzag signed LEB128 varint.
+/// @tparam T char or uint8_t
+/// @param bytes
+/// @param size
+/// @param consumed
+/// @param result
+/// @return
+template <typename T>
+int32_t ToVarInt32(const T* bytes, const size_t& size, size_t& consumed,
+                   ByteOpResult& result) noexcept {
+  return ZigZagDecode32(ToVarUint32(bytes, size, consumed, result));
+}
+
+/// @brief Encode array of integers as consecutive LEB128 varints.
+/// @tparam TVal int64_t or uint64_t
+/// @tparam TSeq char or uint8_t
+/// @param vals
+/// @param count number of elements in vals
+/// @param dest
+/// @param dest_size
+/// @param written number of bytes written, on failure the bytes of every
+/// fully encoded element.
+/// @return
+template <typename TVal, typename TSeq>
+ByteOpResult ToVarintBytesArray(const TVal* vals, const size_t& count,
+                                TSeq* dest, const size_t& dest_size,
+                                size_t& written) noexcept {
+  static_assert(
+      std::is_same<TSeq, char>::value || std::is_same<TSeq, uint8_t>::value,
+      "T can only be char or uint8_t");
+  static_assert(
+      std::is_same<TVal, int64_t>::value || std::is_same<TVal, uint64_t>::value,
+      "TVal can only be int64_t or uint64_t");
+
+  auto result = ByteOpResult::None;
+  auto buffer = reinterpret_cast<uint8_t*>(dest);
+
+  if constexpr (std::is_same<TVal, int64_t>::value) {
+    written = details::varint::EncodeVarInt64Array(vals, count, buffer,
+                                                   dest_size, result);
+  } else {
+    written = details::varint::EncodeVarUInt64Array(vals, count, buffer,
+                                                    dest_size, result);
+  }
+
+  return result;
+}
+
+/// @brief Decode count consecutive LEB128 varints.
+/// @tparam TVal int64_t or uint64_t
+/// @tparam TSeq char or uint8_t
+/// @param bytes
+/// @param size
+/// @param vals destination, must hold count elements
+/// @param count
+/// @param consumed number of bytes read
+/// @return
+template <typename TVal, typename TSeq>
+ByteOpResult ToVarintArray(const TSeq* bytes, const size_t& size, TVal* vals,
+                           const size_t& count, size_t& consumed) noexcept {
+  static_assert(
+      std::is_same<TSeq, char>::value || std::is_same<TSeq, uint8_t>::value,
+      "T can only be char or uint8_t");
+  static_assert(
+      std::is_same<TVal, int64_t>::value || std::is_same<TVal, uint64_t>::value,
+      "TVal can only be int64_t or uint64_t");
+
+  auto result = ByteOpResult::None;
+  auto buffer = reinterpret_cast<const uint8_t*>(bytes);
+
+  if constexpr (std::is_same<TVal, int64_t>::value) {
+    consumed = details::varint::DecodeVarInt64Array(buffer, size, vals, count,
+                                                    result);
+  } else {
+    consumed = details::varint::DecodeVarUInt64Array(buffer, size, vals, count,
+                                                     result);
+  }
+
+  return result;
+}
+
+}  // namespace bytes
+}  // namespace nvm
+
+#endif  // NVM_CORE_BYTES_V2_VARINT_H
@@ -0,0 +1,702 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/io/async_file.h"
+
+#ifdef NVM_IO_HAS_ASYNC_FILE
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#ifdef NVM_IO_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace nvm {
+namespace io {
+
+struct AsyncFile::Operation {
+  std::promise<int64_t> promise;
+  AsyncIoCallback callback;
+};
+
+namespace {
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+  return what + " '" + path + "': " + std::strerror(errno);
+}
+
+/// Blocking positional transfer used by the ThreadPool backend, retries on
+/// EINTR and short transfers.
+int64_t TransferAll(int fd, bool is_write, uint8_t* buffer, size_t length,
+                    uint64_t offset) noexcept {
+  size_t done = 0;
+  while (done < length) {
+    ssize_t n = is_write ? ::pwrite(fd, buffer + done, length - done,
+                                    static_cast<off_t>(offset + done))
+                         : ::pread(fd, buffer + done, length - done,
+                                   static_cast<off_t>(offset + done));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -errno;
+    }
+    if (n == 0) {
+      break;
+    }
+    done += static_cast<size_t>(n);
+  }
+  return static_cast<int64_t>(done);
+}
+
+#ifdef NVM_IO_HAS_IO_URING
+/// Linux MAX_RW_COUNT, the most a single read or write transfers.
+constexpr size_t kMaxTransfer = 0x7ffff000;
+#endif
+
+}  // namespace
+
+namespace details {
+
+#ifdef NVM_IO_HAS_IO_URING
+
+/// Minimal io_uring driver on raw system calls, the library does not depend
+/// on liburing.
+struct IoUringRing {
+  int fd = -1;
+  uint8_t* sq_ptr = nullptr;
+  size_t sq_len = 0;
+  uint8_t* cq_ptr = nullptr;
+  size_t cq_len = 0;
+  io_uring_sqe* sqes = nullptr;
+  size_t sqes_len = 0;
+
+  unsigned* sq_head = nullptr;
+  unsigned* sq_tail = nullptr;
+  unsigned* sq_mask = nullptr;
+  unsigned* sq_array = nullptr;
+  unsigned sq_entries = 0;
+  unsigned* cq_head = nullptr;
+  unsigned* cq_tail = nullptr;
+  unsigned* cq_mask = nullptr;
+  io_uring_cqe* cqes = nullptr;
+  unsigned cq_entries = 0;
+
+  unsigned unsubmitted = 0;
+  bool buffers_registered = false;
+  std::thread completion_thread;
+
+  ~IoUringRing() {
+    if (sqes) {
+      ::munmap(sqes, sqes_len);
+    }
+    if (cq_ptr && cq_ptr != sq_ptr) {
+      ::munmap(cq_ptr, cq_len);
+    }
+    if (sq_ptr) {
+      ::munmap(sq_ptr, sq_len);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  static int Enter(int fd, unsigned to_submit, unsigned min_complete,
+                   unsigned flags) noexcept {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit,
+                                      min_complete, flags, nullptr, 0));
+  }
+
+  /// Plain READ/WRITE arrived in 5.6 while the ring itself exists since 5.1,
+  /// a ring without them would fail every unregistered transfer with EINVAL.
+  /// IORING_REGISTER_PROBE is 5.6 as well, so a failing probe means missing.
+  static bool SupportsTransferOps(int fd) noexcept {
+    constexpr unsigned kProbeOps = 256;
+    std::vector<uint8_t> storage(sizeof(io_uring_probe) +
+                                 kProbeOps * sizeof(io_uring_probe_op));
+    auto probe = reinterpret_cast<io_uring_probe*>(storage.data());
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe,
+                  kProbeOps) < 0) {
+      return false;
+    }
+
+    for (unsigned op : {IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED,
+                        IORING_OP_WRITE_FIXED}) {
+      if (op > probe->last_op ||
+          !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// @return nullptr when the kernel does not provide io_uring or lacks the
+  /// read/write opcodes
+  static std::unique_ptr<IoUringRing> Create(uint32_t entries) noexcept {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    auto ring = std::make_unique<IoUringRing>();
+    ring->fd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if (ring->fd < 0 || !SupportsTransferOps(ring->fd)) {
+      return nullptr;
+    }
+
+    ring->sq_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_len =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+      ring->sq_len = ring->cq_len = std::max(ring->sq_len, ring->cq_len);
+    }
+
+    void* sq = ::mmap(nullptr, ring->sq_len, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+      return nullptr;
+    }
+    ring->sq_ptr = static_cast<uint8_t*>(sq);
+
+    if (single_mmap) {
+      ring->cq_ptr = ring->sq_ptr;
+    } else {
+      void* cq = ::mmap(nullptr, ring->cq_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+      if (cq == MAP_FAILED) {
+        return nullptr;
+      }
+      ring->cq_ptr = static_cast<uint8_t*>(cq);
+    }
+
+    ring->sqes_len = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqes = ::mmap(nullptr, ring->sqes_len, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      return nullptr;
+    }
+    ring->sqes = static_cast<io_uring_sqe*>(sqes);
+
+    auto sq_at = [&](uint32_t off) {
+      return reinterpret_cast<unsigned*>(ring->sq_ptr + off);
+    };
+    auto cq_at = [&](uint32_t off) {
+      return reinterpret_cast<unsigned*>(ring->cq_ptr + off);
+    };
+    ring->sq_head = sq_at(params.sq_off.head);
+    ring->sq_tail = sq_at(params.sq_off.tail);
+    ring->sq_mask = sq_at(params.sq_off.ring_mask);
+    ring->sq_array = sq_at(params.sq_off.array);
+    ring->sq_entries = params.sq_entries;
+    ring->cq_head = cq_at(params.cq_off.head);
+    ring->cq_tail = cq_at(params.cq_off.tail);
+    ring->cq_mask = cq_at(params.cq_off.ring_mask);
+    ring->cqes =
+        reinterpret_cast<io_uring_cqe*>(ring->cq_ptr + params.cq_off.cqes);
+    ring->cq_entries = params.cq_entries;
+
+    // Probe with a NOP, seccomp profiles may allow setup but block enter.
+    io_uring_sqe* sqe = ring->NextSqe();
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = 0;
+    if (ring->Flush() != 0 ||
+        Enter(ring->fd, 0, 1, IORING_ENTER_GETEVENTS) < 0) {
+      return nullptr;
+    }
+    ring->Reap([](uint64_t, int32_t) {});
+    return ring;
+  }
+
+  /// Caller holds the submit lock and made sure a slot is free.
+  io_uring_sqe* NextSqe() noexcept {
+    unsigned tail = *sq_tail;
+    unsigned index = tail & *sq_mask;
+    io_uring_sqe* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    sq_array[index] = index;
+    __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++unsubmitted;
+    return sqe;
+  }
+
+  /// Hand every queued entry to the kernel with as few calls as possible.
+  /// @return 0 or -errno
+  int Flush() noexcept {
+    while (unsubmitted > 0) {
+      int n = Enter(fd, unsubmitted, 0, 0);
+      if (n < 0) {
+        if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+          std::this_thread::yield();
+          continue;
+        }
+        return -errno;
+      }
+      unsubmitted -= static_cast<unsigned>(n);
+    }
+    return 0;
+  }
+
+  /// Take back the entries Flush() could not hand over, the kernel only
+  /// reads the submission queue inside io_uring_enter.
+  /// @return number of entries dropped, always the tail of the last batch
+  unsigned DropUnsubmitted() noexcept {
+    unsigned dropped = unsubmitted;
+    __atomic_store_n(sq_tail, *sq_tail - dropped, __ATOMIC_RELEASE);
+    unsubmitted = 0;
+    return dropped;
+  }
+
+  /// Consume every available completion.
+  /// @return number of completions
+  template <typename F>
+  size_t Reap(F&& on_cqe) noexcept {
+    unsigned head = *cq_head;
+    unsigned tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+    size_t count = 0;
+    while (head != tail) {
+      io_uring_cqe* cqe = &cqes[head & *cq_mask];
+      uint64_t user_data = cqe->user_data;
+      int32_t res = cqe->res;
+      ++head;
+      __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+      on_cqe(user_data, res);
+      ++count;
+    }
+    return count;
+  }
+};
+
+#else
+
+struct IoUringRing {};
+
+#endif  // NVM_IO_HAS_IO_URING
+
+}  // namespace details
+
+AsyncFile::AsyncFile(const std::string& path, AsyncFileMode mode,
+                     AsyncFileOptions options)
+                : fd_(-1),
+                  backend_(AsyncIoBackend::ThreadPool),
+                  pool_(options.pool),
+                  inflight_(0),
+                  inflight_limit_(options.queue_depth == 0
+                                      ? 64
+                                      : options.queue_depth) {
+  int flags = O_CLOEXEC;
+  switch (mode) {
+    case AsyncFileMode::Read:
+      flags |= O_RDONLY;
+      break;
+    case AsyncFileMode::Write:
+      flags |= O_WRONLY | O_CREAT | O_TRUNC;
+      break;
+    default:
+      flags |= O_RDWR | O_CREAT;
+      break;
+  }
+
+  fd_ = ::open(path.c_str(), flags, 0644);
+  if (fd_ < 0) {
+    throw IoException(ErrnoMessage("AsyncFile: failed to open", path));
+  }
+
+#ifdef NVM_IO_HAS_IO_URING
+  if (options.prefer_io_uring) {
+    ring_ = details::IoUringRing::Create(static_cast<uint32_t>(inflight_limit_));
+  }
+
+  if (ring_) {
+    backend_ = AsyncIoBackend::IoUring;
+    // The submission queue can not overflow while in-flight operations are
+    // capped at its size, the completion queue is twice as large.
+    inflight_limit_ = ring_->sq_entries;
+    ring_->completion_thread = std::thread([this] { RunCompletions(); });
+    return;
+  }
+#endif
+
+  if (!pool_) {
+    pool_ = threads::TaskPool::Create(4);
+  }
+}
+
+AsyncFile::~AsyncFile() {
+  Shutdown();
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+void AsyncFile::Shutdown() noexcept {
+  Drain();
+
+#ifdef NVM_IO_HAS_IO_URING
+  if (ring_ && ring_->completion_thread.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(submit_mutex_);
+      io_uring_sqe* sqe = ring_->NextSqe();
+      sqe->opcode = IORING_OP_NOP;
+      sqe->user_data = 0;  // stop marker
+      ring_->Flush();
+    }
+    ring_->completion_thread.join();
+  }
+#endif
+}
+
+uint64_t AsyncFile::FileSize() const {
+  struct stat st;
+  if (::fstat(fd_, &st) != 0) {
+    throw IoException(std::string("AsyncFile: fstat failed: ") +
+                      std::strerror(errno));
+  }
+  return static_cast<uint64_t>(st.st_size);
+}
+
+bool AsyncFile::RegisterBuffers(const std::vector<Span<uint8_t>>& buffers) {
+  Drain();
+  buffers_ = buffers;
+
+#ifdef NVM_IO_HAS_IO_URING
+  if (ring_) {
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    if (ring_->buffers_registered) {
+      ::syscall(__NR_io_uring_register, ring_->fd, IORING_UNREGISTER_BUFFERS,
+                nullptr, 0);
+      ring_->buffers_registered = false;
+    }
+
+    if (buffers_.empty()) {
+      return true;
+    }
+
+    std::vector<iovec> iov(buffers_.size());
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      iov[i].iov_base = buffers_[i].Data();
+      iov[i].iov_len = buffers_[i].Size();
+    }
+    ring_->buffers_registered =
+        ::syscall(__NR_io_uring_register, ring_->fd, IORING_REGISTER_BUFFERS,
+                  iov.data(), static_cast<unsigned>(iov.size())) == 0;
+    return ring_->buffers_registered;
+  }
+#endif
+
+  return true;
+}
+
+void AsyncFile::Acquire(size_t n) {
+  std::unique_lock<std::mutex> lock(inflight_mutex_);
+  inflight_cv_.wait(lock, [&] { return inflight_ + n <= inflight_limit_; });
+  inflight_ += n;
+}
+
+void AsyncFile::Release(size_t n) noexcept {
+  if (n == 0) {
+    return;
+  }
+  // notify under the lock, a Drain() in the destructor may return and
+  // destroy the condition variable as soon as the lock is released
+  std::lock_guard<std::mutex> lock(inflight_mutex_);
+  inflight_ -= n;
+  inflight_cv_.notify_all();
+}
+
+void AsyncFile::Complete(Operation* op, int64_t result) noexcept {
+  if (op->callback && pool_ && backend_ == AsyncIoBackend::IoUring) {
+    AsyncIoCallback cb = std::move(op->callback);
+    delete op;
+    // the slot is released after the callback ran, so Drain() waits for
+    // callbacks like on the ThreadPool backend. Never block the completion
+    // thread on a full pool, deliver inline when the queue is full or the
+    // pool stopped.
+    auto deliver = [this, cb, result]() noexcept {
+      cb(result);
+      Release(1);
+    };
+    bool posted = false;
+    try {
+      posted = pool_->TryExecuteTask(deliver);
+    } catch (...) {
+      posted = false;
+    }
+    if (!posted) {
+      deliver();
+    }
+    return;
+  }
+
+  if (op->callback) {
+    op->callback(result);
+  } else {
+    op->promise.set_value(result);
+  }
+  delete op;
+  Release(1);
+}
+
+void AsyncFile::Abandon(std::vector<Operation*>& ops, size_t from,
+                        std::exception_ptr error) noexcept {
+  for (size_t i = from; i < ops.size(); ++i) {
+    Operation* op = ops[i];
+    if (op->callback) {
+      op->callback(-ECANCELED);
+    } else {
+      op->promise.set_exception(error);
+    }
+    delete op;
+    ops[i] = nullptr;
+  }
+}
+
+void AsyncFile::Enqueue(bool is_write,
+                        const std::vector<AsyncIoRequest>& requests,
+                        std::vector<Operation*>& ops) {
+  size_t start = 0;
+  while (start < requests.size()) {
+    size_t count = std::min(requests.size() - start, inflight_limit_);
+    Acquire(count);
+
+    std::lock_guard<std::mutex> lock(submit_mutex_);
+    // ops before `queued` belong to the kernel or the pool, on failure the
+    // rest is released, failed and deleted here
+    size_t queued = start;
+    try {
+      for (size_t i = start; i < start + count; ++i) {
+        AsyncIoRequest req = requests[i];
+        Operation* op = ops[i];
+        bool registered =
+            req.buffer_index >= 0 &&
+            static_cast<size_t>(req.buffer_index) < buffers_.size();
+        if (registered && !req.buffer) {
+          req.buffer = buffers_[req.buffer_index].Data();
+          if (req.length == 0) {
+            req.length = buffers_[req.buffer_index].Size();
+          }
+        }
+
+#ifdef NVM_IO_HAS_IO_URING
+        if (ring_) {
+          io_uring_sqe* sqe = ring_->NextSqe();
+          bool fixed = registered && ring_->buffers_registered;
+          if (fixed) {
+            sqe->opcode =
+                is_write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+            sqe->buf_index = static_cast<uint16_t>(req.buffer_index);
+          } else {
+            sqe->opcode = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+          }
+          sqe->fd = fd_;
+          sqe->off = req.offset;
+          sqe->addr = reinterpret_cast<uint64_t>(req.buffer);
+          // the kernel caps one transfer like pread does, larger requests
+          // complete short instead of wrapping the 32-bit length
+          sqe->len = static_cast<uint32_t>(
+              std::min<size_t>(req.length, kMaxTransfer));
+          sqe->user_data = reinterpret_cast<uint64_t>(op);
+          continue;
+        }
+#endif
+
+        int fd = fd_;
+        pool_->ExecuteTask([this, fd, is_write, req, op]() {
+          Complete(op, TransferAll(fd, is_write, req.buffer, req.length,
+                                   req.offset));
+        });
+        queued = i + 1;
+      }
+
+#ifdef NVM_IO_HAS_IO_URING
+      if (ring_) {
+        int err = ring_->Flush();
+        queued = start + count - ring_->DropUnsubmitted();
+        if (err != 0) {
+          throw IoException(
+              std::string("AsyncFile: io_uring submit failed: ") +
+              std::strerror(-err));
+        }
+      }
+#endif
+    } catch (...) {
+      Release(start + count - queued);
+      Abandon(ops, queued, std::current_exception());
+      throw;
+    }
+
+    start += count;
+  }
+}
+
+void AsyncFile::RunCompletions() noexcept {
+#ifdef NVM_IO_HAS_IO_URING
+  bool stop = false;
+  while (!stop) {
+    int n = details::IoUringRing::Enter(ring_->fd, 0, 1,
+                                        IORING_ENTER_GETEVENTS);
+    if (n < 0 && errno != EINTR) {
+      std::this_thread::yield();
+    }
+
+    ring_->Reap([&](uint64_t user_data, int32_t res) {
+      if (user_data == 0) {
+        stop = true;
+        return;
+      }
+      Complete(reinterpret_cast<Operation*>(user_data), res);
+    });
+  }
+#endif
+}
+
+std::future<int64_t> AsyncFile::Read(uint64_t offset, Span<uint8_t> dest) {
+  auto futures = ReadBatch({AsyncIoRequest{offset, dest.Data(), dest.Size()}});
+  return std::move(futures.front());
+}
+
+std::future<int64_t> AsyncFile::Write(uint64_t offset,
+                                      Span<const uint8_t> src) {
+  auto futures = WriteBatch({AsyncIoRequest{
+      offset, const_cast<uint8_t*>(src.Data()), src.Size()}});
+  return std::move(futures.front());
+}
+
+void AsyncFile::Read(uint64_t offset, Span<uint8_t> dest,
+                     AsyncIoCallback on_complete) {
+  std::vector<Operation*> ops{new Operation()};
+  ops[0]->callback = std::move(on_complete);
+  Enqueue(false, {AsyncIoRequest{offset, dest.Data(), dest.Size()}}, ops);
+}
+
+void AsyncFile::Write(uint64_t offset, Span<const uint8_t> src,
+                      AsyncIoCallback on_complete) {
+  std::vector<Operation*> ops{new Operation()};
+  ops[0]->callback = std::move(on_complete);
+  Enqueue(true,
+          {AsyncIoRequest{offset, const_cast<uint8_t*>(src.Data()),
+                          src.Size()}},
+          ops);
+}
+
+std::vector<std::future<int64_t>> AsyncFile::ReadBatch(
+    const std::vector<AsyncIoRequest>& requests) {
+  std::vector<Operation*> ops(requests.size());
+  std::vector<std::future<int64_t>> futures(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i) {
+    ops[i] = new Operation();
+    futures[i] = ops[i]->promise.get_future();
+  }
+  Enqueue(false, requests, ops);
+  return futures;
+}
+
+std::vector<std::future<int64_t>> AsyncFile::WriteBatch(
+    const std::vector<AsyncIoRequest>& requests) {
+  std::vector<Operation*> ops(requests.size());
+  std::vector<std::future<int64_t>> futures(requests.size());
+  for (size_t i = 0; i < requests.size(); ++i) {
+    ops[i] = new Operation();
+    futures[i] = ops[i]->promise.get_future();
+  }
+  Enqueue(true, requests, ops);
+  return futures;
+}
+
+std::vector<uint8_t> AsyncFile::ReadAll(size_t chunk_size) {
+  if (chunk_size == 0) {
+    chunk_size = 1 << 20;
+  }
+
+  std::vector<uint8_t> content(FileSize());
+  std::vector<AsyncIoRequest> requests;
+  for (size_t offset = 0; offset < content.size(); offset += chunk_size) {
+    size_t length = std::min(chunk_size, content.size() - offset);
+    requests.push_back(AsyncIoRequest{offset, content.data() + offset, length});
+  }
+
+  auto futures = ReadBatch(requests);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    int64_t res = futures[i].get();
+    auto& req = requests[i];
+    // short reads only happen near EOF, finish the chunk in place
+    while (res > 0 && static_cast<size_t>(res) < req.length) {
+      req.offset += res;
+      req.buffer += res;
+      req.length -= res;
+      res = Read(req.offset, Span<uint8_t>(req.buffer, req.length)).get();
+    }
+    if (res <= 0 && req.length > 0) {
+      throw IoException(std::string("AsyncFile: read failed: ") +
+                        (res < 0 ? std::strerror(static_cast<int>(-res))
+                                 : "unexpected end of file"));
+    }
+  }
+  return content;
+}
+
+void AsyncFile::WriteAll(uint64_t offset, Span<const uint8_t> src,
+                         size_t chunk_size) {
+  if (chunk_size == 0) {
+    chunk_size = 1 << 20;
+  }
+
+  auto base = const_cast<uint8_t*>(src.Data());
+  std::vector<AsyncIoRequest> requests;
+  for (size_t pos = 0; pos < src.Size(); pos += chunk_size) {
+    size_t length = std::min(chunk_size, src.Size() - pos);
+    requests.push_back(AsyncIoRequest{offset + pos, base + pos, length});
+  }
+
+  auto futures = WriteBatch(requests);
+  for (size_t i = 0; i < futures.size(); ++i) {
+    int64_t res = futures[i].get();
+    auto& req = requests[i];
+    while (res > 0 && static_cast<size_t>(res) < req.length) {
+      req.offset += res;
+      req.buffer += res;
+      req.length -= res;
+      res = Write(req.offset, Span<const uint8_t>(req.buffer, req.length))
+                .get();
+    }
+    if (res <= 0 && req.length > 0) {
+      throw IoException(std::string("AsyncFile: write failed: ") +
+                        (res < 0 ? std::strerror(static_cast<int>(-res))
+                                 : "nothing written"));
+    }
+  }
+}
+
+void AsyncFile::Drain() {
+  std::unique_lock<std::mutex> lock(inflight_mutex_);
+  inflight_cv_.wait(lock, [this] { return inflight_ == 0; });
+}
+
+}  // namespace io
+}  // namespace nvm
+
+#endif  // NVM_IO_HAS_ASYNC_FILE
@@ -0,0 +1,215 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_IO_V2_ASYNC_FILE_H
+#define NVM_CORE_IO_V2_ASYNC_FILE_H
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NVM_IO_HAS_ASYNC_FILE 1
+#endif
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define NVM_IO_HAS_IO_URING 1
+#endif
+#endif
+
+#ifdef NVM_IO_HAS_ASYNC_FILE
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "nvm/exceptions/exception.h"
+#include "nvm/macro.h"
+#include "nvm/span.h"
+#include "nvm/threads/task_pool.h"
+
+namespace nvm {
+namespace io {
+
+enum class AsyncIoBackend : uint8_t {
+  /// @brief Linux io_uring, one submission queue per file.
+  IoUring = 1,
+  /// @brief Blocking pread/pwrite executed on a TaskPool.
+  ThreadPool = 2,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(AsyncIoBackend)
+
+enum class AsyncFileMode : uint8_t {
+  Read = 1,
+  /// @brief Create or truncate.
+  Write = 2,
+  /// @brief Create if missing, keep content.
+  ReadWrite = 3,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(AsyncFileMode)
+
+/// @brief Completion callback, receives bytes transferred or -errno.
+using AsyncIoCallback = std::function<void(int64_t)>;
+
+struct AsyncFileOptions {
+  /// @brief Submission queue entries, io_uring rounds up to power of two.
+  uint32_t queue_depth = 64;
+  /// @brief Use io_uring when the kernel allows it, otherwise fall back.
+  bool prefer_io_uring = true;
+  /// @brief Pool that runs callbacks and, for the ThreadPool backend, the
+  /// blocking calls. When empty the ThreadPool backend creates its own and
+  /// io_uring callbacks run on the completion thread.
+  threads::TaskPoolPtr pool;
+};
+
+/// @brief One read or write of a batch.
+struct AsyncIoRequest {
+  uint64_t offset = 0;
+  uint8_t* buffer = nullptr;
+  size_t length = 0;
+  /// @brief Index into RegisterBuffers(), -1 when buffer is not registered.
+  int buffer_index = -1;
+};
+
+namespace details {
+struct IoUringRing;
+}  // namespace details
+
+/// @brief Asynchronous positional file I/O. Uses io_uring on Linux and falls
+/// back to pread/pwrite on a TaskPool when io_uring is not available (old
+/// kernel, seccomp, non-Linux). Both backends share the same interface, so
+/// callers never branch on the backend.
+/// Operations complete in any order, the caller owns the buffers and must
+/// keep them alive until the future is ready or the callback ran.
+/// Like pread/pwrite a single operation may complete short, requests above
+/// 0x7ffff000 bytes always do; ReadAll/WriteAll resubmit the remainder.
+/// When submission fails the operations not handed over complete with
+/// -ECANCELED (callbacks) or the thrown exception (futures).
+class AsyncFile {
+ private:
+  struct Operation;
+
+  int fd_;
+  AsyncIoBackend backend_;
+  threads::TaskPoolPtr pool_;
+  std::unique_ptr<details::IoUringRing> ring_;
+  std::vector<Span<uint8_t>> buffers_;
+
+  std::mutex submit_mutex_;
+  std::mutex inflight_mutex_;
+  std::condition_variable inflight_cv_;
+  size_t inflight_;
+  size_t inflight_limit_;
+
+  void Acquire(size_t n);
+  void Release(size_t n) noexcept;
+  void Complete(Operation* op, int64_t result) noexcept;
+  void Abandon(std::vector<Operation*>& ops, size_t from,
+               std::exception_ptr error) noexcept;
+  void Enqueue(bool is_write, const std::vector<AsyncIoRequest>& requests,
+               std::vector<Operation*>& ops);
+  void RunCompletions() noexcept;
+  void Shutdown() noexcept;
+
+ public:
+  /// @brief Open path.
+  /// @param path
+  /// @param mode
+  /// @param options
+  /// @throw nvm::IoException when the file can not be opened
+  AsyncFile(const std::string& path, AsyncFileMode mode,
+            AsyncFileOptions options = AsyncFileOptions());
+
+  AsyncFile(const AsyncFile&) = delete;
+  AsyncFile& operator=(const AsyncFile&) = delete;
+
+  /// @brief Waits for all in-flight operations.
+  ~AsyncFile();
+
+  AsyncIoBackend Backend() const noexcept {
+    return backend_;
+  }
+
+  /// @brief Current file size.
+  /// @throw nvm::IoException when fstat fails
+  uint64_t FileSize() const;
+
+  /// @brief Register fixed buffers, io_uring then skips the per-call page
+  /// pinning. Replaces previously registered buffers, no operation may be in
+  /// flight.
+  /// @return false when the kernel refused, buffers are still usable by index
+  bool RegisterBuffers(const std::vector<Span<uint8_t>>& buffers);
+
+  /// @brief Read into dest at offset.
+  /// @return future with bytes read or -errno
+  std::future<int64_t> Read(uint64_t offset, Span<uint8_t> dest);
+
+  /// @brief Write src at offset.
+  /// @return future with bytes written or -errno
+  std::future<int64_t> Write(uint64_t offset, Span<const uint8_t> src);
+
+  /// @brief Read into dest, on_complete runs on the pool when one is set and
+  /// on the completion thread while the pool queue is full.
+  void Read(uint64_t offset, Span<uint8_t> dest, AsyncIoCallback on_complete);
+
+  /// @brief Write src, on_complete runs on the pool when one is set.
+  void Write(uint64_t offset, Span<const uint8_t> src,
+             AsyncIoCallback on_complete);
+
+  /// @brief Submit all reads with a single system call.
+  /// @throw nvm::IoException when io_uring refuses the submission
+  std::vector<std::future<int64_t>> ReadBatch(
+      const std::vector<AsyncIoRequest>& requests);
+
+  /// @brief Submit all writes with a single system call.
+  /// @throw nvm::IoException when io_uring refuses the submission
+  std::vector<std::future<int64_t>> WriteBatch(
+      const std::vector<AsyncIoRequest>& requests);
+
+  /// @brief Read the whole file in chunk_size pieces, all chunks are in
+  /// flight together. The result can be handed to io::ByteStream.
+  /// @throw nvm::IoException when a chunk fails
+  std::vector<uint8_t> ReadAll(size_t chunk_size = 1 << 20);
+
+  /// @brief Write src starting at offset in chunk_size pieces, e.g. the
+  /// content of io::ByteStreamWriter.
+  /// @throw nvm::IoException when a chunk fails
+  void WriteAll(uint64_t offset, Span<const uint8_t> src,
+                size_t chunk_size = 1 << 20);
+
+  /// @brief Block until every submitted operation completed and its
+  /// callback, if any, returned. Callbacks must not call it.
+  void Drain();
+};
+
+}  // namespace io
+}  // namespace nvm
+
+#endif  // NVM_IO_HAS_ASYNC_FILE
+
+#endif  // NVM_CORE_IO_V2_ASYNC_FILE_H
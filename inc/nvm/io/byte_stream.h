@@ -1,9 +1,19 @@
 #ifndef NVM_CORE_IO_V2_BYTE_STREAM_H
 #define NVM_CORE_IO_V2_BYTE_STREAM_H
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
 #include <functional>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "nvm/bytes/byte.h"
+#include "nvm/span.h"
 
 namespace nvm {
 namespace io {
@@ -16,6 +26,7 @@ class IStream {
 class StreamCursor {
  private:
   size_t final_position_;
+  size_t end_position_;
   size_t move_size_;
   bool is_success_;
   bool can_chain_;
@@ -23,54 +34,207 @@ class StreamCursor {
  public:
   StreamCursor()
       : final_position_(0),
+        end_position_(0),
         move_size_(0),
         is_success_(false),
         can_chain_(false) {}
 
   const size_t &FinalPosition() const { return final_position_; }
 
+  /// @brief End of the window reserved by ReadChainStart, exclusive.
+  const size_t &EndPosition() const { return end_position_; }
+
   const size_t &MoveSize() const { return move_size_; }
 
   const bool &IsSuccess() const { return is_success_; }
 
   const bool &CanChain() const { return can_chain_; }
 
+  /// @brief Bytes left inside the reserved window.
+  size_t Remaining() const { return end_position_ - final_position_; }
+
   friend void SetCanCursorChain(StreamCursor &lhs, bool can_chain, bool success,
                                 size_t final_position, size_t move_size);
+
+  friend void SetCursorWindow(StreamCursor &lhs, size_t end_position);
+};
+
+inline void SetCanCursorChain(StreamCursor &lhs, bool can_chain, bool success,
+                              size_t final_position, size_t move_size) {
+  lhs.can_chain_ = can_chain;
+  lhs.is_success_ = success;
+  lhs.move_size_ = move_size;
+  lhs.final_position_ = final_position;
+}
+
+inline void SetCursorWindow(StreamCursor &lhs, size_t end_position) {
+  lhs.end_position_ = end_position;
+}
+
+/// @brief Access raw bytes of a stream source. Default expects the nvm::Span
+/// style Data()/Size() members, so any source exposing those plugs straight
+/// into ByteStream.
+/// @tparam TStream
+template <typename TStream>
+struct StreamSourceTraits {
+  static auto Data(const TStream &stream) { return stream.Data(); }
+  static size_t Size(const TStream &stream) { return stream.Size(); }
 };
 
-template <typename TStream, typename TByte>
+template <typename T, typename Alloc>
+struct StreamSourceTraits<std::vector<T, Alloc>> {
+  static const T *Data(const std::vector<T, Alloc> &stream) {
+    return stream.data();
+  }
+  static size_t Size(const std::vector<T, Alloc> &stream) {
+    return stream.size();
+  }
+};
+
+/// @brief Zero-copy binary reader. Values are decoded with the nvm::bytes
+/// converters directly from the memory owned by TStream.
+/// @example
+/// ```cxx
+/// io::ByteStream<Span<const uint8_t>, uint8_t> stream(Span<const uint8_t>(buf));
+/// uint16_t id; uint32_t len; std::string_view name;
+/// auto cursor = stream.ReadChainStart(0, 10);
+/// stream.ReadChain(id, cursor).ReadChain(len, cursor).ReadChain(name, 4, cursor);
+/// if (!cursor.IsSuccess()) { ... }
+/// ```
+/// @tparam TStream byte source, nvm::Span<const TByte>, std::vector<TByte> or
+/// any type exposing Data()/Size()
+/// @tparam TByte char or uint8_t
+template <typename TStream, typename TByte = uint8_t>
 class ByteStream {
+  static_assert(std::is_same<TByte, char>::value ||
+                    std::is_same<TByte, uint8_t>::value,
+                "TByte can only be char or uint8_t");
+
  private:
  protected:
   TStream stream_;
+  bytes::EndianessType endianess_;
+
+  const TByte *Begin() const {
+    return reinterpret_cast<const TByte *>(
+        StreamSourceTraits<TStream>::Data(stream_));
+  }
+
+  static void FailCursor(StreamCursor &cursor) {
+    SetCanCursorChain(cursor, false, false, cursor.FinalPosition(), 0);
+  }
+
+  template <typename TVal>
+  static TVal DecodeValue(const TByte *ptr, size_t size,
+                          bytes::ByteOpResult &err,
+                          bytes::EndianessType endianess) {
+    if constexpr (std::is_same<TVal, bool>::value) {
+      return bytes::ToUint8(ptr, size, err) != 0;
+    } else if constexpr (std::is_same<TVal, uint8_t>::value) {
+      return bytes::ToUint8(ptr, size, err);
+    } else if constexpr (std::is_same<TVal, int8_t>::value) {
+      return bytes::ToInt8(ptr, size, err);
+    } else if constexpr (std::is_same<TVal, uint16_t>::value) {
+      return bytes::ToUint16(ptr, size, err, endianess);
+    } else if constexpr (std::is_same<TVal, int16_t>::value) {
+      return bytes::ToInt16(ptr, size, err, endianess);
+    } else if constexpr (std::is_same<TVal, uint32_t>::value) {
+      return bytes::ToUint32(ptr, size, err, endianess);
+    } else if constexpr (std::is_same<TVal, int32_t>::value) {
+      return bytes::ToInt32(ptr, size, err, endianess);
+    } else if constexpr (std::is_same<TVal, uint64_t>::value) {
+      return bytes::ToUint64(ptr, size, err, endianess);
+    } else if constexpr (std::is_same<TVal, int64_t>::value) {
+      return bytes::ToInt64(ptr, size, err, endianess);
+    } else if constexpr (std::is_same<TVal, float>::value) {
+      return bytes::ToFloat(ptr, size, err, endianess);
+    } else {
+      static_assert(std::is_same<TVal, double>::value,
+                    "TVal can only be bool, int8_t to int64_t, uint8_t to "
+                    "uint64_t, float or double");
+      return bytes::ToDouble(ptr, size, err, endianess);
+    }
+  }
 
  public:
-  explicit ByteStream(TStream &&stream) : stream_(std::move(stream)){};
+  explicit ByteStream(
+      TStream &&stream,
+      bytes::EndianessType endianess = bytes::EndianessType::LittleEndian)
+      : stream_(std::move(stream)), endianess_(endianess){};
   virtual ~ByteStream(){};
 
+  /// @brief Size of the underlying source in bytes.
+  size_t Size() const { return StreamSourceTraits<TStream>::Size(stream_); }
+
+  /// @brief Read-only view of the whole source.
+  Span<const TByte> Bytes() const { return Span<const TByte>(Begin(), Size()); }
+
+  /// @brief Underlying source, e.g. to slide the window of a mapped file.
+  /// Cursors taken before the source changes are no longer valid.
+  TStream &Source() { return stream_; }
+
+  const TStream &Source() const { return stream_; }
+
+  bytes::EndianessType Endianess() const { return endianess_; }
+
+  void SetEndianess(bytes::EndianessType endianess) { endianess_ = endianess; }
+
+  /// @brief Start a read chain over [position, position + n). This is the
+  /// only place the source bounds are checked, chained reads only check
+  /// against the reserved window.
+  /// @param position
+  /// @param n window size in bytes
+  /// @return failed cursor when the window is out of bound
   StreamCursor ReadChainStart(size_t position, size_t n) {
-    // check for out of bound
     auto s = StreamCursor();
+    size_t size = Size();
+    if (position > size || n > size - position) {
+      SetCanCursorChain(s, false, false, position, 0);
+      return s;
+    }
+
     SetCanCursorChain(s, true, true, position, 0);
-    return std::move(s);
+    SetCursorWindow(s, position + n);
+    return s;
   }
 
-  friend void SetCanCursorChain(StreamCursor &lhs, bool can_chain, bool success,
-                                size_t final_position, size_t move_size) {
-    lhs.can_chain_ = can_chain;
-    lhs.is_success_ = success;
-    lhs.move_size_ = move_size;
-    lhs.final_position_ = final_position;
+  /// @brief Start a read chain from position to the end of the source.
+  StreamCursor ReadChainStart(size_t position) {
+    return ReadChainStart(position, position > Size() ? 0 : Size() - position);
   }
 
   template <typename TVal>
   ByteStream<TStream, TByte> &ReadChain(TVal &val, StreamCursor &cursor) {
+    return ReadChain(val, cursor, endianess_);
+  }
+
+  /// @brief Decode one value and move the cursor.
+  /// @tparam TVal bool, int8_t to int64_t, uint8_t to uint64_t, float, double
+  /// @param val
+  /// @param cursor
+  /// @param endianess byte order of this value on the wire
+  /// @return
+  template <typename TVal>
+  ByteStream<TStream, TByte> &ReadChain(TVal &val, StreamCursor &cursor,
+                                        bytes::EndianessType endianess) {
     if (!cursor.IsSuccess()) {
       return *this;
     }
 
-    size_t moving = 10;  // simulate cursor move
+    constexpr size_t moving = sizeof(TVal);
+    if (cursor.Remaining() < moving) {
+      FailCursor(cursor);
+      return *this;
+    }
+
+    auto err = bytes::ByteOpResult::None;
+    val = DecodeValue<TVal>(Begin() + cursor.FinalPosition(), moving, err,
+                            endianess);
+    if (err != bytes::ByteOpResult::Ok) {
+      FailCursor(cursor);
+      return *this;
+    }
+
     SetCanCursorChain(cursor, cursor.CanChain(), true,
                       cursor.FinalPosition() + moving, moving);
 
@@ -80,16 +244,189 @@ class ByteStream {
   template <typename TVal>
   ByteStream<TStream, TByte> &ReadChain(
       StreamCursor &cursor, std::function<void(const TVal &val)> l) {
+    TVal val{};
+    ReadChain(val, cursor);
+    if (cursor.IsSuccess()) {
+      l(val);
+    }
+    return *this;
+  }
+
+  /// @brief Reference n bytes of the source as text, no copy is made.
+  /// The view is valid as long as the source memory is.
+  /// @param val
+  /// @param n
+  /// @param cursor
+  /// @return
+  ByteStream<TStream, TByte> &ReadChain(std::string_view &val, size_t n,
+                                        StreamCursor &cursor) {
     if (!cursor.IsSuccess()) {
       return *this;
     }
 
-    size_t moving = 10;  // simulate cursor move
+    if (cursor.Remaining() < n) {
+      FailCursor(cursor);
+      return *this;
+    }
+
+    val = std::string_view(
+        reinterpret_cast<const char *>(Begin() + cursor.FinalPosition()), n);
     SetCanCursorChain(cursor, cursor.CanChain(), true,
-                      cursor.FinalPosition() + moving, moving);
+                      cursor.FinalPosition() + n, n);
+    return *this;
+  }
+
+  /// @brief Reference n bytes of the source, no copy is made.
+  /// @param val
+  /// @param n
+  /// @param cursor
+  /// @return
+  ByteStream<TStream, TByte> &ReadChain(Span<const TByte> &val, size_t n,
+                                        StreamCursor &cursor) {
+    if (!cursor.IsSuccess()) {
+      return *this;
+    }
+
+    if (cursor.Remaining() < n) {
+      FailCursor(cursor);
+      return *this;
+    }
+
+    val = Span<const TByte>(Begin() + cursor.FinalPosition(), n);
+    SetCanCursorChain(cursor, cursor.CanChain(), true,
+                      cursor.FinalPosition() + n, n);
+    return *this;
+  }
+
+  /// @brief Copy n bytes of the source into std::string.
+  /// @param val
+  /// @param n
+  /// @param cursor
+  /// @return
+  ByteStream<TStream, TByte> &ReadChain(std::string &val, size_t n,
+                                        StreamCursor &cursor) {
+    std::string_view view;
+    ReadChain(view, n, cursor);
+    if (cursor.IsSuccess()) {
+      val.assign(view.data(), view.size());
+    }
+    return *this;
+  }
+
+  /// @brief Move the cursor n bytes forward without decoding.
+  ByteStream<TStream, TByte> &Skip(size_t n, StreamCursor &cursor) {
+    if (!cursor.IsSuccess()) {
+      return *this;
+    }
+
+    if (cursor.Remaining() < n) {
+      FailCursor(cursor);
+      return *this;
+    }
+
+    SetCanCursorChain(cursor, cursor.CanChain(), true,
+                      cursor.FinalPosition() + n, n);
+    return *this;
+  }
+};
+
+/// @brief Growable binary writer, values are encoded with the nvm::bytes
+/// converters into an owned buffer.
+/// @tparam TByte char or uint8_t
+template <typename TByte = uint8_t>
+class ByteStreamWriter {
+  static_assert(std::is_same<TByte, char>::value ||
+                    std::is_same<TByte, uint8_t>::value,
+                "TByte can only be char or uint8_t");
+
+ private:
+  std::vector<TByte> buffer_;
+  bytes::EndianessType endianess_;
+  bool is_success_;
+
+  TByte *Grow(size_t n) {
+    size_t offset = buffer_.size();
+    buffer_.resize(offset + n);
+    return buffer_.data() + offset;
+  }
+
+ public:
+  explicit ByteStreamWriter(
+      size_t reserve = 0,
+      bytes::EndianessType endianess = bytes::EndianessType::LittleEndian)
+      : buffer_(), endianess_(endianess), is_success_(true) {
+    buffer_.reserve(reserve);
+  }
+
+  /// @brief false once any write failed, later writes are ignored.
+  bool IsSuccess() const { return is_success_; }
+
+  size_t Size() const { return buffer_.size(); }
+
+  void Reserve(size_t n) { buffer_.reserve(n); }
+
+  void Clear() {
+    buffer_.clear();
+    is_success_ = true;
+  }
+
+  /// @brief Read-only view of written bytes, invalidated by the next write.
+  Span<const TByte> Bytes() const {
+    return Span<const TByte>(buffer_.data(), buffer_.size());
+  }
+
+  /// @brief Move the written bytes out, the writer is empty afterwards.
+  std::vector<TByte> Release() {
+    std::vector<TByte> out = std::move(buffer_);
+    buffer_ = std::vector<TByte>();
+    return out;
+  }
+
+  template <typename TVal,
+            typename = std::enable_if_t<std::is_arithmetic<TVal>::value>>
+  ByteStreamWriter &WriteChain(const TVal &val) {
+    return WriteChain(val, endianess_);
+  }
+
+  /// @brief Encode one value at the end of the buffer.
+  /// @tparam TVal bool, int8_t to int64_t, uint8_t to uint64_t, float, double
+  /// @param val
+  /// @param endianess
+  /// @return
+  template <typename TVal,
+            typename = std::enable_if_t<std::is_arithmetic<TVal>::value>>
+  ByteStreamWriter &WriteChain(const TVal &val,
+                               bytes::EndianessType endianess) {
+    if (!is_success_) {
+      return *this;
+    }
+
+    size_t offset = buffer_.size();
+    auto err = bytes::ToBytes(val, Grow(sizeof(TVal)), sizeof(TVal), endianess);
+    if (err != bytes::ByteOpResult::Ok) {
+      buffer_.resize(offset);
+      is_success_ = false;
+    }
+    return *this;
+  }
+
+  /// @brief Append raw text bytes, no length prefix.
+  ByteStreamWriter &WriteChain(std::string_view val) {
+    if (!is_success_ || val.empty()) {
+      return *this;
+    }
+
+    std::memcpy(Grow(val.size()), val.data(), val.size());
+    return *this;
+  }
+
+  /// @brief Append raw bytes.
+  ByteStreamWriter &WriteChain(const Span<const TByte> &val) {
+    if (!is_success_ || val.Empty()) {
+      return *this;
+    }
 
-    TVal val = 100.0f;
-    l(val);
+    std::memcpy(Grow(val.Size()), val.Data(), val.Size());
     return *this;
   }
 };
@@ -0,0 +1,368 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/io/compressed_frame.h"
+
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <string>
+
+#include "nvm/bytes/byte.h"
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/exceptions/exception.h"
+#include "nvm/threads/task_pool.h"
+
+namespace nvm {
+namespace io {
+
+namespace {
+
+constexpr uint8_t kMagic[4] = {'N', 'V', 'Z', '1'};
+constexpr size_t kHeaderSize = 12;
+constexpr size_t kBlockHeaderSize = 8;
+constexpr size_t kChecksumSize = 4;
+constexpr uint32_t kRawFlag = 0x80000000u;
+constexpr uint8_t kFlagLinked = 0x01;
+constexpr uint8_t kFlagChecksum = 0x02;
+constexpr size_t kMinBlockSize = 1024;
+constexpr size_t kMaxBlockSize = 4 * 1024 * 1024;
+constexpr size_t kHistorySize = 64 * 1024;
+
+inline void StoreU32(uint32_t value, uint8_t* p) noexcept {
+  bytes::details::unchecked::Store<uint32_t>(value, p, true);
+}
+
+inline uint32_t LoadU32(const uint8_t* p) noexcept {
+  return bytes::details::unchecked::Load<uint32_t>(p, true);
+}
+
+/// Keep the last kHistorySize bytes of [0, used) at the front of window.
+size_t SlideHistory(std::vector<uint8_t>& window, size_t used) noexcept {
+  size_t keep = used < kHistorySize ? used : kHistorySize;
+  if (keep > 0 && keep < used) {
+    std::memmove(window.data(), window.data() + used - keep, keep);
+  }
+  return keep;
+}
+
+}  // namespace
+
+// CompressedFrameWriter
+
+CompressedFrameWriter::CompressedFrameWriter(
+    const CompressedFrameOptions& options)
+                : options_(options),
+                  compressor_(),
+                  out_(),
+                  window_(),
+                  history_(0),
+                  pending_(0),
+                  finished_(false) {
+  if (options_.block_size < kMinBlockSize ||
+      options_.block_size > kMaxBlockSize) {
+    throw InvalidArgException(
+        "CompressedFrameWriter: block size must be 1 KiB to 4 MiB, got " +
+        std::to_string(options_.block_size));
+  }
+
+  bool linked = options_.mode == CompressionBlockMode::Linked;
+  window_.resize((linked ? kHistorySize : 0) + options_.block_size);
+
+  out_.resize(kHeaderSize);
+  std::memcpy(out_.data(), kMagic, sizeof(kMagic));
+  out_[4] = static_cast<uint8_t>((linked ? kFlagLinked : 0) |
+                                 (options_.checksum ? kFlagChecksum : 0));
+  out_[5] = out_[6] = out_[7] = 0;
+  StoreU32(static_cast<uint32_t>(options_.block_size), out_.data() + 8);
+}
+
+void CompressedFrameWriter::FlushBlock() {
+  if (pending_ == 0) {
+    return;
+  }
+
+  bool linked = options_.mode == CompressionBlockMode::Linked;
+  const uint8_t* src = window_.data() + history_;
+  size_t bound = bytes::LzCompressBound(pending_);
+  size_t position = out_.size();
+  out_.resize(position + kBlockHeaderSize + bound + kChecksumSize);
+
+  uint8_t* payload = out_.data() + position + kBlockHeaderSize;
+  // a block that does not shrink is stored as is
+  size_t stored = compressor_.Compress(src, pending_, payload, pending_ - 1,
+                                       linked ? history_ : 0);
+  uint32_t tag = static_cast<uint32_t>(stored);
+  if (stored == 0) {
+    std::memcpy(payload, src, pending_);
+    stored = pending_;
+    tag = static_cast<uint32_t>(pending_) | kRawFlag;
+  }
+
+  StoreU32(tag, out_.data() + position);
+  StoreU32(static_cast<uint32_t>(pending_), out_.data() + position + 4);
+  size_t end = position + kBlockHeaderSize + stored;
+  if (options_.checksum) {
+    bytes::ByteOpResult err;
+    StoreU32(bytes::Crc32C(src, pending_, err), out_.data() + end);
+    end += kChecksumSize;
+  }
+  out_.resize(end);
+
+  history_ = linked ? SlideHistory(window_, history_ + pending_) : 0;
+  pending_ = 0;
+}
+
+CompressedFrameWriter& CompressedFrameWriter::Write(const uint8_t* data,
+                                                    size_t size) {
+  if (finished_) {
+    throw RuntimeException("CompressedFrameWriter: write after Finish()");
+  }
+  while (size > 0) {
+    size_t space = options_.block_size - pending_;
+    size_t n = size < space ? size : space;
+    std::memcpy(window_.data() + history_ + pending_, data, n);
+    pending_ += n;
+    data += n;
+    size -= n;
+    if (pending_ == options_.block_size) {
+      FlushBlock();
+    }
+  }
+  return *this;
+}
+
+std::vector<uint8_t> CompressedFrameWriter::Finish() {
+  if (!finished_) {
+    FlushBlock();
+    size_t position = out_.size();
+    out_.resize(position + 4);
+    StoreU32(0, out_.data() + position);
+    finished_ = true;
+  }
+  return std::move(out_);
+}
+
+// CompressedFrameReader
+
+CompressedFrameReader::CompressedFrameReader(const Span<const uint8_t>& frame)
+                : frame_(frame),
+                  options_(),
+                  position_(0),
+                  is_success_(true),
+                  at_end_(false),
+                  window_(),
+                  history_(0),
+                  last_size_(0) {
+  is_success_ = ReadHeader();
+  if (is_success_) {
+    bool linked = options_.mode == CompressionBlockMode::Linked;
+    window_.resize((linked ? kHistorySize : 0) + options_.block_size);
+  }
+}
+
+bool CompressedFrameReader::ReadHeader() noexcept {
+  if (!frame_.Data() || frame_.Size() < kHeaderSize ||
+      std::memcmp(frame_.Data(), kMagic, sizeof(kMagic)) != 0) {
+    return false;
+  }
+  uint8_t flags = frame_[4];
+  if ((flags & ~(kFlagLinked | kFlagChecksum)) != 0) {
+    return false;
+  }
+  size_t block_size = LoadU32(frame_.Data() + 8);
+  if (block_size < kMinBlockSize || block_size > kMaxBlockSize) {
+    return false;
+  }
+
+  options_.block_size = block_size;
+  options_.mode = (flags & kFlagLinked) ? CompressionBlockMode::Linked
+                                        : CompressionBlockMode::Independent;
+  options_.checksum = (flags & kFlagChecksum) != 0;
+  position_ = kHeaderSize;
+  return true;
+}
+
+bool CompressedFrameReader::ParseBlock(BlockInfo& info) noexcept {
+  if (!is_success_ || at_end_) {
+    return false;
+  }
+
+  size_t available = frame_.Size() - position_;
+  if (available < 4) {
+    is_success_ = false;
+    return false;
+  }
+  uint32_t tag = LoadU32(frame_.Data() + position_);
+  if (tag == 0) {
+    position_ += 4;
+    at_end_ = true;
+    return false;
+  }
+  if (available < kBlockHeaderSize) {
+    is_success_ = false;
+    return false;
+  }
+
+  info.is_raw = (tag & kRawFlag) != 0;
+  info.stored_size = tag & ~kRawFlag;
+  info.raw_size = LoadU32(frame_.Data() + position_ + 4);
+  info.src_offset = position_ + kBlockHeaderSize;
+
+  size_t trailer = options_.checksum ? kChecksumSize : 0;
+  if (info.raw_size == 0 || info.raw_size > options_.block_size ||
+      (info.is_raw && info.stored_size != info.raw_size) ||
+      available - kBlockHeaderSize < info.stored_size ||
+      available - kBlockHeaderSize - info.stored_size < trailer) {
+    is_success_ = false;
+    return false;
+  }
+
+  position_ = info.src_offset + info.stored_size + trailer;
+  return true;
+}
+
+bool CompressedFrameReader::DecodeBlock(const BlockInfo& info, uint8_t* dest,
+                                        size_t prefix) const noexcept {
+  const uint8_t* src = frame_.Data() + info.src_offset;
+  if (info.is_raw) {
+    std::memcpy(dest, src, info.raw_size);
+  } else {
+    size_t written = 0;
+    auto result = bytes::LzDecompress(src, info.stored_size, dest,
+                                      info.raw_size, written, prefix);
+    if (result != bytes::ByteOpResult::Ok || written != info.raw_size) {
+      return false;
+    }
+  }
+
+  if (options_.checksum) {
+    uint32_t expected = LoadU32(src + info.stored_size);
+    bytes::ByteOpResult err;
+    if (bytes::Crc32C(dest, info.raw_size, err) != expected) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CompressedFrameReader::NextBlock(Span<const uint8_t>& block) {
+  BlockInfo info;
+  if (!ParseBlock(info)) {
+    return false;
+  }
+
+  uint8_t* dest = window_.data();
+  size_t prefix = 0;
+  if (options_.mode == CompressionBlockMode::Linked) {
+    history_ = SlideHistory(window_, history_ + last_size_);
+    dest += history_;
+    prefix = history_;
+  }
+
+  if (!DecodeBlock(info, dest, prefix)) {
+    is_success_ = false;
+    return false;
+  }
+  last_size_ = info.raw_size;
+  block = Span<const uint8_t>(dest, info.raw_size);
+  return true;
+}
+
+bool CompressedFrameReader::ReadAll(std::vector<uint8_t>& out,
+                                    const threads::TaskPoolPtr& pool) {
+  out.clear();
+  if (options_.mode == CompressionBlockMode::Linked) {
+    // each block depends on the one before, decode in order
+    Span<const uint8_t> block;
+    while (NextBlock(block)) {
+      out.insert(out.end(), block.Begin(), block.End());
+    }
+    return is_success_ && at_end_;
+  }
+
+  std::vector<BlockInfo> blocks;
+  size_t total = 0;
+  BlockInfo info;
+  while (ParseBlock(info)) {
+    info.out_offset = total;
+    total += info.raw_size;
+    blocks.push_back(info);
+  }
+  if (!is_success_ || !at_end_) {
+    is_success_ = false;
+    return false;
+  }
+
+  out.resize(total);
+  uint8_t* base = out.data();
+
+  if (!pool || blocks.size() < 2) {
+    for (const auto& block : blocks) {
+      if (!DecodeBlock(block, base + block.out_offset, 0)) {
+        is_success_ = false;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  std::atomic<bool> ok(true);
+  std::vector<std::future<void>> futures;
+  futures.reserve(blocks.size());
+  for (const auto& block : blocks) {
+    const BlockInfo* b = &block;
+    auto task = [this, b, base, &ok]() {
+      if (ok.load(std::memory_order_relaxed) &&
+          !DecodeBlock(*b, base + b->out_offset, 0)) {
+        ok.store(false, std::memory_order_relaxed);
+      }
+    };
+    try {
+      futures.push_back(pool->ExecuteTask(task).first);
+    } catch (const std::runtime_error&) {
+      // pool is stopping, finish on this thread
+      task();
+    }
+  }
+  for (auto& future : futures) {
+    future.wait();
+  }
+
+  is_success_ = ok.load();
+  return is_success_;
+}
+
+std::vector<uint8_t> CompressFrame(const Span<const uint8_t>& data,
+                                   const CompressedFrameOptions& options) {
+  CompressedFrameWriter writer(options);
+  writer.Write(data);
+  return writer.Finish();
+}
+
+bool DecompressFrame(const Span<const uint8_t>& frame,
+                     std::vector<uint8_t>& out,
+                     const threads::TaskPoolPtr& pool) {
+  CompressedFrameReader reader(frame);
+  return reader.ReadAll(out, pool);
+}
+
+}  // namespace io
+}  // namespace nvm
@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_IO_V2_COMPRESSED_FRAME_H
+#define NVM_CORE_IO_V2_COMPRESSED_FRAME_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "nvm/bytes/lz_block.h"
+#include "nvm/macro.h"
+#include "nvm/span.h"
+#include "nvm/threads/def.h"
+
+namespace nvm {
+namespace io {
+
+enum class CompressionBlockMode : uint8_t {
+  /// @brief Every block is self contained, blocks decompress in parallel.
+  Independent = 1,
+  /// @brief Matches may reach into the previous 64 KiB, better ratio on
+  /// small blocks, blocks must be decoded in order.
+  Linked = 2,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(CompressionBlockMode)
+
+struct CompressedFrameOptions {
+  /// @brief Uncompressed bytes per block, 1 KiB to 4 MiB.
+  size_t block_size = 64 * 1024;
+  CompressionBlockMode mode = CompressionBlockMode::Independent;
+  /// @brief Append a CRC-32C of the uncompressed bytes to every block.
+  bool checksum = true;
+};
+
+/// @brief Streaming compressor for the nvcore frame format:
+///
+///   header: "NVZ1", flags (bit0 linked, bit1 checksum), 3 reserved bytes,
+///           block size (u32 BE)
+///   block:  u32 BE stored size, bit31 set when the payload is raw,
+///           u32 BE uncompressed size, payload, [u32 BE CRC-32C]
+///   end:    u32 0
+///
+/// Feed it the output of a ByteStreamWriter (or anything else), blocks are
+/// compressed as soon as they fill up.
+class CompressedFrameWriter {
+ private:
+  CompressedFrameOptions options_;
+  bytes::LzCompressor compressor_;
+  std::vector<uint8_t> out_;
+  // linked mode: [history][current block], independent: [current block]
+  std::vector<uint8_t> window_;
+  size_t history_;
+  size_t pending_;
+  bool finished_;
+
+  void FlushBlock();
+
+ public:
+  /// @throw InvalidArgException when block_size is out of range
+  explicit CompressedFrameWriter(
+      const CompressedFrameOptions& options = CompressedFrameOptions());
+
+  /// @brief Append uncompressed bytes.
+  /// @throw RuntimeException after Finish()
+  CompressedFrameWriter& Write(const uint8_t* data, size_t size);
+
+  CompressedFrameWriter& Write(const Span<const uint8_t>& data) {
+    return Write(data.Data(), data.Size());
+  }
+
+  /// @brief Compressed bytes produced so far, complete blocks only.
+  Span<const uint8_t> Bytes() const noexcept {
+    return Span<const uint8_t>(out_.data(), out_.size());
+  }
+
+  /// @brief Compress the last partial block, write the end mark and hand
+  /// over the frame.
+  std::vector<uint8_t> Finish();
+};
+
+/// @brief Decoder for frames made by CompressedFrameWriter. NextBlock()
+/// streams block by block with bounded memory, ReadAll() decodes everything
+/// and can spread independent blocks over a TaskPool.
+///
+/// Wrap the result in a ByteStream to parse it:
+/// ```cxx
+/// std::vector<uint8_t> raw;
+/// io::CompressedFrameReader reader(Span<const uint8_t>(frame));
+/// if (reader.ReadAll(raw, pool)) {
+///   io::ByteStream<std::vector<uint8_t>, uint8_t> stream(std::move(raw));
+/// }
+/// ```
+class CompressedFrameReader {
+ private:
+  struct BlockInfo {
+    size_t src_offset;
+    size_t stored_size;
+    size_t raw_size;
+    size_t out_offset;
+    bool is_raw;
+  };
+
+  Span<const uint8_t> frame_;
+  CompressedFrameOptions options_;
+  size_t position_;
+  bool is_success_;
+  bool at_end_;
+  std::vector<uint8_t> window_;
+  size_t history_;
+  size_t last_size_;
+
+  bool ReadHeader() noexcept;
+  /// Parse the block header at position_, false at the end mark or on error.
+  bool ParseBlock(BlockInfo& info) noexcept;
+  bool DecodeBlock(const BlockInfo& info, uint8_t* dest,
+                   size_t prefix) const noexcept;
+
+ public:
+  explicit CompressedFrameReader(const Span<const uint8_t>& frame);
+
+  /// @brief false once the frame was found malformed or a checksum failed.
+  bool IsSuccess() const noexcept {
+    return is_success_;
+  }
+
+  const CompressedFrameOptions& Options() const noexcept {
+    return options_;
+  }
+
+  /// @brief Decode the next block.
+  /// @param block uncompressed bytes, valid until the next call
+  /// @return false at the end of the frame or on error, see IsSuccess()
+  bool NextBlock(Span<const uint8_t>& block);
+
+  /// @brief Decode the remaining blocks into out (replaced). Independent
+  /// blocks are decoded on pool when one is given.
+  bool ReadAll(std::vector<uint8_t>& out,
+               const threads::TaskPoolPtr& pool = nullptr);
+};
+
+/// @brief One shot compression of data.
+std::vector<uint8_t> CompressFrame(
+    const Span<const uint8_t>& data,
+    const CompressedFrameOptions& options = CompressedFrameOptions());
+
+/// @brief One shot decompression, parallel over pool when given.
+/// @return false on a malformed frame or checksum mismatch
+bool DecompressFrame(const Span<const uint8_t>& frame,
+                     std::vector<uint8_t>& out,
+                     const threads::TaskPoolPtr& pool = nullptr);
+
+}  // namespace io
+}  // namespace nvm
+
+#endif  // NVM_CORE_IO_V2_COMPRESSED_FRAME_H
@@ -0,0 +1,224 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/io/frame_decoder.h"
+
+#include <cstring>
+#include <string>
+
+#include "nvm/bytes/byte.h"
+#include "nvm/exceptions/exception.h"
+
+namespace nvm {
+namespace io {
+
+namespace {
+
+size_t TrailerSize(FrameChecksum checksum) {
+  switch (checksum) {
+    case FrameChecksum::Crc16IBM:
+      return 2;
+    case FrameChecksum::Crc32C:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+}  // namespace
+
+FrameDecoder::FrameDecoder(const FrameDecoderOptions& options)
+                : options_(options),
+                  buffer_(),
+                  read_(0),
+                  write_(0),
+                  header_size_(0),
+                  trailer_size_(0),
+                  frames_(0),
+                  resyncs_(0),
+                  discarded_(0),
+                  in_sync_(true) {
+  if (options_.prefix_size == 0 || options_.prefix_size > 8) {
+    throw InvalidArgException("FrameDecoder: prefix size must be 1 to 8, got " +
+                              std::to_string(options_.prefix_size));
+  }
+  if (options_.prefix_endianess == bytes::EndianessType::Mixed ||
+      options_.checksum_endianess == bytes::EndianessType::Mixed) {
+    throw InvalidArgException("FrameDecoder: mixed endianess is not supported");
+  }
+
+  header_size_ = options_.sync_marker.size() + options_.prefix_size +
+                 (options_.header_check ? 2 : 0);
+  trailer_size_ = TrailerSize(options_.checksum);
+
+  size_t largest = header_size_ + options_.max_frame_size + trailer_size_;
+  buffer_.resize(options_.buffer_size > largest ? options_.buffer_size
+                                                : largest);
+}
+
+uint64_t FrameDecoder::DecodeLength(const uint8_t* p) const noexcept {
+  uint64_t length = 0;
+  size_t n = options_.prefix_size;
+  if (options_.prefix_endianess == bytes::EndianessType::BigEndian) {
+    for (size_t i = 0; i < n; ++i) {
+      length = (length << 8) | p[i];
+    }
+  } else {
+    for (size_t i = n; i > 0; --i) {
+      length = (length << 8) | p[i - 1];
+    }
+  }
+  return length;
+}
+
+bool FrameDecoder::VerifyHeader(const uint8_t* prefix) const noexcept {
+  bytes::ByteOpResult err = bytes::ByteOpResult::None;
+  uint16_t expected = bytes::ToUint16(prefix + options_.prefix_size, 2, err,
+                                      options_.checksum_endianess);
+  return bytes::Crc16IBM(prefix, options_.prefix_size, err) == expected;
+}
+
+bool FrameDecoder::VerifyChecksum(const uint8_t* frame,
+                                  size_t covered) const noexcept {
+  bytes::ByteOpResult err = bytes::ByteOpResult::None;
+  const uint8_t* trailer = frame + covered;
+  switch (options_.checksum) {
+    case FrameChecksum::Crc16IBM: {
+      uint16_t expected =
+          bytes::ToUint16(trailer, 2, err, options_.checksum_endianess);
+      return bytes::Crc16IBM(frame, covered, err) == expected;
+    }
+    case FrameChecksum::Crc32C: {
+      uint32_t expected =
+          bytes::ToUint32(trailer, 4, err, options_.checksum_endianess);
+      return bytes::Crc32C(frame, covered, err) == expected;
+    }
+    default:
+      return true;
+  }
+}
+
+void FrameDecoder::Resync() noexcept {
+  if (in_sync_) {
+    ++resyncs_;
+    in_sync_ = false;
+  }
+
+  size_t skip = 1;
+  const auto& marker = options_.sync_marker;
+  if (!marker.empty()) {
+    // jump straight to the next possible marker start
+    const void* found = std::memchr(buffer_.data() + read_ + 1, marker[0],
+                                    write_ - read_ - 1);
+    skip = found ? static_cast<const uint8_t*>(found) -
+                       (buffer_.data() + read_)
+                 : write_ - read_;
+  }
+  read_ += skip;
+  discarded_ += skip;
+}
+
+bool FrameDecoder::Next(Span<const uint8_t>& frame) noexcept {
+  const auto& marker = options_.sync_marker;
+  while (read_ < write_) {
+    const uint8_t* start = buffer_.data() + read_;
+    size_t available = write_ - read_;
+
+    if (!marker.empty()) {
+      size_t n = available < marker.size() ? available : marker.size();
+      if (std::memcmp(start, marker.data(), n) != 0) {
+        Resync();
+        continue;
+      }
+    }
+    if (available < header_size_) {
+      return false;
+    }
+
+    const uint8_t* prefix = start + marker.size();
+    if (options_.header_check && !VerifyHeader(prefix)) {
+      Resync();
+      continue;
+    }
+    uint64_t length = DecodeLength(prefix);
+    if (length > options_.max_frame_size) {
+      Resync();
+      continue;
+    }
+
+    size_t total = header_size_ + static_cast<size_t>(length) + trailer_size_;
+    if (available < total) {
+      return false;
+    }
+
+    if (trailer_size_ > 0 &&
+        !VerifyChecksum(prefix, header_size_ - marker.size() +
+                                    static_cast<size_t>(length))) {
+      Resync();
+      continue;
+    }
+
+    frame = Span<const uint8_t>(start + header_size_,
+                                static_cast<size_t>(length));
+    read_ += total;
+    ++frames_;
+    in_sync_ = true;
+    return true;
+  }
+
+  read_ = 0;
+  write_ = 0;
+  return false;
+}
+
+void FrameDecoder::Compact() noexcept {
+  if (read_ == 0) {
+    return;
+  }
+  size_t pending = write_ - read_;
+  if (pending > 0) {
+    std::memmove(buffer_.data(), buffer_.data() + read_, pending);
+  }
+  read_ = 0;
+  write_ = pending;
+}
+
+size_t FrameDecoder::Feed(const Span<const uint8_t>& data) noexcept {
+  if (!data.Data() || data.Empty()) {
+    return 0;
+  }
+  if (buffer_.size() - write_ < data.Size()) {
+    Compact();
+  }
+
+  size_t space = buffer_.size() - write_;
+  size_t n = data.Size() < space ? data.Size() : space;
+  std::memcpy(buffer_.data() + write_, data.Data(), n);
+  write_ += n;
+  return n;
+}
+
+void FrameDecoder::Reset() noexcept {
+  read_ = 0;
+  write_ = 0;
+  in_sync_ = true;
+}
+
+}  // namespace io
+}  // namespace nvm
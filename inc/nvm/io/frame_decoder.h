@@ -0,0 +1,174 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_IO_V2_FRAME_DECODER_H
+#define NVM_CORE_IO_V2_FRAME_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/macro.h"
+#include "nvm/span.h"
+
+namespace nvm {
+namespace io {
+
+enum class FrameChecksum : uint8_t {
+  None = 0,
+  /// @brief 2 bytes, bytes::Crc16IBM.
+  Crc16IBM = 1,
+  /// @brief 4 bytes, bytes::Crc32C.
+  Crc32C = 2,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(FrameChecksum)
+
+/// @brief Wire layout of a frame:
+/// [sync marker][length prefix][header check][payload][checksum trailer]
+/// The length counts payload bytes only. The header check, when enabled, is
+/// the 2 byte Crc16IBM of the length prefix. The checksum covers everything
+/// from the length prefix to the end of the payload.
+struct FrameDecoderOptions {
+  /// @brief Length prefix width, 1 to 8 bytes.
+  size_t prefix_size = 4;
+  bytes::EndianessType prefix_endianess = bytes::EndianessType::BigEndian;
+  /// @brief Larger length prefixes are treated as corruption.
+  size_t max_frame_size = 1024 * 1024;
+  FrameChecksum checksum = FrameChecksum::None;
+  bytes::EndianessType checksum_endianess = bytes::EndianessType::BigEndian;
+  /// @brief Optional bytes in front of every frame. With a marker, resync
+  /// after corruption is a linear memchr scan.
+  std::vector<uint8_t> sync_marker;
+  /// @brief Write a header check after the length prefix, in
+  /// checksum_endianess. Resync then rejects a candidate from its header
+  /// alone instead of running the checksum over up to max_frame_size bytes.
+  bool header_check = false;
+  /// @brief Receive buffer size, raised to fit at least one maximum frame.
+  size_t buffer_size = 64 * 1024;
+};
+
+/// @brief Incremental decoder for length-prefixed frames. Feed() it chunks as
+/// they arrive from a socket, Next() hands out complete, verified payloads as
+/// spans into the receive buffer. Each byte is copied once and parsed once;
+/// a partial frame only costs a header check per Feed().
+///
+/// The buffer is compacted instead of wrapping, so a frame is always
+/// contiguous. Spans returned by Next() stay valid until the next Feed() or
+/// Reset().
+///
+/// Resync after corruption steps one candidate start at a time. In the plain
+/// [length][payload][checksum] layout every candidate whose length is within
+/// max_frame_size and fully buffered costs a checksum over up to
+/// max_frame_size bytes, so scanning n corrupt bytes is O(n * max_frame_size)
+/// in the worst case. Keep max_frame_size tight for such streams. A sync
+/// marker or the header check are opt-in speedups: a candidate then pays for
+/// the checksum only after passing them, which random bytes do with
+/// probability 2^-8 per marker byte or 2^-16, for an expected
+/// O(n * (1 + max_frame_size / 2^16)).
+class FrameDecoder {
+ private:
+  FrameDecoderOptions options_;
+  std::vector<uint8_t> buffer_;
+  size_t read_;
+  size_t write_;
+  size_t header_size_;
+  size_t trailer_size_;
+
+  uint64_t frames_;
+  uint64_t resyncs_;
+  uint64_t discarded_;
+  bool in_sync_;
+
+  uint64_t DecodeLength(const uint8_t* p) const noexcept;
+  bool VerifyHeader(const uint8_t* prefix) const noexcept;
+  bool VerifyChecksum(const uint8_t* frame, size_t covered) const noexcept;
+  /// Drop the current frame start and look for the next candidate.
+  void Resync() noexcept;
+  void Compact() noexcept;
+
+ public:
+  /// @throw InvalidArgException on an unsupported prefix size
+  explicit FrameDecoder(const FrameDecoderOptions& options);
+
+  FrameDecoder(const FrameDecoder&) = delete;
+  FrameDecoder& operator=(const FrameDecoder&) = delete;
+  FrameDecoder(FrameDecoder&&) = default;
+  FrameDecoder& operator=(FrameDecoder&&) = default;
+
+  /// @brief Append received bytes.
+  /// @return bytes accepted, less than data.Size() only when the buffer is
+  /// full of frames not taken with Next() yet
+  size_t Feed(const Span<const uint8_t>& data) noexcept;
+
+  /// @brief Append data and call on_frame(Span<const uint8_t>) for every
+  /// complete frame, draining as needed so all of data is consumed.
+  template <typename TFunc>
+  void Feed(Span<const uint8_t> data, TFunc&& on_frame) {
+    Span<const uint8_t> frame;
+    while (!data.Empty()) {
+      size_t n = Feed(data);
+      data = data.Subspan(n);
+      while (Next(frame)) {
+        on_frame(frame);
+      }
+    }
+  }
+
+  /// @brief Take the next complete frame payload.
+  /// @return false when more bytes are needed
+  bool Next(Span<const uint8_t>& frame) noexcept;
+
+  /// @brief Drop all buffered bytes, statistics are kept.
+  void Reset() noexcept;
+
+  /// @brief Bytes received but not yet returned or discarded.
+  size_t Buffered() const noexcept {
+    return write_ - read_;
+  }
+
+  size_t Capacity() const noexcept {
+    return buffer_.size();
+  }
+
+  uint64_t FramesDecoded() const noexcept {
+    return frames_;
+  }
+
+  /// @brief Times the decoder lost sync (bad length, marker or checksum).
+  uint64_t Resyncs() const noexcept {
+    return resyncs_;
+  }
+
+  /// @brief Bytes skipped while resynchronizing.
+  uint64_t BytesDiscarded() const noexcept {
+    return discarded_;
+  }
+
+  const FrameDecoderOptions& Options() const noexcept {
+    return options_;
+  }
+};
+
+}  // namespace io
+}  // namespace nvm
+
+#endif  // NVM_CORE_IO_V2_FRAME_DECODER_H
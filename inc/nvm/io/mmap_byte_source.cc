@@ -0,0 +1,337 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/io/mmap_byte_source.h"
+
+#ifdef NVM_IO_HAS_MMAP
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace nvm {
+namespace io {
+
+namespace {
+
+int ToMadvise(MmapAccessHint hint) {
+  switch (hint) {
+    case MmapAccessHint::Sequential:
+      return MADV_SEQUENTIAL;
+    case MmapAccessHint::Random:
+      return MADV_RANDOM;
+    case MmapAccessHint::WillNeed:
+      return MADV_WILLNEED;
+    default:
+      return MADV_NORMAL;
+  }
+}
+
+std::string ErrnoMessage(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+std::string ErrnoMessage(const std::string& what, const std::string& path) {
+  return what + " '" + path + "': " + std::strerror(errno);
+}
+
+}  // namespace
+
+// MmapByteSource
+
+MmapByteSource::MmapByteSource(const std::string& path, MmapAccessHint hint,
+                               size_t window_size)
+                : fd_(-1),
+                  map_base_(nullptr),
+                  map_length_(0),
+                  window_(nullptr),
+                  window_length_(0),
+                  window_offset_(0),
+                  window_size_(0),
+                  file_size_(0),
+                  hint_(hint) {
+  fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) {
+    throw IoException(ErrnoMessage("MmapByteSource: failed to open", path));
+  }
+
+  struct stat st;
+  if (::fstat(fd_, &st) != 0) {
+    auto message = ErrnoMessage("MmapByteSource: failed to stat", path);
+    Close();
+    throw IoException(message);
+  }
+
+  file_size_ = static_cast<size_t>(st.st_size);
+
+  if (window_size != 0) {
+    // round the window up to whole pages
+    size_t page = PageSize();
+    window_size_ = ((window_size + page - 1) / page) * page;
+  }
+
+  try {
+    MapWindow(0);
+  } catch (...) {
+    Close();
+    throw;
+  }
+}
+
+MmapByteSource::MmapByteSource(MmapByteSource&& other) noexcept
+                : fd_(std::exchange(other.fd_, -1)),
+                  map_base_(std::exchange(other.map_base_, nullptr)),
+                  map_length_(std::exchange(other.map_length_, 0)),
+                  window_(std::exchange(other.window_, nullptr)),
+                  window_length_(std::exchange(other.window_length_, 0)),
+                  window_offset_(std::exchange(other.window_offset_, 0)),
+                  window_size_(std::exchange(other.window_size_, 0)),
+                  file_size_(std::exchange(other.file_size_, 0)),
+                  hint_(other.hint_) {}
+
+MmapByteSource& MmapByteSource::operator=(MmapByteSource&& other) noexcept {
+  if (this != &other) {
+    Close();
+    fd_ = std::exchange(other.fd_, -1);
+    map_base_ = std::exchange(other.map_base_, nullptr);
+    map_length_ = std::exchange(other.map_length_, 0);
+    window_ = std::exchange(other.window_, nullptr);
+    window_length_ = std::exchange(other.window_length_, 0);
+    window_offset_ = std::exchange(other.window_offset_, 0);
+    window_size_ = std::exchange(other.window_size_, 0);
+    file_size_ = std::exchange(other.file_size_, 0);
+    hint_ = other.hint_;
+  }
+  return *this;
+}
+
+MmapByteSource::~MmapByteSource() {
+  Close();
+}
+
+void MmapByteSource::Unmap() noexcept {
+  if (map_base_) {
+    ::munmap(map_base_, map_length_);
+  }
+  map_base_ = nullptr;
+  map_length_ = 0;
+  window_ = nullptr;
+  window_length_ = 0;
+}
+
+void MmapByteSource::Close() noexcept {
+  Unmap();
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+}
+
+Span<const uint8_t> MmapByteSource::MapWindow(size_t offset) {
+  if (offset > file_size_) {
+    offset = file_size_;
+  }
+
+  // Whole file is mapped once, later calls only re-slice.
+  if (!IsWindowed()) {
+    if (!map_base_ && file_size_ > 0) {
+      void* p = ::mmap(nullptr, file_size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+      if (p == MAP_FAILED) {
+        throw IoException(ErrnoMessage("MmapByteSource: mmap failed"));
+      }
+      map_base_ = static_cast<uint8_t*>(p);
+      map_length_ = file_size_;
+      ::madvise(map_base_, map_length_, ToMadvise(hint_));
+    }
+
+    window_ = map_base_ ? map_base_ + offset : nullptr;
+    window_length_ = file_size_ - offset;
+    window_offset_ = offset;
+    return Bytes();
+  }
+
+  size_t page = PageSize();
+  size_t aligned = (offset / page) * page;
+  size_t length = window_size_;
+  if (aligned + length > file_size_) {
+    length = file_size_ - aligned;
+  }
+
+  Unmap();
+  if (length > 0) {
+    void* p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd_,
+                     static_cast<off_t>(aligned));
+    if (p == MAP_FAILED) {
+      throw IoException(ErrnoMessage("MmapByteSource: mmap failed"));
+    }
+    map_base_ = static_cast<uint8_t*>(p);
+    map_length_ = length;
+    ::madvise(map_base_, map_length_, ToMadvise(hint_));
+  }
+
+  window_ = map_base_ ? map_base_ + (offset - aligned) : nullptr;
+  window_length_ = map_base_ ? length - (offset - aligned) : 0;
+  window_offset_ = offset;
+  return Bytes();
+}
+
+bool MmapByteSource::Advise(MmapAccessHint hint) noexcept {
+  hint_ = hint;
+  if (!map_base_) {
+    return true;
+  }
+  return ::madvise(map_base_, map_length_, ToMadvise(hint)) == 0;
+}
+
+bool MmapByteSource::WillNeed(size_t offset, size_t length) noexcept {
+  if (!window_ || offset >= window_length_) {
+    return false;
+  }
+
+  if (length > window_length_ - offset) {
+    length = window_length_ - offset;
+  }
+
+  // madvise wants a page aligned address
+  const uint8_t* start = window_ + offset;
+  size_t page = PageSize();
+  uintptr_t addr = reinterpret_cast<uintptr_t>(start);
+  uintptr_t aligned = (addr / page) * page;
+  return ::madvise(reinterpret_cast<void*>(aligned), length + (addr - aligned),
+                   MADV_WILLNEED) == 0;
+}
+
+size_t MmapByteSource::PageSize() noexcept {
+  static const size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  return page;
+}
+
+// MmapByteSink
+
+MmapByteSink::MmapByteSink(const std::string& path, size_t capacity)
+                : fd_(-1), map_base_(nullptr), capacity_(capacity), used_(0) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd_ < 0) {
+    throw IoException(ErrnoMessage("MmapByteSink: failed to create", path));
+  }
+
+  if (capacity_ == 0) {
+    return;
+  }
+
+#if defined(__linux__)
+  int rc = ::posix_fallocate(fd_, 0, static_cast<off_t>(capacity_));
+  if (rc != 0) {
+    // fall back to a sparse file on filesystems without fallocate
+    rc = ::ftruncate(fd_, static_cast<off_t>(capacity_));
+  }
+#else
+  int rc = ::ftruncate(fd_, static_cast<off_t>(capacity_));
+#endif
+  if (rc != 0) {
+    auto message = ErrnoMessage("MmapByteSink: failed to allocate", path);
+    Release();
+    throw IoException(message);
+  }
+
+  void* p = ::mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fd_, 0);
+  if (p == MAP_FAILED) {
+    auto message = ErrnoMessage("MmapByteSink: mmap failed", path);
+    Release();
+    throw IoException(message);
+  }
+
+  map_base_ = static_cast<uint8_t*>(p);
+  ::madvise(map_base_, capacity_, MADV_SEQUENTIAL);
+}
+
+MmapByteSink::MmapByteSink(MmapByteSink&& other) noexcept
+                : fd_(std::exchange(other.fd_, -1)),
+                  map_base_(std::exchange(other.map_base_, nullptr)),
+                  capacity_(std::exchange(other.capacity_, 0)),
+                  used_(std::exchange(other.used_, 0)) {}
+
+MmapByteSink& MmapByteSink::operator=(MmapByteSink&& other) noexcept {
+  if (this != &other) {
+    Release();
+    fd_ = std::exchange(other.fd_, -1);
+    map_base_ = std::exchange(other.map_base_, nullptr);
+    capacity_ = std::exchange(other.capacity_, 0);
+    used_ = std::exchange(other.used_, 0);
+  }
+  return *this;
+}
+
+MmapByteSink::~MmapByteSink() {
+  Release();
+}
+
+void MmapByteSink::Release() noexcept {
+  if (map_base_) {
+    ::munmap(map_base_, capacity_);
+  }
+  map_base_ = nullptr;
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+  fd_ = -1;
+}
+
+bool MmapByteSink::Sync(bool async) noexcept {
+  if (!map_base_) {
+    return true;
+  }
+  return ::msync(map_base_, capacity_, async ? MS_ASYNC : MS_SYNC) == 0;
+}
+
+void MmapByteSink::Finish() {
+  if (fd_ < 0) {
+    return;
+  }
+
+  if (!Sync(false)) {
+    auto message = ErrnoMessage("MmapByteSink: failed to flush");
+    Release();
+    throw IoException(message);
+  }
+  if (map_base_) {
+    ::munmap(map_base_, capacity_);
+    map_base_ = nullptr;
+  }
+
+  if (::ftruncate(fd_, static_cast<off_t>(used_)) != 0) {
+    auto message = ErrnoMessage("MmapByteSink: failed to trim");
+    Release();
+    throw IoException(message);
+  }
+
+  capacity_ = used_;
+  Release();
+}
+
+}  // namespace io
+}  // namespace nvm
+
+#endif  // NVM_IO_HAS_MMAP
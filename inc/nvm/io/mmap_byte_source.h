@@ -0,0 +1,197 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_IO_V2_MMAP_BYTE_SOURCE_H
+#define NVM_CORE_IO_V2_MMAP_BYTE_SOURCE_H
+
+#if defined(__unix__) || defined(__APPLE__)
+#define NVM_IO_HAS_MMAP 1
+#endif
+
+#ifdef NVM_IO_HAS_MMAP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "nvm/exceptions/exception.h"
+#include "nvm/macro.h"
+#include "nvm/span.h"
+
+namespace nvm {
+namespace io {
+
+enum class MmapAccessHint : uint8_t {
+  Normal = 0,
+  Sequential = 1,
+  Random = 2,
+  WillNeed = 3,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(MmapAccessHint)
+
+/// @brief Read-only memory mapped file. Exposes the mapped bytes through
+/// Data()/Size(), so it can be used directly as io::ByteStream source and
+/// decoding runs on the mapped pages without a heap copy.
+/// When window_size is 0 the whole file is mapped, otherwise only
+/// window_size bytes are mapped at a time and MapWindow() slides the window,
+/// this keeps address space usage bounded for very large files.
+class MmapByteSource {
+ private:
+  int fd_;
+  uint8_t* map_base_;
+  size_t map_length_;
+  const uint8_t* window_;
+  size_t window_length_;
+  size_t window_offset_;
+  size_t window_size_;
+  size_t file_size_;
+  MmapAccessHint hint_;
+
+  void Unmap() noexcept;
+  void Close() noexcept;
+
+ public:
+  /// @brief Map path read-only.
+  /// @param path
+  /// @param hint access pattern passed to madvise
+  /// @param window_size 0 maps whole file, otherwise max bytes mapped at once
+  /// @throw nvm::IoException when the file can not be opened or mapped
+  explicit MmapByteSource(const std::string& path,
+                          MmapAccessHint hint = MmapAccessHint::Sequential,
+                          size_t window_size = 0);
+
+  MmapByteSource(const MmapByteSource&) = delete;
+  MmapByteSource& operator=(const MmapByteSource&) = delete;
+  MmapByteSource(MmapByteSource&& other) noexcept;
+  MmapByteSource& operator=(MmapByteSource&& other) noexcept;
+
+  ~MmapByteSource();
+
+  /// @brief Pointer to the first byte of the current window.
+  const uint8_t* Data() const noexcept {
+    return window_;
+  }
+
+  /// @brief Bytes available in the current window.
+  size_t Size() const noexcept {
+    return window_length_;
+  }
+
+  /// @brief Current window as Span.
+  Span<const uint8_t> Bytes() const noexcept {
+    return Span<const uint8_t>(window_, window_length_);
+  }
+
+  /// @brief File offset of Data()[0].
+  size_t WindowOffset() const noexcept {
+    return window_offset_;
+  }
+
+  size_t FileSize() const noexcept {
+    return file_size_;
+  }
+
+  bool IsWindowed() const noexcept {
+    return window_size_ != 0 && window_size_ < file_size_;
+  }
+
+  /// @brief Remap the window so it starts at file offset. No-op when the whole
+  /// file is mapped, the span is then just re-sliced.
+  /// @param offset file offset, clamped to FileSize()
+  /// @return view of the new window
+  /// @throw nvm::IoException when mmap fails
+  Span<const uint8_t> MapWindow(size_t offset);
+
+  /// @brief Change access hint of the current window.
+  /// @return false if madvise failed
+  bool Advise(MmapAccessHint hint) noexcept;
+
+  /// @brief Ask the kernel to start reading [offset, offset + length) of the
+  /// current window ahead of use.
+  /// @return false if madvise failed
+  bool WillNeed(size_t offset, size_t length) noexcept;
+
+  /// @brief System page size, windows are aligned to it.
+  static size_t PageSize() noexcept;
+};
+
+/// @brief Writable memory mapped output file. The file is created (or
+/// truncated) and pre-allocated to capacity bytes, encoders write straight
+/// into the mapped pages. Call Finish() to flush and trim to the used size.
+class MmapByteSink {
+ private:
+  int fd_;
+  uint8_t* map_base_;
+  size_t capacity_;
+  size_t used_;
+
+  void Release() noexcept;
+
+ public:
+  /// @brief Create path with capacity bytes reserved on disk.
+  /// @throw nvm::IoException when the file can not be created or mapped
+  MmapByteSink(const std::string& path, size_t capacity);
+
+  MmapByteSink(const MmapByteSink&) = delete;
+  MmapByteSink& operator=(const MmapByteSink&) = delete;
+  MmapByteSink(MmapByteSink&& other) noexcept;
+  MmapByteSink& operator=(MmapByteSink&& other) noexcept;
+
+  ~MmapByteSink();
+
+  uint8_t* Data() const noexcept {
+    return map_base_;
+  }
+
+  size_t Size() const noexcept {
+    return capacity_;
+  }
+
+  Span<uint8_t> Bytes() const noexcept {
+    return Span<uint8_t>(map_base_, capacity_);
+  }
+
+  /// @brief Mark how many bytes from the beginning hold real data, Finish()
+  /// trims the file to this size.
+  void SetUsed(size_t used) noexcept {
+    used_ = used > capacity_ ? capacity_ : used;
+  }
+
+  size_t Used() const noexcept {
+    return used_;
+  }
+
+  /// @brief Flush dirty pages to disk.
+  /// @param async true schedules the write and returns immediately
+  /// @return false if msync failed
+  bool Sync(bool async = false) noexcept;
+
+  /// @brief Flush, unmap and trim the file to Used() bytes.
+  /// @throw nvm::IoException when the flush or the trim fails
+  void Finish();
+};
+
+}  // namespace io
+}  // namespace nvm
+
+#endif  // NVM_IO_HAS_MMAP
+
+#endif  // NVM_CORE_IO_V2_MMAP_BYTE_SOURCE_H
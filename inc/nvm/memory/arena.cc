@@ -0,0 +1,190 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/memory/arena.h"
+
+#include <cstring>
+
+#include "nvm/bytes/hash.h"
+
+namespace nvm {
+namespace memory {
+
+struct alignas(std::max_align_t) Arena::Block {
+  Block* next;
+  size_t size;
+
+  char* Payload() noexcept {
+    return reinterpret_cast<char*>(this + 1);
+  }
+};
+
+Arena::Arena(size_t block_size) noexcept
+                : head_(nullptr),
+                  cursor_(nullptr),
+                  limit_(nullptr),
+                  retired_(0),
+                  reserved_(0),
+                  next_block_size_(block_size < 64 ? 64 : block_size),
+                  block_count_(0) {}
+
+Arena::~Arena() {
+  while (head_) {
+    Block* next = head_->next;
+    ::operator delete(head_);
+    head_ = next;
+  }
+}
+
+void* Arena::AllocateSlow(size_t size, size_t alignment) {
+  // payloads start max_align_t aligned, larger alignments need the slack
+  size_t needed =
+      size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+  if (needed < size) {
+    throw std::bad_alloc();
+  }
+  size_t block_size = next_block_size_;
+  while (block_size < needed) {
+    block_size *= 2;
+  }
+
+  auto* block =
+      static_cast<Block*>(::operator new(sizeof(Block) + block_size));
+  block->next = head_;
+  block->size = block_size;
+  if (head_) {
+    retired_ += static_cast<size_t>(cursor_ - head_->Payload());
+  }
+  head_ = block;
+  cursor_ = block->Payload();
+  limit_ = cursor_ + block_size;
+  reserved_ += block_size;
+  block_count_ += 1;
+  if (next_block_size_ < kMaxBlockSize) {
+    next_block_size_ *= 2;
+  }
+
+  return Allocate(size, alignment);
+}
+
+std::string_view Arena::CopyString(std::string_view value) {
+  auto* out = static_cast<char*>(Allocate(value.size() + 1, 1));
+  if (!value.empty()) {
+    std::memcpy(out, value.data(), value.size());
+  }
+  out[value.size()] = '\0';
+  return std::string_view(out, value.size());
+}
+
+void Arena::Reset() noexcept {
+  if (!head_) {
+    return;
+  }
+  Block* keep = head_;
+  Block* block = keep->next;
+  while (block) {
+    Block* next = block->next;
+    reserved_ -= block->size;
+    ::operator delete(block);
+    block = next;
+  }
+  keep->next = nullptr;
+  head_ = keep;
+  cursor_ = keep->Payload();
+  limit_ = cursor_ + keep->size;
+  retired_ = 0;
+  block_count_ = 1;
+}
+
+size_t Arena::BytesUsed() const noexcept {
+  return head_ ? retired_ + static_cast<size_t>(cursor_ - head_->Payload())
+               : 0;
+}
+
+namespace {
+
+constexpr size_t kInitialSlots = 32;
+
+inline size_t SlotOf(std::string_view value, size_t mask) noexcept {
+  return static_cast<size_t>(
+             bytes::Hash64(value.data(), value.size(), value.size())) &
+         mask;
+}
+
+}  // namespace
+
+StringInterner::StringInterner(Arena& arena) noexcept
+                : arena_(&arena), slots_(nullptr), capacity_(0), size_(0) {}
+
+std::string_view StringInterner::Intern(std::string_view value) {
+  if (value.empty()) {
+    return std::string_view("", 0);
+  }
+  // at most half full
+  if ((size_ + 1) * 2 > capacity_) {
+    Grow();
+  }
+
+  size_t mask = capacity_ - 1;
+  size_t i = SlotOf(value, mask);
+  while (slots_[i].data() != nullptr) {
+    if (slots_[i] == value) {
+      return slots_[i];
+    }
+    i = (i + 1) & mask;
+  }
+
+  slots_[i] = arena_->CopyString(value);
+  size_ += 1;
+  return slots_[i];
+}
+
+void StringInterner::Grow() {
+  size_t capacity = capacity_ == 0 ? kInitialSlots : capacity_ * 2;
+  auto* slots = static_cast<std::string_view*>(arena_->Allocate(
+      capacity * sizeof(std::string_view), alignof(std::string_view)));
+  for (size_t i = 0; i < capacity; ++i) {
+    new (slots + i) std::string_view();
+  }
+
+  size_t mask = capacity - 1;
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (slots_[i].data() == nullptr) {
+      continue;
+    }
+    size_t j = SlotOf(slots_[i], mask);
+    while (slots[j].data() != nullptr) {
+      j = (j + 1) & mask;
+    }
+    slots[j] = slots_[i];
+  }
+
+  // the old table stays in the arena until the next reset
+  slots_ = slots;
+  capacity_ = capacity;
+}
+
+void StringInterner::Clear() noexcept {
+  slots_ = nullptr;
+  capacity_ = 0;
+  size_ = 0;
+}
+
+}  // namespace memory
+}  // namespace nvm
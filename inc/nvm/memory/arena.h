@@ -0,0 +1,183 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_MEMORY_V2_ARENA_H
+#define NVM_CORE_MEMORY_V2_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string_view>
+#include <utility>
+
+namespace nvm {
+namespace memory {
+
+/// @brief Monotonic bump allocator over a chain of growing blocks. Nothing
+/// is freed one by one, Reset() or the destructor give everything back at
+/// once. Single owner, not thread safe.
+/// The arena never runs destructors, objects placed in it either are
+/// trivially destructible or are destroyed by their owner before Reset().
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 4096;
+  static constexpr size_t kMaxBlockSize = size_t(1) << 20;
+
+  /// @param block_size size of the first block, later blocks double up to
+  /// kMaxBlockSize. Nothing is allocated before the first request.
+  explicit Arena(size_t block_size = kDefaultBlockSize) noexcept;
+
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /// @brief size bytes aligned to alignment (a power of two).
+  /// @throw std::bad_alloc
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) &
+                  ~(uintptr_t(alignment) - 1);
+    uintptr_t limit = reinterpret_cast<uintptr_t>(limit_);
+    if (p <= limit && size <= limit - p) {
+      cursor_ = reinterpret_cast<char*>(p + size);
+      return reinterpret_cast<void*>(p);
+    }
+    return AllocateSlow(size, alignment);
+  }
+
+  /// @brief Construct T in the arena, see the class note about destructors.
+  template <typename T, typename... Args>
+  T* Create(Args&&... args) {
+    return new (Allocate(sizeof(T), alignof(T)))
+        T(std::forward<Args>(args)...);
+  }
+
+  /// @brief Copy of value, NUL terminated.
+  std::string_view CopyString(std::string_view value);
+
+  /// @brief Forget every allocation. The newest (largest) block is kept for
+  /// reuse, a builder that is reset per request stops touching the system
+  /// allocator once that block fits its requests.
+  void Reset() noexcept;
+
+  /// @brief Bytes handed out since the last Reset(), alignment included.
+  size_t BytesUsed() const noexcept;
+
+  /// @brief Bytes held from the system.
+  size_t BytesReserved() const noexcept {
+    return reserved_;
+  }
+
+  size_t BlockCount() const noexcept {
+    return block_count_;
+  }
+
+ private:
+  struct Block;
+
+  void* AllocateSlow(size_t size, size_t alignment);
+
+  Block* head_;
+  char* cursor_;
+  char* limit_;
+  // bytes used in blocks before head_
+  size_t retired_;
+  size_t reserved_;
+  size_t next_block_size_;
+  size_t block_count_;
+};
+
+/// @brief Standard allocator handing out arena memory, deallocate() is a
+/// no-op. Containers using it must not outlive the arena nor a Reset().
+template <typename T>
+class ArenaAllocator {
+ private:
+  Arena* arena_;
+
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) noexcept : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept
+                  : arena_(other.GetArena()) {}
+
+  T* allocate(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+      throw std::bad_array_new_length();
+    }
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, size_t) noexcept {}
+
+  Arena* GetArena() const noexcept {
+    return arena_;
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const noexcept {
+    return arena_ == other.GetArena();
+  }
+
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const noexcept {
+    return arena_ != other.GetArena();
+  }
+};
+
+/// @brief Deduplicating string table stored in an arena. Equal strings
+/// intern to the same view, so the text of a name used many times is kept
+/// once. Views stay valid until the arena is reset, call Clear() together
+/// with Arena::Reset().
+class StringInterner {
+ public:
+  explicit StringInterner(Arena& arena) noexcept;
+
+  StringInterner(const StringInterner&) = delete;
+  StringInterner& operator=(const StringInterner&) = delete;
+
+  /// @brief Interned copy of value. The empty string is never stored, its
+  /// view still has non-null data.
+  std::string_view Intern(std::string_view value);
+
+  /// @brief Distinct non-empty strings interned.
+  size_t Size() const noexcept {
+    return size_;
+  }
+
+  /// @brief Forget every string, the slots are arena memory and are
+  /// reclaimed by the arena.
+  void Clear() noexcept;
+
+ private:
+  void Grow();
+
+  Arena* arena_;
+  std::string_view* slots_;
+  size_t capacity_;
+  size_t size_;
+};
+
+}  // namespace memory
+}  // namespace nvm
+
+#endif
@@ -0,0 +1,409 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/memory/buffer_pool.h"
+
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#ifdef NVM_MEMORY_HAS_IOVEC
+#include <cerrno>
+#include <climits>
+#include <unistd.h>
+#endif
+
+namespace nvm {
+namespace memory {
+
+namespace details {
+
+struct BufferPoolCore {
+  size_t slab_size;
+  size_t max_free;
+  std::mutex mutex;
+  std::vector<SlabHeader*> free_list;
+  // slabs alive (in use, cached or free) plus one for the BufferPool handle
+  std::atomic<size_t> live;
+  std::atomic<size_t> created;
+  std::atomic<bool> closed;
+
+  BufferPoolCore(size_t slab_size, size_t max_free)
+                  : slab_size(slab_size),
+                    max_free(max_free),
+                    live(1),
+                    created(0),
+                    closed(false) {}
+};
+
+namespace {
+
+constexpr size_t kThreadCacheSlabs = 32;
+
+// slabs held from the system over every pool, for BufferPool::SlabsAlive()
+std::atomic<size_t> slabs_alive(0);
+
+SlabHeader* NewSlab(BufferPoolCore* core) {
+  void* mem = ::operator new(sizeof(SlabHeader) + core->slab_size,
+                             std::align_val_t(alignof(SlabHeader)));
+  auto slab = new (mem) SlabHeader();
+  slab->refs.store(1, std::memory_order_relaxed);
+  slab->core = core;
+  slab->capacity = core->slab_size;
+  core->live.fetch_add(1, std::memory_order_relaxed);
+  core->created.fetch_add(1, std::memory_order_relaxed);
+  slabs_alive.fetch_add(1, std::memory_order_relaxed);
+  return slab;
+}
+
+void Unref(BufferPoolCore* core) noexcept {
+  if (core->live.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete core;
+  }
+}
+
+void FreeSlab(SlabHeader* slab) noexcept {
+  BufferPoolCore* core = slab->core;
+  slab->~SlabHeader();
+  ::operator delete(slab, std::align_val_t(alignof(SlabHeader)));
+  slabs_alive.fetch_sub(1, std::memory_order_relaxed);
+  Unref(core);
+}
+
+/// Push to the shared list, or free when the pool is gone or the list full.
+void ReturnToCore(SlabHeader* slab) noexcept {
+  BufferPoolCore* core = slab->core;
+  if (!core->closed.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(core->mutex);
+    if (!core->closed.load(std::memory_order_relaxed) &&
+        core->free_list.size() < core->max_free) {
+      core->free_list.push_back(slab);
+      return;
+    }
+  }
+  FreeSlab(slab);
+}
+
+struct ThreadCacheEntry {
+  BufferPoolCore* core;
+  std::vector<SlabHeader*> slabs;
+};
+
+enum : uint8_t { kCacheNone = 0, kCacheAlive = 1, kCacheDestroyed = 2 };
+
+// Trivially destructible, still readable while other thread_local objects
+// are being torn down. The cache must not be touched once destroyed.
+thread_local uint8_t tls_cache_state = kCacheNone;
+
+struct ThreadCache {
+  std::vector<ThreadCacheEntry> entries;
+
+  ThreadCache() {
+    tls_cache_state = kCacheAlive;
+  }
+
+  ~ThreadCache() {
+    tls_cache_state = kCacheDestroyed;
+    for (auto& entry : entries) {
+      for (auto slab : entry.slabs) {
+        ReturnToCore(slab);
+      }
+    }
+  }
+
+  /// Free the slabs of pools destroyed on other threads and drop empty
+  /// entries. A cached slab holds a reference, so the core of an entry with
+  /// slabs is alive; entries with no slabs may point to a core that is
+  /// already gone and are never dereferenced.
+  void Prune() noexcept {
+    size_t kept = 0;
+    for (size_t i = 0; i < entries.size(); ++i) {
+      auto& entry = entries[i];
+      if (!entry.slabs.empty() &&
+          entry.core->closed.load(std::memory_order_acquire)) {
+        for (auto slab : entry.slabs) {
+          FreeSlab(slab);
+        }
+        entry.slabs.clear();
+      }
+      if (entry.slabs.empty()) {
+        continue;
+      }
+      if (kept != i) {
+        entries[kept] = std::move(entry);
+      }
+      ++kept;
+    }
+    entries.resize(kept);
+  }
+
+  std::vector<SlabHeader*>* Find(BufferPoolCore* core) {
+    Prune();
+    for (auto& entry : entries) {
+      if (entry.core == core) {
+        return &entry.slabs;
+      }
+    }
+    return nullptr;
+  }
+
+  std::vector<SlabHeader*>& Get(BufferPoolCore* core) {
+    if (auto slabs = Find(core)) {
+      return *slabs;
+    }
+    entries.push_back(ThreadCacheEntry{core, {}});
+    return entries.back().slabs;
+  }
+};
+
+ThreadCache& LocalCache() {
+  thread_local ThreadCache cache;
+  return cache;
+}
+
+}  // namespace
+
+void ReleaseSlab(SlabHeader* slab) noexcept {
+  if (slab->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+
+  BufferPoolCore* core = slab->core;
+  if (core->closed.load(std::memory_order_acquire)) {
+    FreeSlab(slab);
+    return;
+  }
+
+  if (tls_cache_state == kCacheNone) {
+    try {
+      LocalCache();
+    } catch (...) {
+    }
+  }
+  if (tls_cache_state != kCacheAlive) {
+    // thread is shutting down
+    ReturnToCore(slab);
+    return;
+  }
+
+  try {
+    auto& slabs = LocalCache().Get(core);
+    if (slabs.size() >= kThreadCacheSlabs) {
+      // keep half locally, the rest goes where other threads can take it
+      for (size_t i = kThreadCacheSlabs / 2; i < slabs.size(); ++i) {
+        ReturnToCore(slabs[i]);
+      }
+      slabs.resize(kThreadCacheSlabs / 2);
+    }
+    slabs.push_back(slab);
+  } catch (...) {
+    ReturnToCore(slab);
+  }
+}
+
+}  // namespace details
+
+BufferPool::BufferPool(size_t slab_size, size_t max_free_slabs)
+                : core_(new details::BufferPoolCore(
+                      slab_size == 0 ? 16 * 1024 : slab_size,
+                      max_free_slabs)) {}
+
+BufferPool::~BufferPool() {
+  std::vector<details::SlabHeader*> free_list;
+  {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    core_->closed.store(true, std::memory_order_release);
+    free_list.swap(core_->free_list);
+  }
+
+  // slabs cached by this thread go now, other threads drop theirs the next
+  // time they use their cache, or on exit
+  if (details::tls_cache_state == details::kCacheAlive) {
+    details::LocalCache().Prune();
+  }
+
+  for (auto slab : free_list) {
+    details::FreeSlab(slab);
+  }
+  details::Unref(core_);
+}
+
+PooledBuffer BufferPool::Allocate() {
+  if (details::tls_cache_state == details::kCacheAlive) {
+    if (auto slabs = details::LocalCache().Find(core_)) {
+      if (!slabs->empty()) {
+        auto slab = slabs->back();
+        slabs->pop_back();
+        slab->refs.store(1, std::memory_order_relaxed);
+        return PooledBuffer(slab);
+      }
+    }
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(core_->mutex);
+    if (!core_->free_list.empty()) {
+      auto slab = core_->free_list.back();
+      core_->free_list.pop_back();
+      slab->refs.store(1, std::memory_order_relaxed);
+      return PooledBuffer(slab);
+    }
+  }
+
+  return PooledBuffer(details::NewSlab(core_));
+}
+
+size_t BufferPool::SlabSize() const noexcept {
+  return core_->slab_size;
+}
+
+size_t BufferPool::SlabsCreated() const noexcept {
+  return core_->created.load(std::memory_order_relaxed);
+}
+
+size_t BufferPool::SlabsAlive() noexcept {
+  return details::slabs_alive.load(std::memory_order_relaxed);
+}
+
+size_t BufferPool::FreeSlabs() const noexcept {
+  std::lock_guard<std::mutex> lock(core_->mutex);
+  return core_->free_list.size();
+}
+
+// BufferChain
+
+void BufferChain::Consume(size_t n) {
+  if (n >= size_) {
+    Clear();
+    return;
+  }
+
+  size_t drop = 0;
+  while (drop < slices_.size() && slices_[drop].Size() <= n) {
+    n -= slices_[drop].Size();
+    size_ -= slices_[drop].Size();
+    ++drop;
+  }
+  slices_.erase(slices_.begin(), slices_.begin() + drop);
+
+  if (n > 0) {
+    auto& front = slices_.front();
+    front = front.Subslice(n, front.Size() - n);
+    size_ -= n;
+  }
+}
+
+std::vector<uint8_t> BufferChain::Flatten() const {
+  std::vector<uint8_t> out(size_);
+  size_t offset = 0;
+  for (const auto& slice : slices_) {
+    std::memcpy(out.data() + offset, slice.Data(), slice.Size());
+    offset += slice.Size();
+  }
+  return out;
+}
+
+#ifdef NVM_MEMORY_HAS_IOVEC
+void BufferChain::IoVec(std::vector<iovec>& out) const {
+  out.resize(slices_.size());
+  for (size_t i = 0; i < slices_.size(); ++i) {
+    out[i].iov_base = const_cast<uint8_t*>(slices_[i].Data());
+    out[i].iov_len = slices_[i].Size();
+  }
+}
+
+int64_t BufferChain::WriteTo(int fd) {
+#ifdef IOV_MAX
+  const size_t max_iov = IOV_MAX;
+#else
+  const size_t max_iov = 1024;
+#endif
+
+  int64_t total = 0;
+  std::vector<iovec> iov;
+  while (!Empty()) {
+    IoVec(iov);
+    int count = static_cast<int>(iov.size() < max_iov ? iov.size() : max_iov);
+    ssize_t n = ::writev(fd, iov.data(), count);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -errno;
+    }
+    Consume(static_cast<size_t>(n));
+    total += n;
+  }
+  return total;
+}
+#endif
+
+// ChainWriter
+
+void ChainWriter::Seal() {
+  if (current_.Size() > 0) {
+    chain_.Append(current_.ToSlice());
+  } else {
+    current_.Reset();
+  }
+}
+
+Span<uint8_t> ChainWriter::Reserve(size_t n) {
+  if (n > pool_.SlabSize()) {
+    return Span<uint8_t>();
+  }
+  if (current_.Empty() || current_.Capacity() - current_.Size() < n) {
+    Seal();
+    current_ = pool_.Allocate();
+  }
+  return Span<uint8_t>(current_.Data() + current_.Size(), n);
+}
+
+ChainWriter& ChainWriter::Write(const uint8_t* data, size_t size) {
+  while (size > 0) {
+    if (current_.Empty() || current_.Size() == current_.Capacity()) {
+      Seal();
+      current_ = pool_.Allocate();
+    }
+    auto tail = current_.Tail();
+    size_t n = size < tail.Size() ? size : tail.Size();
+    std::memcpy(tail.Data(), data, n);
+    current_.Resize(current_.Size() + n);
+    data += n;
+    size -= n;
+  }
+  return *this;
+}
+
+ChainWriter& ChainWriter::Append(Slice slice) {
+  // keep order, what was written so far goes first
+  Seal();
+  chain_.Append(std::move(slice));
+  return *this;
+}
+
+BufferChain ChainWriter::Finish() {
+  Seal();
+  BufferChain out = std::move(chain_);
+  chain_.Clear();
+  return out;
+}
+
+}  // namespace memory
+}  // namespace nvm
@@ -0,0 +1,405 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_MEMORY_V2_BUFFER_POOL_H
+#define NVM_CORE_MEMORY_V2_BUFFER_POOL_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/uio.h>
+#define NVM_MEMORY_HAS_IOVEC 1
+#endif
+
+#include "nvm/span.h"
+
+namespace nvm {
+namespace memory {
+
+namespace details {
+
+struct BufferPoolCore;
+
+/// Slab header, the payload follows directly after it.
+struct alignas(64) SlabHeader {
+  std::atomic<uint32_t> refs;
+  BufferPoolCore* core;
+  size_t capacity;
+
+  uint8_t* Payload() noexcept {
+    return reinterpret_cast<uint8_t*>(this + 1);
+  }
+};
+
+/// Drop one reference, the last one hands the slab back to its pool.
+void ReleaseSlab(SlabHeader* slab) noexcept;
+
+inline void RetainSlab(SlabHeader* slab) noexcept {
+  slab->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+}  // namespace details
+
+class Slice;
+
+/// @brief Writable slab owned by a single writer. Fill it through Data() or
+/// Writable(), then turn it into a shareable Slice.
+class PooledBuffer {
+ private:
+  details::SlabHeader* slab_;
+  size_t size_;
+
+  friend class BufferPool;
+
+  explicit PooledBuffer(details::SlabHeader* slab) noexcept
+                  : slab_(slab), size_(0) {}
+
+ public:
+  PooledBuffer() noexcept : slab_(nullptr), size_(0) {}
+
+  PooledBuffer(const PooledBuffer&) = delete;
+  PooledBuffer& operator=(const PooledBuffer&) = delete;
+
+  PooledBuffer(PooledBuffer&& other) noexcept
+                  : slab_(std::exchange(other.slab_, nullptr)),
+                    size_(std::exchange(other.size_, 0)) {}
+
+  PooledBuffer& operator=(PooledBuffer&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      slab_ = std::exchange(other.slab_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  ~PooledBuffer() {
+    Reset();
+  }
+
+  /// @brief Return the slab to the pool.
+  void Reset() noexcept {
+    if (slab_) {
+      details::ReleaseSlab(slab_);
+    }
+    slab_ = nullptr;
+    size_ = 0;
+  }
+
+  bool Empty() const noexcept {
+    return slab_ == nullptr;
+  }
+
+  uint8_t* Data() const noexcept {
+    return slab_ ? slab_->Payload() : nullptr;
+  }
+
+  size_t Capacity() const noexcept {
+    return slab_ ? slab_->capacity : 0;
+  }
+
+  /// @brief Bytes holding data, becomes the Slice length.
+  size_t Size() const noexcept {
+    return size_;
+  }
+
+  /// @brief Set the number of valid bytes, clamped to Capacity().
+  void Resize(size_t size) noexcept {
+    size_ = size > Capacity() ? Capacity() : size;
+  }
+
+  /// @brief Whole slab as writable span.
+  Span<uint8_t> Writable() const noexcept {
+    return Span<uint8_t>(Data(), Capacity());
+  }
+
+  /// @brief Free space after Size().
+  Span<uint8_t> Tail() const noexcept {
+    return Span<uint8_t>(Data() + size_, Capacity() - size_);
+  }
+
+  /// @brief Freeze [0, Size()) into a shareable slice, this buffer becomes
+  /// empty.
+  Slice ToSlice() noexcept;
+};
+
+/// @brief Reference counted read-only view into a pooled slab. Copies share
+/// the bytes, the slab is recycled when the last slice is gone.
+class Slice {
+ private:
+  details::SlabHeader* slab_;
+  const uint8_t* data_;
+  size_t size_;
+
+  friend class PooledBuffer;
+
+  Slice(details::SlabHeader* slab, const uint8_t* data, size_t size) noexcept
+                  : slab_(slab), data_(data), size_(size) {}
+
+ public:
+  Slice() noexcept : slab_(nullptr), data_(nullptr), size_(0) {}
+
+  Slice(const Slice& other) noexcept
+                  : slab_(other.slab_), data_(other.data_), size_(other.size_) {
+    if (slab_) {
+      details::RetainSlab(slab_);
+    }
+  }
+
+  Slice& operator=(const Slice& other) noexcept {
+    if (this != &other) {
+      if (other.slab_) {
+        details::RetainSlab(other.slab_);
+      }
+      Reset();
+      slab_ = other.slab_;
+      data_ = other.data_;
+      size_ = other.size_;
+    }
+    return *this;
+  }
+
+  Slice(Slice&& other) noexcept
+                  : slab_(std::exchange(other.slab_, nullptr)),
+                    data_(std::exchange(other.data_, nullptr)),
+                    size_(std::exchange(other.size_, 0)) {}
+
+  Slice& operator=(Slice&& other) noexcept {
+    if (this != &other) {
+      Reset();
+      slab_ = std::exchange(other.slab_, nullptr);
+      data_ = std::exchange(other.data_, nullptr);
+      size_ = std::exchange(other.size_, 0);
+    }
+    return *this;
+  }
+
+  ~Slice() {
+    Reset();
+  }
+
+  void Reset() noexcept {
+    if (slab_) {
+      details::ReleaseSlab(slab_);
+    }
+    slab_ = nullptr;
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  const uint8_t* Data() const noexcept {
+    return data_;
+  }
+
+  size_t Size() const noexcept {
+    return size_;
+  }
+
+  bool Empty() const noexcept {
+    return size_ == 0;
+  }
+
+  Span<const uint8_t> Bytes() const noexcept {
+    return Span<const uint8_t>(data_, size_);
+  }
+
+  /// @brief Slices sharing the slab, 0 for an empty slice.
+  uint32_t UseCount() const noexcept {
+    return slab_ ? slab_->refs.load(std::memory_order_relaxed) : 0;
+  }
+
+  /// @brief Share [offset, offset + length) of this slice, clamped to Size().
+  Slice Subslice(size_t offset, size_t length) const noexcept {
+    if (offset > size_) {
+      offset = size_;
+    }
+    if (length > size_ - offset) {
+      length = size_ - offset;
+    }
+    if (slab_) {
+      details::RetainSlab(slab_);
+    }
+    return Slice(slab_, data_ + offset, length);
+  }
+};
+
+inline Slice PooledBuffer::ToSlice() noexcept {
+  auto slab = std::exchange(slab_, nullptr);
+  auto size = std::exchange(size_, 0);
+  return Slice(slab, slab ? slab->Payload() : nullptr, size);
+}
+
+/// @brief Pool of fixed-size slabs. Freed slabs go to a small per-thread
+/// cache first and overflow into a shared free list, so the steady state of
+/// an encode loop allocates nothing.
+/// Slabs may outlive the pool, they are released to the system then.
+class BufferPool {
+ private:
+  details::BufferPoolCore* core_;
+
+ public:
+  /// @param slab_size payload bytes per slab
+  /// @param max_free_slabs slabs kept in the shared free list
+  explicit BufferPool(size_t slab_size = 16 * 1024,
+                      size_t max_free_slabs = 256);
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  ~BufferPool();
+
+  static std::shared_ptr<BufferPool> Create(size_t slab_size = 16 * 1024,
+                                            size_t max_free_slabs = 256) {
+    return std::make_shared<BufferPool>(slab_size, max_free_slabs);
+  }
+
+  /// @brief Take a slab, recycled when possible.
+  /// @throw std::bad_alloc
+  PooledBuffer Allocate();
+
+  size_t SlabSize() const noexcept;
+
+  /// @brief Slabs ever requested from the system, for monitoring.
+  size_t SlabsCreated() const noexcept;
+
+  /// @brief Slabs in the shared free list (thread caches not included).
+  size_t FreeSlabs() const noexcept;
+
+  /// @brief Slabs held from the system by all pools, including destroyed
+  /// pools whose slabs are still in use or cached, for monitoring.
+  static size_t SlabsAlive() noexcept;
+};
+
+/// @brief Ordered list of slices forming one logical message. Appending and
+/// forwarding never copies payload, IoVec() feeds writev/sendmsg directly.
+class BufferChain {
+ private:
+  std::vector<Slice> slices_;
+  size_t size_;
+
+ public:
+  BufferChain() noexcept : size_(0) {}
+
+  /// @brief Total bytes over all slices.
+  size_t Size() const noexcept {
+    return size_;
+  }
+
+  bool Empty() const noexcept {
+    return size_ == 0;
+  }
+
+  size_t SliceCount() const noexcept {
+    return slices_.size();
+  }
+
+  const std::vector<Slice>& Slices() const noexcept {
+    return slices_;
+  }
+
+  void Append(Slice slice) {
+    if (slice.Empty()) {
+      return;
+    }
+    size_ += slice.Size();
+    slices_.push_back(std::move(slice));
+  }
+
+  /// @brief Share every slice of other.
+  void Append(const BufferChain& other) {
+    slices_.reserve(slices_.size() + other.slices_.size());
+    for (const auto& slice : other.slices_) {
+      Append(slice);
+    }
+  }
+
+  void Clear() noexcept {
+    slices_.clear();
+    size_ = 0;
+  }
+
+  /// @brief Drop n bytes from the front, e.g. after a partial write.
+  void Consume(size_t n);
+
+  /// @brief Copy into one contiguous vector.
+  std::vector<uint8_t> Flatten() const;
+
+#ifdef NVM_MEMORY_HAS_IOVEC
+  /// @brief Describe the chain as iovec entries, replaces out.
+  void IoVec(std::vector<iovec>& out) const;
+
+  /// @brief writev the whole chain, retrying partial writes. Written bytes
+  /// are consumed from the chain.
+  /// @return bytes written or -errno
+  int64_t WriteTo(int fd);
+#endif
+};
+
+/// @brief Append-only writer that fills pooled slabs and collects them into
+/// a BufferChain. Encoders reserve a contiguous span, write straight into the
+/// slab, then commit.
+class ChainWriter {
+ private:
+  BufferPool& pool_;
+  BufferChain chain_;
+  PooledBuffer current_;
+
+  void Seal();
+
+ public:
+  explicit ChainWriter(BufferPool& pool) : pool_(pool) {}
+
+  /// @brief Bytes written so far.
+  size_t Size() const noexcept {
+    return chain_.Size() + current_.Size();
+  }
+
+  /// @brief Contiguous space for n bytes, starts a new slab when the current
+  /// one is too full.
+  /// @return empty span when n is larger than a slab
+  Span<uint8_t> Reserve(size_t n);
+
+  /// @brief Mark n bytes of the last Reserve() as written.
+  void Commit(size_t n) noexcept {
+    current_.Resize(current_.Size() + n);
+  }
+
+  /// @brief Copy bytes, spanning slabs as needed.
+  ChainWriter& Write(const uint8_t* data, size_t size);
+
+  ChainWriter& Write(const Span<const uint8_t>& data) {
+    return Write(data.Data(), data.Size());
+  }
+
+  /// @brief Share an existing slice without copying.
+  ChainWriter& Append(Slice slice);
+
+  /// @brief Hand over the chain, the writer starts empty again.
+  BufferChain Finish();
+};
+
+}  // namespace memory
+}  // namespace nvm
+
+#endif  // NVM_CORE_MEMORY_V2_BUFFER_POOL_H
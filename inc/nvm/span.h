@@ -70,6 +70,24 @@ class Span {
   constexpr Span(const std::vector<T, Alloc>& vec) noexcept
                   : data_(vec.data()), size_(vec.size()) {}
 
+  // Read-only view over std::vector of the non-const element type
+  template <typename Alloc, typename U = T,
+            typename = std::enable_if_t<std::is_const<U>::value>>
+  constexpr Span(const std::vector<value_type, Alloc>& vec) noexcept
+                  : data_(vec.data()), size_(vec.size()) {}
+
+  // Span<T> to Span<const T>
+  template <typename U,
+            typename = std::enable_if_t<
+                std::is_convertible<U (*)[], T (*)[]>::value &&
+                !std::is_same<U, T>::value>>
+  constexpr Span(const Span<U>& other) noexcept
+                  : data_(other.Data()), size_(other.Size()) {}
+
+  // Copy semantics, a span is only a view so copying is cheap
+  constexpr Span(const Span& other) noexcept = default;
+  constexpr Span& operator=(const Span& other) noexcept = default;
+
   // Move semantics
   constexpr Span(Span&& other) noexcept
                   : data_(other.data_), size_(other.size_) {
@@ -0,0 +1,406 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "nvm/span.h"
+#include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/parameter_buffer.h"
+#include "nvm/sqlbuilder/pg_binary_parameters.h"
+
+namespace nvm::sqlbuilder {
+
+enum class CopyFormat { Text = 1, Binary = 2 };
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(CopyFormat)
+
+/// @brief One multi-row INSERT of a RecordBatchInsert. Full chunks share the
+/// same sql text, values points into the batch.
+template <typename TParameterType = DefaultPostgresParamType>
+struct BatchInsertStatement {
+  std::shared_ptr<const std::string> sql;
+  Span<const TParameterType> values;
+  size_t first_row;
+  size_t row_count;
+};
+
+/// @brief Batch INSERT for PostgreSQL over a fixed column list. Rows are
+/// kept row-major in one vector and leave either as multi-row INSERT
+/// statements, chunked so no statement binds more than max_parameters
+/// values, or as a COPY ... FROM STDIN stream in text or binary format.
+/// @example
+/// ```cxx
+/// RecordBatchInsert<> batch("readings", {"sensor_id", "at", "value"});
+/// for (const auto& r : readings) {
+///   batch.AddRow(r.sensor_id, r.at, r.value);
+/// }
+/// std::string data;
+/// batch.WriteCopy(data, CopyFormat::Binary);
+/// // PQexec(conn, batch.CopySql(CopyFormat::Binary).c_str()), then
+/// // PQputCopyData(conn, data.data(), data.size()) and PQputCopyEnd
+/// ```
+template <typename TParameterType = DefaultPostgresParamType>
+class RecordBatchInsert {
+ public:
+  using Statement = BatchInsertStatement<TParameterType>;
+
+  /// @brief Bind parameters PostgreSQL accepts in one statement.
+  static constexpr size_t kMaxParameters = 65535;
+
+ private:
+  std::string table_name_;
+  std::vector<std::string> columns_;
+  std::vector<std::string> returning_;
+  std::vector<TParameterType> values_;
+  size_t rows_per_statement_;
+
+  /// A single std::vector<TParameterType> goes to the row overload.
+  template <typename... T>
+  struct IsRowVector : std::false_type {};
+
+  template <typename T>
+  struct IsRowVector<T>
+      : std::is_same<std::decay_t<T>, std::vector<TParameterType>> {};
+
+ public:
+  /// @throw std::invalid_argument when columns is empty or one row needs
+  /// more than max_parameters values
+  RecordBatchInsert(std::string table_name, std::vector<std::string> columns,
+                    size_t max_parameters = kMaxParameters)
+                  : table_name_(std::move(table_name)),
+                    columns_(std::move(columns)),
+                    returning_(),
+                    values_(),
+                    rows_per_statement_(0) {
+    if (columns_.empty()) {
+      throw std::invalid_argument("RecordBatchInsert: no columns");
+    }
+    if (max_parameters > kMaxParameters) {
+      max_parameters = kMaxParameters;
+    }
+    if (columns_.size() > max_parameters) {
+      throw std::invalid_argument(
+          "RecordBatchInsert: one row exceeds the parameter limit");
+    }
+    rows_per_statement_ = max_parameters / columns_.size();
+  }
+
+  void Reserve(size_t rows) {
+    values_.reserve(rows * columns_.size());
+  }
+
+  /// @brief Append one row, one value per column in column order. A view
+  /// parameter type rejects temporary strings and vectors at compile time.
+  /// @throw std::invalid_argument when the value count does not match
+  template <typename... T>
+  auto AddRow(T&&... values) -> std::enable_if_t<
+      !IsRowVector<T...>::value, RecordBatchInsert<TParameterType>&> {
+    static_assert(
+        ((std::is_lvalue_reference<T>::value ||
+          !details::binds_as_view_v<TParameterType, std::decay_t<T>>) &&
+         ...),
+        "a temporary string or vector would dangle in a view parameter type, "
+        "bind an lvalue that outlives the values");
+    if (sizeof...(T) != columns_.size()) {
+      throw std::invalid_argument(
+          "RecordBatchInsert: row does not match the column list");
+    }
+    (values_.emplace_back(std::forward<T>(values)), ...);
+    return *this;
+  }
+
+  /// @throw std::invalid_argument when the value count does not match
+  RecordBatchInsert<TParameterType>& AddRow(
+      const std::vector<TParameterType>& row) {
+    if (row.size() != columns_.size()) {
+      throw std::invalid_argument(
+          "RecordBatchInsert: row does not match the column list");
+    }
+    values_.insert(values_.end(), row.begin(), row.end());
+    return *this;
+  }
+
+  RecordBatchInsert<TParameterType>& AddReturning(
+      const std::string& column_name) {
+    returning_.push_back(column_name);
+    return *this;
+  }
+
+  /// @brief Drop the rows, keep the columns and the capacity.
+  void Clear() noexcept {
+    values_.clear();
+  }
+
+  size_t RowCount() const noexcept {
+    return values_.size() / columns_.size();
+  }
+
+  size_t ColumnCount() const noexcept {
+    return columns_.size();
+  }
+
+  size_t RowsPerStatement() const noexcept {
+    return rows_per_statement_;
+  }
+
+  size_t StatementCount() const noexcept {
+    return (RowCount() + rows_per_statement_ - 1) / rows_per_statement_;
+  }
+
+  /// @brief All values, row-major.
+  const std::vector<TParameterType>& Values() const noexcept {
+    return values_;
+  }
+
+  /// @brief INSERT INTO t (a, b) VALUES ($1, $2), ($3, $4) ... for
+  /// row_count rows.
+  std::string StatementSql(size_t row_count) const {
+    return RenderSql([&](SqlWriter& out) {
+      out.Append("INSERT INTO ").Append(table_name_).Append(" (");
+      AppendColumns(out);
+      out.Append(") VALUES ");
+      uint32_t index = 1;
+      for (size_t row = 0; row < row_count; ++row) {
+        out.Append(row == 0 ? "(" : ", (");
+        for (size_t column = 0; column < columns_.size(); ++column) {
+          if (column > 0) {
+            out.Append(", ");
+          }
+          out.AppendParameter(DatabaseDialect::PostgreSQL, index++);
+        }
+        out.Append(')');
+      }
+      if (!returning_.empty()) {
+        out.Append(" RETURNING ");
+        for (size_t i = 0; i < returning_.size(); ++i) {
+          if (i > 0) {
+            out.Append(", ");
+          }
+          out.Append(returning_[i]);
+        }
+      }
+    });
+  }
+
+  /// @brief The rows as INSERT statements in order. Only the full chunk
+  /// and the tail are rendered, every full chunk shares one text.
+  std::vector<Statement> Statements() const {
+    std::vector<Statement> statements;
+    size_t rows = RowCount();
+    statements.reserve(StatementCount());
+
+    std::shared_ptr<const std::string> full;
+    for (size_t first = 0; first < rows; first += rows_per_statement_) {
+      size_t count = rows - first < rows_per_statement_ ? rows - first
+                                                        : rows_per_statement_;
+      std::shared_ptr<const std::string> sql;
+      if (count == rows_per_statement_) {
+        if (!full) {
+          full = std::make_shared<const std::string>(StatementSql(count));
+        }
+        sql = full;
+      } else {
+        sql = std::make_shared<const std::string>(StatementSql(count));
+      }
+      statements.push_back(Statement{
+          std::move(sql),
+          Span<const TParameterType>(values_.data() + first * columns_.size(),
+                                     count * columns_.size()),
+          first, count});
+    }
+    return statements;
+  }
+
+  /// @brief COPY t (a, b) FROM STDIN, with the binary option for
+  /// CopyFormat::Binary.
+  std::string CopySql(CopyFormat format) const {
+    return RenderSql([&](SqlWriter& out) {
+      out.Append("COPY ").Append(table_name_).Append(" (");
+      AppendColumns(out);
+      out.Append(") FROM STDIN");
+      if (format == CopyFormat::Binary) {
+        out.Append(" WITH (FORMAT binary)");
+      }
+    });
+  }
+
+  /// @brief Append every row as COPY data: header, rows and trailer for the
+  /// binary format.
+  /// @throw std::invalid_argument for a value type without an encoding
+  void WriteCopy(std::string& out, CopyFormat format) const {
+    if (format == CopyFormat::Binary) {
+      WriteCopyBinaryHeader(out);
+      WriteCopyRows(out, format, 0, RowCount());
+      WriteCopyBinaryTrailer(out);
+    } else {
+      WriteCopyRows(out, format, 0, RowCount());
+    }
+  }
+
+  /// @brief Append rows [first_row, first_row + row_count) only, to stream a
+  /// large batch in pieces. The binary stream still needs one header before
+  /// the first and one trailer after the last piece.
+  void WriteCopyRows(std::string& out, CopyFormat format, size_t first_row,
+                     size_t row_count) const {
+    size_t rows = RowCount();
+    if (first_row > rows) {
+      first_row = rows;
+    }
+    if (row_count > rows - first_row) {
+      row_count = rows - first_row;
+    }
+    const TParameterType* begin = values_.data() + first_row * columns_.size();
+    const TParameterType* end = begin + row_count * columns_.size();
+    if (format == CopyFormat::Binary) {
+      WriteBinaryRows(out, begin, end);
+    } else {
+      WriteTextRows(out, begin, end);
+    }
+  }
+
+  /// @brief PGCOPY signature, flags and an empty header extension.
+  static void WriteCopyBinaryHeader(std::string& out) {
+    static constexpr char kSignature[] = "PGCOPY\n\377\r\n";
+    // the signature ends with a NUL, followed by flags and extension length
+    out.append(kSignature, sizeof(kSignature));
+    out.append(8, '\0');
+  }
+
+  static void WriteCopyBinaryTrailer(std::string& out) {
+    out.append(2, '\xff');
+  }
+
+ private:
+  void AppendColumns(SqlWriter& out) const {
+    for (size_t i = 0; i < columns_.size(); ++i) {
+      if (i > 0) {
+        out.Append(", ");
+      }
+      out.Append(columns_[i]);
+    }
+  }
+
+  void WriteTextRows(std::string& out, const TParameterType* begin,
+                     const TParameterType* end) const {
+    std::string scratch;
+    size_t column = 0;
+    for (const TParameterType* value = begin; value != end; ++value) {
+      std::visit(
+          [&out, &scratch](const auto& v) { AppendCopyText(out, scratch, v); },
+          *value);
+      column += 1;
+      if (column == columns_.size()) {
+        out.push_back('\n');
+        column = 0;
+      } else {
+        out.push_back('\t');
+      }
+    }
+  }
+
+  template <typename T>
+  static void AppendCopyText(std::string& out, std::string& scratch,
+                             const T& value) {
+    constexpr ParameterKind kind = details::KindOf<T>();
+    if constexpr (std::is_same_v<T, std::monostate>) {
+      out.append("\\N");
+    } else if constexpr (kind == ParameterKind::kNull) {
+      throw std::invalid_argument(
+          "RecordBatchInsert: unsupported parameter type");
+    } else if constexpr (kind == ParameterKind::kText ||
+                         kind == ParameterKind::kBytes) {
+      // only these can carry backslashes or separators
+      scratch.clear();
+      details::AppendPostgresText(scratch, value);
+      for (char c : scratch) {
+        switch (c) {
+          case '\\':
+            out.append("\\\\");
+            break;
+          case '\t':
+            out.append("\\t");
+            break;
+          case '\n':
+            out.append("\\n");
+            break;
+          case '\r':
+            out.append("\\r");
+            break;
+          default:
+            out.push_back(c);
+        }
+      }
+    } else {
+      details::AppendPostgresText(out, value);
+    }
+  }
+
+  void WriteBinaryRows(std::string& out, const TParameterType* begin,
+                       const TParameterType* end) const {
+    // field count per tuple, then length and bytes of every field
+    size_t rows = static_cast<size_t>(end - begin) / columns_.size();
+    size_t total = rows * 2;
+    for (const TParameterType* value = begin; value != end; ++value) {
+      total += 4 + std::visit(
+                       [](const auto& v) {
+                         return details::PostgresBinarySize(v);
+                       },
+                       *value);
+    }
+
+    size_t offset = out.size();
+    out.resize(offset + total);
+    auto* p = reinterpret_cast<uint8_t*>(&out[offset]);
+    size_t column = 0;
+    for (const TParameterType* value = begin; value != end; ++value) {
+      if (column == 0) {
+        p = details::PutBigEndian<int16_t>(
+            static_cast<int16_t>(columns_.size()), p);
+      }
+      p = std::visit(
+          [p](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+              return details::PutBigEndian<int32_t>(-1, p);
+            } else {
+              uint8_t* field = p + 4;
+              uint8_t* field_end = details::WritePostgresBinary(v, field);
+              details::PutBigEndian<int32_t>(
+                  static_cast<int32_t>(field_end - field), p);
+              return field_end;
+            }
+          },
+          *value);
+      column = column + 1 == columns_.size() ? 0 : column + 1;
+    }
+  }
+};
+
+}  // namespace nvm::sqlbuilder
@@ -20,8 +20,11 @@
 #ifndef NVM_CORE_CONTAINERS_V2_RECORD_DEF_H
 #define NVM_CORE_CONTAINERS_V2_RECORD_DEF_H
 
+#include <nvm/bytes/hash.h>
 #include <nvm/macro.h>
+#include <nvm/span.h>
 
+#include <charconv>
 #include <chrono>
 #include <cstdint>
 #include <iomanip>
@@ -30,6 +33,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <variant>
 #include <vector>
@@ -54,9 +58,18 @@ using DefaultOracleParamType = std::variant<
     std::chrono::system_clock::time_point,  // Oracle DATE, TIMESTAMP, TIMESTAMP
                                             // WITH TIME ZONE, TIMESTAMP WITH
                                             // LOCAL TIME ZONE
-    std::vector<unsigned char>              // Oracle RAW, BLOB
+    std::vector<unsigned char>,             // Oracle RAW, BLOB
+    std::vector<int>  // Oracle collection of NUMBER, e.g. a SQL TABLE type
+                      // bound for InListMode::kArray
     >;
 
+// Same as DefaultPostgresParamType but strings and arrays are bound by
+// reference, nothing the caller owns is copied while the query is built.
+// The referenced data must outlive every use of the parameter values.
+using DefaultPostgresViewParamType =
+    std::variant<int, long long, float, double, std::string_view, bool,
+                 std::chrono::system_clock::time_point, Span<const int>>;
+
 // using DefaultPostgresParamType =
 //     std::variant<int, long long, float, double, std::string, bool,
 //                  std::chrono::system_clock::time_point, std::vector<int>,
@@ -67,9 +80,272 @@ using DefaultOracleParamType = std::variant<
 
 enum class DatabaseDialect { PostgreSQL = 1, Oracle = 2 };
 
+namespace details {
+
+/// @brief True when the variant TVariant has T as one of its alternatives,
+/// not merely something T converts to.
+template <typename TVariant, typename T>
+struct has_alternative : std::false_type {};
+
+template <typename... TAlternatives, typename T>
+struct has_alternative<std::variant<TAlternatives...>, T>
+    : std::disjunction<std::is_same<TAlternatives, T>...> {};
+
+template <typename TVariant, typename T>
+constexpr bool has_alternative_v = has_alternative<TVariant, T>::value;
+
+/// @brief True when TVariant keeps only a view of a bound T, a std::string
+/// as std::string_view or a std::vector<U> as Span<const U>. Binding a
+/// temporary T would dangle.
+template <typename TVariant, typename T>
+struct binds_as_view : std::false_type {};
+
+template <typename TVariant>
+struct binds_as_view<TVariant, std::string>
+    : std::bool_constant<!has_alternative_v<TVariant, std::string> &&
+                         has_alternative_v<TVariant, std::string_view>> {};
+
+template <typename TVariant, typename U>
+struct binds_as_view<TVariant, std::vector<U>>
+    : std::bool_constant<!has_alternative_v<TVariant, std::vector<U>> &&
+                         has_alternative_v<TVariant, Span<const U>>> {};
+
+template <typename TVariant, typename T>
+constexpr bool binds_as_view_v = binds_as_view<TVariant, T>::value;
+
+/// @brief Type a builder binds for an argument U when the caller asked for
+/// T, void meaning "as given".
+template <typename T, typename U>
+using bound_type_t =
+    std::conditional_t<std::is_void<T>::value, std::decay_t<U>, T>;
+
+/// @brief True when the bound value is a temporary: U is an rvalue, or it
+/// has to be converted to T first.
+template <typename T, typename U>
+constexpr bool binds_temporary_v =
+    !std::is_lvalue_reference<U>::value ||
+    !std::is_same<bound_type_t<T, U>, std::decay_t<U>>::value;
+
+/// @brief value as T, or as given for void. Keeps lvalue-ness when no
+/// conversion is needed.
+template <typename T, typename U>
+decltype(auto) ConvertBound(U&& value) {
+  if constexpr (std::is_same<bound_type_t<T, U>, std::decay_t<U>>::value) {
+    return std::forward<U>(value);
+  } else {
+    return T(std::forward<U>(value));
+  }
+}
+
+}  // namespace details
+
 // cppcheck-suppress unknownMacro
 NVM_ENUM_CLASS_DISPLAY_TRAIT(DatabaseDialect)
 
+/// @brief Append-only sink the statement tree renders into. A writer made
+/// with the default constructor only counts bytes, rendering the tree through
+/// it first gives the exact size so the real pass appends into a string that
+/// was reserved once. See RenderSql().
+class SqlWriter {
+ private:
+  std::string* out_;
+  size_t size_;
+
+ public:
+  /// @brief Measuring writer, nothing is stored.
+  SqlWriter() noexcept : out_(nullptr), size_(0) {}
+
+  explicit SqlWriter(std::string& out) noexcept : out_(&out), size_(0) {}
+
+  bool IsMeasuring() const noexcept {
+    return out_ == nullptr;
+  }
+
+  /// @brief Bytes appended so far.
+  size_t Size() const noexcept {
+    return size_;
+  }
+
+  SqlWriter& Append(std::string_view value) {
+    size_ += value.size();
+    if (out_) {
+      out_->append(value.data(), value.size());
+    }
+    return *this;
+  }
+
+  SqlWriter& Append(char value) {
+    size_ += 1;
+    if (out_) {
+      out_->push_back(value);
+    }
+    return *this;
+  }
+
+  SqlWriter& AppendRepeat(char value, size_t count) {
+    size_ += count;
+    if (out_) {
+      out_->append(count, value);
+    }
+    return *this;
+  }
+
+  SqlWriter& AppendUInt(uint64_t value) {
+    char buffer[20];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return Append(
+        std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+  }
+
+  SqlWriter& AppendIndentation(uint32_t level, char indent_char = ' ',
+                               uint32_t number_per_print = 2) {
+    return AppendRepeat(indent_char, size_t(number_per_print) * level);
+  }
+
+  /// @brief Placeholder of the dialect, $n for PostgreSQL and :n for Oracle.
+  SqlWriter& AppendParameter(DatabaseDialect dialect,
+                             uint32_t parameter_index) {
+    switch (dialect) {
+      case DatabaseDialect::PostgreSQL:
+        return Append('$').AppendUInt(parameter_index);
+      case DatabaseDialect::Oracle:
+        return Append(':').AppendUInt(parameter_index);
+      default:
+        return *this;
+    }
+  }
+};
+
+/// @brief Call render(SqlWriter&) twice, once measuring and once into a
+/// string reserved to the measured size.
+template <typename TRender>
+std::string RenderSql(TRender&& render) {
+  SqlWriter measure;
+  render(measure);
+
+  std::string out;
+  out.reserve(measure.Size());
+  SqlWriter writer(out);
+  render(writer);
+  return out;
+}
+
+/// @brief Structural hash of a statement tree. Every node feeds what changes
+/// its rendered text (identifiers, operators, modes, parameter positions),
+/// so two trees with the same key render the same SQL and only their
+/// parameter values differ. Strings are hashed one by one, so neighbouring
+/// identifiers cannot run into each other.
+class ShapeHasher {
+ private:
+  bytes::Hasher128 hasher_;
+  // nodes feed many small words, batch them before they reach the hasher. The
+  // counter is not uint64_t so word stores cannot alias it.
+  uint64_t words_[32];
+  uint32_t used_;
+
+  void Flush() noexcept {
+    hasher_.Update(words_, used_ * sizeof(uint64_t));
+    used_ = 0;
+  }
+
+ public:
+  ShapeHasher() noexcept : hasher_(), used_(0) {}
+
+  ShapeHasher& AddUInt(uint64_t value) noexcept {
+    if (used_ == 32) {
+      Flush();
+    }
+    words_[used_++] = value;
+    return *this;
+  }
+
+  template <typename TEnum>
+  ShapeHasher& AddEnum(TEnum value) noexcept {
+    return AddUInt(static_cast<uint64_t>(value));
+  }
+
+  /// @brief Identifiers are short, hashing each one on its own and feeding
+  /// the 64-bit result is cheaper than copying the bytes.
+  ShapeHasher& AddString(std::string_view value) noexcept {
+    if (value.empty()) {
+      return AddUInt(0);
+    }
+    return AddUInt(bytes::Hash64(value.data(), value.size(), value.size()));
+  }
+
+  /// @brief Absent and empty values hash differently.
+  ShapeHasher& AddOptional(const std::optional<std::string>& value) noexcept {
+    if (!value.has_value()) {
+      return AddUInt(1);
+    }
+    return AddString(value.value());
+  }
+
+  /// @brief Interned name, a view without data is absent, see QueryArena.
+  ShapeHasher& AddName(std::string_view value) noexcept {
+    if (value.data() == nullptr) {
+      return AddUInt(1);
+    }
+    return AddString(value);
+  }
+
+  bytes::Hash128Value Digest() const noexcept {
+    bytes::Hasher128 hasher = hasher_;
+    hasher.Update(words_, used_ * sizeof(uint64_t));
+    return hasher.Digest();
+  }
+};
+
+/// @brief Running 64-bit hash of the normalized structure of a statement:
+/// tables, fields, operators and clause modes. Unlike ShapeHasher it leaves
+/// out what only changes the text, parameter numbering, IN list sizes and
+/// formatting, so one query shape keeps one fingerprint. Builders fold each
+/// node in as it is added, see NvSelect::Fingerprint().
+class StatementFingerprint {
+ private:
+  uint64_t value_;
+
+ public:
+  constexpr StatementFingerprint() noexcept : value_(0) {}
+
+  StatementFingerprint& AddUInt(uint64_t value) noexcept {
+    value_ = bytes::Hash64(&value, sizeof(value), value_);
+    return *this;
+  }
+
+  template <typename TEnum>
+  StatementFingerprint& AddEnum(TEnum value) noexcept {
+    return AddUInt(static_cast<uint64_t>(value));
+  }
+
+  StatementFingerprint& AddString(std::string_view value) noexcept {
+    if (value.empty()) {
+      return AddUInt(0);
+    }
+    return AddUInt(bytes::Hash64(value.data(), value.size(), value.size()));
+  }
+
+  StatementFingerprint& AddOptional(
+      const std::optional<std::string>& value) noexcept {
+    if (!value.has_value()) {
+      return AddUInt(1);
+    }
+    return AddString(value.value());
+  }
+
+  /// @brief Interned name, see ShapeHasher::AddName().
+  StatementFingerprint& AddName(std::string_view value) noexcept {
+    if (value.data() == nullptr) {
+      return AddUInt(1);
+    }
+    return AddString(value);
+  }
+
+  uint64_t Value() const noexcept {
+    return value_;
+  }
+};
+
 // struct RecordTable {
 //   std::string name;
 //   std::optional<std::string> alias;
@@ -181,6 +457,23 @@ struct RecordKey {
     return table_alias.has_value() ? table + " AS " + table_alias.value()
                                    : table;
   }
+
+  void AppendField(SqlWriter& out) const {
+    out.Append(table_alias.has_value() ? table_alias.value() : table)
+        .Append('.')
+        .Append(field);
+  }
+
+  void AppendTableName(SqlWriter& out) const {
+    out.Append(table);
+    if (table_alias.has_value()) {
+      out.Append(" AS ").Append(table_alias.value());
+    }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddString(table).AddString(field).AddOptional(table_alias);
+  }
 };
 
 // Forward declaration WhereStatement
@@ -209,11 +502,14 @@ class NvSelectBasic {
 
   virtual void UpdateCurrentParamIndex(uint32_t current_param_index) = 0;
 
-  virtual std::string TableAlias() const = 0;
+  virtual std::string_view TableAlias() const = 0;
 
   virtual uint32_t GetBlockLevel() const = 0;
 
   virtual std::string GenerateQuery(bool pretty_print = false) const = 0;
+
+  /// @brief Render the statement into out, see RenderSql().
+  virtual void AppendQuery(SqlWriter& out, bool pretty_print = false) const = 0;
 };
 
 // Forward declaration for NvSelect
@@ -222,22 +518,13 @@ class NvSelect;
 
 inline std::string DetermineParameterFormat(const DatabaseDialect& dialect,
                                             const uint32_t parameter_index) {
-  std::ostringstream ss;
-  switch (dialect) {
-    case DatabaseDialect::PostgreSQL:
-      ss << "$" << parameter_index;
-      break;
-    case DatabaseDialect::Oracle:
-      ss << ":" << parameter_index;
-      break;
-    default:
-      break;
-  }
-
-  return ss.str();
+  std::string out;
+  SqlWriter writer(out);
+  writer.AppendParameter(dialect, parameter_index);
+  return out;
 }
 
-inline std::string SqlOperatorToString(SqlOperator op) {
+constexpr std::string_view SqlOperatorSymbol(SqlOperator op) {
   switch (op) {
     case SqlOperator::kEqual:
       return "=";
@@ -262,6 +549,29 @@ inline std::string SqlOperatorToString(SqlOperator op) {
   }
 }
 
+inline std::string SqlOperatorToString(SqlOperator op) {
+  return std::string(SqlOperatorSymbol(op));
+}
+
+constexpr std::string_view AggregateFunctionKeyword(SqlAggregateFunction fn) {
+  switch (fn) {
+    case SqlAggregateFunction::Distinct:
+      return "DISTINCT";
+    case SqlAggregateFunction::Count:
+      return "COUNT";
+    case SqlAggregateFunction::Avg:
+      return "AVG";
+    case SqlAggregateFunction::Sum:
+      return "SUM";
+    case SqlAggregateFunction::ToUpper:
+      return "TO_UPPER";
+    case SqlAggregateFunction::ToLower:
+      return "TO_LOWER";
+    default:
+      return "";
+  }
+}
+
 inline std::string LogicOperatorToString(LogicOperator logic) {
   switch (logic) {
     case LogicOperator::kAnd:
@@ -275,14 +585,7 @@ inline std::string LogicOperatorToString(LogicOperator logic) {
 
 inline std::string GenerateIndentation(uint32_t level, char indent_char = ' ',
                                        uint32_t number_per_print = 2) {
-  if (level == 0)
-    return std::string();
-  int32_t n = number_per_print * level;
-  std::ostringstream oss;
-  for (int i = 0; i < n; ++i) {
-    oss << indent_char;
-  }
-  return oss.str();
+  return std::string(size_t(number_per_print) * level, indent_char);
 }
 
 template <typename TParameterType = DefaultPostgresParamType>
@@ -326,8 +629,13 @@ class ParameterParser {
     if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point>) {
       std::time_t time = std::chrono::system_clock::to_time_t(value);
       oss << std::put_time(std::localtime(&time), "%F %T");
+    } else if constexpr (std::is_same_v<T, std::monostate>) {
+      oss << "NULL";
     } else if constexpr (is_vector<T>::value) {
       AppendVector(oss, value);
+    } else if constexpr (is_span<T>::value) {
+      AppendVector(oss, std::vector<typename T::value_type>(
+                            value.Begin(), value.End()));
     } else {
       oss << value;
     }
@@ -373,6 +681,12 @@ class ParameterParser {
 
   template <typename T>
   struct is_vector<std::vector<T>> : std::true_type {};
+
+  template <typename T>
+  struct is_span : std::false_type {};
+
+  template <typename T>
+  struct is_span<Span<T>> : std::true_type {};
 };
 
 // Example of a derived class
@@ -383,10 +697,9 @@ class PostgresDefaultParameterParser : public ParameterParser<TParameterType> {
 
  protected:
   std::shared_ptr<void> ParseImplInternal() const override {
-    // Implement the actual parsing logic here
-    // For simplicity, returning the same parameter values cast to void
-    return std::make_shared<std::vector<TParameterType>>(
-        *this->parameter_values_);
+    // the values already are in the destination type, share them instead
+    // of copying the whole list. Use ParameterBuffer for a flat copy.
+    return this->parameter_values_;
   }
 };
 
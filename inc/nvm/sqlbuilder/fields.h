@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/query_arena.h"
 namespace nvm::sqlbuilder {
 enum class FieldDefMode {
   FieldRaw = 0,
@@ -15,16 +16,18 @@ NVM_ENUM_CLASS_DISPLAY_TRAIT(FieldDefMode)
 template <typename TParameterType = DefaultPostgresParamType>
 class FieldDef {
  private:
-  std::string field_;
-  std::optional<std::string> table_alias_;
-  const std::vector<std::string> static_param_values_;
+  // names are interned in the QueryArena of the select
+  std::string_view field_;
+  std::string_view table_alias_;
+  ArenaVector<std::string_view> static_param_values_;
   std::shared_ptr<std::vector<TParameterType>> parameter_values_;
-  const std::vector<TParameterType> fn_values_;
-  std::string function_name_;
-  std::string parameter_format_;
+  std::string_view function_name_;
+  std::string_view parameter_format_;
   bool enclose_field_name_;
   SqlAggregateFunction aggregate_fn_;
-  std::optional<std::string> field_alias_;
+  std::string_view field_alias_;
+  // the values themselves go to parameter_values_ right away
+  uint32_t fn_value_count_;
   uint32_t start_parameter_index_;
   uint32_t current_parameter_index_;
   uint32_t level_;
@@ -32,9 +35,8 @@ class FieldDef {
   DatabaseDialect dialect_;
 
   uint32_t ProcessFunctionParameterIndex(
-      const int32_t& current_param_index, const std::string& parameter_format,
-      const std::vector<TParameterType>& parameter_values,
-      const std::vector<std::string>& static_param_values) {
+      const int32_t& current_param_index, std::string_view parameter_format,
+      const std::vector<TParameterType>& parameter_values) {
     if (parameter_format.empty()) {
       return current_param_index;
     }
@@ -45,7 +47,7 @@ class FieldDef {
 
     for (char ch : parameter_format) {
       if (index_params < size_params && ch == 'v') {
-        parameter_values_->push_back(fn_values_.at(index_params));
+        parameter_values_->push_back(parameter_values[index_params]);
         param_index += 1;
         index_params += 1;
       }
@@ -54,88 +56,82 @@ class FieldDef {
     return param_index;
   }
 
-  std::string BuildField() const {
-    std::ostringstream oss;
-
+  void AppendField(SqlWriter& out) const {
     // Translate to sql keyword
     if (aggregate_fn_ == SqlAggregateFunction::Distinct) {
-      oss << AggregateFunctionToString(aggregate_fn_) << " ";
+      out.Append(AggregateFunctionKeyword(aggregate_fn_)).Append(' ');
     } else if (aggregate_fn_ != SqlAggregateFunction::None) {
-      oss << AggregateFunctionToString(aggregate_fn_) << "(";
+      out.Append(AggregateFunctionKeyword(aggregate_fn_)).Append('(');
     }
 
     // append alias if any
-    if (table_alias_.has_value()) {
-      oss << table_alias_.value() << ".";
+    if (HasName(table_alias_)) {
+      out.Append(table_alias_).Append('.');
     }
 
-    oss << field_;
+    out.Append(field_);
 
     // determine the function closure
-    if (aggregate_fn_ == SqlAggregateFunction::Distinct) {
-      oss << "";
-    } else if (aggregate_fn_ != SqlAggregateFunction::None) {
-      oss << ")";
+    if (aggregate_fn_ != SqlAggregateFunction::Distinct &&
+        aggregate_fn_ != SqlAggregateFunction::None) {
+      out.Append(')');
     }
 
     // append new name alias if any
-    if (field_alias_.has_value()) {
-      oss << " AS " << field_alias_.value();
-    }
-
-    return oss.str();
+    AppendFieldAlias(out);
   }
 
-  std::string BuildFunctionWithDynamicParameters() const {
+  void AppendFunctionWithDynamicParameters(SqlWriter& out) const {
     uint32_t param_index = start_parameter_index_;
     size_t index_params = 0;
     size_t index_statics = 0;
-    size_t size_params = fn_values_.size();
+    size_t size_params = fn_value_count_;
     size_t size_statics = static_param_values_.size();
     bool is_first_element = true;
-    std::ostringstream fn_call;
 
-    fn_call << function_name_ << "(";
+    out.Append(function_name_).Append('(');
     for (char ch : parameter_format_) {
       if ((index_statics < size_statics || index_params < size_params) &&
-          (ch == 's' || ch == 'v')) {
-        fn_call << (is_first_element ? "" : ", ");
+          (ch == 's' || ch == 'v') && !is_first_element) {
+        out.Append(", ");
       }
 
       if (ch == 's' && index_statics < size_statics) {
-        fn_call << static_param_values_[index_statics];
+        out.Append(static_param_values_[index_statics]);
         index_statics += 1;
         is_first_element = false;
       } else if (ch == 'v' && index_params < size_params) {
-        fn_call << DetermineParameterFormat(dialect_, param_index);
+        out.AppendParameter(dialect_, param_index);
         param_index += 1;
         index_params += 1;
         is_first_element = false;
       }
     }
 
-    fn_call << ")"
-            << (field_alias_.has_value() ? " AS " + field_alias_.value() : "");
-
-    return fn_call.str();
+    out.Append(')');
+    AppendFieldAlias(out);
   }
 
-  std::string BuildFunctionWithStaticParameters() const {
-    std::ostringstream fn_call;
-    fn_call << function_name_ << "(";
+  void AppendFunctionWithStaticParameters(SqlWriter& out) const {
+    out.Append(function_name_).Append('(');
     for (size_t i = 0; i < static_param_values_.size(); ++i) {
       if (i > 0)
-        fn_call << ", ";
-      fn_call << static_param_values_[i];
+        out.Append(", ");
+      out.Append(static_param_values_[i]);
     }
-    fn_call << ")"
-            << (field_alias_.has_value() ? " AS " + field_alias_.value() : "");
+    out.Append(')');
+    AppendFieldAlias(out);
+  }
 
-    return fn_call.str();
+  void AppendFieldAlias(SqlWriter& out) const {
+    if (HasName(field_alias_)) {
+      out.Append(" AS ").Append(field_alias_);
+    }
   }
 
  public:
   /// @brief Normal Field defintion
+  /// @param arena
   /// @param field
   /// @param table_alias
   /// @param enclose_field_name
@@ -144,22 +140,22 @@ class FieldDef {
   /// @param level
   /// @param mode
   explicit FieldDef(
-      DatabaseDialect dialect, const std::string& field,
-      const std::optional<std::string>& table_alias = std::nullopt,
+      QueryArena& arena, DatabaseDialect dialect, std::string_view field,
+      const std::optional<std::string_view>& table_alias = std::nullopt,
       bool enclose_field_name = false,
       SqlAggregateFunction aggregate_fn = SqlAggregateFunction::None,
-      const std::optional<std::string>& field_alias = std::nullopt,
+      const std::optional<std::string_view>& field_alias = std::nullopt,
       uint32_t level = 0, FieldDefMode mode = FieldDefMode::FieldWType)
-                  : field_(field),
-                    table_alias_(table_alias),
-                    static_param_values_(),
+                  : field_(arena.Name(field)),
+                    table_alias_(arena.OptionalName(table_alias)),
+                    static_param_values_(arena.Vector<std::string_view>()),
                     parameter_values_(nullptr),
-                    fn_values_(),
                     function_name_(),
                     parameter_format_(),
                     enclose_field_name_(enclose_field_name),
                     aggregate_fn_(aggregate_fn),
-                    field_alias_(field_alias),
+                    field_alias_(arena.OptionalName(field_alias)),
+                    fn_value_count_(0),
                     start_parameter_index_(),
                     current_parameter_index_(),
                     level_(level),
@@ -167,24 +163,26 @@ class FieldDef {
                     dialect_(dialect) {}
 
   /// @brief Function call static definitions
+  /// @param arena
   /// @param function_name
   /// @param static_param_values
   /// @param level
   /// @param alias
-  explicit FieldDef(DatabaseDialect dialect, const std::string& function_name,
-                    const std::vector<std::string>& static_param_values,
-                    uint32_t level,
-                    const std::optional<std::string>& alias = std::nullopt)
+  explicit FieldDef(
+      QueryArena& arena, DatabaseDialect dialect,
+      std::string_view function_name,
+      const std::vector<std::string>& static_param_values, uint32_t level,
+      const std::optional<std::string_view>& alias = std::nullopt)
                   : field_(),
                     table_alias_(),
-                    static_param_values_(static_param_values),
+                    static_param_values_(arena.Names(static_param_values)),
                     parameter_values_(nullptr),
-                    fn_values_(),
-                    function_name_(function_name),
+                    function_name_(arena.Name(function_name)),
                     parameter_format_(),
                     enclose_field_name_(),
                     aggregate_fn_(SqlAggregateFunction::None),
-                    field_alias_(alias),
+                    field_alias_(arena.OptionalName(alias)),
+                    fn_value_count_(0),
                     start_parameter_index_(),
                     current_parameter_index_(),
                     level_(level),
@@ -192,6 +190,7 @@ class FieldDef {
                     dialect_(dialect) {}
 
   /// @brief Function call for parameterized parameters definitions
+  /// @param arena
   /// @param function_name
   /// @param parameter_format
   /// @param parameter_values
@@ -200,26 +199,27 @@ class FieldDef {
   /// @param level
   /// @param alias
   explicit FieldDef(
-      DatabaseDialect dialect, const std::string& function_name,
-      const std::string& parameter_format,
+      QueryArena& arena, DatabaseDialect dialect,
+      std::string_view function_name, std::string_view parameter_format,
       std::shared_ptr<std::vector<TParameterType>> parameter_values,
       const std::vector<TParameterType>& fn_param_values,
       const std::vector<std::string>& static_param_values, uint32_t param_index,
-      uint32_t level, const std::optional<std::string>& alias = std::nullopt)
+      uint32_t level,
+      const std::optional<std::string_view>& alias = std::nullopt)
                   : field_(),
                     table_alias_(),
-                    static_param_values_(static_param_values),
+                    static_param_values_(arena.Names(static_param_values)),
                     parameter_values_(parameter_values),
-                    fn_values_(fn_param_values),
-                    function_name_(function_name),
-                    parameter_format_(parameter_format),
+                    function_name_(arena.Name(function_name)),
+                    parameter_format_(arena.Name(parameter_format)),
                     enclose_field_name_(),
                     aggregate_fn_(SqlAggregateFunction::None),
-                    field_alias_(alias),
+                    field_alias_(arena.OptionalName(alias)),
+                    fn_value_count_(
+                        static_cast<uint32_t>(fn_param_values.size())),
                     start_parameter_index_(param_index),
                     current_parameter_index_(ProcessFunctionParameterIndex(
-                        param_index, parameter_format, fn_values_,
-                        static_param_values_)),
+                        param_index, parameter_format, fn_param_values)),
                     level_(level),
                     mode_(FieldDefMode::FnParameterizedValues),
                     dialect_(dialect) {}
@@ -232,16 +232,16 @@ class FieldDef {
     return current_parameter_index_;
   }
 
-  std::string Field() const {
+  std::string_view Field() const {
     return field_;
   }
 
-  std::optional<std::string> TableAlias() const {
-    return table_alias_;
+  std::optional<std::string_view> TableAlias() const {
+    return AsOptional(table_alias_);
   }
 
-  std::optional<std::string> FieldAlias() const {
-    return field_alias_;
+  std::optional<std::string_view> FieldAlias() const {
+    return AsOptional(field_alias_);
   }
 
   bool EncloseFieldName() const {
@@ -252,11 +252,11 @@ class FieldDef {
     return aggregate_fn_;
   }
 
-  std::string FunctionName() const {
+  std::string_view FunctionName() const {
     return function_name_;
   }
 
-  const std::vector<std::string>& StaticParameterValues() {
+  const ArenaVector<std::string_view>& StaticParameterValues() const {
     return static_param_values_;
   }
 
@@ -265,37 +265,66 @@ class FieldDef {
   }
 
   std::string GenerateQuery() const {
+    return RenderSql([&](SqlWriter& out) { AppendQuery(out); });
+  }
+
+  void AppendQuery(SqlWriter& out) const {
     switch (mode_) {
       case FieldDefMode::FieldRaw:
-        return BuildField();
       case FieldDefMode::FieldWType:
-        return BuildField();
+        AppendField(out);
+        break;
       case FieldDefMode::FnStaticParameter:
-        return BuildFunctionWithStaticParameters();
+        AppendFunctionWithStaticParameters(out);
+        break;
       case FieldDefMode::FnParameterizedValues:
-        return BuildFunctionWithDynamicParameters();
+        AppendFunctionWithDynamicParameters(out);
+        break;
       default:
-        return std::string();
+        break;
     }
   }
 
-  std::string AggregateFunctionToString(SqlAggregateFunction fn) const {
-    switch (fn) {
-      case SqlAggregateFunction::Distinct:
-        return "DISTINCT";
-      case SqlAggregateFunction::Count:
-        return "COUNT";
-      case SqlAggregateFunction::Avg:
-        return "AVG";
-      case SqlAggregateFunction::Sum:
-        return "SUM";
-      case SqlAggregateFunction::ToUpper:
-        return "TO_UPPER";
-      case SqlAggregateFunction::ToLower:
-        return "TO_LOWER";
-      default:
-        return "";
+  void HashShape(ShapeHasher& hasher) const {
+    hasher
+        .AddUInt(static_cast<uint64_t>(mode_) |
+                 static_cast<uint64_t>(aggregate_fn_) << 8 |
+                 static_cast<uint64_t>(start_parameter_index_) << 32)
+        .AddString(field_)
+        .AddName(table_alias_)
+        .AddName(field_alias_);
+    if (mode_ == FieldDefMode::FnStaticParameter ||
+        mode_ == FieldDefMode::FnParameterizedValues) {
+      hasher.AddString(function_name_)
+          .AddString(parameter_format_)
+          .AddUInt(static_cast<uint64_t>(fn_value_count_) << 32 |
+                   static_param_values_.size());
+      for (const auto& value : static_param_values_) {
+        hasher.AddString(value);
+      }
+    }
+  }
+
+  void Fingerprint(StatementFingerprint& fingerprint) const {
+    fingerprint
+        .AddUInt(static_cast<uint64_t>(mode_) |
+                 static_cast<uint64_t>(aggregate_fn_) << 8)
+        .AddString(field_)
+        .AddName(table_alias_)
+        .AddName(field_alias_);
+    if (mode_ == FieldDefMode::FnStaticParameter ||
+        mode_ == FieldDefMode::FnParameterizedValues) {
+      fingerprint.AddString(function_name_)
+          .AddString(parameter_format_)
+          .AddUInt(static_param_values_.size());
+      for (const auto& value : static_param_values_) {
+        fingerprint.AddString(value);
+      }
     }
   }
+
+  std::string AggregateFunctionToString(SqlAggregateFunction fn) const {
+    return std::string(AggregateFunctionKeyword(fn));
+  }
 };
 }  // namespace nvm::sqlbuilder
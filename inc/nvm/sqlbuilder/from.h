@@ -1,6 +1,7 @@
 #pragma once
 
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/query_arena.h"
 
 namespace nvm::sqlbuilder {
 struct FromTable {
@@ -17,44 +18,67 @@ struct FromTable {
     return table_alias.has_value() ? table + " AS " + table_alias.value()
                                    : table;
   }
+
+  void AppendTableName(SqlWriter& out) const {
+    out.Append(table);
+    if (table_alias.has_value()) {
+      out.Append(" AS ").Append(table_alias.value());
+    }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddString(table).AddOptional(table_alias);
+  }
 };
 
 template <typename TParameterType = DefaultPostgresParamType>
 class FromTableStatement {
  private:
+  std::shared_ptr<QueryArena> arena_;
   NvSelect<TParameterType>* parent_;
-  std::vector<FromTable> tables_;
-  std::vector<NvSelect<TParameterType>> subqueries_;
+  // FROM tables, field is empty
+  ArenaVector<NameKey> tables_;
+  ArenaVector<NvSelect<TParameterType>> subqueries_;
   std::shared_ptr<std::vector<TParameterType>> parameter_values_;
   uint32_t level_;
   uint32_t current_parameter_index_;
   DatabaseDialect dialect_;
+  // tables only, subqueries are folded in by Fingerprint()
+  StatementFingerprint fingerprint_;
 
-  std::string __GetTableAliasFromParent(
+  std::string_view __GetTableAliasFromParent(
       const NvSelect<TParameterType>& select) const;
 
   uint32_t __GetCurrentParameterIndexFromParent(
       const NvSelect<TParameterType>& select) const;
 
-  void __CreateNewSelectBlock(std::vector<NvSelect<TParameterType>>& selects,
+  void __CreateNewSelectBlock(ArenaVector<NvSelect<TParameterType>>& selects,
                               uint32_t index, uint32_t level,
-                              const std::string& table_alias);
+                              std::string_view table_alias);
 
-  std::string __GenerateSelectQuery(const NvSelect<TParameterType>& selects,
-                                    bool pretty_print) const;
+  void __AppendSelectQuery(const NvSelect<TParameterType>& select,
+                           SqlWriter& out, bool pretty_print) const;
+
+  void __HashSelectShape(const NvSelect<TParameterType>& select,
+                         ShapeHasher& hasher) const;
+
+  uint64_t __SelectFingerprint(const NvSelect<TParameterType>& select) const;
 
  public:
   explicit FromTableStatement(
+      std::shared_ptr<QueryArena> arena,
       std::shared_ptr<std::vector<TParameterType>> values,
       NvSelect<TParameterType>* parent, uint32_t parameter_index,
       uint32_t level, DatabaseDialect dialect)
-                  : parent_(parent),
-                    tables_(),
+                  : arena_(std::move(arena)),
+                    parent_(parent),
+                    tables_(arena_->Vector<NameKey>()),
+                    subqueries_(arena_->Vector<NvSelect<TParameterType>>()),
                     parameter_values_(values),
-                    subqueries_(),
                     level_(uint32_t(level)),
                     current_parameter_index_(parameter_index),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fingerprint_() {}
 
   ~FromTableStatement() {}
 
@@ -62,7 +86,9 @@ class FromTableStatement {
   /// @param table
   /// @return
   FromTableStatement& AddTable(FromTable&& table) {
-    tables_.emplace_back(std::forward<FromTable>(table));
+    tables_.emplace_back(*arena_, table.table, std::string_view(),
+                         table.table_alias);
+    tables_.back().Fingerprint(fingerprint_);
     return *this;
   }
 
@@ -71,9 +97,11 @@ class FromTableStatement {
   /// @param table_alias
   /// @return
   FromTableStatement& AddTable(
-      const std::string& table_name,
-      const std::optional<std::string>& table_alias = std::nullopt) {
-    tables_.emplace_back(table_name, table_alias);
+      std::string_view table_name,
+      const std::optional<std::string_view>& table_alias = std::nullopt) {
+    tables_.emplace_back(*arena_, table_name, std::string_view(),
+                         table_alias);
+    tables_.back().Fingerprint(fingerprint_);
     return *this;
   }
 
@@ -88,11 +116,12 @@ class FromTableStatement {
   /// @brief Construct SUBQUERY inside FROM Statement block
   /// @param table_alias
   /// @return
-  NvSelect<TParameterType>& BeginSubquery(const std::string& table_alias);
+  NvSelect<TParameterType>& BeginSubquery(std::string_view table_alias);
 
   NvSelect<TParameterType>& Reset() {
     subqueries_.clear();
     tables_.clear();
+    fingerprint_ = StatementFingerprint();
     current_parameter_index_ = 0;
     return parent_;
   }
@@ -114,30 +143,62 @@ class FromTableStatement {
   }
 
   std::string GenerateQuery(bool pretty_print = false) const {
-    std::ostringstream query;
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
+
+  void AppendQuery(SqlWriter& out, bool pretty_print = false) const {
     bool first_element = true;
     for (size_t i = 0; i < tables_.size(); ++i) {
       if (!first_element) {
-        query << (pretty_print ? ",\n" : ", ");
+        out.Append(pretty_print ? ",\n" : ", ");
+      }
+      if (pretty_print) {
+        out.AppendIndentation(level_ + 1);
       }
-      query << (pretty_print ? GenerateIndentation(level_ + 1) : "")
-            << tables_[i].BuildTableName();
+      tables_[i].AppendTableName(out);
 
       first_element = false;
     }
 
-    if (!subqueries_.empty()) {
-      for (auto& s : subqueries_) {
-        auto alias = __GetTableAliasFromParent(s);
-        if (!first_element)
-          query << (pretty_print ? ",\n" : ", ");
+    for (auto& s : subqueries_) {
+      auto alias = __GetTableAliasFromParent(s);
+      if (!first_element)
+        out.Append(pretty_print ? ",\n" : ", ");
 
-        query << (pretty_print ? GenerateIndentation(level_ + 1) + "(\n" : " (")
-              << __GenerateSelectQuery(s, pretty_print) << ")"
-              << (alias.empty() ? "" : " AS " + alias);
+      if (pretty_print) {
+        out.AppendIndentation(level_ + 1).Append("(\n");
+      } else {
+        out.Append(" (");
       }
+      __AppendSelectQuery(s, out, pretty_print);
+      out.Append(')');
+      if (!alias.empty()) {
+        out.Append(" AS ").Append(alias);
+      }
+    }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddUInt(level_).AddUInt(tables_.size());
+    for (const auto& table : tables_) {
+      table.HashShape(hasher);
+    }
+    hasher.AddUInt(subqueries_.size());
+    for (const auto& s : subqueries_) {
+      __HashSelectShape(s, hasher);
+    }
+  }
+
+  uint64_t Fingerprint() const {
+    if (subqueries_.empty()) {
+      return fingerprint_.Value();
+    }
+    StatementFingerprint fingerprint = fingerprint_;
+    for (const auto& s : subqueries_) {
+      fingerprint.AddUInt(__SelectFingerprint(s));
     }
-    return query.str();
+    return fingerprint.Value();
   }
 };
 }  // namespace nvm::sqlbuilder
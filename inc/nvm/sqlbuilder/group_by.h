@@ -28,6 +28,7 @@
 #include <unordered_map>
 
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/query_arena.h"
 
 namespace nvm::sqlbuilder {
 
@@ -41,8 +42,8 @@ NVM_ENUM_CLASS_DISPLAY_TRAIT(GroupByMode)
 
 class GroupByClause {
  private:
-  std::string field_name_;
-  std::optional<std::string> table_alias_;
+  std::string_view field_name_;
+  std::string_view table_alias_;
   uint32_t start_parameter_index_;
   uint32_t parameter_index_;
   uint32_t level_;
@@ -54,12 +55,12 @@ class GroupByClause {
   }
 
  public:
-  explicit GroupByClause(const std::string& field_name,
-                         const std::optional<std::string>& alias,
+  explicit GroupByClause(QueryArena& arena, std::string_view field_name,
+                         const std::optional<std::string_view>& alias,
                          GroupByMode mode, uint32_t parameter_index,
                          uint32_t level)
-                  : field_name_(field_name),
-                    table_alias_(alias),
+                  : field_name_(arena.Name(field_name)),
+                    table_alias_(arena.OptionalName(alias)),
                     start_parameter_index_(parameter_index),
                     parameter_index_(
                         ProcessNextParameterIndex(mode, parameter_index)),
@@ -70,60 +71,95 @@ class GroupByClause {
     return parameter_index_;
   }
 
-  std::string FieldName() const {
+  std::string_view FieldName() const {
     return field_name_;
   }
 
-  std::optional<std::string> TableAlias() const {
-    return table_alias_;
+  std::optional<std::string_view> TableAlias() const {
+    return AsOptional(table_alias_);
   }
 
   std::string BuildFieldname() const {
-    return table_alias_.has_value() ? table_alias_.value() + "." + field_name_
-                                    : field_name_;
+    return RenderSql([&](SqlWriter& out) { AppendQuery(out); });
   }
 
   std::string GenerateQuery() const {
     return BuildFieldname();
   }
+
+  void AppendQuery(SqlWriter& out) const {
+    if (HasName(table_alias_)) {
+      out.Append(table_alias_).Append('.');
+    }
+    out.Append(field_name_);
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddEnum(mode_).AddString(field_name_).AddName(table_alias_);
+  }
+
+  void Fingerprint(StatementFingerprint& fingerprint) const {
+    fingerprint.AddEnum(mode_).AddString(field_name_).AddName(table_alias_);
+  }
 };
 
 template <typename TParameterType>
 class GroupByStatement {
  public:
-  GroupByStatement() : parent_(nullptr), sorts_(), level_(), param_index_(1) {}
-
-  explicit GroupByStatement(NvSelect<TParameterType>* parent,
+  GroupByStatement()
+                  : arena_(std::make_shared<QueryArena>()),
+                    parent_(nullptr),
+                    sorts_(arena_->Vector<GroupByClause>()),
+                    level_(),
+                    param_index_(1),
+                    fingerprint_() {}
+
+  explicit GroupByStatement(std::shared_ptr<QueryArena> arena,
+                            NvSelect<TParameterType>* parent,
                             uint32_t parameter_index, uint32_t level)
-                  : parent_(parent),
-                    sorts_(),
+                  : arena_(std::move(arena)),
+                    parent_(parent),
+                    sorts_(arena_->Vector<GroupByClause>()),
                     level_(level),
-                    param_index_(parameter_index) {}
+                    param_index_(parameter_index),
+                    fingerprint_() {}
 
   GroupByStatement& Field(
-      const std::string& field_name,
-      const std::optional<std::string>& table_alias = std::nullopt) {
-    sorts_.emplace_back(field_name, table_alias, GroupByMode::Field,
+      std::string_view field_name,
+      const std::optional<std::string_view>& table_alias = std::nullopt) {
+    sorts_.emplace_back(*arena_, field_name, table_alias, GroupByMode::Field,
                         param_index_, level_);
-
-    auto back = sorts_.back();
-    param_index_ = back.NextParameterIndex();
+    param_index_ = sorts_.back().NextParameterIndex();
+    sorts_.back().Fingerprint(fingerprint_);
     return *this;
   }
 
   std::string GenerateQuery(bool pretty_print = false) const {
-    std::ostringstream query;
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
+
+  void AppendQuery(SqlWriter& out, bool pretty_print = false) const {
     bool is_first_element = true;
 
     for (auto& s : sorts_) {
       if (!is_first_element)
-        query << ", ";
+        out.Append(", ");
 
-      query << s.GenerateQuery();
+      s.AppendQuery(out);
       is_first_element = false;
     }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddUInt(sorts_.size());
+    for (const auto& s : sorts_) {
+      s.HashShape(hasher);
+    }
+  }
 
-    return query.str();
+  uint64_t Fingerprint() const {
+    return fingerprint_.Value();
   }
 
   uint32_t CurrentParameterIndex() const {
@@ -139,10 +175,12 @@ class GroupByStatement {
   }
 
  private:
+  std::shared_ptr<QueryArena> arena_;
   NvSelect<TParameterType>* parent_;
-  std::vector<GroupByClause> sorts_;
+  ArenaVector<GroupByClause> sorts_;
   uint32_t level_;
   uint32_t param_index_;
+  StatementFingerprint fingerprint_;
 };
 
 }  // namespace nvm::sqlbuilder
\ No newline at end of file
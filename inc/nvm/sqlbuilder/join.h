@@ -1,50 +1,56 @@
 #pragma once
 
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/query_arena.h"
 
 namespace nvm::sqlbuilder {
 template <typename TParameterType = DefaultPostgresParamType>
 class JoinDef {
  public:
-  JoinDef(RecordKey&& left_table, RecordKey&& right_table, SqlJoinType join,
-          uint32_t level, DatabaseDialect dialect)
+  JoinDef(QueryArena& arena, RecordKey&& left_table, RecordKey&& right_table,
+          SqlJoinType join, uint32_t level, DatabaseDialect dialect)
                   : subquery_str_(),
                     subsquery_str_alias_(),
                     subquery_field_key_(),
                     subquery_obj_(),
-                    left_table_(std::forward<RecordKey>(left_table)),
-                    right_table_(std::forward<RecordKey>(right_table)),
+                    left_table_(arena, left_table),
+                    right_table_(arena, right_table),
                     join_type_(join),
                     join_mode_(JoinDefMode::RecordKeyBoth),
+                    sql_operator_(SqlOperator::kEqual),
                     level_(level),
                     dialect_(dialect) {}
 
-  JoinDef(RecordKey&& left_table, SqlJoinType join, const std::string& subquery,
-          const std::string& subquery_field_key,
-          const std::string& subquery_table_alias, SqlOperator op,
-          uint32_t level, DatabaseDialect dialect)
-                  : subquery_str_(std::string(subquery)),
-                    subsquery_str_alias_(std::string(subquery_table_alias)),
-                    subquery_field_key_(std::string(subquery_field_key)),
+  JoinDef(QueryArena& arena, RecordKey&& left_table, SqlJoinType join,
+          std::string_view subquery, std::string_view subquery_field_key,
+          const std::optional<std::string_view>& subquery_table_alias,
+          SqlOperator op, uint32_t level, DatabaseDialect dialect)
+                  : subquery_str_(arena.Name(subquery)),
+                    subsquery_str_alias_(
+                        arena.OptionalName(subquery_table_alias)),
+                    subquery_field_key_(arena.Name(subquery_field_key)),
                     subquery_obj_(),
-                    left_table_(std::forward<RecordKey>(left_table)),
-                    right_table_(RecordKey()),
+                    left_table_(arena, left_table),
+                    right_table_(),
                     join_type_(join),
                     join_mode_(JoinDefMode::SubquerySelectString),
+                    sql_operator_(op),
                     level_(level),
                     dialect_(dialect) {}
 
-  JoinDef(RecordKey&& existing_table, NvSelect<TParameterType>&& subquery,
-          SqlJoinType join, uint32_t level, DatabaseDialect dialect)
+  JoinDef(QueryArena& arena, RecordKey&& existing_table,
+          NvSelect<TParameterType>&& subquery, SqlJoinType join,
+          uint32_t level, DatabaseDialect dialect)
                   : subquery_str_(),
                     subsquery_str_alias_(),
                     subquery_field_key_(),
-                    subquery_obj_(std::make_shared<NvSelect<TParameterType>>(
+                    subquery_obj_(arena.MakeShared<NvSelect<TParameterType>>(
                         std::forward<NvSelect<TParameterType>>(subquery))),
-                    left_table_(std::forward<RecordKey>(existing_table)),
-                    right_table_(RecordKey()),
+                    left_table_(arena, existing_table),
+                    right_table_(),
                     join_type_(join),
                     join_mode_(JoinDefMode::SubquerySelectObject),
+                    sql_operator_(SqlOperator::kEqual),
                     level_(level),
                     dialect_(dialect) {}
 
@@ -56,11 +62,11 @@ class JoinDef {
     return join_mode_;
   }
 
-  const RecordKey& LeftTable() const {
+  const NameKey& LeftTable() const {
     return left_table_;
   }
 
-  const RecordKey& RightTable() const {
+  const NameKey& RightTable() const {
     return right_table_;
   }
 
@@ -72,212 +78,184 @@ class JoinDef {
     return subquery_obj_ != nullptr;
   }
 
-  const std::string& SubqueryString() const {
+  std::string_view SubqueryString() const {
     return subquery_str_;
   }
 
-  const std::string& SubqueryAliasString() const {
+  std::string_view SubqueryAliasString() const {
     return subsquery_str_alias_;
   }
 
   std::string GenerateQuery(bool pretty_print = false) const {
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
+
+  void AppendQuery(SqlWriter& out, bool pretty_print = false) const {
     switch (join_mode_) {
       case JoinDefMode::RecordKeyBoth:
-        return GenerateJoinRecordBoth(pretty_print);
+        AppendJoinRecordBoth(out, pretty_print);
         break;
       case JoinDefMode::SubquerySelectString:
-        return GenerateJoinRecordSubqueryString();
+        AppendJoinRecordSubqueryString(out);
         break;
       case JoinDefMode::SubquerySelectObject:
-        return GenerateJoinRecordSubqueryObject();
+        AppendJoinRecordSubqueryObject(out);
         break;
       default:
         break;
     }
+  }
 
-    return std::string();
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddUInt(static_cast<uint64_t>(join_mode_) |
+                   static_cast<uint64_t>(join_type_) << 8 |
+                   static_cast<uint64_t>(sql_operator_) << 16 |
+                   static_cast<uint64_t>(level_) << 32);
+    left_table_.HashShape(hasher);
+    if (join_mode_ == JoinDefMode::RecordKeyBoth) {
+      right_table_.HashShape(hasher);
+    } else {
+      hasher.AddString(subquery_str_)
+          .AddString(subsquery_str_alias_)
+          .AddString(subquery_field_key_);
+      HashSubqueryObjectShape(hasher);
+    }
+  }
+
+  void Fingerprint(StatementFingerprint& fingerprint) const {
+    fingerprint.AddUInt(static_cast<uint64_t>(join_mode_) |
+                        static_cast<uint64_t>(join_type_) << 8 |
+                        static_cast<uint64_t>(sql_operator_) << 16);
+    left_table_.Fingerprint(fingerprint);
+    if (join_mode_ == JoinDefMode::RecordKeyBoth) {
+      right_table_.Fingerprint(fingerprint);
+    } else {
+      fingerprint.AddString(subquery_str_)
+          .AddString(subsquery_str_alias_)
+          .AddString(subquery_field_key_);
+      FingerprintSubqueryObject(fingerprint);
+    }
   }
 
  private:
-  std::string subquery_str_;
-  std::string subsquery_str_alias_;
-  std::string subquery_field_key_;
+  std::string_view subquery_str_;
+  std::string_view subsquery_str_alias_;
+  std::string_view subquery_field_key_;
   mutable std::shared_ptr<NvSelect<TParameterType>> subquery_obj_;
-  RecordKey left_table_;
-  RecordKey right_table_;
+  NameKey left_table_;
+  NameKey right_table_;
   SqlJoinType join_type_;
   JoinDefMode join_mode_;
   SqlOperator sql_operator_;
   uint32_t level_;
   DatabaseDialect dialect_;
 
-  std::string GenerateJoinRecordBoth(bool pretty_print) const {
+  void AppendJoinRecordBoth(SqlWriter& out, bool pretty_print) const {
     if (join_type_ == SqlJoinType::InnerJoin) {
-      return GenerateInnerJoin(left_table_, right_table_, pretty_print);
+      AppendJoin(out, "INNER JOIN", left_table_, right_table_, pretty_print);
     } else if (join_type_ == SqlJoinType::LeftJoin) {
-      return GenerateLeftJoin(left_table_, right_table_, pretty_print);
+      AppendJoin(out, "LEFT JOIN", left_table_, right_table_, pretty_print);
     } else if (join_type_ == SqlJoinType::RightJoin) {
-      return GenerateRightJoin(left_table_, right_table_);
+      AppendJoin(out, "RIGHT JOIN", left_table_, right_table_, false);
     }
-
-    return std::string();
   }
 
-  std::string GenerateJoinRecordSubqueryString() const {
-    if (join_type_ == SqlJoinType::InnerJoin) {
-      return GenerateInnerJoin(left_table_, subquery_str_, subquery_field_key_,
-                               subsquery_str_alias_, sql_operator_);
+  void AppendJoinRecordSubqueryString(SqlWriter& out) const {
+    if (join_type_ == SqlJoinType::InnerJoin ||
+        join_type_ == SqlJoinType::RightJoin) {
+      // INNER/RIGHT JOIN (subquery) AS alias ON key op alias.field
+      out.Append(join_type_ == SqlJoinType::InnerJoin ? "INNER JOIN ("
+                                                      : "RIGHT JOIN (");
+      AppendSubqueryTable(out);
+      out.Append(" ON ");
+      left_table_.AppendField(out);
+      out.Append(SqlOperatorSymbol(sql_operator_));
+      AppendSubqueryField(out);
     } else if (join_type_ == SqlJoinType::LeftJoin) {
-      return GenerateLeftJoin(left_table_, subquery_str_, subquery_field_key_,
-                              subsquery_str_alias_, sql_operator_);
-    } else if (join_type_ == SqlJoinType::RightJoin) {
-      return GenerateRightJoin(left_table_, subquery_str_, subquery_field_key_,
-                               subsquery_str_alias_, sql_operator_);
+      // LEFT JOIN (subquery) AS alias ON alias.field op key
+      out.Append("LEFT JOIN (");
+      AppendSubqueryTable(out);
+      out.Append(" ON ");
+      AppendSubqueryField(out);
+      out.Append(SqlOperatorSymbol(sql_operator_));
+      left_table_.AppendField(out);
     }
-
-    return std::string();
   }
 
-  std::string GenerateJoinRecordSubqueryObject() const;
-
-  std::string GenerateLeftJoin(const RecordKey& left_key,
-                               const RecordKey& right_key,
-                               bool pretty_print) const {
-    std::ostringstream join;
-    // clang-format off
-    join << 
-        (pretty_print? GenerateIndentation(level_) : "") << 
-        (pretty_print? "LEFT JOIN\n" : "LEFT JOIN ") << 
-        (pretty_print? GenerateIndentation(level_+1) : "") <<
-        right_key.BuildTableName() <<  
-        (pretty_print? "\n" + GenerateIndentation(level_+1) + "ON\n" : " ON ") << 
-        (pretty_print? GenerateIndentation(level_+2) : "") << 
-        left_key.BuildField() << " = " << right_key.BuildField();
-    // clang-format on
-
-    return join.str();
-  }
+  void AppendJoinRecordSubqueryObject(SqlWriter& out) const;
 
-  std::string GenerateLeftJoin(const RecordKey& right_table,
-                               const std::string& left_table,
-                               const std::string& left_table_field_key,
-                               const std::string& left_table_alias,
-                               SqlOperator op = SqlOperator::kEqual) const {
-    std::ostringstream join;
-
-    // clang-format off
-    join << 
-        "LEFT JOIN " << 
-        "(" << left_table << ")" << 
-         (!left_table_alias.empty()? 
-          " AS " + left_table_alias : "") << 
-        " ON " << 
-        (!left_table_alias.empty()? 
-        left_table_alias + "." + left_table_field_key  : left_table_field_key) <<
-        SqlOperatorToString(op) <<
-        right_table.BuildField();
-    // clang-format on
-
-    return join.str();
-  }
+  void HashSubqueryObjectShape(ShapeHasher& hasher) const;
 
-  std::string GenerateRightJoin(const RecordKey& left_table,
-                                const RecordKey& right_table) const {
-    std::ostringstream join;
-    // clang-format off
-    join << 
-        "RIGHT JOIN " << 
-        right_table.BuildTableName() << 
-        " ON " << 
-        left_table.BuildField() << " = " << right_table.BuildField();
-    // clang-format on
-
-    return join.str();
-  }
+  void FingerprintSubqueryObject(StatementFingerprint& fingerprint) const;
 
-  std::string GenerateRightJoin(const RecordKey& left_table,
-                                const std::string& right_table,
-                                const std::string& right_table_field_key,
-                                const std::string& right_table_alias,
-                                SqlOperator op = SqlOperator::kEqual) const {
-    std::ostringstream join;
-    // clang-format off
-    join << 
-        "RIGHT JOIN " << 
-        "(" << right_table << ")" << 
-         (!right_table_alias.empty()? 
-          " AS " + right_table_alias : "") << 
-        " ON " << 
-        left_table.BuildField() <<
-        SqlOperatorToString(op) << 
-        (!right_table_alias.empty()? 
-          right_table_alias + "." + right_table_field_key : right_table_field_key);
-
-    // clang-format on
-
-    return join.str();
+  void AppendSubqueryTable(SqlWriter& out) const {
+    out.Append(subquery_str_).Append(')');
+    if (!subsquery_str_alias_.empty()) {
+      out.Append(" AS ").Append(subsquery_str_alias_);
+    }
   }
 
-  std::string GenerateInnerJoin(const RecordKey& existing_select,
-                                const RecordKey& join_on_table,
-                                bool pretty_print) const {
-    std::ostringstream join;
-    // clang-format off
-    join << 
-        (pretty_print? GenerateIndentation(level_) : "") << 
-        (pretty_print? "INNER JOIN\n" : "INNER JOIN ") << 
-        (pretty_print? GenerateIndentation(level_+1) : "") <<
-        join_on_table.BuildTableName() <<  
-        (pretty_print? "\n" + GenerateIndentation(level_+1) + "ON\n" : " ON ") << 
-        (pretty_print? GenerateIndentation(level_+2) : "") << 
-        existing_select.BuildField() << " = " << join_on_table.BuildField();
-    // clang-format on
-
-    return join.str();
+  void AppendSubqueryField(SqlWriter& out) const {
+    if (!subsquery_str_alias_.empty()) {
+      out.Append(subsquery_str_alias_).Append('.');
+    }
+    out.Append(subquery_field_key_);
   }
 
-  std::string GenerateInnerJoin(const RecordKey& existing_select,
-                                const std::string& join_on_table,
-                                const std::string& join_table_field_key,
-                                const std::string& join_table_alias,
-                                SqlOperator op = SqlOperator::kEqual) const {
-    std::ostringstream join;
-    // clang-format off
-    join << 
-        "INNER JOIN " << 
-        "(" << join_on_table << ")" << 
-         (!join_table_alias.empty()? 
-          " AS " + join_table_alias : "") << 
-        " ON " << 
-        existing_select.BuildField() <<
-        SqlOperatorToString(op) << 
-        (!join_table_alias.empty()? 
-          join_table_alias + "." +  join_table_field_key : join_table_field_key);
-    // clang-format on
-    return join.str();
+  void AppendJoin(SqlWriter& out, std::string_view keyword,
+                  const NameKey& existing_select, const NameKey& join_on_table,
+                  bool pretty_print) const {
+    if (pretty_print) {
+      out.AppendIndentation(level_).Append(keyword).Append('\n');
+      out.AppendIndentation(level_ + 1);
+    } else {
+      out.Append(keyword).Append(' ');
+    }
+    join_on_table.AppendTableName(out);
+    if (pretty_print) {
+      out.Append('\n').AppendIndentation(level_ + 1).Append("ON\n");
+      out.AppendIndentation(level_ + 2);
+    } else {
+      out.Append(" ON ");
+    }
+    existing_select.AppendField(out);
+    out.Append(" = ");
+    join_on_table.AppendField(out);
   }
 };
 
 template <typename TParameterType = DefaultPostgresParamType>
 class JoinStatement {
  private:
+  std::shared_ptr<QueryArena> arena_;
   NvSelect<TParameterType>& parent_;
-  std::vector<JoinDef<TParameterType>> joins_;
+  ArenaVector<JoinDef<TParameterType>> joins_;
   // std::unique_ptr<NvSelect<TParameterType>> subquery_;
   uint32_t current_parameter_index_;
   uint32_t level_;
   DatabaseDialect dialect_;
+  StatementFingerprint fingerprint_;
+
+  template <typename... TArgs>
+  void EmplaceJoin(TArgs&&... args) {
+    joins_.emplace_back(std::forward<TArgs>(args)...);
+    joins_.back().Fingerprint(fingerprint_);
+  }
 
  public:
-  explicit JoinStatement(NvSelect<TParameterType>& parent,
+  explicit JoinStatement(std::shared_ptr<QueryArena> arena,
+                         NvSelect<TParameterType>& parent,
                          uint32_t parameter_index, uint32_t level,
                          DatabaseDialect dialect)
-                  : parent_(parent),
-                    joins_(),
+                  : arena_(std::move(arena)),
+                    parent_(parent),
+                    joins_(arena_->Vector<JoinDef<TParameterType>>()),
                     // subquery_(nullptr),
                     current_parameter_index_(parameter_index),
                     level_(level),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fingerprint_() {}
 
   NvSelect<TParameterType>& EndJoinBlock() {
     // sync the current_parameter
@@ -287,7 +265,7 @@ class JoinStatement {
 
   std::string __GenerateSelectBlock(const NvSelect<TParameterType>& select);
 
-  const std::vector<JoinDef<TParameterType>>& GetJoinClauses() const {
+  const ArenaVector<JoinDef<TParameterType>>& GetJoinClauses() const {
     return joins_;
   }
 
@@ -296,15 +274,28 @@ class JoinStatement {
   }
 
   std::string GenerateQuery(bool prety_print = false) const {
-    std::ostringstream query;
+    return RenderSql([&](SqlWriter& out) { AppendQuery(out, prety_print); });
+  }
+
+  void AppendQuery(SqlWriter& out, bool prety_print = false) const {
     bool is_first_element = true;
     for (const auto& clause : joins_) {
       if (!is_first_element)
-        query << (prety_print ? "\n" : " ");
-      query << clause.GenerateQuery(prety_print);
+        out.Append(prety_print ? "\n" : " ");
+      clause.AppendQuery(out, prety_print);
       is_first_element = false;
     }
-    return query.str();
+  }
+
+  uint64_t Fingerprint() const {
+    return fingerprint_.Value();
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddUInt(level_).AddUInt(joins_.size());
+    for (const auto& clause : joins_) {
+      clause.HashShape(hasher);
+    }
   }
 
   /// @brief Construct LEFT JOIN Statement
@@ -312,9 +303,9 @@ class JoinStatement {
   /// @param right_table
   /// @return
   JoinStatement& LeftJoin(RecordKey&& left_table, RecordKey&& right_table) {
-    joins_.emplace_back(std::forward<RecordKey>(left_table),
-                        std::forward<RecordKey>(right_table),
-                        SqlJoinType::LeftJoin, level_, dialect_);
+    EmplaceJoin(*arena_, std::forward<RecordKey>(left_table),
+                std::forward<RecordKey>(right_table), SqlJoinType::LeftJoin,
+                level_, dialect_);
     return *this;
   }
 
@@ -325,10 +316,9 @@ class JoinStatement {
   /// @param left_table_alias
   /// @param op
   /// @return
-  JoinStatement& LeftJoin(RecordKey&& right_table,
-                          const std::string& left_table,
-                          const std::string& left_table_field_key,
-                          const std::string& left_table_alias,
+  JoinStatement& LeftJoin(RecordKey&& right_table, std::string_view left_table,
+                          std::string_view left_table_field_key,
+                          std::string_view left_table_alias,
                           SqlOperator op = SqlOperator::kEqual) {
     // Const format
     // RecordKey&& left_table, SqlJoinType join,
@@ -337,9 +327,9 @@ class JoinStatement {
     //       const std::optional<std::string>& subquery_table_alias,
     //       SqlOperator op = SqlOperator::kEqual
 
-    joins_.emplace_back(std::forward<RecordKey>(right_table),
-                        SqlJoinType::LeftJoin, left_table, left_table_field_key,
-                        left_table_alias, op, level_, dialect_);
+    EmplaceJoin(*arena_, std::forward<RecordKey>(right_table),
+                SqlJoinType::LeftJoin, left_table, left_table_field_key,
+                left_table_alias, op, level_, dialect_);
     return *this;
   }
 
@@ -348,9 +338,9 @@ class JoinStatement {
   /// @param right_table
   /// @return
   JoinStatement& RightJoin(RecordKey&& left_table, RecordKey&& right_table) {
-    joins_.emplace_back(std::forward<RecordKey>(left_table),
-                        std::forward<RecordKey>(right_table),
-                        SqlJoinType::RightJoin, level_);
+    EmplaceJoin(*arena_, std::forward<RecordKey>(left_table),
+                std::forward<RecordKey>(right_table), SqlJoinType::RightJoin,
+                level_, dialect_);
     return *this;
   }
 
@@ -361,11 +351,11 @@ class JoinStatement {
   /// @param right_table_alias
   /// @param op
   /// @return
-  JoinStatement& RightJoin(RecordKey&& left_table,
-                           const std::string& right_table,
-                           const std::string& right_table_field_key,
-                           const std::optional<std::string>& right_table_alias,
-                           SqlOperator op = SqlOperator::kEqual) {
+  JoinStatement& RightJoin(
+      RecordKey&& left_table, std::string_view right_table,
+      std::string_view right_table_field_key,
+      const std::optional<std::string_view>& right_table_alias,
+      SqlOperator op = SqlOperator::kEqual) {
     // Const format
     // RecordKey&& left_table, SqlJoinType join,
     //       const std::string& subquery,
@@ -373,9 +363,9 @@ class JoinStatement {
     //       const std::optional<std::string>& subquery_table_alias,
     //       SqlOperator op = SqlOperator::kEqual
 
-    joins_.emplace_back(
-        std::forward<RecordKey>(left_table), SqlJoinType::LeftJoin, right_table,
-        right_table_field_key, right_table_alias, op, level_, dialect_);
+    EmplaceJoin(*arena_, std::forward<RecordKey>(left_table),
+                SqlJoinType::LeftJoin, right_table, right_table_field_key,
+                right_table_alias, op, level_, dialect_);
 
     return *this;
   }
@@ -386,9 +376,9 @@ class JoinStatement {
   /// @return
   JoinStatement& InnerJoin(RecordKey&& existing_select,
                            RecordKey&& join_on_table) {
-    joins_.emplace_back(std::forward<RecordKey>(existing_select),
-                        std::forward<RecordKey>(join_on_table),
-                        SqlJoinType::InnerJoin, level_, dialect_);
+    EmplaceJoin(*arena_, std::forward<RecordKey>(existing_select),
+                std::forward<RecordKey>(join_on_table), SqlJoinType::InnerJoin,
+                level_, dialect_);
     return *this;
   }
 
@@ -399,11 +389,11 @@ class JoinStatement {
   /// @param join_table_alias
   /// @param op
   /// @return
-  JoinStatement& InnerJoin(RecordKey& existing_select,
-                           const std::string& join_on_table,
-                           const std::string& join_table_field_key,
-                           const std::optional<std::string>& join_table_alias,
-                           SqlOperator op = SqlOperator::kEqual) {
+  JoinStatement& InnerJoin(
+      RecordKey& existing_select, std::string_view join_on_table,
+      std::string_view join_table_field_key,
+      const std::optional<std::string_view>& join_table_alias,
+      SqlOperator op = SqlOperator::kEqual) {
     // Const format
     // RecordKey&& left_table, SqlJoinType join,
     //       const std::string& subquery,
@@ -411,10 +401,9 @@ class JoinStatement {
     //       const std::optional<std::string>& subquery_table_alias,
     //       SqlOperator op = SqlOperator::kEqual
 
-    joins_.emplace_back(std::forward<RecordKey>(existing_select),
-                        SqlJoinType::LeftJoin, join_on_table,
-                        join_table_field_key, join_table_alias, op, level_,
-                        dialect_);
+    EmplaceJoin(*arena_, std::forward<RecordKey>(existing_select),
+                SqlJoinType::LeftJoin, join_on_table, join_table_field_key,
+                join_table_alias, op, level_, dialect_);
     return *this;
   }
 
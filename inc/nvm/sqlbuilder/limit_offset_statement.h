@@ -1,10 +1,25 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 #include "nvm/macro.h"
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/order_by.h"
 
 namespace nvm::sqlbuilder {
-enum class LimitOffsetMode { None = 0, LimitOffset = 1, Limit = 2 };
+/// @brief Keyset selects rows after the last row of the previous page by the
+/// ORDER BY columns, then limits them. The server seeks with the index
+/// instead of skipping offset rows, page N costs the same as page 1.
+enum class LimitOffsetMode {
+  None = 0,
+  LimitOffset = 1,
+  Limit = 2,
+  Keyset = 3
+};
 
 // cppcheck-suppress unknownMacro
 NVM_ENUM_CLASS_DISPLAY_TRAIT(LimitOffsetMode)
@@ -18,8 +33,10 @@ class LimitOffsetStatement {
       uint32_t param_index, uint32_t level, DatabaseDialect dialect)
                   : parent_(parent),
                     parameter_values_(parameter_values),
-                    offset_(),
-                    limit_(),
+                    limit_index_(),
+                    offset_index_(),
+                    seek_index_(),
+                    seek_count_(),
                     current_param_index_(param_index),
                     level_(level),
                     dialect_(dialect),
@@ -33,39 +50,167 @@ class LimitOffsetStatement {
     return current_param_index_;
   }
 
+  void UpdateCurrentParameterIndex(uint32_t param_index) {
+    current_param_index_ = param_index;
+  }
+
+  /// @brief LIMIT limit, binds the limit as int32_t.
+  /// @throw std::runtime_error when a limit is already set
   LimitOffsetStatement& Limit(const int32_t& limit) {
-    limit_ = int32_t(limit);
-    mode_ = LimitOffsetMode::Limit;
+    SetMode(LimitOffsetMode::Limit);
+    PushLimit(limit);
 
     return *this;
   }
 
+  /// @brief LIMIT limit OFFSET offset, binds the limit as int32_t then the
+  /// offset as long long like StaticSelect::LimitOffset().
+  /// @throw std::runtime_error when a limit is already set
   LimitOffsetStatement& LimitOffset(const int32_t& limit,
                                     const int64_t& offset) {
-    limit_ = int32_t(limit);
-    offset_ = int64_t(offset);
-    mode_ = LimitOffsetMode::LimitOffset;
+    SetMode(LimitOffsetMode::LimitOffset);
+    PushLimit(limit);
+    offset_index_ = current_param_index_++;
+    parameter_values_->push_back(static_cast<long long>(offset));
+
+    return *this;
+  }
+
+  /// @brief Keyset page of limit rows after last_row. last_row holds the
+  /// values of the ORDER BY columns of the last row on the previous page, in
+  /// ORDER BY order, empty for the first page. Call OrderBy() first. The
+  /// columns must not be NULL and together must be unique, end them with the
+  /// primary key. Ascending columns continue with greater values, descending
+  /// columns with smaller ones:
+  /// @example
+  /// ```cxx
+  /// // ORDER BY created_at DESC, id DESC
+  /// // WHERE (created_at, id) < ($1, $2) LIMIT $3
+  /// select.LimitOffset().Keyset(50, {last.created_at, last.id});
+  /// ```
+  /// A single direction renders one row comparison on PostgreSQL. Mixed
+  /// directions, and Oracle which has no row comparison, expand to
+  /// (a > $1 OR (a = $1 AND b < $2)), reusing the placeholder of a column.
+  /// Bind Oracle parameters by name.
+  /// @throw std::runtime_error when a limit is already set or there is no
+  /// ORDER BY
+  /// @throw std::invalid_argument when last_row does not match the ORDER BY
+  /// columns
+  LimitOffsetStatement& Keyset(const int32_t& limit,
+                               const std::vector<TParamType>& last_row = {}) {
+    const OrderByStatement<TParamType>* order_by =
+        parent_ ? parent_->OrderByBlock() : nullptr;
+    if (!order_by || order_by->Size() == 0) {
+      throw std::runtime_error("Keyset: call OrderBy() first");
+    }
+    if (!last_row.empty() && last_row.size() != order_by->Size()) {
+      throw std::invalid_argument(
+          "Keyset: last_row needs one value per ORDER BY column");
+    }
+
+    SetMode(LimitOffsetMode::Keyset);
+    seek_index_ = current_param_index_;
+    seek_count_ = static_cast<uint32_t>(last_row.size());
+    current_param_index_ += seek_count_;
+    parameter_values_->insert(parameter_values_->end(), last_row.begin(),
+                              last_row.end());
+    PushLimit(limit);
 
     return *this;
   }
 
-  std::string GenerateQuery() const {
-    std::ostringstream ss;
+  /// @brief True when AppendSeekCondition() has a condition to render.
+  bool HasSeekCondition() const {
+    return mode_ == LimitOffsetMode::Keyset && seek_count_ > 0;
+  }
+
+  /// @brief Render the keyset condition over the ORDER BY columns, the
+  /// caller puts it into WHERE.
+  void AppendSeekCondition(SqlWriter& out,
+                           const OrderByStatement<TParamType>& order_by) const {
+    const auto& sorts = order_by.Clauses();
+    bool uniform = true;
+    for (const auto& s : sorts) {
+      uniform = uniform && s.sort_type_ == sorts.front().sort_type_;
+    }
+
+    if (dialect_ == DatabaseDialect::PostgreSQL && uniform) {
+      bool row = sorts.size() > 1;
+      AppendSeekColumns(out, row, [&](uint32_t i) {
+        sorts[i].AppendFieldname(out);
+      });
+      out.Append(SeekOperator(sorts.front()));
+      AppendSeekColumns(out, row, [&](uint32_t i) {
+        out.AppendParameter(dialect_, seek_index_ + i);
+      });
+      return;
+    }
+
+    out.Append('(');
+    for (uint32_t i = 0; i < seek_count_; ++i) {
+      if (i > 0) {
+        out.Append(" OR (");
+      }
+      for (uint32_t j = 0; j < i; ++j) {
+        sorts[j].AppendFieldname(out);
+        out.Append(" = ").AppendParameter(dialect_, seek_index_ + j);
+        out.Append(" AND ");
+      }
+      sorts[i].AppendFieldname(out);
+      out.Append(SeekOperator(sorts[i]))
+          .AppendParameter(dialect_, seek_index_ + i);
+      if (i > 0) {
+        out.Append(')');
+      }
+    }
+    out.Append(')');
+  }
+
+  std::string GenerateQuery(bool pretty_print = false) const {
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
+
+  /// @brief Render the LIMIT clause, nothing while no limit is set.
+  void AppendQuery(SqlWriter& out, bool pretty_print = false) const {
+    if (mode_ == LimitOffsetMode::None) {
+      return;
+    }
+
+    if (pretty_print) {
+      out.Append('\n').AppendIndentation(level_);
+    } else {
+      out.Append(' ');
+    }
 
     switch (dialect_) {
       case DatabaseDialect::PostgreSQL:
-        GeneratePostgresStatement(ss);
+        AppendPostgresStatement(out);
         break;
 
       case DatabaseDialect::Oracle:
-        GenerateOracleStatement(ss);
+        AppendOracleStatement(out);
         break;
 
       default:
         break;
     }
+  }
 
-    return ss.str();
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddEnum(mode_)
+        .AddUInt(limit_index_)
+        .AddUInt(offset_index_)
+        .AddUInt(seek_index_)
+        .AddUInt(seek_count_);
+  }
+
+  /// @brief Only the mode and whether a keyset page seeks, not the
+  /// placeholder positions.
+  uint64_t Fingerprint() const {
+    StatementFingerprint fingerprint;
+    fingerprint.AddEnum(mode_).AddUInt(seek_count_ > 0);
+    return fingerprint.Value();
   }
 
   NvSelect<TParamType>& EndLimitOffsetBlock() {
@@ -76,20 +221,63 @@ class LimitOffsetStatement {
  private:
   NvSelect<TParamType>* parent_;
   std::shared_ptr<std::vector<TParamType>> parameter_values_;
-  int64_t offset_;
-  int32_t limit_;
+  uint32_t limit_index_;
+  uint32_t offset_index_;
+  uint32_t seek_index_;
+  uint32_t seek_count_;
   uint32_t current_param_index_;
   uint32_t level_;
   DatabaseDialect dialect_;
   LimitOffsetMode mode_;
 
-  void GenerateOracleStatement(std::ostringstream& ss) {
-    //LIMIT =  FETCH FIRST 5 ROWS ONLY;
-    ss << "OFFSET 20 ROWS FETCH NEXT 10 ROWS ONLY";
+  void SetMode(LimitOffsetMode mode) {
+    if (mode_ != LimitOffsetMode::None) {
+      throw std::runtime_error("LimitOffsetStatement: limit is already set");
+    }
+    mode_ = mode;
   }
 
-  void GeneratePostgresStatement(std::ostringstream& ss) {
-    ss << "LIMIT " << "OFFSET ";
+  void PushLimit(int32_t limit) {
+    limit_index_ = current_param_index_++;
+    parameter_values_->push_back(limit);
+  }
+
+  static std::string_view SeekOperator(const OrderByClause& sort) {
+    return sort.sort_type_ == SortType::Descending ? " < " : " > ";
+  }
+
+  template <typename TAppendItem>
+  void AppendSeekColumns(SqlWriter& out, bool row,
+                         TAppendItem&& append_item) const {
+    if (row) {
+      out.Append('(');
+    }
+    for (uint32_t i = 0; i < seek_count_; ++i) {
+      if (i > 0) {
+        out.Append(", ");
+      }
+      append_item(i);
+    }
+    if (row) {
+      out.Append(')');
+    }
+  }
+
+  void AppendOracleStatement(SqlWriter& out) const {
+    if (mode_ == LimitOffsetMode::LimitOffset) {
+      out.Append("OFFSET ").AppendParameter(dialect_, offset_index_);
+      out.Append(" ROWS FETCH NEXT ").AppendParameter(dialect_, limit_index_);
+    } else {
+      out.Append("FETCH FIRST ").AppendParameter(dialect_, limit_index_);
+    }
+    out.Append(" ROWS ONLY");
+  }
+
+  void AppendPostgresStatement(SqlWriter& out) const {
+    out.Append("LIMIT ").AppendParameter(dialect_, limit_index_);
+    if (mode_ == LimitOffsetMode::LimitOffset) {
+      out.Append(" OFFSET ").AppendParameter(dialect_, offset_index_);
+    }
   }
 };
 }  // namespace nvm::sqlbuilder
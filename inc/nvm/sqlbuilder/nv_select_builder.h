@@ -34,41 +34,70 @@
 #include "nvm/sqlbuilder/join.h"
 #include "nvm/sqlbuilder/limit_offset_statement.h"
 #include "nvm/sqlbuilder/order_by.h"
+#include "nvm/sqlbuilder/query_arena.h"
 #include "nvm/sqlbuilder/where.h"
 
 namespace nvm::sqlbuilder {
 
+template <typename TParameterType>
+class FrozenSelect;
+
+template <typename TParameterType>
+class QueryShapeCache;
+
 /// @brief Fluent SQL Select Builder. TParameterType is typedef of
 /// std::variant<supported_data_type_by_cpp_for_db>. You can customize to your
 /// supported c++ data type for any database based on the db connector that
 /// you are use.
+/// Every node and identifier of the tree, subqueries included, lives in one
+/// QueryArena. Without an arena argument the select owns a private one,
+/// pass a shared arena to recycle its memory across queries.
 /// @tparam TParameterType DefaultPostgresParamType.
 template <typename TParameterType>
 class NvSelect final : public NvSelectBasic {
  private:
+  // first member, the nodes below are destroyed before their memory goes
+  std::shared_ptr<QueryArena> arena_;
   uint32_t current_param_index_;
   uint32_t level_;
-  std::vector<JoinStatement<TParameterType>> join_blocks_;
+  ArenaVector<JoinStatement<TParameterType>> join_blocks_;
   std::shared_ptr<FromTableStatement<TParameterType>> from_table_;
-  std::vector<FieldDef<TParameterType>> fields_;
+  ArenaVector<FieldDef<TParameterType>> fields_;
   std::shared_ptr<std::vector<TParameterType>> parameter_values_;
   FromTableStatement<TParameterType>* subquery_from_parent_;
-  std::string table_alias_;
+  std::string_view table_alias_;
   std::shared_ptr<WhereStatement<TParameterType>> where_;
   std::shared_ptr<OrderByStatement<TParameterType>> order_by_;
   std::shared_ptr<GroupByStatement<TParameterType>> group_by_;
   WhereStatement<TParameterType>* subquery_where_parent_;
   std::shared_ptr<LimitOffsetStatement<TParameterType>> limit_offset_;
   DatabaseDialect dialect_;
+  StatementFingerprint fields_fingerprint_;
+
+  static std::shared_ptr<QueryArena> RequireArena(
+      std::shared_ptr<QueryArena> arena) {
+    if (!arena) {
+      throw std::invalid_argument("NvSelect: arena must not be null");
+    }
+    return arena;
+  }
+
+  template <typename... TArgs>
+  void EmplaceField(TArgs&&... args) {
+    fields_.emplace_back(std::forward<TArgs>(args)...);
+    fields_.back().Fingerprint(fields_fingerprint_);
+  }
 
  public:
   /// @brief Construct NvSelect with parameter index start from 1.
   explicit NvSelect(DatabaseDialect dialect = DatabaseDialect::PostgreSQL)
-                  : current_param_index_(1),
+                  : arena_(std::make_shared<QueryArena>()),
+                    current_param_index_(1),
                     level_(0),
-                    join_blocks_(),
+                    join_blocks_(
+                        arena_->Vector<JoinStatement<TParameterType>>()),
                     from_table_(nullptr),
-                    fields_(),
+                    fields_(arena_->Vector<FieldDef<TParameterType>>()),
                     parameter_values_(
                         std::make_shared<std::vector<TParameterType>>()),
                     subquery_from_parent_(nullptr),
@@ -78,18 +107,45 @@ class NvSelect final : public NvSelectBasic {
                     group_by_(nullptr),
                     subquery_where_parent_(nullptr),
                     limit_offset_(nullptr),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fields_fingerprint_() {}
+
+  /// @brief Construct NvSelect in arena, parameter index start from 1.
+  /// @param arena shared with other builders, see QueryArena::Reset()
+  /// @throw std::invalid_argument when arena is null
+  explicit NvSelect(std::shared_ptr<QueryArena> arena,
+                    DatabaseDialect dialect = DatabaseDialect::PostgreSQL)
+                  : arena_(RequireArena(std::move(arena))),
+                    current_param_index_(1),
+                    level_(0),
+                    join_blocks_(
+                        arena_->Vector<JoinStatement<TParameterType>>()),
+                    from_table_(nullptr),
+                    fields_(arena_->Vector<FieldDef<TParameterType>>()),
+                    parameter_values_(
+                        std::make_shared<std::vector<TParameterType>>()),
+                    subquery_from_parent_(nullptr),
+                    table_alias_(),
+                    where_(nullptr),
+                    order_by_(nullptr),
+                    group_by_(nullptr),
+                    subquery_where_parent_(nullptr),
+                    limit_offset_(nullptr),
+                    dialect_(dialect),
+                    fields_fingerprint_() {}
 
   /// @brief Construct NvSelect with parameter as specified.
   /// @param current_param_index start of parameter index, must be 1 based for
   /// the start.
   explicit NvSelect(uint32_t current_param_index,
                     DatabaseDialect dialect = DatabaseDialect::PostgreSQL)
-                  : current_param_index_(current_param_index),
+                  : arena_(std::make_shared<QueryArena>()),
+                    current_param_index_(current_param_index),
                     level_(0),
-                    join_blocks_(),
+                    join_blocks_(
+                        arena_->Vector<JoinStatement<TParameterType>>()),
                     from_table_(nullptr),
-                    fields_(),
+                    fields_(arena_->Vector<FieldDef<TParameterType>>()),
                     parameter_values_(
                         std::make_shared<std::vector<TParameterType>>()),
                     subquery_from_parent_(nullptr),
@@ -99,19 +155,23 @@ class NvSelect final : public NvSelectBasic {
                     group_by_(nullptr),
                     subquery_where_parent_(nullptr),
                     limit_offset_(nullptr),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fields_fingerprint_() {}
 
   /// @brief DO NOT USE THIS DIRECTLY, SUBQUERY USE THIS CONST
   /// @param current_param_index
   /// @param level
-  explicit NvSelect(std::shared_ptr<std::vector<TParameterType>> values,
+  explicit NvSelect(std::shared_ptr<QueryArena> arena,
+                    std::shared_ptr<std::vector<TParameterType>> values,
                     uint32_t current_param_index, uint32_t level,
                     DatabaseDialect dialect)
-                  : current_param_index_(current_param_index),
+                  : arena_(std::move(arena)),
+                    current_param_index_(current_param_index),
                     level_(level),
-                    join_blocks_(),
+                    join_blocks_(
+                        arena_->Vector<JoinStatement<TParameterType>>()),
                     from_table_(nullptr),
-                    fields_(),
+                    fields_(arena_->Vector<FieldDef<TParameterType>>()),
                     parameter_values_(values),
                     subquery_from_parent_(nullptr),
                     table_alias_(),
@@ -120,7 +180,8 @@ class NvSelect final : public NvSelectBasic {
                     group_by_(nullptr),
                     subquery_where_parent_(nullptr),
                     limit_offset_(nullptr),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fields_fingerprint_() {}
 
   /// @brief DO NOT USE DIRECTLY, SUBQUERY FROM NESTED FROM STATEMENT USE THIS
   /// CONST
@@ -128,24 +189,28 @@ class NvSelect final : public NvSelectBasic {
   /// @param level
   /// @param from_obj
   /// @param table_alias
-  explicit NvSelect(std::shared_ptr<std::vector<TParameterType>> values,
+  explicit NvSelect(std::shared_ptr<QueryArena> arena,
+                    std::shared_ptr<std::vector<TParameterType>> values,
                     uint32_t current_param_index, uint32_t level,
                     FromTableStatement<TParameterType>* from_obj,
-                    const std::string& table_alias, DatabaseDialect dialect)
-                  : current_param_index_(current_param_index),
+                    std::string_view table_alias, DatabaseDialect dialect)
+                  : arena_(std::move(arena)),
+                    current_param_index_(current_param_index),
                     level_(level),
-                    join_blocks_(),
+                    join_blocks_(
+                        arena_->Vector<JoinStatement<TParameterType>>()),
                     from_table_(nullptr),
-                    fields_(),
+                    fields_(arena_->Vector<FieldDef<TParameterType>>()),
                     parameter_values_(values),
                     subquery_from_parent_(from_obj),
-                    table_alias_(std::string(table_alias)),
+                    table_alias_(arena_->Name(table_alias)),
                     where_(nullptr),
                     order_by_(nullptr),
                     group_by_(nullptr),
                     subquery_where_parent_(nullptr),
                     limit_offset_(nullptr),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fields_fingerprint_() {}
 
   /// @brief DO NOT USE DIRECTLY, SUBQUERY FROM NESTED WHERE STATEMENT USE
   /// THIS CONST
@@ -153,24 +218,28 @@ class NvSelect final : public NvSelectBasic {
   /// @param level
   /// @param from_obj
   /// @param table_alias
-  explicit NvSelect(std::shared_ptr<std::vector<TParameterType>> values,
+  explicit NvSelect(std::shared_ptr<QueryArena> arena,
+                    std::shared_ptr<std::vector<TParameterType>> values,
                     WhereStatement<TParameterType>* where_obj,
                     uint32_t current_param_index, uint32_t level,
-                    const std::string& table_alias, DatabaseDialect dialect)
-                  : current_param_index_(current_param_index),
+                    std::string_view table_alias, DatabaseDialect dialect)
+                  : arena_(std::move(arena)),
+                    current_param_index_(current_param_index),
                     level_(level),
-                    join_blocks_(),
+                    join_blocks_(
+                        arena_->Vector<JoinStatement<TParameterType>>()),
                     from_table_(nullptr),
-                    fields_(),
+                    fields_(arena_->Vector<FieldDef<TParameterType>>()),
                     parameter_values_(values),
                     subquery_from_parent_(nullptr),
-                    table_alias_(std::string(table_alias)),
+                    table_alias_(arena_->Name(table_alias)),
                     where_(nullptr),
                     order_by_(nullptr),
                     group_by_(nullptr),
                     subquery_where_parent_(where_obj),
                     limit_offset_(nullptr),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fields_fingerprint_() {}
 
   ~NvSelect() {}
 
@@ -186,10 +255,15 @@ class NvSelect final : public NvSelectBasic {
     current_param_index_ = current_param_index;
   }
 
-  std::string TableAlias() const override {
+  std::string_view TableAlias() const override {
     return table_alias_;
   }
 
+  /// @brief Arena holding this tree.
+  const std::shared_ptr<QueryArena>& Arena() const {
+    return arena_;
+  }
+
   uint32_t GetBlockLevel() const override {
     return level_;
   }
@@ -199,7 +273,7 @@ class NvSelect final : public NvSelectBasic {
   /// @param field
   /// @return
   template <typename T>
-  NvSelect& Field(const std::string& field) {
+  NvSelect& Field(std::string_view field) {
     return Field<T>(field, std::nullopt, std::nullopt,
                     SqlAggregateFunction::None, false);
   }
@@ -210,8 +284,8 @@ class NvSelect final : public NvSelectBasic {
   /// @param table_alias
   /// @return
   template <typename T>
-  NvSelect& Field(const std::string& field,
-                  const std::optional<std::string>& table_alias) {
+  NvSelect& Field(std::string_view field,
+                  const std::optional<std::string_view>& table_alias) {
     return Field<T>(field, table_alias, std::nullopt,
                     SqlAggregateFunction::None, false);
   }
@@ -223,9 +297,9 @@ class NvSelect final : public NvSelectBasic {
   /// @param field_alias
   /// @return
   template <typename T>
-  NvSelect& Field(const std::string& field,
-                  const std::optional<std::string>& table_alias,
-                  const std::optional<std::string>& field_alias) {
+  NvSelect& Field(std::string_view field,
+                  const std::optional<std::string_view>& table_alias,
+                  const std::optional<std::string_view>& field_alias) {
     return Field<T>(field, table_alias, field_alias, SqlAggregateFunction::None,
                     false);
   }
@@ -237,8 +311,8 @@ class NvSelect final : public NvSelectBasic {
   /// @param aggregate_fn
   /// @return
   template <typename T>
-  NvSelect& Field(const std::string& field,
-                  const std::optional<std::string>& table_alias,
+  NvSelect& Field(std::string_view field,
+                  const std::optional<std::string_view>& table_alias,
                   SqlAggregateFunction aggregate_fn) {
     return Field<T>(field, table_alias, std::nullopt, aggregate_fn, false);
   }
@@ -252,13 +326,12 @@ class NvSelect final : public NvSelectBasic {
   /// @param enclose_field_name
   /// @return
   template <typename T>
-  NvSelect& Field(const std::string& field,
-                  const std::optional<std::string>& table_alias,
-                  const std::optional<std::string>& field_alias,
+  NvSelect& Field(std::string_view field,
+                  const std::optional<std::string_view>& table_alias,
+                  const std::optional<std::string_view>& field_alias,
                   SqlAggregateFunction aggregate_fn, bool enclose_field_name) {
-    fields_.emplace_back(dialect_, field, table_alias, enclose_field_name,
-                         aggregate_fn, field_alias, level_,
-                         FieldDefMode::FieldWType);
+    EmplaceField(*arena_, dialect_, field, table_alias, enclose_field_name,
+                 aggregate_fn, field_alias, level_, FieldDefMode::FieldWType);
     return *this;
   }
 
@@ -269,7 +342,7 @@ class NvSelect final : public NvSelectBasic {
   /// for this field.
   /// @param field
   /// @return
-  NvSelect& F(const std::string& field) {
+  NvSelect& F(std::string_view field) {
     return F(field, std::nullopt, std::nullopt, SqlAggregateFunction::None,
              false);
   }
@@ -280,8 +353,8 @@ class NvSelect final : public NvSelectBasic {
   /// @param field
   /// @param table_alias
   /// @return
-  NvSelect& F(const std::string& field,
-              const std::optional<std::string>& table_alias) {
+  NvSelect& F(std::string_view field,
+              const std::optional<std::string_view>& table_alias) {
     return F(field, table_alias, std::nullopt, SqlAggregateFunction::None,
              false);
   }
@@ -293,9 +366,9 @@ class NvSelect final : public NvSelectBasic {
   /// @param table_alias
   /// @param field_alias
   /// @return
-  NvSelect& F(const std::string& field,
-              const std::optional<std::string>& table_alias,
-              const std::optional<std::string>& field_alias) {
+  NvSelect& F(std::string_view field,
+              const std::optional<std::string_view>& table_alias,
+              const std::optional<std::string_view>& field_alias) {
     return F(field, table_alias, field_alias, SqlAggregateFunction::None,
              false);
   }
@@ -307,8 +380,8 @@ class NvSelect final : public NvSelectBasic {
   /// @param table_alias
   /// @param aggregate_fn
   /// @return
-  NvSelect& F(const std::string& field,
-              const std::optional<std::string>& table_alias,
+  NvSelect& F(std::string_view field,
+              const std::optional<std::string_view>& table_alias,
               SqlAggregateFunction aggregate_fn) {
     return F(field, table_alias, std::nullopt, aggregate_fn, false);
   }
@@ -322,13 +395,12 @@ class NvSelect final : public NvSelectBasic {
   /// @param aggregate_fn
   /// @param enclose_field_name
   /// @return
-  NvSelect& F(const std::string& field,
-              const std::optional<std::string>& table_alias,
-              const std::optional<std::string>& field_alias,
+  NvSelect& F(std::string_view field,
+              const std::optional<std::string_view>& table_alias,
+              const std::optional<std::string_view>& field_alias,
               SqlAggregateFunction aggregate_fn, bool enclose_field_name) {
-    fields_.emplace_back(dialect_, field, table_alias, enclose_field_name,
-                         aggregate_fn, field_alias, level_,
-                         FieldDefMode::FieldRaw);
+    EmplaceField(*arena_, dialect_, field, table_alias, enclose_field_name,
+                 aggregate_fn, field_alias, level_, FieldDefMode::FieldRaw);
     return *this;
   }
 
@@ -376,8 +448,9 @@ class NvSelect final : public NvSelectBasic {
         //             level_(uint32_t(level)),
         //             current_parameter_index_(parameter_index) {}
 
-        from_table_ = std::make_shared<FromTableStatement<TParameterType>>(
-            parameter_values_, this, current_param_index_, level_, dialect_);
+        from_table_ = arena_->MakeShared<FromTableStatement<TParameterType>>(
+            arena_, parameter_values_, this, current_param_index_, level_,
+            dialect_);
       }
 
       // if (from_table_->GetCurrentParameterIndex() != current_param_index_)
@@ -406,8 +479,9 @@ class NvSelect final : public NvSelectBasic {
     //                 current_param_index_(current_param_index) {}
 
     if (!where_) {
-      where_ = std::make_shared<WhereStatement<TParameterType>>(
-          parameter_values_, this, current_param_index_, level_, dialect_);
+      where_ = arena_->MakeShared<WhereStatement<TParameterType>>(
+          arena_, parameter_values_, this, current_param_index_, level_,
+          dialect_);
       // std::cout << "Where INIT:" << current_param_index_ <<std::endl;
     }
 
@@ -428,7 +502,8 @@ class NvSelect final : public NvSelectBasic {
   /// @return
   JoinStatement<TParameterType>& Join() {
     try {
-      join_blocks_.emplace_back(*this, current_param_index_, level_, dialect_);
+      join_blocks_.emplace_back(arena_, *this, current_param_index_, level_,
+                                dialect_);
       return join_blocks_.back();
     } catch (const std::exception& e) {
       std::cout << "Create JOINBLOCK_FAILED [" << level_ << "]: " << e.what()
@@ -441,19 +516,24 @@ class NvSelect final : public NvSelectBasic {
   /// @return
   OrderByStatement<TParameterType>& OrderBy() {
     if (!order_by_) {
-      order_by_ =
-          std::make_shared<OrderByStatement<TParameterType>>(this, level_);
+      order_by_ = arena_->MakeShared<OrderByStatement<TParameterType>>(
+          arena_, this, level_);
     }
 
     return *order_by_;
   }
 
+  /// @brief The ORDER BY block, nullptr until OrderBy() is called.
+  const OrderByStatement<TParameterType>* OrderByBlock() const {
+    return order_by_.get();
+  }
+
   /// @brief Construct SQL GROUP BY Statement block
   /// @return
   GroupByStatement<TParameterType>& GroupBy() {
     if (!group_by_) {
-      group_by_ = std::make_shared<GroupByStatement<TParameterType>>(
-          this, current_param_index_, level_);
+      group_by_ = arena_->MakeShared<GroupByStatement<TParameterType>>(
+          arena_, this, current_param_index_, level_);
     }
 
     return *group_by_;
@@ -472,16 +552,17 @@ class NvSelect final : public NvSelectBasic {
   /// @param param_values
   /// @param field_alias
   /// @return
-  NvSelect& Fn(const std::string& fn_name,
+  NvSelect& Fn(std::string_view fn_name,
                const std::vector<std::string>& param_values,
-               const std::optional<std::string>& field_alias = std::nullopt) {
+               const std::optional<std::string_view>& field_alias =
+                   std::nullopt) {
     // TARGET
     // explicit FieldDef(const std::string& function_name,
     //                   const std::vector<std::string>& static_param_values,
     //                   uint32_t level,
     //                   const std::optional<std::string>& alias = std::nullopt)
 
-    fields_.emplace_back(fn_name, param_values, level_, field_alias);
+    EmplaceField(*arena_, dialect_, fn_name, param_values, level_, field_alias);
 
     // No need to update current_parameter_index
     return *this;
@@ -497,12 +578,12 @@ class NvSelect final : public NvSelectBasic {
   /// @param static_param_values
   /// @param alias
   /// @return
-  NvSelect& Fn(const std::string& fn_name,
-               const std::string& parameter_list_format,
+  NvSelect& Fn(std::string_view fn_name,
+               std::string_view parameter_list_format,
                const std::vector<TParameterType>& param_values,
                const std::vector<std::string>& static_param_values =
                    std::vector<std::string>(),
-               std::optional<std::string> alias = std::nullopt) {
+               const std::optional<std::string_view>& alias = std::nullopt) {
     // TARGET
     // explicit FieldDef(
     // const std::string& function_name, const std::string& parameter_format,
@@ -512,40 +593,40 @@ class NvSelect final : public NvSelectBasic {
     // param_index, uint32_t level, const std::optional<std::string>& alias =
     // std::nullopt)
 
-    fields_.emplace_back(dialect_, fn_name, parameter_list_format,
-                         parameter_values_, param_values, static_param_values,
-                         current_param_index_, level_, alias);
+    EmplaceField(*arena_, dialect_, fn_name, parameter_list_format,
+                 parameter_values_, param_values, static_param_values,
+                 current_param_index_, level_, alias);
 
     // sync the current param index
-    auto f = fields_.back();
-    current_param_index_ = f.GetCurrentParameterIndex();
+    current_param_index_ = fields_.back().GetCurrentParameterIndex();
 
     return *this;
   }
 
   template <typename T>
-  NvSelect& Fn(const std::string& fn_name,
+  NvSelect& Fn(std::string_view fn_name,
                const std::vector<std::string>& param_values,
-               const std::optional<std::string>& field_alias = std::nullopt) {
+               const std::optional<std::string_view>& field_alias =
+                   std::nullopt) {
     // TARGET
     // explicit FieldDef(const std::string& function_name,
     //                   const std::vector<std::string>& static_param_values,
     //                   uint32_t level,
     //                   const std::optional<std::string>& alias = std::nullopt)
 
-    fields_.emplace_back(dialect_, fn_name, param_values, level_, field_alias);
+    EmplaceField(*arena_, dialect_, fn_name, param_values, level_, field_alias);
 
     // No need to update current_parameter_index
     return *this;
   }
 
   template <typename T>
-  NvSelect& Fn(const std::string& fn_name,
-               const std::string& parameter_list_format,
+  NvSelect& Fn(std::string_view fn_name,
+               std::string_view parameter_list_format,
                const std::vector<TParameterType>& param_values,
                const std::vector<std::string>& static_param_values =
                    std::vector<std::string>(),
-               std::optional<std::string> alias = std::nullopt) {
+               const std::optional<std::string_view>& alias = std::nullopt) {
     // TARGET
     // explicit FieldDef(
     // const std::string& function_name, const std::string& parameter_format,
@@ -555,13 +636,12 @@ class NvSelect final : public NvSelectBasic {
     // param_index, uint32_t level, const std::optional<std::string>& alias =
     // std::nullopt)
 
-    fields_.emplace_back(dialect_, fn_name, parameter_list_format,
-                         parameter_values_, param_values, static_param_values,
-                         current_param_index_, level_, alias);
+    EmplaceField(*arena_, dialect_, fn_name, parameter_list_format,
+                 parameter_values_, param_values, static_param_values,
+                 current_param_index_, level_, alias);
 
     // sync the current param index
-    auto f = fields_.back();
-    current_param_index_ = f.GetCurrentParameterIndex();
+    current_param_index_ = fields_.back().GetCurrentParameterIndex();
 
     return *this;
   }
@@ -573,10 +653,15 @@ class NvSelect final : public NvSelectBasic {
       //     std::shared_ptr<std::vector<TParamType>> parameter_values,
       //     uint32_t param_index, uint32_t level, DatabaseDialect dialect)
 
-      limit_offset_ = std::make_shared<LimitOffsetStatement<TParameterType>>(
+      limit_offset_ = arena_->MakeShared<LimitOffsetStatement<TParameterType>>(
           this, parameter_values_, current_param_index_, level_, dialect_);
     }
 
+    if (limit_offset_->Mode() == LimitOffsetMode::None &&
+        limit_offset_->GetCurrentParameterIndex() != current_param_index_) {
+      limit_offset_->UpdateCurrentParameterIndex(current_param_index_);
+    }
+
     return *limit_offset_;
   }
 
@@ -584,66 +669,198 @@ class NvSelect final : public NvSelectBasic {
   /// @param pretty_print
   /// @return
   std::string GenerateQuery(bool pretty_print = false) const override {
-    std::ostringstream query;
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
 
+  /// @brief Render this NvSelect into out, subqueries append into the same
+  /// writer so the whole statement lands in one buffer.
+  /// @param out
+  /// @param pretty_print
+  void AppendQuery(SqlWriter& out, bool pretty_print = false) const override {
     // SELECT
-    query << (pretty_print ? GenerateIndentation(level_) + "SELECT \n"
-                           : "SELECT ");
+    if (pretty_print) {
+      out.AppendIndentation(level_).Append("SELECT \n");
+    } else {
+      out.Append("SELECT ");
+    }
     bool first_element = true;
     for (const auto& field : fields_) {
       if (!first_element)
-        query << (pretty_print ? ",\n" : ", ");
-      query << (pretty_print ? GenerateIndentation(level_ + 1) : "")
-            << field.GenerateQuery();
+        out.Append(pretty_print ? ",\n" : ", ");
+      if (pretty_print) {
+        out.AppendIndentation(level_ + 1);
+      }
+      field.AppendQuery(out);
       first_element = false;
     }
 
     // FROM
     if (from_table_ != nullptr && !from_table_->Empty()) {
-      query << (pretty_print ? "\n" + GenerateIndentation(level_) + "FROM \n"
-                             : " FROM ")
-            << from_table_->GenerateQuery(pretty_print);
+      if (pretty_print) {
+        out.Append('\n').AppendIndentation(level_).Append("FROM \n");
+      } else {
+        out.Append(" FROM ");
+      }
+      from_table_->AppendQuery(out, pretty_print);
     }
 
     // JOIN
     if (!join_blocks_.empty()) {
-      query << (pretty_print ? "\n" : " ");
+      out.Append(pretty_print ? "\n" : " ");
       for (const auto& join_block : join_blocks_) {
-        query << join_block.GenerateQuery(pretty_print);
+        join_block.AppendQuery(out, pretty_print);
       }
     }
 
-    // WHERE
-    if (where_ != nullptr) {
-      query << (pretty_print ? "\n" + GenerateIndentation(level_) + "WHERE"
-                             : " WHERE ");
-      query << (pretty_print ? GenerateIndentation(level_ + 1) : "")
-            << where_->GenerateQuery(pretty_print, false);
+    // WHERE, a keyset page adds its condition
+    bool has_where = where_ != nullptr && !where_->Empty();
+    bool has_seek = limit_offset_ != nullptr && order_by_ != nullptr &&
+                    limit_offset_->HasSeekCondition();
+    if (where_ != nullptr || has_seek) {
+      if (pretty_print) {
+        out.Append('\n').AppendIndentation(level_).Append("WHERE");
+        out.AppendIndentation(level_ + 1);
+      } else {
+        out.Append(" WHERE ");
+      }
+      if (has_where && has_seek) {
+        out.Append('(');
+      }
+      if (where_ != nullptr) {
+        where_->AppendQuery(out, pretty_print, false);
+      }
+      if (has_where && has_seek) {
+        out.Append(") AND ");
+      }
+      if (has_seek) {
+        limit_offset_->AppendSeekCondition(out, *order_by_);
+      }
     }
 
     // GROUP BY
     if (group_by_ != nullptr) {
-      query << (pretty_print ? GenerateIndentation(level_) + "\nGROUP BY \n"
-                             : " GROUP BY ");
-      query << (pretty_print ? GenerateIndentation(level_ + 1) : "")
-            << group_by_->GenerateQuery(pretty_print);
+      if (pretty_print) {
+        out.AppendIndentation(level_).Append("\nGROUP BY \n");
+        out.AppendIndentation(level_ + 1);
+      } else {
+        out.Append(" GROUP BY ");
+      }
+      group_by_->AppendQuery(out, pretty_print);
     }
 
     // HAVING BY
 
     // ORDER BY
     if (order_by_ != nullptr) {
-      query << (pretty_print ? GenerateIndentation(level_) + "\nORDER BY \n"
-                             : " ORDER BY ");
-      query << (pretty_print ? GenerateIndentation(level_ + 1) : "")
-            << order_by_->GenerateQuery(pretty_print);
+      if (pretty_print) {
+        out.AppendIndentation(level_).Append("\nORDER BY \n");
+        out.AppendIndentation(level_ + 1);
+      } else {
+        out.Append(" ORDER BY ");
+      }
+      order_by_->AppendQuery(out, pretty_print);
     }
 
     // LIMIT
+    if (limit_offset_ != nullptr) {
+      limit_offset_->AppendQuery(out, pretty_print);
+    }
+  }
+
+  /// @brief Feed the structure of this statement into hasher, see
+  /// ShapeHasher. Parameter values are not part of the shape.
+  /// @param hasher
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddEnum(dialect_).AddUInt(level_).AddString(table_alias_);
+    hasher.AddUInt(fields_.size());
+    for (const auto& field : fields_) {
+      field.HashShape(hasher);
+    }
+
+    hasher.AddUInt(from_table_ != nullptr);
+    if (from_table_ != nullptr) {
+      from_table_->HashShape(hasher);
+    }
+
+    hasher.AddUInt(join_blocks_.size());
+    for (const auto& join_block : join_blocks_) {
+      join_block.HashShape(hasher);
+    }
 
-    return query.str();
+    hasher.AddUInt(where_ != nullptr);
+    if (where_ != nullptr) {
+      where_->HashShape(hasher);
+    }
+
+    hasher.AddUInt(group_by_ != nullptr);
+    if (group_by_ != nullptr) {
+      group_by_->HashShape(hasher);
+    }
+
+    hasher.AddUInt(order_by_ != nullptr);
+    if (order_by_ != nullptr) {
+      order_by_->HashShape(hasher);
+    }
+
+    hasher.AddUInt(limit_offset_ != nullptr);
+    if (limit_offset_ != nullptr) {
+      limit_offset_->HashShape(hasher);
+    }
   }
 
+  /// @brief Key of the SQL text GenerateQuery(pretty_print) would produce,
+  /// computed from the tree without rendering. Builders that only differ in
+  /// parameter values share a key, see QueryShapeCache.
+  /// @param pretty_print
+  /// @return
+  bytes::Hash128Value ShapeKey(bool pretty_print = false) const {
+    ShapeHasher hasher;
+    hasher.AddUInt(pretty_print);
+    HashShape(hasher);
+    return hasher.Digest();
+  }
+
+  /// @brief Stable 64-bit hash of the normalized statement: tables, fields,
+  /// operators and clause shapes. Parameter values and numbering, IN list
+  /// sizes and formatting are left out, so one query shape has one
+  /// fingerprint, use it to key latency metrics or plan caches. Every
+  /// builder call folds its node into its clause as it is added, reading
+  /// the fingerprint combines the clauses and subqueries without visiting
+  /// the nodes or rendering SQL. Unlike ShapeKey() two selects with the same
+  /// fingerprint may render different text.
+  /// @return
+  uint64_t Fingerprint() const {
+    StatementFingerprint fingerprint;
+    fingerprint.AddEnum(dialect_)
+        .AddName(table_alias_)
+        .AddUInt(fields_fingerprint_.Value())
+        .AddUInt(from_table_ != nullptr ? from_table_->Fingerprint() : 0);
+    for (const auto& join_block : join_blocks_) {
+      fingerprint.AddUInt(join_block.Fingerprint());
+    }
+    fingerprint.AddUInt(where_ != nullptr ? where_->Fingerprint() : 0)
+        .AddUInt(group_by_ != nullptr ? group_by_->Fingerprint() : 0)
+        .AddUInt(order_by_ != nullptr ? order_by_->Fingerprint() : 0)
+        .AddUInt(limit_offset_ != nullptr ? limit_offset_->Fingerprint() : 0);
+    return fingerprint.Value();
+  }
+
+  /// @brief Immutable snapshot of this statement to share between threads,
+  /// see FrozenSelect. The SQL is rendered once and the values are copied,
+  /// the builder can be changed or destroyed afterwards.
+  /// @param pretty_print
+  /// @return
+  std::shared_ptr<const FrozenSelect<TParameterType>> Freeze(
+      bool pretty_print = false) const;
+
+  /// @brief Freeze() with the statement taken from cache.
+  /// @param cache
+  /// @param pretty_print
+  /// @return
+  std::shared_ptr<const FrozenSelect<TParameterType>> Freeze(
+      QueryShapeCache<TParameterType>& cache, bool pretty_print = false) const;
+
   /// @brief Get parameter values, all values has been packed with order based
   /// on the parameter index
   /// @return
@@ -660,12 +877,28 @@ class NvSelect final : public NvSelectBasic {
 // Late Complete Declare
 
 template <typename TParameterType>
-std::string JoinDef<TParameterType>::GenerateJoinRecordSubqueryObject() const {
-  if (!subquery_obj_)
-    return std::string();
-  return subquery_obj_->GenerateQuery();
+void JoinDef<TParameterType>::AppendJoinRecordSubqueryObject(
+    SqlWriter& out) const {
+  if (subquery_obj_) {
+    subquery_obj_->AppendQuery(out);
+  }
 };
 
+template <typename TParameterType>
+void JoinDef<TParameterType>::HashSubqueryObjectShape(
+    ShapeHasher& hasher) const {
+  hasher.AddUInt(subquery_obj_ != nullptr);
+  if (subquery_obj_) {
+    subquery_obj_->HashShape(hasher);
+  }
+}
+
+template <typename TParameterType>
+void JoinDef<TParameterType>::FingerprintSubqueryObject(
+    StatementFingerprint& fingerprint) const {
+  fingerprint.AddUInt(subquery_obj_ ? subquery_obj_->Fingerprint() : 0);
+}
+
 template <typename TParameterType>
 std::string JoinStatement<TParameterType>::__GenerateSelectBlock(
     const NvSelect<TParameterType>& select) {
@@ -681,7 +914,7 @@ FromTableStatement<TParameterType>::__GetCurrentParameterIndexFromParent(
 
 template <typename TParameterType>
 NvSelect<TParameterType>& FromTableStatement<TParameterType>::BeginSubquery(
-    const std::string& table_alias) {
+    std::string_view table_alias) {
   uint32_t index;
   index = current_parameter_index_;
 
@@ -691,30 +924,61 @@ NvSelect<TParameterType>& FromTableStatement<TParameterType>::BeginSubquery(
 
 template <typename TParameterType>
 void FromTableStatement<TParameterType>::__CreateNewSelectBlock(
-    std::vector<NvSelect<TParameterType>>& selects, uint32_t index,
-    uint32_t level, const std::string& table_alias) {
-  selects.emplace_back(parameter_values_, index, level, this, table_alias,
-                       dialect_);
+    ArenaVector<NvSelect<TParameterType>>& selects, uint32_t index,
+    uint32_t level, std::string_view table_alias) {
+  selects.emplace_back(arena_, parameter_values_, index, level, this,
+                       table_alias, dialect_);
 }
 
 template <typename TParameterType>
-std::string FromTableStatement<TParameterType>::__GenerateSelectQuery(
-    const NvSelect<TParameterType>& select, bool pretty_print) const {
-  return select.GenerateQuery(pretty_print);
+void FromTableStatement<TParameterType>::__AppendSelectQuery(
+    const NvSelect<TParameterType>& select, SqlWriter& out,
+    bool pretty_print) const {
+  select.AppendQuery(out, pretty_print);
 }
 
 template <typename TParameterType>
-std::string Condition<TParameterType>::__GenerateQueryFromSubquery(
-    bool pretty_print) const {
-  if (!subquery_)
-    return std::string();
-  return subquery_->GenerateQuery(pretty_print);
+void FromTableStatement<TParameterType>::__HashSelectShape(
+    const NvSelect<TParameterType>& select, ShapeHasher& hasher) const {
+  select.HashShape(hasher);
 }
 
 template <typename TParameterType>
-std::string FromTableStatement<TParameterType>::__GetTableAliasFromParent(
+uint64_t FromTableStatement<TParameterType>::__SelectFingerprint(
+    const NvSelect<TParameterType>& select) const {
+  return select.Fingerprint();
+}
+
+template <typename TParameterType>
+void Condition<TParameterType>::__AppendQueryFromSubquery(
+    SqlWriter& out, bool pretty_print) const {
+  if (subquery_) {
+    subquery_->AppendQuery(out, pretty_print);
+  }
+}
+
+template <typename TParameterType>
+void Condition<TParameterType>::__HashSubqueryShape(
+    ShapeHasher& hasher) const {
+  hasher.AddUInt(subquery_ != nullptr);
+  if (subquery_) {
+    subquery_->HashShape(hasher);
+  }
+}
+
+template <typename TParameterType>
+uint64_t Condition<TParameterType>::__SubqueryFingerprint() const {
+  return subquery_ ? subquery_->Fingerprint() : 0;
+}
+
+template <typename TParameterType>
+std::string_view FromTableStatement<TParameterType>::__GetTableAliasFromParent(
     const NvSelect<TParameterType>& select) const {
   return select.TableAlias();
 }
 
-}  // namespace nvm::sqlbuilder
\ No newline at end of file
+}  // namespace nvm::sqlbuilder
+
+// Freeze() builds on the statement cache, pull in its definitions when this
+// header is included on its own.
+#include "nvm/sqlbuilder/query_cache.h"
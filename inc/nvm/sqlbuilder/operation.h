@@ -56,7 +56,8 @@ class RecordInsert {
   template <typename T>
   RecordInsert<TParameterType>& AddValue(const std::string& column_name,
                                          const T& value) {
-    if (!columns_.str().empty()) {
+    // tellp() is O(1), str() would copy the whole stream for every column
+    if (columns_.tellp() > 0) {
       columns_ << ", ";
       sstr_ << ", ";
     }
@@ -67,8 +68,22 @@ class RecordInsert {
     return *this;
   }
 
+  /// @brief A temporary would dangle in a view parameter type and is
+  /// rejected at compile time there.
+  template <typename T = void, typename U,
+            typename = std::enable_if_t<details::binds_temporary_v<T, U>>>
+  RecordInsert<TParameterType>& AddValue(const std::string& column_name,
+                                         U&& value) {
+    static_assert(
+        !details::binds_as_view_v<TParameterType, details::bound_type_t<T, U>>,
+        "a temporary string or vector would dangle in a view parameter "
+                  "type, bind an lvalue that outlives the values");
+    const auto& bound = details::ConvertBound<T>(std::forward<U>(value));
+    return AddValue<details::bound_type_t<T, U>>(column_name, bound);
+  }
+
   RecordInsert<TParameterType>& AddReturning(const std::string& column_name) {
-    if (!returning_clause_.str().empty()) {
+    if (returning_clause_.tellp() > 0) {
       returning_clause_ << ", ";
     }
     returning_clause_ << column_name;
@@ -117,7 +132,7 @@ class RecordUpdate {
   template <typename T>
   RecordUpdate<TParameterType>& SetValue(const std::string& column_name,
                                          const T& value) {
-    if (!set_clause_.str().empty()) {
+    if (set_clause_.tellp() > 0) {
       set_clause_ << ", ";
     }
     set_clause_ << column_name << " = $" << current_param_index_++;
@@ -126,10 +141,24 @@ class RecordUpdate {
     return *this;
   }
 
+  /// @brief Rejects temporaries for view parameter types, see
+  /// RecordInsert::AddValue.
+  template <typename T = void, typename U,
+            typename = std::enable_if_t<details::binds_temporary_v<T, U>>>
+  RecordUpdate<TParameterType>& SetValue(const std::string& column_name,
+                                         U&& value) {
+    static_assert(
+        !details::binds_as_view_v<TParameterType, details::bound_type_t<T, U>>,
+        "a temporary string or vector would dangle in a view parameter "
+                  "type, bind an lvalue that outlives the values");
+    const auto& bound = details::ConvertBound<T>(std::forward<U>(value));
+    return SetValue<details::bound_type_t<T, U>>(column_name, bound);
+  }
+
   template <typename T>
   RecordUpdate<TParameterType>& AddCondition(const std::string& field_name,
                                              SqlOperator op, const T& value) {
-    if (!where_clause_.str().empty()) {
+    if (where_clause_.tellp() > 0) {
       where_clause_ << " AND ";
     }
 
@@ -139,8 +168,22 @@ class RecordUpdate {
     return *this;
   }
 
+  /// @brief Rejects temporaries for view parameter types, see
+  /// RecordInsert::AddValue.
+  template <typename T = void, typename U,
+            typename = std::enable_if_t<details::binds_temporary_v<T, U>>>
+  RecordUpdate<TParameterType>& AddCondition(const std::string& field_name,
+                                             SqlOperator op, U&& value) {
+    static_assert(
+        !details::binds_as_view_v<TParameterType, details::bound_type_t<T, U>>,
+        "a temporary string or vector would dangle in a view parameter "
+                  "type, bind an lvalue that outlives the values");
+    const auto& bound = details::ConvertBound<T>(std::forward<U>(value));
+    return AddCondition<details::bound_type_t<T, U>>(field_name, op, bound);
+  }
+
   RecordUpdate<TParameterType>& AddReturning(const std::string& column_name) {
-    if (!returning_clause_.str().empty()) {
+    if (returning_clause_.tellp() > 0) {
       returning_clause_ << ", ";
     }
 
@@ -194,7 +237,7 @@ class RecordDelete {
   template <typename T>
   RecordDelete<TParameterType>& AddCondition(const std::string& field_name,
                                              SqlOperator op, const T& value) {
-    if (!where_clause_.str().empty()) {
+    if (where_clause_.tellp() > 0) {
       where_clause_ << " AND ";
     }
 
@@ -206,8 +249,22 @@ class RecordDelete {
     return *this;
   }
 
+  /// @brief Rejects temporaries for view parameter types, see
+  /// RecordInsert::AddValue.
+  template <typename T = void, typename U,
+            typename = std::enable_if_t<details::binds_temporary_v<T, U>>>
+  RecordDelete<TParameterType>& AddCondition(const std::string& field_name,
+                                             SqlOperator op, U&& value) {
+    static_assert(
+        !details::binds_as_view_v<TParameterType, details::bound_type_t<T, U>>,
+        "a temporary string or vector would dangle in a view parameter "
+                  "type, bind an lvalue that outlives the values");
+    const auto& bound = details::ConvertBound<T>(std::forward<U>(value));
+    return AddCondition<details::bound_type_t<T, U>>(field_name, op, bound);
+  }
+
   RecordDelete<TParameterType>& AddReturning(const std::string& column_name) {
-    if (!returning_clause_.str().empty()) {
+    if (returning_clause_.tellp() > 0) {
       returning_clause_ << ", ";
     }
 
@@ -28,36 +28,41 @@
 #include <unordered_map>
 
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/query_arena.h"
 #include "nvm/sqlbuilder/policy/order_by.h"
 
 namespace nvm::sqlbuilder {
 struct OrderByClause {
-  std::string field_name_;
-  std::optional<std::string> table_alias;
+  // interned in the QueryArena of the select
+  std::string_view field_name_;
+  std::string_view table_alias;
   uint32_t level_;
   SortType sort_type_;
   bool define_sort_type_;
 
-  explicit OrderByClause(const std::string& field_name, SortType sort,
-                         bool define_sort_type, uint32_t level)
-                  : field_name_(field_name),
-                    table_alias(std::nullopt),
+  explicit OrderByClause(QueryArena& arena, std::string_view field_name,
+                         SortType sort, bool define_sort_type, uint32_t level)
+                  : field_name_(arena.Name(field_name)),
+                    table_alias(),
+                    level_(level),
                     sort_type_(sort),
-                    define_sort_type_(define_sort_type),
-                    level_(level) {}
-
-  explicit OrderByClause(const std::string& field_name,
-                         const std::optional<std::string>& alias, SortType sort,
-                         bool define_sort_type, uint32_t level)
-                  : field_name_(field_name),
-                    table_alias(alias),
+                    define_sort_type_(define_sort_type) {}
+
+  explicit OrderByClause(QueryArena& arena, std::string_view field_name,
+                         const std::optional<std::string_view>& alias,
+                         SortType sort, bool define_sort_type, uint32_t level)
+                  : field_name_(arena.Name(field_name)),
+                    table_alias(arena.OptionalName(alias)),
+                    level_(level),
                     sort_type_(sort),
-                    define_sort_type_(define_sort_type),
-                    level_(level) {}
+                    define_sort_type_(define_sort_type) {}
 
   std::string BuildFieldname() const {
-    return table_alias.has_value() ? table_alias.value() + "." + field_name_
-                                   : field_name_;
+    std::string out;
+    if (HasName(table_alias)) {
+      out.append(table_alias).push_back('.');
+    }
+    return out.append(field_name_);
   }
 
   std::string GenerateQuery() const {
@@ -66,57 +71,119 @@ struct OrderByClause {
                 ? (sort_type_ == SortType::Ascending ? " ASC" : " DESC")
                 : "");
   }
+
+  void AppendFieldname(SqlWriter& out) const {
+    if (HasName(table_alias)) {
+      out.Append(table_alias).Append('.');
+    }
+    out.Append(field_name_);
+  }
+
+  void AppendQuery(SqlWriter& out) const {
+    AppendFieldname(out);
+    if (define_sort_type_) {
+      out.Append(sort_type_ == SortType::Ascending ? " ASC" : " DESC");
+    }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher
+        .AddUInt(static_cast<uint64_t>(sort_type_) |
+                 static_cast<uint64_t>(define_sort_type_) << 8)
+        .AddString(field_name_)
+        .AddName(table_alias);
+  }
+
+  void Fingerprint(StatementFingerprint& fingerprint) const {
+    fingerprint
+        .AddUInt(static_cast<uint64_t>(sort_type_) |
+                 static_cast<uint64_t>(define_sort_type_) << 8)
+        .AddString(field_name_)
+        .AddName(table_alias);
+  }
 };
 
 template <typename TParameterType>
 class OrderByStatement {
  public:
-  OrderByStatement() : parent_(nullptr), sorts_(), level_() {}
-
-  explicit OrderByStatement(NvSelect<TParameterType>* parent, uint32_t level)
-                  : parent_(parent), sorts_(), level_(level) {}
+  OrderByStatement()
+                  : arena_(std::make_shared<QueryArena>()),
+                    parent_(nullptr),
+                    sorts_(arena_->Vector<OrderByClause>()),
+                    level_(),
+                    fingerprint_() {}
+
+  explicit OrderByStatement(std::shared_ptr<QueryArena> arena,
+                            NvSelect<TParameterType>* parent, uint32_t level)
+                  : arena_(std::move(arena)),
+                    parent_(parent),
+                    sorts_(arena_->Vector<OrderByClause>()),
+                    level_(level),
+                    fingerprint_() {}
 
   OrderByStatement& ApplyFrom(
       const policy::OrderByPolicyParameter<TParameterType>& parameters);
 
   OrderByStatement& Asc(
-      const std::string& field_name,
-      const std::optional<std::string>& table_alias = std::nullopt,
+      std::string_view field_name,
+      const std::optional<std::string_view>& table_alias = std::nullopt,
       bool define_sort_type = true) {
     return By(field_name, table_alias, SortType::Ascending, define_sort_type);
   }
 
   OrderByStatement& Desc(
-      const std::string& field_name,
-      const std::optional<std::string>& table_alias = std::nullopt,
+      std::string_view field_name,
+      const std::optional<std::string_view>& table_alias = std::nullopt,
       bool define_sort_type = true) {
     return By(field_name, table_alias, SortType::Descending, define_sort_type);
   }
 
   OrderByStatement& By(
-      const std::string& field_name,
-      const std::optional<std::string>& table_alias = std::nullopt,
+      std::string_view field_name,
+      const std::optional<std::string_view>& table_alias = std::nullopt,
       const SortType sort_type = SortType::Ascending,
       bool define_sort_type = true) {
-    sorts_.emplace_back(field_name, table_alias, sort_type, define_sort_type,
-                        level_);
+    sorts_.emplace_back(*arena_, field_name, table_alias, sort_type,
+                        define_sort_type, level_);
+    sorts_.back().Fingerprint(fingerprint_);
 
     return *this;
   }
 
   std::string GenerateQuery(bool pretty_print = false) const {
-    std::ostringstream query;
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
+
+  void AppendQuery(SqlWriter& out, bool pretty_print = false) const {
     bool is_first_element = true;
 
     for (auto& s : sorts_) {
       if (!is_first_element)
-        query << ", ";
+        out.Append(", ");
 
-      query << s.GenerateQuery();
+      s.AppendQuery(out);
       is_first_element = false;
     }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddUInt(sorts_.size());
+    for (const auto& s : sorts_) {
+      s.HashShape(hasher);
+    }
+  }
+
+  size_t Size() const {
+    return sorts_.size();
+  }
+
+  uint64_t Fingerprint() const {
+    return fingerprint_.Value();
+  }
 
-    return query.str();
+  const ArenaVector<OrderByClause>& Clauses() const {
+    return sorts_;
   }
 
   NvSelect<TParameterType>& EndOrderByBlock() {
@@ -128,9 +195,11 @@ class OrderByStatement {
   }
 
  private:
+  std::shared_ptr<QueryArena> arena_;
   NvSelect<TParameterType>* parent_;
-  std::vector<OrderByClause> sorts_;
+  ArenaVector<OrderByClause> sorts_;
   uint32_t level_;
+  StatementFingerprint fingerprint_;
 };
 
 }  // namespace nvm::sqlbuilder
\ No newline at end of file
@@ -0,0 +1,366 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include "nvm/span.h"
+#include "nvm/sqlbuilder/def.h"
+
+namespace nvm::sqlbuilder {
+
+/// @brief What a slot of a ParameterBuffer holds.
+enum class ParameterKind : uint8_t {
+  kNull = 0,
+  kInt32,
+  kInt64,
+  kFloat32,
+  kFloat64,
+  kText,
+  kBool,
+  kTimestamp,
+  kInt32Array,
+  kBytes,
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(ParameterKind)
+
+namespace details {
+
+template <typename T>
+struct is_span : std::false_type {};
+
+template <typename T>
+struct is_span<Span<T>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_int32_list_v =
+    std::is_same_v<T, std::vector<int>> || std::is_same_v<T, Span<const int>> ||
+    std::is_same_v<T, Span<int>>;
+
+template <typename T>
+constexpr bool is_byte_list_v = std::is_same_v<T, std::vector<unsigned char>> ||
+                                std::is_same_v<T, Span<const unsigned char>> ||
+                                std::is_same_v<T, Span<unsigned char>>;
+
+/// @brief Kind of one bound C++ type, kNull for types the buffer does not
+/// know.
+template <typename T>
+constexpr ParameterKind KindOf() {
+  if constexpr (std::is_same_v<T, bool>) {
+    return ParameterKind::kBool;
+  } else if constexpr (std::is_integral_v<T> && sizeof(T) <= 4) {
+    return ParameterKind::kInt32;
+  } else if constexpr (std::is_integral_v<T>) {
+    return ParameterKind::kInt64;
+  } else if constexpr (std::is_same_v<T, float>) {
+    return ParameterKind::kFloat32;
+  } else if constexpr (std::is_floating_point_v<T>) {
+    return ParameterKind::kFloat64;
+  } else if constexpr (std::is_same_v<T, std::string> ||
+                       std::is_same_v<T, std::string_view>) {
+    return ParameterKind::kText;
+  } else if constexpr (std::is_same_v<T,
+                                      std::chrono::system_clock::time_point>) {
+    return ParameterKind::kTimestamp;
+  } else if constexpr (is_int32_list_v<T>) {
+    return ParameterKind::kInt32Array;
+  } else if constexpr (is_byte_list_v<T>) {
+    return ParameterKind::kBytes;
+  } else {
+    return ParameterKind::kNull;
+  }
+}
+
+/// @brief Microseconds since 1970-01-01 00:00:00 UTC.
+inline int64_t UnixMicros(std::chrono::system_clock::time_point value) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             value.time_since_epoch())
+      .count();
+}
+
+template <typename TList>
+size_t ListSize(const TList& list) noexcept {
+  if constexpr (is_span<TList>::value) {
+    return list.Size();
+  } else {
+    return list.size();
+  }
+}
+
+template <typename TList>
+auto ListData(const TList& list) noexcept {
+  if constexpr (is_span<TList>::value) {
+    return list.Data();
+  } else {
+    return list.data();
+  }
+}
+
+template <typename T>
+void AppendTextNumber(std::string& out, T value) {
+  char text[32];
+  auto result = std::to_chars(text, text + sizeof(text), value);
+  out.append(text, static_cast<size_t>(result.ptr - text));
+}
+
+inline void AppendTextPadded(std::string& out, int64_t value, size_t width) {
+  char text[24];
+  auto result = std::to_chars(text, text + sizeof(text), value);
+  size_t size = static_cast<size_t>(result.ptr - text);
+  if (size < width) {
+    out.append(width - size, '0');
+  }
+  out.append(text, size);
+}
+
+/// @brief UTC as YYYY-MM-DD HH:MM:SS.ffffff+00, valid for timestamptz and
+/// timestamp columns.
+inline void AppendTextTimestamp(std::string& out, int64_t micros) {
+  int64_t days = micros / 86400000000LL;
+  int64_t rest = micros % 86400000000LL;
+  if (rest < 0) {
+    rest += 86400000000LL;
+    days -= 1;
+  }
+
+  // civil date from days since 1970-01-01, proleptic Gregorian
+  days += 719468;
+  int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+  int64_t doe = days - era * 146097;
+  int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  int64_t mp = (5 * doy + 2) / 153;
+  int64_t day = doy - (153 * mp + 2) / 5 + 1;
+  int64_t month = mp < 10 ? mp + 3 : mp - 9;
+  int64_t year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+  int64_t seconds = rest / 1000000;
+  AppendTextPadded(out, year, 4);
+  out.push_back('-');
+  AppendTextPadded(out, month, 2);
+  out.push_back('-');
+  AppendTextPadded(out, day, 2);
+  out.push_back(' ');
+  AppendTextPadded(out, seconds / 3600, 2);
+  out.push_back(':');
+  AppendTextPadded(out, seconds / 60 % 60, 2);
+  out.push_back(':');
+  AppendTextPadded(out, seconds % 60, 2);
+  out.push_back('.');
+  AppendTextPadded(out, rest % 1000000, 6);
+  out.append("+00");
+}
+
+/// @brief Append value in the PostgreSQL text format: int lists as array
+/// literals, bytes as hex bytea, bool as t/f. T must have a kind other than
+/// kNull.
+template <typename T>
+void AppendPostgresText(std::string& out, const T& value) {
+  constexpr ParameterKind kind = KindOf<T>();
+  static_assert(kind != ParameterKind::kNull, "T has no text format");
+  if constexpr (kind == ParameterKind::kText) {
+    out.append(value.data(), value.size());
+  } else if constexpr (kind == ParameterKind::kBool) {
+    out.push_back(value ? 't' : 'f');
+  } else if constexpr (kind == ParameterKind::kTimestamp) {
+    AppendTextTimestamp(out, UnixMicros(value));
+  } else if constexpr (kind == ParameterKind::kInt32Array) {
+    const int* items = ListData(value);
+    out.push_back('{');
+    for (size_t i = 0; i < ListSize(value); ++i) {
+      if (i > 0) {
+        out.push_back(',');
+      }
+      AppendTextNumber(out, items[i]);
+    }
+    out.push_back('}');
+  } else if constexpr (kind == ParameterKind::kBytes) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    const unsigned char* items = ListData(value);
+    out.append("\\x");
+    for (size_t i = 0; i < ListSize(value); ++i) {
+      out.push_back(kHex[items[i] >> 4]);
+      out.push_back(kHex[items[i] & 0x0f]);
+    }
+  } else {
+    AppendTextNumber(out, value);
+  }
+}
+
+}  // namespace details
+
+/// @brief Flat, columnar copy of a parameter list in the PostgreSQL text
+/// format. Every value is written once into a single data block, the per
+/// slot kinds, offsets and lengths sit in their own arrays and Values() is
+/// the pointer array libpq takes as paramValues:
+/// @example
+/// ```cxx
+/// ParameterBuffer params;
+/// params.Assign(*select.Values());
+/// PQexecParams(conn, sql.c_str(), params.Size(), nullptr, params.Values(),
+///              params.Lengths(), nullptr, 0);
+/// ```
+/// Combined with a view parameter type (DefaultPostgresViewParamType) caller
+/// owned strings and arrays are never copied before they reach this buffer.
+/// Reuse one buffer per connection, Assign() keeps the capacity.
+class ParameterBuffer {
+ private:
+  std::vector<ParameterKind> kinds_;
+  std::vector<uint32_t> offsets_;
+  std::vector<int> lengths_;
+  std::vector<const char*> values_;
+  // every value followed by a NUL, text parameters are read as C strings
+  std::string data_;
+
+ public:
+  ParameterBuffer() = default;
+
+  /// @brief Replace the content with values.
+  /// @throw std::invalid_argument for a type the buffer does not know
+  /// @throw std::length_error when the data block exceeds 4 GiB
+  template <typename TParameterType>
+  void Assign(const std::vector<TParameterType>& values) {
+    Clear();
+    kinds_.reserve(values.size());
+    offsets_.reserve(values.size());
+    lengths_.reserve(values.size());
+    data_.reserve(MeasureHint(values));
+    for (const auto& value : values) {
+      std::visit([this](const auto& v) { Append(v); }, value);
+    }
+    Seal();
+  }
+
+  void Clear() noexcept {
+    kinds_.clear();
+    offsets_.clear();
+    lengths_.clear();
+    values_.clear();
+    data_.clear();
+  }
+
+  size_t Size() const noexcept {
+    return kinds_.size();
+  }
+
+  ParameterKind Kind(size_t index) const {
+    return kinds_.at(index);
+  }
+
+  /// @brief Text of slot index, without the trailing NUL.
+  std::string_view Value(size_t index) const {
+    return std::string_view(data_.data() + offsets_.at(index),
+                            static_cast<size_t>(lengths_.at(index)));
+  }
+
+  const ParameterKind* Kinds() const noexcept {
+    return kinds_.data();
+  }
+
+  const uint32_t* Offsets() const noexcept {
+    return offsets_.data();
+  }
+
+  const int* Lengths() const noexcept {
+    return lengths_.data();
+  }
+
+  /// @brief One NUL terminated pointer per slot, nullptr for SQL NULL.
+  const char* const* Values() const noexcept {
+    return values_.data();
+  }
+
+  /// @brief The data block all values point into.
+  std::string_view Data() const noexcept {
+    return data_;
+  }
+
+ private:
+  template <typename TParameterType>
+  static size_t MeasureHint(const std::vector<TParameterType>& values) {
+    size_t bytes = 0;
+    for (const auto& value : values) {
+      bytes += std::visit(
+          [](const auto& v) -> size_t {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::string> ||
+                          std::is_same_v<T, std::string_view>) {
+              return v.size() + 1;
+            } else if constexpr (details::is_byte_list_v<T>) {
+              return details::ListSize(v) * 2 + 3;
+            } else if constexpr (details::is_int32_list_v<T>) {
+              return details::ListSize(v) * 12 + 3;
+            } else {
+              // longest scalar text is a timestamp
+              return 33;
+            }
+          },
+          value);
+    }
+    return bytes;
+  }
+
+  template <typename T>
+  void Append(const T& value) {
+    constexpr ParameterKind kind = details::KindOf<T>();
+    if constexpr (std::is_same_v<T, std::monostate>) {
+      kinds_.push_back(ParameterKind::kNull);
+      offsets_.push_back(static_cast<uint32_t>(data_.size()));
+      lengths_.push_back(0);
+      return;
+    } else if constexpr (kind == ParameterKind::kNull) {
+      throw std::invalid_argument(
+          "ParameterBuffer: unsupported parameter type");
+    } else {
+      size_t offset = data_.size();
+      details::AppendPostgresText(data_, value);
+      if (data_.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("ParameterBuffer: data block exceeds 4 GiB");
+      }
+      kinds_.push_back(kind);
+      offsets_.push_back(static_cast<uint32_t>(offset));
+      lengths_.push_back(static_cast<int>(data_.size() - offset));
+      data_.push_back('\0');
+    }
+  }
+
+  // data_ does not move any more, point into it
+  void Seal() {
+    values_.resize(kinds_.size());
+    for (size_t i = 0; i < kinds_.size(); ++i) {
+      values_[i] = kinds_[i] == ParameterKind::kNull
+                       ? nullptr
+                       : data_.data() + offsets_[i];
+    }
+  }
+};
+
+}  // namespace nvm::sqlbuilder
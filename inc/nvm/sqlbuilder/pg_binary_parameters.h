@@ -0,0 +1,353 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "nvm/bytes/byte_declaration.h"
+#include "nvm/bytes/details/internal_unchecked.h"
+#include "nvm/memory/buffer_pool.h"
+#include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/parameter_buffer.h"
+
+namespace nvm::sqlbuilder {
+
+/// @brief Type OIDs from pg_type.dat the binary encoder emits.
+namespace pg_oid {
+constexpr uint32_t kUnspecified = 0;
+constexpr uint32_t kBool = 16;
+constexpr uint32_t kBytea = 17;
+constexpr uint32_t kInt8 = 20;
+constexpr uint32_t kInt4 = 23;
+constexpr uint32_t kText = 25;
+constexpr uint32_t kFloat4 = 700;
+constexpr uint32_t kFloat8 = 701;
+constexpr uint32_t kInt4Array = 1007;
+constexpr uint32_t kTimestampTz = 1184;
+}  // namespace pg_oid
+
+/// @brief 2000-01-01 00:00:00 UTC, the PostgreSQL epoch, in Unix
+/// microseconds.
+constexpr int64_t kPostgresEpochUnixMicros = 946684800LL * 1000000LL;
+
+namespace details {
+
+/// @brief Type OID sent for T, kUnspecified for unknown types.
+template <typename T>
+constexpr uint32_t PostgresOidOf() {
+  constexpr ParameterKind kind = KindOf<T>();
+  if constexpr (kind == ParameterKind::kInt32) {
+    return pg_oid::kInt4;
+  } else if constexpr (kind == ParameterKind::kInt64) {
+    return pg_oid::kInt8;
+  } else if constexpr (kind == ParameterKind::kFloat32) {
+    return pg_oid::kFloat4;
+  } else if constexpr (kind == ParameterKind::kFloat64) {
+    return pg_oid::kFloat8;
+  } else if constexpr (kind == ParameterKind::kText) {
+    return pg_oid::kText;
+  } else if constexpr (kind == ParameterKind::kBool) {
+    return pg_oid::kBool;
+  } else if constexpr (kind == ParameterKind::kTimestamp) {
+    return pg_oid::kTimestampTz;
+  } else if constexpr (kind == ParameterKind::kInt32Array) {
+    return pg_oid::kInt4Array;
+  } else if constexpr (kind == ParameterKind::kBytes) {
+    return pg_oid::kBytea;
+  } else {
+    return pg_oid::kUnspecified;
+  }
+}
+
+/// @brief Bytes of value in the binary format, the field length.
+/// @throw std::invalid_argument for a type without a binary encoding
+template <typename T>
+size_t PostgresBinarySize(const T& value) {
+  constexpr ParameterKind kind = KindOf<T>();
+  if constexpr (std::is_same_v<T, std::monostate>) {
+    return 0;
+  } else if constexpr (kind == ParameterKind::kNull) {
+    throw std::invalid_argument(
+        "PostgreSQL binary format: unsupported parameter type");
+  } else if constexpr (kind == ParameterKind::kInt32 ||
+                       kind == ParameterKind::kFloat32) {
+    return 4;
+  } else if constexpr (kind == ParameterKind::kInt64 ||
+                       kind == ParameterKind::kFloat64 ||
+                       kind == ParameterKind::kTimestamp) {
+    return 8;
+  } else if constexpr (kind == ParameterKind::kBool) {
+    return 1;
+  } else if constexpr (kind == ParameterKind::kText) {
+    return value.size();
+  } else if constexpr (kind == ParameterKind::kBytes) {
+    return ListSize(value);
+  } else {
+    // ndim, has-null flag, element type, then dimension and lower bound
+    size_t count = ListSize(value);
+    return count == 0 ? 12 : 20 + count * 8;
+  }
+}
+
+template <typename T>
+inline uint8_t* PutBigEndian(T value, uint8_t* p) noexcept {
+  bytes::details::unchecked::Store<T>(value, p, true);
+  return p + sizeof(T);
+}
+
+/// @brief Write value at p, p must hold PostgresBinarySize(value) bytes.
+/// @return the end of the value
+template <typename T>
+uint8_t* WritePostgresBinary(const T& value, uint8_t* p) {
+  constexpr ParameterKind kind = KindOf<T>();
+  if constexpr (kind == ParameterKind::kInt32) {
+    return PutBigEndian<int32_t>(static_cast<int32_t>(value), p);
+  } else if constexpr (kind == ParameterKind::kInt64) {
+    return PutBigEndian<int64_t>(static_cast<int64_t>(value), p);
+  } else if constexpr (kind == ParameterKind::kFloat32) {
+    return PutBigEndian<float>(value, p);
+  } else if constexpr (kind == ParameterKind::kFloat64) {
+    return PutBigEndian<double>(static_cast<double>(value), p);
+  } else if constexpr (kind == ParameterKind::kBool) {
+    *p = value ? 1 : 0;
+    return p + 1;
+  } else if constexpr (kind == ParameterKind::kTimestamp) {
+    return PutBigEndian<int64_t>(
+        UnixMicros(value) - kPostgresEpochUnixMicros, p);
+  } else if constexpr (kind == ParameterKind::kText ||
+                       kind == ParameterKind::kBytes) {
+    size_t size = ListSize(value);
+    if (size > 0) {
+      std::memcpy(p, ListData(value), size);
+    }
+    return p + size;
+  } else if constexpr (kind == ParameterKind::kInt32Array) {
+    size_t count = ListSize(value);
+    const int* items = ListData(value);
+    p = PutBigEndian<int32_t>(count == 0 ? 0 : 1, p);
+    p = PutBigEndian<int32_t>(0, p);
+    p = PutBigEndian<uint32_t>(pg_oid::kInt4, p);
+    if (count == 0) {
+      return p;
+    }
+    p = PutBigEndian<int32_t>(static_cast<int32_t>(count), p);
+    p = PutBigEndian<int32_t>(1, p);
+    for (size_t i = 0; i < count; ++i) {
+      p = PutBigEndian<int32_t>(4, p);
+      p = PutBigEndian<int32_t>(items[i], p);
+    }
+    return p;
+  } else {
+    // rejected by PostgresBinarySize()
+    return p;
+  }
+}
+
+}  // namespace details
+
+/// @brief One encoded parameter, the bytes point into the owning
+/// PostgresBinaryParameters.
+struct PostgresBinaryValue {
+  uint32_t type;
+  Span<const uint8_t> bytes;
+  bool is_null;
+};
+
+/// @brief Parameters in the PostgreSQL binary wire format, ready for
+/// PQexecParams / PQexecPrepared:
+/// @example
+/// ```cxx
+/// auto params = parser.Encode();
+/// PQexecParams(conn, sql.c_str(), params.Size(), params.Types(),
+///              params.Values(), params.Lengths(), params.Formats(), 0);
+/// ```
+/// All values live in one buffer, a pooled slab when the parser has a pool
+/// and the values fit, a heap block otherwise. Move only, the arrays stay
+/// valid as long as this object lives.
+class PostgresBinaryParameters {
+ private:
+  memory::PooledBuffer pooled_;
+  std::vector<uint8_t> heap_;
+  std::vector<const char*> values_;
+  std::vector<int> lengths_;
+  std::vector<int> formats_;
+  std::vector<uint32_t> types_;
+  const uint8_t* data_;
+  size_t size_;
+
+  template <typename TParameterType>
+  friend class PostgresBinaryParameterParser;
+
+ public:
+  PostgresBinaryParameters() noexcept : data_(nullptr), size_(0) {}
+
+  PostgresBinaryParameters(PostgresBinaryParameters&&) noexcept = default;
+  PostgresBinaryParameters& operator=(PostgresBinaryParameters&&) noexcept =
+      default;
+
+  /// @brief Number of parameters, nParams.
+  int Size() const noexcept {
+    return static_cast<int>(types_.size());
+  }
+
+  /// @brief paramValues, nullptr for SQL NULL.
+  const char* const* Values() const noexcept {
+    return values_.data();
+  }
+
+  /// @brief paramLengths in bytes.
+  const int* Lengths() const noexcept {
+    return lengths_.data();
+  }
+
+  /// @brief paramFormats, always 1 (binary).
+  const int* Formats() const noexcept {
+    return formats_.data();
+  }
+
+  /// @brief paramTypes, pass as const Oid*.
+  const uint32_t* Types() const noexcept {
+    return types_.data();
+  }
+
+  /// @brief The buffer every value points into.
+  Span<const uint8_t> Data() const noexcept {
+    return Span<const uint8_t>(data_, size_);
+  }
+
+  /// @brief True when the values sit in a pooled slab.
+  bool IsPooled() const noexcept {
+    return !pooled_.Empty();
+  }
+
+  PostgresBinaryValue At(size_t index) const {
+    const char* value = values_.at(index);
+    return PostgresBinaryValue{
+        types_[index],
+        Span<const uint8_t>(reinterpret_cast<const uint8_t*>(value),
+                            static_cast<size_t>(lengths_[index])),
+        value == nullptr};
+  }
+};
+
+/// @brief ParameterParser emitting the PostgreSQL binary format. Numbers are
+/// written big-endian, timestamps as microseconds since 2000-01-01 UTC
+/// (timestamptz), int lists as one-dimensional int4[], so neither side
+/// formats or parses text.
+/// Parse<PostgresBinaryValue>() goes through the ParameterParser interface,
+/// Encode() gives the libpq arrays directly.
+template <typename TParameterType = DefaultPostgresParamType>
+class PostgresBinaryParameterParser : public ParameterParser<TParameterType> {
+ private:
+  std::shared_ptr<memory::BufferPool> pool_;
+
+ public:
+  /// @param parameter_values
+  /// @param pool slabs to encode into, nullptr to always use the heap
+  explicit PostgresBinaryParameterParser(
+      std::shared_ptr<std::vector<TParameterType>> parameter_values,
+      std::shared_ptr<memory::BufferPool> pool = nullptr)
+                  : ParameterParser<TParameterType>(
+                        std::move(parameter_values)),
+                    pool_(std::move(pool)) {}
+
+  /// @throw std::invalid_argument for a type without a binary encoding
+  /// @throw std::length_error when a value exceeds 2 GiB
+  PostgresBinaryParameters Encode() const {
+    const auto& values = *this->parameter_values_;
+    PostgresBinaryParameters out;
+    out.values_.reserve(values.size());
+    out.lengths_.reserve(values.size());
+    out.formats_.assign(values.size(), 1);
+    out.types_.reserve(values.size());
+
+    size_t total = 0;
+    for (const auto& value : values) {
+      size_t size = std::visit(
+          [](const auto& v) { return details::PostgresBinarySize(v); }, value);
+      if (size > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        throw std::length_error(
+            "PostgresBinaryParameterParser: value exceeds 2 GiB");
+      }
+      total += size;
+    }
+
+    uint8_t* data = nullptr;
+    if (pool_ && total > 0 && total <= pool_->SlabSize()) {
+      out.pooled_ = pool_->Allocate();
+      out.pooled_.Resize(total);
+      data = out.pooled_.Data();
+    } else {
+      // never empty, a zero length value still needs a non-null pointer
+      out.heap_.resize(total == 0 ? 1 : total);
+      data = out.heap_.data();
+    }
+    out.data_ = data;
+    out.size_ = total;
+
+    uint8_t* p = data;
+    for (const auto& value : values) {
+      std::visit(
+          [&out, &p](const auto& v) {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+              out.values_.push_back(nullptr);
+              out.lengths_.push_back(0);
+              out.types_.push_back(pg_oid::kUnspecified);
+            } else {
+              uint8_t* end = details::WritePostgresBinary(v, p);
+              out.values_.push_back(reinterpret_cast<const char*>(p));
+              out.lengths_.push_back(static_cast<int>(end - p));
+              out.types_.push_back(details::PostgresOidOf<T>());
+              p = end;
+            }
+          },
+          value);
+    }
+    return out;
+  }
+
+ protected:
+  std::shared_ptr<void> ParseImplInternal() const override {
+    struct Holder {
+      PostgresBinaryParameters parameters;
+      std::vector<PostgresBinaryValue> values;
+    };
+    auto holder = std::make_shared<Holder>();
+    holder->parameters = Encode();
+    holder->values.reserve(holder->parameters.types_.size());
+    for (size_t i = 0; i < holder->parameters.types_.size(); ++i) {
+      holder->values.push_back(holder->parameters.At(i));
+    }
+    // the values keep the encoded buffer alive
+    return std::shared_ptr<std::vector<PostgresBinaryValue>>(holder,
+                                                             &holder->values);
+  }
+};
+
+}  // namespace nvm::sqlbuilder
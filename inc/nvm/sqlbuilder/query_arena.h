@@ -0,0 +1,219 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "nvm/memory/arena.h"
+#include "nvm/span.h"
+#include "nvm/sqlbuilder/def.h"
+
+namespace nvm::sqlbuilder {
+
+template <typename T>
+using ArenaVector = std::vector<T, memory::ArenaAllocator<T>>;
+
+/// @brief Memory of one query tree. The statement blocks, clause lists and
+/// identifiers of an NvSelect and all of its subqueries come from this
+/// arena, identifiers are interned so a table alias used by ten clauses is
+/// stored once. An NvSelect creates a private arena by default, pass one in
+/// to reuse its blocks across queries:
+/// @example
+/// ```cxx
+/// auto arena = std::make_shared<QueryArena>();
+/// for (const auto& request : requests) {
+///   {
+///     NvSelect<> select(arena);
+///     // ... build, render, execute
+///   }
+///   // every builder using the arena is gone, recycle it in one step
+///   arena->Reset();
+/// }
+/// ```
+/// Names are string_views, an absent optional name is a view without data
+/// and differs from an empty one.
+class QueryArena {
+ private:
+  memory::Arena memory_;
+  memory::StringInterner names_;
+
+ public:
+  explicit QueryArena(size_t block_size = memory::Arena::kDefaultBlockSize)
+                  : memory_(block_size), names_(memory_) {}
+
+  QueryArena(const QueryArena&) = delete;
+  QueryArena& operator=(const QueryArena&) = delete;
+
+  /// @brief Interned copy of value.
+  std::string_view Name(std::string_view value) {
+    return names_.Intern(value);
+  }
+
+  /// @brief Interned copy of value, nullopt stays absent.
+  std::string_view OptionalName(const std::optional<std::string_view>& value) {
+    return value.has_value() ? names_.Intern(value.value())
+                             : std::string_view();
+  }
+
+  template <typename T>
+  memory::ArenaAllocator<T> Allocator() noexcept {
+    return memory::ArenaAllocator<T>(&memory_);
+  }
+
+  template <typename T>
+  ArenaVector<T> Vector() noexcept {
+    return ArenaVector<T>(Allocator<T>());
+  }
+
+  /// @brief Object and control block in the arena. The object is destroyed
+  /// with the last owner as usual, only the memory stays until Reset().
+  template <typename T, typename... Args>
+  std::shared_ptr<T> MakeShared(Args&&... args) {
+    return std::allocate_shared<T>(Allocator<T>(),
+                                   std::forward<Args>(args)...);
+  }
+
+  /// @brief Plain copy of value, not interned. For parameter text that only
+  /// a view parameter type would reference.
+  std::string_view CopyString(std::string_view value) {
+    return memory_.CopyString(value);
+  }
+
+  /// @brief Copy of values as one array, lives until Reset().
+  template <typename T>
+  Span<const T> CopyArray(const std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "arena arrays are never destroyed");
+    if (values.empty()) {
+      return Span<const T>();
+    }
+    auto data = static_cast<T*>(
+        memory_.Allocate(values.size() * sizeof(T), alignof(T)));
+    std::memcpy(data, values.data(), values.size() * sizeof(T));
+    return Span<const T>(data, values.size());
+  }
+
+  /// @brief Intern every value.
+  ArenaVector<std::string_view> Names(const std::vector<std::string>& values) {
+    auto names = Vector<std::string_view>();
+    names.reserve(values.size());
+    for (const auto& value : values) {
+      names.push_back(Name(value));
+    }
+    return names;
+  }
+
+  size_t BytesUsed() const noexcept {
+    return memory_.BytesUsed();
+  }
+
+  size_t BytesReserved() const noexcept {
+    return memory_.BytesReserved();
+  }
+
+  /// @brief Distinct identifiers stored.
+  size_t NameCount() const noexcept {
+    return names_.Size();
+  }
+
+  /// @brief Drop every node and name at once. Only call it when no builder
+  /// built on this arena is alive any more.
+  void Reset() noexcept {
+    names_.Clear();
+    memory_.Reset();
+  }
+};
+
+/// @brief value as TParameterType. A temporary that the parameter type would
+/// only view (see details::binds_as_view) is copied into arena first, the
+/// bound value then lives as long as the arena.
+template <typename TParameterType, typename T>
+TParameterType BindParameter(QueryArena& arena, T&& value) {
+  using TValue = std::decay_t<T>;
+  if constexpr (!std::is_lvalue_reference<T>::value &&
+                details::binds_as_view_v<TParameterType, TValue>) {
+    if constexpr (std::is_same<TValue, std::string>::value) {
+      return TParameterType(arena.CopyString(value));
+    } else {
+      return TParameterType(arena.CopyArray(value));
+    }
+  } else {
+    return TParameterType(std::forward<T>(value));
+  }
+}
+
+inline bool HasName(std::string_view name) noexcept {
+  return name.data() != nullptr;
+}
+
+inline std::optional<std::string_view> AsOptional(std::string_view name) {
+  return HasName(name) ? std::optional<std::string_view>(name) : std::nullopt;
+}
+
+/// @brief Interned table, field and alias of a join or FROM entry, the tree
+/// keeps these instead of copying RecordKey.
+struct NameKey {
+  std::string_view table;
+  std::string_view field;
+  std::string_view table_alias;
+
+  NameKey() noexcept : table(), field(), table_alias() {}
+
+  NameKey(QueryArena& arena, std::string_view table, std::string_view field,
+          const std::optional<std::string_view>& alias)
+                  : table(arena.Name(table)),
+                    field(arena.Name(field)),
+                    table_alias(arena.OptionalName(alias)) {}
+
+  NameKey(QueryArena& arena, const RecordKey& key)
+                  : table(arena.Name(key.table)),
+                    field(arena.Name(key.field)),
+                    table_alias(arena.OptionalName(key.table_alias)) {}
+
+  void AppendField(SqlWriter& out) const {
+    out.Append(HasName(table_alias) ? table_alias : table)
+        .Append('.')
+        .Append(field);
+  }
+
+  void AppendTableName(SqlWriter& out) const {
+    out.Append(table);
+    if (HasName(table_alias)) {
+      out.Append(" AS ").Append(table_alias);
+    }
+  }
+
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddString(table).AddString(field).AddName(table_alias);
+  }
+
+  void Fingerprint(StatementFingerprint& fingerprint) const {
+    fingerprint.AddString(table).AddString(field).AddName(table_alias);
+  }
+};
+
+}  // namespace nvm::sqlbuilder
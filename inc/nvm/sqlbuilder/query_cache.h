@@ -0,0 +1,390 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "nvm/bytes/hash.h"
+#include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/nv_select_builder.h"
+
+namespace nvm::sqlbuilder {
+
+/// @brief Immutable rendered statement of one query shape. Share it freely
+/// between threads, pair Sql() with the Values() of any builder that has
+/// the same ShapeKey().
+template <typename TParameterType = DefaultPostgresParamType>
+class QueryTemplate final {
+ private:
+  bytes::Hash128Value key_;
+  std::string sql_;
+  size_t parameter_count_;
+  DatabaseDialect dialect_;
+  bool pretty_print_;
+
+ public:
+  explicit QueryTemplate(const bytes::Hash128Value& key, std::string sql,
+                         size_t parameter_count, DatabaseDialect dialect,
+                         bool pretty_print)
+                  : key_(key),
+                    sql_(std::move(sql)),
+                    parameter_count_(parameter_count),
+                    dialect_(dialect),
+                    pretty_print_(pretty_print) {}
+
+  /// @brief Render select once and keep the text.
+  /// @param select
+  /// @param pretty_print
+  /// @return
+  static QueryTemplate From(const NvSelect<TParameterType>& select,
+                            bool pretty_print = false) {
+    return QueryTemplate(select.ShapeKey(pretty_print),
+                         select.GenerateQuery(pretty_print),
+                         select.Values()->size(), select.Dialect(),
+                         pretty_print);
+  }
+
+  const bytes::Hash128Value& Key() const {
+    return key_;
+  }
+
+  const std::string& Sql() const {
+    return sql_;
+  }
+
+  /// @brief Number of values a builder of this shape binds.
+  size_t ParameterCount() const {
+    return parameter_count_;
+  }
+
+  DatabaseDialect Dialect() const {
+    return dialect_;
+  }
+
+  bool PrettyPrint() const {
+    return pretty_print_;
+  }
+};
+
+/// @brief Statement and the values one caller binds to it. The statement is
+/// shared, the values belong to the instance.
+template <typename TParameterType = DefaultPostgresParamType>
+struct QueryInstance {
+  std::shared_ptr<const QueryTemplate<TParameterType>> statement;
+  std::vector<TParameterType> values;
+
+  const std::string& Sql() const {
+    return statement->Sql();
+  }
+};
+
+/// @brief Immutable snapshot of a built NvSelect, see NvSelect::Freeze().
+/// It holds the rendered statement and a copy of the parameter values the
+/// builder bound, not the tree. Nothing in it changes after construction,
+/// so any number of threads instantiate one shared FrozenSelect
+/// concurrently without locks, each with its own parameter set:
+/// @example
+/// ```cxx
+/// auto frozen = select.Freeze();
+/// pool->ExecuteTask([frozen, id]() {
+///   auto query = frozen->Instantiate();
+///   query.values[0] = id;
+///   db.Execute(query.Sql(), query.values);
+/// });
+/// ```
+/// Values are in placeholder order, slot i binds parameter i + 1. With a
+/// view parameter type the defaults still point at the caller's data.
+template <typename TParameterType = DefaultPostgresParamType>
+class FrozenSelect final {
+ public:
+  using Template = QueryTemplate<TParameterType>;
+  using TemplatePtr = std::shared_ptr<const Template>;
+
+  /// @throw std::invalid_argument when statement is null or does not bind
+  /// as many values as defaults holds
+  explicit FrozenSelect(TemplatePtr statement,
+                        std::vector<TParameterType> defaults,
+                        uint64_t fingerprint)
+                  : statement_(std::move(statement)),
+                    defaults_(std::move(defaults)),
+                    fingerprint_(fingerprint) {
+    if (!statement_) {
+      throw std::invalid_argument("FrozenSelect: statement must not be null");
+    }
+    if (statement_->ParameterCount() != defaults_.size()) {
+      throw std::invalid_argument(
+          "FrozenSelect: defaults do not match the statement");
+    }
+  }
+
+  /// @brief Render select once and copy its values.
+  static std::shared_ptr<const FrozenSelect> From(
+      const NvSelect<TParameterType>& select, bool pretty_print = false) {
+    return std::make_shared<const FrozenSelect>(
+        std::make_shared<const Template>(Template::From(select, pretty_print)),
+        *select.Values(), select.Fingerprint());
+  }
+
+  /// @brief Like From(select), the statement comes from cache and is shared
+  /// with every other builder of the same shape.
+  static std::shared_ptr<const FrozenSelect> From(
+      const NvSelect<TParameterType>& select,
+      QueryShapeCache<TParameterType>& cache, bool pretty_print = false) {
+    return std::make_shared<const FrozenSelect>(
+        cache.Acquire(select, pretty_print), *select.Values(),
+        select.Fingerprint());
+  }
+
+  /// @brief Instance bound to the values of the frozen builder, overwrite
+  /// the slots that differ.
+  QueryInstance<TParameterType> Instantiate() const {
+    return QueryInstance<TParameterType>{statement_, defaults_};
+  }
+
+  /// @brief Instance bound to values.
+  /// @throw std::invalid_argument when the number of values differs from
+  /// ParameterCount() or a value holds another type than the frozen one,
+  /// std::monostate (NULL) fits every slot
+  QueryInstance<TParameterType> Instantiate(
+      std::vector<TParameterType> values) const {
+    if (values.size() != defaults_.size()) {
+      throw std::invalid_argument(
+          "FrozenSelect: wrong number of parameter values");
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+      if (values[i].index() != defaults_[i].index() && !IsNull(values[i])) {
+        throw std::invalid_argument("FrozenSelect: parameter " +
+                                    std::to_string(i + 1) +
+                                    " has the wrong type");
+      }
+    }
+    return QueryInstance<TParameterType>{statement_, std::move(values)};
+  }
+
+  const TemplatePtr& Statement() const {
+    return statement_;
+  }
+
+  const std::string& Sql() const {
+    return statement_->Sql();
+  }
+
+  size_t ParameterCount() const {
+    return defaults_.size();
+  }
+
+  const std::vector<TParameterType>& Defaults() const {
+    return defaults_;
+  }
+
+  /// @brief NvSelect::Fingerprint() of the frozen builder.
+  uint64_t Fingerprint() const {
+    return fingerprint_;
+  }
+
+ private:
+  const TemplatePtr statement_;
+  const std::vector<TParameterType> defaults_;
+  const uint64_t fingerprint_;
+
+  static bool IsNull(const TParameterType& value) {
+    if constexpr (details::has_alternative_v<TParameterType,
+                                             std::monostate>) {
+      return std::holds_alternative<std::monostate>(value);
+    } else {
+      return false;
+    }
+  }
+};
+
+struct QueryCacheStats {
+  uint64_t hits;
+  uint64_t misses;
+  uint64_t evictions;
+  size_t size;
+  size_t capacity;
+
+  double HitRate() const {
+    uint64_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+  }
+};
+
+/// @brief Bounded LRU of rendered statements keyed by query shape. The key
+/// is computed from the builder tree (NvSelect::ShapeKey()), a hit skips
+/// GenerateQuery() completely and the caller only binds the builder's
+/// Values(). Safe to share between threads, rendering on a miss happens
+/// outside the lock.
+/// @example
+/// ```cxx
+/// static QueryShapeCache<> cache(512);
+///
+/// NvSelect<> select;
+/// select.Field<int32_t>("id").From().AddTable("users").EndFromTableBlock()
+///     .Where().AddCondition<int32_t>("id", SqlOperator::kEqual, id)
+///     .EndWhereBlock();
+/// auto statement = cache.Acquire(select);
+/// db.Execute(statement->Sql(), *select.Values());
+/// ```
+template <typename TParameterType = DefaultPostgresParamType>
+class QueryShapeCache {
+ public:
+  using Template = QueryTemplate<TParameterType>;
+  using TemplatePtr = std::shared_ptr<const Template>;
+
+  /// @throw std::invalid_argument when capacity is 0
+  explicit QueryShapeCache(size_t capacity)
+                  : mutex_(),
+                    entries_(),
+                    index_(),
+                    capacity_(capacity),
+                    hits_(0),
+                    misses_(0),
+                    evictions_(0) {
+    if (capacity_ == 0) {
+      throw std::invalid_argument("QueryShapeCache: capacity must not be 0");
+    }
+  }
+
+  QueryShapeCache(const QueryShapeCache&) = delete;
+  QueryShapeCache& operator=(const QueryShapeCache&) = delete;
+
+  /// @brief Template for the shape of select, rendered and inserted on a
+  /// miss.
+  /// @param select
+  /// @param pretty_print
+  /// @return never null
+  TemplatePtr Acquire(const NvSelect<TParameterType>& select,
+                      bool pretty_print = false) {
+    auto key = select.ShapeKey(pretty_print);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto found = index_.find(key);
+      if (found != index_.end()) {
+        entries_.splice(entries_.begin(), entries_, found->second);
+        ++hits_;
+        return found->second->second;
+      }
+      ++misses_;
+    }
+
+    auto rendered = std::make_shared<const Template>(
+        key, select.GenerateQuery(pretty_print), select.Values()->size(),
+        select.Dialect(), pretty_print);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    if (found != index_.end()) {
+      // another thread rendered the same shape meanwhile, keep the first
+      entries_.splice(entries_.begin(), entries_, found->second);
+      return found->second->second;
+    }
+
+    entries_.emplace_front(key, rendered);
+    index_.emplace(key, entries_.begin());
+    if (entries_.size() > capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+      ++evictions_;
+    }
+    return rendered;
+  }
+
+  /// @brief Cached template of key, nullptr when absent. Does not touch the
+  /// statistics or the LRU order.
+  TemplatePtr Find(const bytes::Hash128Value& key) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = index_.find(key);
+    return found == index_.end() ? nullptr : found->second->second;
+  }
+
+  QueryCacheStats Stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return QueryCacheStats{hits_, misses_, evictions_, entries_.size(),
+                           capacity_};
+  }
+
+  size_t Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+  }
+
+  size_t Capacity() const {
+    return capacity_;
+  }
+
+  /// @brief Drop every template and reset the statistics. Templates already
+  /// handed out stay valid.
+  void Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    entries_.clear();
+    hits_ = 0;
+    misses_ = 0;
+    evictions_ = 0;
+  }
+
+ private:
+  struct KeyHash {
+    size_t operator()(const bytes::Hash128Value& key) const noexcept {
+      return static_cast<size_t>(key.low);
+    }
+  };
+
+  using Entry = std::pair<bytes::Hash128Value, TemplatePtr>;
+
+  mutable std::mutex mutex_;
+  // most recently used first
+  std::list<Entry> entries_;
+  std::unordered_map<bytes::Hash128Value, typename std::list<Entry>::iterator,
+                     KeyHash>
+      index_;
+  const size_t capacity_;
+  uint64_t hits_;
+  uint64_t misses_;
+  uint64_t evictions_;
+};
+
+// Late Complete Declare
+
+template <typename TParameterType>
+std::shared_ptr<const FrozenSelect<TParameterType>>
+NvSelect<TParameterType>::Freeze(bool pretty_print) const {
+  return FrozenSelect<TParameterType>::From(*this, pretty_print);
+}
+
+template <typename TParameterType>
+std::shared_ptr<const FrozenSelect<TParameterType>>
+NvSelect<TParameterType>::Freeze(QueryShapeCache<TParameterType>& cache,
+                                 bool pretty_print) const {
+  return FrozenSelect<TParameterType>::From(*this, cache, pretty_print);
+}
+
+}  // namespace nvm::sqlbuilder
@@ -0,0 +1,499 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <utility>
+
+#include "nvm/sqlbuilder/def.h"
+
+namespace nvm::sqlbuilder {
+
+/// @brief constexpr counterpart of RecordKey, an empty alias means none.
+struct StaticKey {
+  std::string_view table;
+  std::string_view field;
+  std::string_view table_alias;
+
+  constexpr StaticKey(std::string_view table, std::string_view field,
+                      std::string_view alias = std::string_view())
+                  : table(table), field(field), table_alias(alias) {}
+};
+
+namespace details::static_sql {
+
+/// Clauses in the order SQL wants them.
+enum class Clause : uint8_t {
+  Select = 0,
+  From = 1,
+  Join = 2,
+  Where = 3,
+  GroupBy = 4,
+  OrderBy = 5,
+  Limit = 6
+};
+
+template <size_t TCapacity>
+struct Text {
+  char data[TCapacity];
+  size_t size;
+  uint32_t next_parameter;
+  Clause clause;
+  bool first_in_clause;
+
+  constexpr Text()
+                  : data(),
+                    size(0),
+                    next_parameter(1),
+                    clause(Clause::Select),
+                    first_in_clause(true) {}
+
+  constexpr void Append(std::string_view value) {
+    if (value.size() > TCapacity - size) {
+      throw std::runtime_error(
+          "StaticSelect: statement is longer than the capacity");
+    }
+    for (char ch : value) {
+      data[size++] = ch;
+    }
+  }
+
+  constexpr void Append(char value) {
+    Append(std::string_view(&value, 1));
+  }
+
+  constexpr void AppendUInt(uint32_t value) {
+    char digits[10] = {};
+    size_t count = 0;
+    do {
+      digits[count++] = static_cast<char>('0' + value % 10);
+      value /= 10;
+    } while (value > 0);
+    while (count > 0) {
+      Append(digits[--count]);
+    }
+  }
+
+  /// Same format as SqlWriter::AppendParameter().
+  constexpr void AppendParameter(DatabaseDialect dialect, uint32_t index) {
+    Append(dialect == DatabaseDialect::Oracle ? ':' : '$');
+    AppendUInt(index);
+  }
+
+  constexpr uint32_t NextParameter(DatabaseDialect dialect) {
+    AppendParameter(dialect, next_parameter);
+    return next_parameter++;
+  }
+
+  /// Start clause with keyword the first time, separator between the
+  /// elements of one clause.
+  constexpr void Enter(Clause target, std::string_view keyword,
+                       std::string_view separator) {
+    if (target < clause) {
+      throw std::runtime_error("StaticSelect: clause is out of SQL order");
+    }
+    if (target != clause) {
+      clause = target;
+      first_in_clause = true;
+      Append(keyword);
+    } else if (!first_in_clause) {
+      Append(separator);
+    }
+    first_in_clause = false;
+  }
+
+  /// Qualified name, alias.field or field.
+  constexpr void AppendName(std::string_view field, std::string_view alias) {
+    if (!alias.empty()) {
+      Append(alias);
+      Append('.');
+    }
+    Append(field);
+  }
+
+  constexpr void AppendKeyField(const StaticKey& key) {
+    AppendName(key.field, key.table_alias.empty() ? key.table : key.table_alias);
+  }
+
+  constexpr void AppendKeyTable(const StaticKey& key) {
+    Append(key.table);
+    if (!key.table_alias.empty()) {
+      Append(" AS ");
+      Append(key.table_alias);
+    }
+  }
+
+  constexpr std::string_view View() const {
+    return std::string_view(data, size);
+  }
+};
+
+template <typename TTuple, typename... T>
+struct Append;
+
+template <typename... TOld, typename... T>
+struct Append<std::tuple<TOld...>, T...> {
+  using type = std::tuple<TOld..., T...>;
+};
+
+template <size_t, typename T>
+using Always = T;
+
+template <typename TTuple, typename T, typename TIndex>
+struct AppendRepeat;
+
+template <typename... TOld, typename T, size_t... I>
+struct AppendRepeat<std::tuple<TOld...>, T, std::index_sequence<I...>> {
+  using type = std::tuple<TOld..., Always<I, T>...>;
+};
+
+/// Bind() of a statement, the signature is the bind types in placeholder
+/// order.
+template <typename TBinds>
+class Binder;
+
+template <typename... T>
+class Binder<std::tuple<T...>> {
+ public:
+  static constexpr size_t kParameterCount = sizeof...(T);
+
+  /// @brief Parameter values in placeholder order, $1 first.
+  template <typename TParameterType = DefaultPostgresParamType>
+  std::array<TParameterType, sizeof...(T)> Bind(const T&... values) const {
+    return std::array<TParameterType, sizeof...(T)>{
+        {TParameterType(values)...}};
+  }
+};
+
+}  // namespace details::static_sql
+
+/// @brief SELECT whose text is fixed at compile time. Every call is
+/// constexpr and returns a new statement type carrying the result row types
+/// (Field<T>) and bind types (AddCondition<T> and friends), so a constexpr
+/// object holds the finished SQL and its Bind() takes exactly the declared
+/// values. Only filling the parameter array is left for run time.
+///
+/// Text and placeholders match the compact NvSelect::GenerateQuery() of the
+/// same statement. Clauses must be added in SQL order and the text must fit
+/// TCapacity, either mistake fails the constant evaluation.
+/// @example
+/// ```cxx
+/// static constexpr auto kFindUser =
+///     StaticSelect<>()
+///         .Field<int32_t>("user_id", "u")
+///         .Field<std::string>("name", "u")
+///         .From("users", "u")
+///         .AddCondition<int32_t>("u.company_id", SqlOperator::kEqual)
+///         .And()
+///         .AddCondition<std::string>("u.name", SqlOperator::kLike);
+///
+/// db.Execute(kFindUser.Sql(), kFindUser.Bind(company_id, "dozer%"));
+/// ```
+/// @tparam TDialect placeholder format
+/// @tparam TCapacity longest statement text
+/// @tparam TRow std::tuple of the field types
+/// @tparam TBinds std::tuple of the bind types
+template <DatabaseDialect TDialect = DatabaseDialect::PostgreSQL,
+          size_t TCapacity = 1024, typename TRow = std::tuple<>,
+          typename TBinds = std::tuple<>>
+class StaticSelect final : public details::static_sql::Binder<TBinds> {
+ private:
+  using Text = details::static_sql::Text<TCapacity>;
+  using Clause = details::static_sql::Clause;
+
+  template <DatabaseDialect, size_t, typename, typename>
+  friend class StaticSelect;
+
+  template <typename TNewRow, typename TNewBinds>
+  using Next = StaticSelect<TDialect, TCapacity, TNewRow, TNewBinds>;
+
+  template <typename... T>
+  using WithRow =
+      Next<typename details::static_sql::Append<TRow, T...>::type, TBinds>;
+
+  template <typename... T>
+  using WithBinds =
+      Next<TRow, typename details::static_sql::Append<TBinds, T...>::type>;
+
+  Text text_;
+
+  constexpr explicit StaticSelect(const Text& text) : text_(text) {}
+
+ public:
+  using Row = TRow;
+  using Binds = TBinds;
+
+  constexpr StaticSelect() : text_() {
+    text_.Append("SELECT ");
+  }
+
+  static constexpr DatabaseDialect Dialect() {
+    return TDialect;
+  }
+
+  /// @brief The statement, valid as long as this object.
+  constexpr std::string_view Sql() const {
+    return text_.View();
+  }
+
+  /// @brief Placeholder number the next bind would get.
+  constexpr uint32_t NextParameterIndex() const {
+    return text_.next_parameter;
+  }
+
+  /// @brief Define select field/column
+  /// @tparam T field type, appended to Row
+  /// @param field
+  /// @param table_alias
+  /// @param field_alias
+  /// @return
+  template <typename T>
+  constexpr WithRow<T> Field(
+      std::string_view field, std::string_view table_alias = std::string_view(),
+      std::string_view field_alias = std::string_view()) const {
+    return Field<T>(field, table_alias, SqlAggregateFunction::None,
+                    field_alias);
+  }
+
+  /// @brief Define select field/column wrapped in aggregate_fn
+  template <typename T>
+  constexpr WithRow<T> Field(
+      std::string_view field, std::string_view table_alias,
+      SqlAggregateFunction aggregate_fn,
+      std::string_view field_alias = std::string_view()) const {
+    Text text = text_;
+    text.Enter(Clause::Select, std::string_view(), ", ");
+    bool wrap = aggregate_fn != SqlAggregateFunction::None &&
+                aggregate_fn != SqlAggregateFunction::Distinct;
+    if (aggregate_fn == SqlAggregateFunction::Distinct) {
+      text.Append(AggregateFunctionKeyword(aggregate_fn));
+      text.Append(' ');
+    } else if (wrap) {
+      text.Append(AggregateFunctionKeyword(aggregate_fn));
+      text.Append('(');
+    }
+    text.AppendName(field, table_alias);
+    if (wrap) {
+      text.Append(')');
+    }
+    if (!field_alias.empty()) {
+      text.Append(" AS ");
+      text.Append(field_alias);
+    }
+    return WithRow<T>(text);
+  }
+
+  /// @brief Add table clause inside FROM statement
+  constexpr StaticSelect From(
+      std::string_view table,
+      std::string_view table_alias = std::string_view()) const {
+    Text text = text_;
+    text.Enter(Clause::From, " FROM ", ", ");
+    text.AppendKeyTable(StaticKey(table, std::string_view(), table_alias));
+    return StaticSelect(text);
+  }
+
+  constexpr StaticSelect InnerJoin(const StaticKey& existing_select,
+                                   const StaticKey& join_on_table) const {
+    return Join("INNER JOIN ", existing_select, join_on_table);
+  }
+
+  constexpr StaticSelect LeftJoin(const StaticKey& left_table,
+                                  const StaticKey& right_table) const {
+    return Join("LEFT JOIN ", left_table, right_table);
+  }
+
+  constexpr StaticSelect RightJoin(const StaticKey& left_table,
+                                   const StaticKey& right_table) const {
+    return Join("RIGHT JOIN ", left_table, right_table);
+  }
+
+  /// @brief field op placeholder, one T to bind.
+  template <typename T>
+  constexpr WithBinds<T> AddCondition(std::string_view field_name,
+                                      SqlOperator op) const {
+    Text text = ConditionStart(field_name, op);
+    text.NextParameter(TDialect);
+    return WithBinds<T>(text);
+  }
+
+  /// @brief field BETWEEN placeholder AND placeholder, two T to bind.
+  template <typename T>
+  constexpr WithBinds<T, T> AddConditionBetween(
+      std::string_view field_name) const {
+    Text text = ConditionStart(field_name, SqlOperator::kBetween);
+    text.NextParameter(TDialect);
+    text.Append(" AND ");
+    text.NextParameter(TDialect);
+    return WithBinds<T, T>(text);
+  }
+
+  /// @brief field IN (N placeholders), N times T to bind.
+  template <typename T, size_t N>
+  constexpr Next<TRow, typename details::static_sql::AppendRepeat<
+                           TBinds, T, std::make_index_sequence<N>>::type>
+  AddConditionIn(std::string_view field_name) const {
+    static_assert(N > 0, "IN needs at least one value");
+    Text text = ConditionStart(field_name, SqlOperator::kIn);
+    text.Append('(');
+    for (size_t i = 0; i < N; ++i) {
+      if (i > 0) {
+        text.Append(", ");
+      }
+      text.NextParameter(TDialect);
+    }
+    text.Append(')');
+    return Next<TRow, typename details::static_sql::AppendRepeat<
+                          TBinds, T, std::make_index_sequence<N>>::type>(text);
+  }
+
+  constexpr StaticSelect And() const {
+    return WhereToken(" AND ");
+  }
+
+  constexpr StaticSelect Or() const {
+    return WhereToken(" OR ");
+  }
+
+  constexpr StaticSelect StartGroup() const {
+    return WhereToken("(");
+  }
+
+  constexpr StaticSelect EndGroup() const {
+    return WhereToken(")");
+  }
+
+  constexpr StaticSelect GroupBy(
+      std::string_view field_name,
+      std::string_view table_alias = std::string_view()) const {
+    Text text = text_;
+    text.Enter(Clause::GroupBy, " GROUP BY ", ", ");
+    text.AppendName(field_name, table_alias);
+    return StaticSelect(text);
+  }
+
+  constexpr StaticSelect Asc(
+      std::string_view field_name,
+      std::string_view table_alias = std::string_view()) const {
+    return By(field_name, table_alias, " ASC");
+  }
+
+  constexpr StaticSelect Desc(
+      std::string_view field_name,
+      std::string_view table_alias = std::string_view()) const {
+    return By(field_name, table_alias, " DESC");
+  }
+
+  /// @brief Row limit, binds the limit as int32_t.
+  constexpr WithBinds<int32_t> Limit() const {
+    Text text = LimitStart();
+    if (TDialect == DatabaseDialect::Oracle) {
+      text.Append("FETCH FIRST ");
+      text.NextParameter(TDialect);
+      text.Append(" ROWS ONLY");
+    } else {
+      text.Append("LIMIT ");
+      text.NextParameter(TDialect);
+    }
+    return WithBinds<int32_t>(text);
+  }
+
+  /// @brief Row limit and offset, binds the limit as int32_t then the offset
+  /// as long long. Oracle puts OFFSET first in the text, the placeholder
+  /// numbers still follow the bind order.
+  constexpr WithBinds<int32_t, long long> LimitOffset() const {
+    Text text = LimitStart();
+    uint32_t limit = text.next_parameter;
+    uint32_t offset = limit + 1;
+    if (TDialect == DatabaseDialect::Oracle) {
+      text.Append("OFFSET ");
+      text.AppendParameter(TDialect, offset);
+      text.Append(" ROWS FETCH NEXT ");
+      text.AppendParameter(TDialect, limit);
+      text.Append(" ROWS ONLY");
+    } else {
+      text.Append("LIMIT ");
+      text.AppendParameter(TDialect, limit);
+      text.Append(" OFFSET ");
+      text.AppendParameter(TDialect, offset);
+    }
+    text.next_parameter = offset + 1;
+    return WithBinds<int32_t, long long>(text);
+  }
+
+ private:
+  constexpr StaticSelect Join(std::string_view keyword,
+                              const StaticKey& existing_select,
+                              const StaticKey& join_on_table) const {
+    Text text = text_;
+    text.Enter(Clause::Join, " ", " ");
+    text.Append(keyword);
+    text.AppendKeyTable(join_on_table);
+    text.Append(" ON ");
+    text.AppendKeyField(existing_select);
+    text.Append(" = ");
+    text.AppendKeyField(join_on_table);
+    return StaticSelect(text);
+  }
+
+  constexpr Text ConditionStart(std::string_view field_name,
+                                SqlOperator op) const {
+    Text text = text_;
+    text.Enter(Clause::Where, " WHERE ", std::string_view());
+    text.Append(field_name);
+    text.Append(' ');
+    text.Append(SqlOperatorSymbol(op));
+    text.Append(' ');
+    return text;
+  }
+
+  constexpr StaticSelect WhereToken(std::string_view token) const {
+    Text text = text_;
+    text.Enter(Clause::Where, " WHERE ", std::string_view());
+    text.Append(token);
+    return StaticSelect(text);
+  }
+
+  constexpr StaticSelect By(std::string_view field_name,
+                            std::string_view table_alias,
+                            std::string_view sort) const {
+    Text text = text_;
+    text.Enter(Clause::OrderBy, " ORDER BY ", ", ");
+    text.AppendName(field_name, table_alias);
+    text.Append(sort);
+    return StaticSelect(text);
+  }
+
+  constexpr Text LimitStart() const {
+    if (text_.clause == Clause::Limit) {
+      throw std::runtime_error("StaticSelect: limit is already set");
+    }
+    Text text = text_;
+    text.Enter(Clause::Limit, " ", std::string_view());
+    return text;
+  }
+};
+
+}  // namespace nvm::sqlbuilder
@@ -19,17 +19,22 @@
 
 #pragma once
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "nvm/span.h"
 #include "nvm/sqlbuilder/def.h"
+#include "nvm/sqlbuilder/query_arena.h"
 
 namespace nvm::sqlbuilder {
 
@@ -44,10 +49,66 @@ enum class ConditionMode {
 // cppcheck-suppress unknownMacro
 NVM_ENUM_CLASS_DISPLAY_TRAIT(ConditionMode)
 
+/// @brief How AddConditionIn binds its list.
+/// kExpand: field IN ($1, $2, ...), one parameter per value.
+/// kArray: one array parameter, field = ANY($1) on PostgreSQL and
+/// field IN (SELECT COLUMN_VALUE FROM TABLE(:1)) on Oracle, the statement
+/// text no longer depends on the list size.
+/// kRanges: integer lists only, sorted and deduplicated, dense runs become
+/// field BETWEEN $1 AND $2, the rest stays an expanded IN.
+/// kRangesArray: kRanges with the rest bound as one array parameter.
+enum class InListMode {
+  kExpand = 0,
+  kArray = 1,
+  kRanges = 2,
+  kRangesArray = 3
+};
+
+// cppcheck-suppress unknownMacro
+NVM_ENUM_CLASS_DISPLAY_TRAIT(InListMode)
+
+/// @brief Runs shorter than this stay in the IN list, a BETWEEN costs two
+/// parameters.
+constexpr size_t kMinInListRun = 3;
+
+/// @brief Integer IN list split into closed ranges and single values.
+template <typename T>
+struct InListRanges {
+  std::vector<std::pair<T, T>> ranges;
+  std::vector<T> rest;
+};
+
+/// @brief Sort and deduplicate values, runs of at least min_run consecutive
+/// integers become a range.
+template <typename T>
+InListRanges<T> CoalesceInList(std::vector<T> values,
+                               size_t min_run = kMinInListRun) {
+  static_assert(std::is_integral_v<T>, "only integer lists form ranges");
+  std::sort(values.begin(), values.end());
+  values.erase(std::unique(values.begin(), values.end()), values.end());
+
+  InListRanges<T> out;
+  size_t i = 0;
+  while (i < values.size()) {
+    // sorted and unique, values[j - 1] < values[j] so + 1 cannot overflow
+    size_t j = i + 1;
+    while (j < values.size() && values[j] == values[j - 1] + 1) {
+      ++j;
+    }
+    if (j - i >= min_run) {
+      out.ranges.emplace_back(values[i], values[j - 1]);
+    } else {
+      out.rest.insert(out.rest.end(), values.begin() + i, values.begin() + j);
+    }
+    i = j;
+  }
+  return out;
+}
+
 template <typename TParameterType = DefaultPostgresParamType>
 class Condition {
  private:
-  std::string field_name_;
+  std::string_view field_name_;
   std::shared_ptr<std::vector<TParameterType>> values_;
   WhereStatement<TParameterType>* where_subquery_parent_;
   std::shared_ptr<NvSelect<TParameterType>> subquery_;
@@ -58,16 +119,27 @@ class Condition {
   uint32_t level_;
   LogicOperator logic_operator_;
   ConditionMode mode_;
-  std::string table_alias_;
+  std::string_view table_alias_;
   DatabaseDialect dialect_;
+  InListMode in_mode_;
+  // BETWEEN ranges in front of the IN list, kRanges and kRangesArray
+  uint32_t range_count_;
+
+  bool InAsArray() const {
+    return in_mode_ == InListMode::kArray ||
+           in_mode_ == InListMode::kRangesArray;
+  }
 
   uint32_t Process(uint32_t start_index) {
     uint32_t index = start_index;
     if (operation == SqlOperator::kBetween && value_size_ == 2) {
       index += 2;
     } else if (operation == SqlOperator::kIn) {
-      for (size_t i = 0; i < value_size_; ++i) {
-        index += 1;
+      index += range_count_ * 2;
+      if (InAsArray()) {
+        index += value_size_ > 0 ? 1 : 0;
+      } else {
+        index += value_size_;
       }
     } else {
       index += 1;
@@ -75,24 +147,57 @@ class Condition {
     return index;
   }
 
-  std::string __GenerateQueryFromSubquery(bool pretty_print) const;
+  void AppendInList(SqlWriter& out, uint32_t index) const;
+
+  void __AppendQueryFromSubquery(SqlWriter& out, bool pretty_print) const;
+
+  void __HashSubqueryShape(ShapeHasher& hasher) const;
 
  public:
-  Condition(std::string field_name, SqlOperator op, uint32_t value_size,
-            uint32_t param_index, uint32_t level, DatabaseDialect dialect)
-                  : field_name_(std::move(field_name)),
+  Condition(QueryArena& arena, std::string_view field_name, SqlOperator op,
+            uint32_t value_size, uint32_t param_index, uint32_t level,
+            DatabaseDialect dialect)
+                  : field_name_(arena.Name(field_name)),
                     values_(nullptr),
                     where_subquery_parent_(nullptr),
                     subquery_(nullptr),
                     operation(op),
                     value_size_(value_size),
                     start_index_(param_index),
-                    param_index_(Process(param_index)),
+                    param_index_(),
                     level_(level),
                     logic_operator_(),
                     mode_(ConditionMode::Comparator),
                     table_alias_(),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    in_mode_(InListMode::kExpand),
+                    range_count_(0) {
+    // Process() reads the IN members, they are initialized last
+    param_index_ = Process(param_index);
+  }
+
+  /// @brief IN list bound in mode, see InListMode.
+  /// @param value_size values left for the IN part, 1 for an array
+  Condition(QueryArena& arena, std::string_view field_name, InListMode mode,
+            uint32_t range_count, uint32_t value_size, uint32_t param_index,
+            uint32_t level, DatabaseDialect dialect)
+                  : field_name_(arena.Name(field_name)),
+                    values_(nullptr),
+                    where_subquery_parent_(nullptr),
+                    subquery_(nullptr),
+                    operation(SqlOperator::kIn),
+                    value_size_(value_size),
+                    start_index_(param_index),
+                    param_index_(),
+                    level_(level),
+                    logic_operator_(),
+                    mode_(ConditionMode::Comparator),
+                    table_alias_(),
+                    dialect_(dialect),
+                    in_mode_(mode),
+                    range_count_(range_count) {
+    param_index_ = Process(param_index);
+  }
 
   Condition(LogicOperator op, ConditionMode mode, uint32_t level,
             DatabaseDialect dialect)
@@ -108,10 +213,13 @@ class Condition {
                     logic_operator_(op),
                     mode_(mode),
                     table_alias_(),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    in_mode_(InListMode::kExpand),
+                    range_count_(0) {}
 
   /// @brief Do not use this directly only inner code to instancing if Where
   /// subquery requested
+  /// @param arena
   /// @param parameter_values
   /// @param parent
   /// @param subquery
@@ -120,16 +228,17 @@ class Condition {
   /// @param subquery_name
   /// @param param_index
   /// @param level_
-  Condition(std::shared_ptr<std::vector<TParameterType>> parameter_values,
-            WhereStatement<TParameterType>* parent,
-            const std::string& field_name, const std::string& subquery_name,
-            SqlOperator op, uint32_t param_index, uint32_t level,
-            DatabaseDialect dialect)
-                  : field_name_(std::move(field_name)),
+  Condition(const std::shared_ptr<QueryArena>& arena,
+            std::shared_ptr<std::vector<TParameterType>> parameter_values,
+            WhereStatement<TParameterType>* parent, std::string_view field_name,
+            std::string_view subquery_name, SqlOperator op,
+            uint32_t param_index, uint32_t level, DatabaseDialect dialect)
+                  : field_name_(arena->Name(field_name)),
+                    values_(nullptr),
                     where_subquery_parent_(parent),
-                    subquery_(std::make_shared<NvSelect<TParameterType>>(
-                        parameter_values, parent, param_index, level + 1,
-                        subquery_name, dialect)),
+                    subquery_(arena->MakeShared<NvSelect<TParameterType>>(
+                        arena, parameter_values, parent, param_index,
+                        level + 1, subquery_name, dialect)),
                     operation(op),
                     value_size_(),
                     start_index_(),
@@ -137,8 +246,10 @@ class Condition {
                     level_(level),
                     logic_operator_(),
                     mode_(ConditionMode::Subquery),
-                    table_alias_(subquery_name),
-                    dialect_(dialect) {}
+                    table_alias_(arena->Name(subquery_name)),
+                    dialect_(dialect),
+                    in_mode_(InListMode::kExpand),
+                    range_count_(0) {}
 
   // explicit NvSelect(std::shared_ptr<std::vector<TParameterType>> values,
   //                   uint32_t current_param_index, uint32_t level,
@@ -158,87 +269,338 @@ class Condition {
     return *subquery_;
   }
 
-  std::string SubqueryTableAlias() const {
+  std::string_view SubqueryTableAlias() const {
     return table_alias_;
   }
 
   std::string GenerateQuery(bool pretty_print) const {
-    std::ostringstream ss;
+    return RenderSql(
+        [&](SqlWriter& out) { AppendQuery(out, pretty_print); });
+  }
+
+  void AppendQuery(SqlWriter& out, bool pretty_print) const {
     auto index = start_index_;
     if (mode_ == ConditionMode::StartGroup) {
-      ss << "(";
+      out.Append('(');
     } else if (mode_ == ConditionMode::LogicalOperator) {
-      ss << LogicOperatorToString(logic_operator_);
+      out.Append(LogicOperatorToString(logic_operator_));
     }
 
     if (mode_ == ConditionMode::Subquery) {
-      ss << (pretty_print ? "\n" + GenerateIndentation(level_) : "")
-         << field_name_ << " " << SqlOperatorToString(operation)
-         << (pretty_print ? " (\n" : " (");
-      ss << __GenerateQueryFromSubquery(pretty_print) << ")"
-         << (table_alias_.empty() ? "" : " AS " + table_alias_) << " ";
+      if (pretty_print) {
+        out.Append('\n').AppendIndentation(level_);
+      }
+      out.Append(field_name_)
+          .Append(' ')
+          .Append(SqlOperatorSymbol(operation))
+          .Append(pretty_print ? " (\n" : " (");
+      __AppendQueryFromSubquery(out, pretty_print);
+      out.Append(')');
+      if (!table_alias_.empty()) {
+        out.Append(" AS ").Append(table_alias_);
+      }
+      out.Append(' ');
     } else if (mode_ == ConditionMode::Comparator) {
-      ss << (pretty_print ? "\n" + GenerateIndentation(level_) : "")
-         << field_name_ << " " << SqlOperatorToString(operation) << " ";
+      if (pretty_print) {
+        out.Append('\n').AppendIndentation(level_);
+      }
+      if (operation == SqlOperator::kIn &&
+          in_mode_ != InListMode::kExpand) {
+        AppendInList(out, index);
+        return;
+      }
+      out.Append(field_name_)
+          .Append(' ')
+          .Append(SqlOperatorSymbol(operation))
+          .Append(' ');
       if (operation == SqlOperator::kBetween && value_size_ == 2) {
-        ss << DetermineParameterFormat(dialect_, index) << " AND "
-           << DetermineParameterFormat(dialect_, index + 1);
+        out.AppendParameter(dialect_, index)
+            .Append(" AND ")
+            .AppendParameter(dialect_, index + 1);
         index += 2;
       } else if (operation == SqlOperator::kIn) {
-        ss << "(";
-        for (size_t i = 0; i < value_size_; ++i) {
-          ss << DetermineParameterFormat(dialect_, index)
-             << (i < value_size_ - 1 && value_size_ > 1 ? ", " : "");
-          index++;
-        }
-        ss << ")";
+        AppendInList(out, index);
       } else {
-        ss << DetermineParameterFormat(dialect_, index);
+        out.AppendParameter(dialect_, index);
         index++;
       }
     } else if (mode_ == ConditionMode::EndGroup) {
-      ss << ")";
+      out.Append(')');
     }
+  }
 
-    return ss.str();
+  void HashShape(ShapeHasher& hasher) const {
+    hasher
+        .AddUInt(static_cast<uint64_t>(mode_) |
+                 static_cast<uint64_t>(operation) << 8 |
+                 static_cast<uint64_t>(logic_operator_) << 16 |
+                 static_cast<uint64_t>(level_) << 32)
+        .AddUInt(static_cast<uint64_t>(value_size_) |
+                 static_cast<uint64_t>(start_index_) << 32)
+        .AddUInt(static_cast<uint64_t>(in_mode_) |
+                 static_cast<uint64_t>(range_count_) << 8)
+        .AddString(field_name_)
+        .AddString(table_alias_);
+    __HashSubqueryShape(hasher);
   }
+
+  /// @brief Leaves out the list size and parameter positions, an IN list
+  /// keeps its fingerprint whatever its length. A subquery is folded in by
+  /// WhereStatement::Fingerprint(), it is still being built here.
+  void Fingerprint(StatementFingerprint& fingerprint) const {
+    fingerprint
+        .AddUInt(static_cast<uint64_t>(mode_) |
+                 static_cast<uint64_t>(operation) << 8 |
+                 static_cast<uint64_t>(logic_operator_) << 16 |
+                 static_cast<uint64_t>(in_mode_) << 24)
+        .AddString(field_name_)
+        .AddString(table_alias_);
+  }
+
+  bool IsSubquery() const {
+    return mode_ == ConditionMode::Subquery;
+  }
+
+  uint64_t __SubqueryFingerprint() const;
 };
 
+template <typename TParameterType>
+void Condition<TParameterType>::AppendInList(SqlWriter& out,
+                                             uint32_t index) const {
+  if (in_mode_ == InListMode::kExpand) {
+    out.Append('(');
+    for (uint32_t i = 0; i < value_size_; ++i) {
+      if (i > 0) {
+        out.Append(", ");
+      }
+      out.AppendParameter(dialect_, index++);
+    }
+    out.Append(')');
+    return;
+  }
+
+  uint32_t parts = range_count_ + (value_size_ > 0 ? 1 : 0);
+  if (parts == 0) {
+    // an empty list matches nothing
+    out.Append("1 = 0");
+    return;
+  }
+  if (parts > 1) {
+    out.Append('(');
+  }
+  for (uint32_t i = 0; i < range_count_; ++i) {
+    if (i > 0) {
+      out.Append(" OR ");
+    }
+    out.Append(field_name_)
+        .Append(" BETWEEN ")
+        .AppendParameter(dialect_, index)
+        .Append(" AND ")
+        .AppendParameter(dialect_, index + 1);
+    index += 2;
+  }
+  if (value_size_ > 0) {
+    if (range_count_ > 0) {
+      out.Append(" OR ");
+    }
+    out.Append(field_name_);
+    if (!InAsArray()) {
+      out.Append(" IN ");
+      out.Append('(');
+      for (uint32_t i = 0; i < value_size_; ++i) {
+        if (i > 0) {
+          out.Append(", ");
+        }
+        out.AppendParameter(dialect_, index++);
+      }
+      out.Append(')');
+    } else if (dialect_ == DatabaseDialect::Oracle) {
+      // the parameter is bound as a collection (nested table) type
+      out.Append(" IN (SELECT COLUMN_VALUE FROM TABLE(")
+          .AppendParameter(dialect_, index)
+          .Append("))");
+    } else {
+      out.Append(" = ANY(").AppendParameter(dialect_, index).Append(')');
+    }
+  }
+  if (parts > 1) {
+    out.Append(')');
+  }
+}
+
 template <typename TParameterType>
 class WhereStatement {
  private:
+  std::shared_ptr<QueryArena> arena_;
   NvSelect<TParameterType>* parent_;
   std::shared_ptr<std::vector<TParameterType>> values_;
-  std::vector<Condition<TParameterType>> conditions_;
+  ArenaVector<Condition<TParameterType>> conditions_;
   uint32_t level_;
   uint32_t current_param_index_;
   DatabaseDialect dialect_;
+  StatementFingerprint fingerprint_;
+  uint32_t subquery_count_;
+
+  /// @brief Add a condition and fold it into the fingerprint.
+  template <typename... TArgs>
+  void EmplaceCondition(TArgs&&... args) {
+    conditions_.emplace_back(std::forward<TArgs>(args)...);
+    conditions_.back().Fingerprint(fingerprint_);
+    subquery_count_ += conditions_.back().IsSubquery() ? 1 : 0;
+  }
+
+  /// @brief One array parameter holding values, a Span when the parameter
+  /// type has one and values outlives the call, a copy otherwise.
+  /// @param owned values is a temporary, a view would dangle
+  template <typename T>
+  static TParameterType ArrayParameter(const std::vector<T>& values,
+                                       bool owned) {
+    if constexpr (details::has_alternative_v<TParameterType, Span<const T>>) {
+      if (!owned) {
+        return TParameterType(Span<const T>(values));
+      }
+    }
+    if constexpr (details::has_alternative_v<TParameterType, std::vector<T>>) {
+      return TParameterType(values);
+    } else {
+      throw std::invalid_argument(
+          "AddConditionIn: the parameter type holds no array of this type");
+    }
+  }
+
+  template <typename T>
+  TParameterType Bind(T&& value) {
+    return BindParameter<TParameterType>(*arena_, std::forward<T>(value));
+  }
+
+  template <typename T>
+  WhereStatement<TParameterType>& BindCondition(std::string_view field_name,
+                                                SqlOperator op, T&& value) {
+    auto bound = Bind(std::forward<T>(value));
+    EmplaceCondition(*arena_, field_name, op, 1, current_param_index_,
+                     level_ + 1, dialect_);
+    current_param_index_ = conditions_.back().NextParameterIndex();
+    values_->push_back(std::move(bound));
+    return *this;
+  }
+
+  template <typename T1, typename T2>
+  WhereStatement<TParameterType>& BindBetween(std::string_view field_name,
+                                              T1&& value1, T2&& value2) {
+    values_->push_back(Bind(std::forward<T1>(value1)));
+    values_->push_back(Bind(std::forward<T2>(value2)));
+    EmplaceCondition(*arena_, field_name, SqlOperator::kBetween, 2,
+                     current_param_index_, level_ + 1, dialect_);
+    current_param_index_ = conditions_.back().NextParameterIndex();
+    return *this;
+  }
+
+  /// @param owned values is a temporary, every element is bound as one
+  template <typename T>
+  WhereStatement<TParameterType>& BindIn(std::string_view field_name,
+                                         const std::vector<T>& values,
+                                         bool owned) {
+    EmplaceCondition(*arena_, field_name, SqlOperator::kIn, values.size(),
+                     current_param_index_, level_ + 1, dialect_);
+    current_param_index_ = conditions_.back().NextParameterIndex();
+    for (auto& value : values) {
+      values_->push_back(owned ? Bind(T(value)) : Bind(value));
+    }
+
+    return *this;
+  }
+
+  /// @param owned values is a temporary, see ArrayParameter
+  template <typename T>
+  WhereStatement<TParameterType>& AddConditionInMode(
+      std::string_view field_name, const std::vector<T>& values,
+      InListMode mode, bool owned) {
+    if (mode == InListMode::kExpand) {
+      return BindIn(field_name, values, owned);
+    }
+    if (mode == InListMode::kArray) {
+      auto array = ArrayParameter(values, owned);
+      EmplaceCondition(*arena_, field_name, mode, 0, 1, current_param_index_,
+                       level_ + 1, dialect_);
+      current_param_index_ = conditions_.back().NextParameterIndex();
+      values_->push_back(std::move(array));
+      return *this;
+    }
+
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>) {
+      auto split = CoalesceInList(values);
+      bool as_array = mode == InListMode::kRangesArray;
+      // build the array before touching the statement, a throw leaves it as
+      // it was
+      std::optional<TParameterType> rest_array;
+      if (as_array && !split.rest.empty()) {
+        rest_array = ArrayParameter(split.rest, true);
+      }
+
+      uint32_t rest_size = static_cast<uint32_t>(split.rest.size());
+      if (as_array) {
+        rest_size = rest_array ? 1 : 0;
+      }
+      EmplaceCondition(*arena_, field_name, mode,
+                       static_cast<uint32_t>(split.ranges.size()), rest_size,
+                       current_param_index_, level_ + 1, dialect_);
+      current_param_index_ = conditions_.back().NextParameterIndex();
+      for (const auto& range : split.ranges) {
+        values_->push_back(range.first);
+        values_->push_back(range.second);
+      }
+      if (as_array) {
+        if (rest_array) {
+          values_->push_back(std::move(*rest_array));
+        }
+      } else {
+        for (const auto& value : split.rest) {
+          values_->push_back(value);
+        }
+      }
+      return *this;
+    } else {
+      throw std::invalid_argument(
+          "AddConditionIn: ranges need an integer list");
+    }
+  }
 
  public:
   explicit WhereStatement(DatabaseDialect dialect = DatabaseDialect::PostgreSQL)
-                  : parent_(nullptr),
+                  : arena_(std::make_shared<QueryArena>()),
+                    parent_(nullptr),
                     values_(std::make_shared<std::vector<TParameterType>>()),
-                    conditions_(),
+                    conditions_(arena_->Vector<Condition<TParameterType>>()),
                     level_(),
                     current_param_index_(1),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fingerprint_(),
+                    subquery_count_(0) {}
 
   explicit WhereStatement(
+      std::shared_ptr<QueryArena> arena,
       std::shared_ptr<std::vector<TParameterType>> parameter_values,
       NvSelect<TParameterType>* parent, uint32_t current_param_index,
       uint32_t level, DatabaseDialect dialect)
-                  : parent_(parent),
+                  : arena_(std::move(arena)),
+                    parent_(parent),
                     values_(parameter_values),
-                    conditions_(),
+                    conditions_(arena_->Vector<Condition<TParameterType>>()),
                     level_(level),
                     current_param_index_(current_param_index),
-                    dialect_(dialect) {}
+                    dialect_(dialect),
+                    fingerprint_(),
+                    subquery_count_(0) {}
   ~WhereStatement() {}
 
   void UpdateCurrentParameterIndex(uint32_t parameter_index) {
     current_param_index_ = parameter_index;
   }
 
+  bool Empty() const {
+    return conditions_.empty();
+  }
+
   int32_t GetCurrentParameterIndex() const {
     return current_param_index_;
   }
@@ -256,91 +618,153 @@ class WhereStatement {
 
   std::string GenerateQuery(bool pretty_print = false,
                             bool append_where_keyword = true) const {
-    std::ostringstream where_clause;
+    return RenderSql([&](SqlWriter& out) {
+      AppendQuery(out, pretty_print, append_where_keyword);
+    });
+  }
+
+  void AppendQuery(SqlWriter& out, bool pretty_print = false,
+                   bool append_where_keyword = true) const {
     if (append_where_keyword) {
-      where_clause << "WHERE ";
+      out.Append("WHERE ");
     }
 
     for (auto& c : conditions_) {
-      where_clause << c.GenerateQuery(pretty_print);
+      c.AppendQuery(out, pretty_print);
     }
+  }
 
-    return where_clause.str();
+  void HashShape(ShapeHasher& hasher) const {
+    hasher.AddUInt(conditions_.size());
+    for (const auto& c : conditions_) {
+      c.HashShape(hasher);
+    }
+  }
+
+  /// @brief Conditions were folded in as they were added, only subqueries
+  /// are visited.
+  uint64_t Fingerprint() const {
+    if (subquery_count_ == 0) {
+      return fingerprint_.Value();
+    }
+    StatementFingerprint fingerprint = fingerprint_;
+    for (const auto& c : conditions_) {
+      if (c.IsSubquery()) {
+        fingerprint.AddUInt(c.__SubqueryFingerprint());
+      }
+    }
+    return fingerprint.Value();
   }
 
   template <typename T>
-  WhereStatement<TParameterType>& AddCondition(const std::string& field_name,
+  WhereStatement<TParameterType>& AddCondition(std::string_view field_name,
                                                SqlOperator op,
                                                const T& values) {
-    conditions_.emplace_back(field_name, op, 1, current_param_index_,
-                             level_ + 1, dialect_);
-    const auto cond = conditions_.back();
-    current_param_index_ = cond.NextParameterIndex();
-    values_->push_back(values);
-    return *this;
+    return BindCondition(field_name, op, values);
+  }
+
+  /// @brief A temporary, or a value converted to T, is copied into the
+  /// query arena when the parameter type would only view it.
+  template <typename T = void, typename U,
+            typename = std::enable_if_t<details::binds_temporary_v<T, U>>>
+  WhereStatement<TParameterType>& AddCondition(std::string_view field_name,
+                                               SqlOperator op, U&& values) {
+    return BindCondition(field_name, op,
+                         details::ConvertBound<T>(std::forward<U>(values)));
   }
 
   template <typename T>
   WhereStatement<TParameterType>& AddConditionBetween(
-      const std::string& field_name, const T& value1, const T& value2) {
-    values_->push_back(value1);
-    values_->push_back(value2);
-    conditions_.emplace_back(field_name, SqlOperator::kBetween, 2,
-                             current_param_index_, level_ + 1, dialect_);
-    const auto cond = conditions_.back();
-    current_param_index_ = cond.NextParameterIndex();
-    return *this;
+      std::string_view field_name, const T& value1, const T& value2) {
+    return BindBetween(field_name, value1, value2);
+  }
+
+  /// @brief Temporaries are copied like AddCondition() does.
+  template <typename T = void, typename U1, typename U2,
+            typename = std::enable_if_t<details::binds_temporary_v<T, U1> ||
+                                        details::binds_temporary_v<T, U2>>>
+  WhereStatement<TParameterType>& AddConditionBetween(
+      std::string_view field_name, U1&& value1, U2&& value2) {
+    return BindBetween(field_name,
+                       details::ConvertBound<T>(std::forward<U1>(value1)),
+                       details::ConvertBound<T>(std::forward<U2>(value2)));
   }
 
   template <typename T>
-  WhereStatement<TParameterType>& AddConditionIn(const std::string& field_name,
+  WhereStatement<TParameterType>& AddConditionIn(std::string_view field_name,
                                                  const std::vector<T>& values) {
-    conditions_.emplace_back(field_name, SqlOperator::kIn, values.size(),
-                             current_param_index_, level_ + 1, dialect_);
-    const auto cond = conditions_.back();
-    current_param_index_ = cond.NextParameterIndex();
-    for (auto& value : values) {
-      values_->push_back(value);
-    }
+    return BindIn(field_name, values, false);
+  }
 
-    return *this;
+  /// @brief Elements of a temporary list are copied like AddCondition()
+  /// does.
+  template <typename T>
+  WhereStatement<TParameterType>& AddConditionIn(std::string_view field_name,
+                                                 std::vector<T>&& values) {
+    return BindIn(field_name, values, true);
+  }
+
+  /// @brief IN condition bound in mode, see InListMode. kRanges and
+  /// kRangesArray need an integer T, the array modes a parameter type that
+  /// holds std::vector<T> (copied) or Span<const T> (referenced, values must
+  /// outlive the parameters).
+  /// @throw std::invalid_argument when TParameterType has no array of T,
+  /// nothing is added then
+  template <typename T>
+  WhereStatement<TParameterType>& AddConditionIn(std::string_view field_name,
+                                                 const std::vector<T>& values,
+                                                 InListMode mode) {
+    return AddConditionInMode(field_name, values, mode, false);
+  }
+
+  /// @brief A temporary list can not be referenced, kArray copies it and
+  /// throws for parameter types that only hold Span<const T>.
+  template <typename T>
+  WhereStatement<TParameterType>& AddConditionIn(std::string_view field_name,
+                                                 std::vector<T>&& values,
+                                                 InListMode mode) {
+    return AddConditionInMode(field_name, values, mode, true);
   }
 
   WhereStatement<TParameterType>& And() {
-    conditions_.emplace_back(LogicOperator::kAnd,
-                             ConditionMode::LogicalOperator, level_, dialect_);
+    EmplaceCondition(LogicOperator::kAnd, ConditionMode::LogicalOperator,
+                     level_, dialect_);
     return *this;
   }
 
   WhereStatement<TParameterType>& Or() {
-    conditions_.emplace_back(LogicOperator::kOr, ConditionMode::LogicalOperator,
-                             level_, dialect_);
+    EmplaceCondition(LogicOperator::kOr, ConditionMode::LogicalOperator,
+                     level_, dialect_);
     return *this;
   }
 
   WhereStatement<TParameterType>& StartGroup() {
-    conditions_.emplace_back(LogicOperator::kOr, ConditionMode::StartGroup,
-                             level_, dialect_);
+    EmplaceCondition(LogicOperator::kOr, ConditionMode::StartGroup, level_,
+                     dialect_);
     return *this;
   }
 
   WhereStatement<TParameterType>& EndGroup() {
-    conditions_.emplace_back(LogicOperator::kOr, ConditionMode::EndGroup,
-                             level_, dialect_);
+    EmplaceCondition(LogicOperator::kOr, ConditionMode::EndGroup, level_,
+                     dialect_);
     return *this;
   }
 
-  NvSelect<TParameterType>& AddSubquery(const std::string& field_name,
+  NvSelect<TParameterType>& AddSubquery(std::string_view field_name,
                                         SqlOperator op,
-                                        const std::string& subquery_name) {
+                                        std::string_view subquery_name) {
     // Condition(std::shared_ptr<std::vector<TParameterType>> parameter_values,
     //         WhereStatement<TParameterType>* parent,
     //         const std::string& field_name,
     //         const std::string& subquery_name, uint32_t param_index,
     //         uint32_t level)
-    conditions_.emplace_back(values_, this, field_name, subquery_name, op,
-                             current_param_index_, level_ + 1, dialect_);
+    EmplaceCondition(arena_, values_, this, field_name, subquery_name, op,
+                     current_param_index_, level_ + 1, dialect_);
     return conditions_.back().Subquery();
   }
 };
-}  // namespace nvm::sqlbuilder
\ No newline at end of file
+}  // namespace nvm::sqlbuilder
+
+// Subquery conditions render through NvSelect, pull in its late definitions
+// when this header is included on its own.
+#include "nvm/sqlbuilder/nv_select_builder.h"
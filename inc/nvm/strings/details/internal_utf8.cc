@@ -0,0 +1,314 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#include "nvm/strings/details/internal_utf8.h"
+
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <tmmintrin.h>
+#define NVM_UTF8_HAS_SSSE3 1
+#define NVM_UTF8_TARGET_SSSE3 __attribute__((target("ssse3,popcnt")))
+#endif
+
+namespace nvm {
+namespace strings {
+namespace details {
+namespace utf8 {
+
+namespace {
+
+/// Count bytes that start a codepoint (everything but 10xxxxxx).
+inline size_t CountLeadBytes(const uint8_t* data, size_t size) noexcept {
+  size_t count = 0;
+  for (size_t i = 0; i < size; ++i) {
+    count += (data[i] & 0xC0) != 0x80;
+  }
+  return count;
+}
+
+/// Scalar validation from data[0], returns the offset of the first byte of an
+/// invalid sequence or size.
+size_t FindInvalidScalar(const uint8_t* data, size_t size) noexcept {
+  size_t i = 0;
+  while (i < size) {
+    // eight ASCII bytes at a time
+    if (i + 8 <= size) {
+      uint64_t word;
+      std::memcpy(&word, data + i, sizeof(word));
+      if ((word & 0x8080808080808080ULL) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+
+    uint8_t b0 = data[i];
+    if (b0 < 0x80) {
+      ++i;
+      continue;
+    }
+
+    size_t n;
+    uint8_t lo = 0x80;
+    uint8_t hi = 0xBF;
+    if (b0 >= 0xC2 && b0 <= 0xDF) {
+      n = 2;
+    } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+      n = 3;
+      if (b0 == 0xE0) {
+        lo = 0xA0;  // overlong
+      } else if (b0 == 0xED) {
+        hi = 0x9F;  // surrogates
+      }
+    } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+      n = 4;
+      if (b0 == 0xF0) {
+        lo = 0x90;  // overlong
+      } else if (b0 == 0xF4) {
+        hi = 0x8F;  // above U+10FFFF
+      }
+    } else {
+      return i;
+    }
+
+    if (size - i < n) {
+      return i;
+    }
+    if (data[i + 1] < lo || data[i + 1] > hi) {
+      return i;
+    }
+    for (size_t k = 2; k < n; ++k) {
+      if ((data[i + k] & 0xC0) != 0x80) {
+        return i;
+      }
+    }
+    i += n;
+  }
+  return size;
+}
+
+#if defined(NVM_UTF8_HAS_SSSE3)
+
+// Lookup-table validation after Keiser and Lemire, "Validating UTF-8 In Less
+// Than One Instruction Per Byte". Each byte pair is classified by three
+// nibble lookups whose AND is non-zero only for an error.
+constexpr uint8_t kTooShort = 1 << 0;
+constexpr uint8_t kTooLong = 1 << 1;
+constexpr uint8_t kOverlong3 = 1 << 2;
+constexpr uint8_t kTooLarge = 1 << 3;
+constexpr uint8_t kSurrogate = 1 << 4;
+constexpr uint8_t kOverlong2 = 1 << 5;
+constexpr uint8_t kTooLarge1000 = 1 << 6;
+constexpr uint8_t kOverlong4 = 1 << 6;
+constexpr uint8_t kTwoConts = 1 << 7;
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+struct Utf8Checker {
+  __m128i error;
+  __m128i prev_input;
+  __m128i prev_incomplete;
+
+  NVM_UTF8_TARGET_SSSE3 Utf8Checker() noexcept
+                  : error(_mm_setzero_si128()),
+                    prev_input(_mm_setzero_si128()),
+                    prev_incomplete(_mm_setzero_si128()) {}
+
+  NVM_UTF8_TARGET_SSSE3 static __m128i HighNibble(__m128i v) noexcept {
+    return _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+  }
+
+  NVM_UTF8_TARGET_SSSE3 static __m128i SpecialCases(__m128i input,
+                                                    __m128i prev1) noexcept {
+    const __m128i byte_1_high_table = _mm_setr_epi8(
+        kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong, kTooLong,
+        kTooLong, kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+        kTooShort | kOverlong2, kTooShort,
+        kTooShort | kOverlong3 | kSurrogate,
+        static_cast<char>(kTooShort | kTooLarge | kTooLarge1000 | kOverlong4));
+    const __m128i byte_1_low_table = _mm_setr_epi8(
+        static_cast<char>(kCarry | kOverlong3 | kOverlong2 | kOverlong4),
+        static_cast<char>(kCarry | kOverlong2), static_cast<char>(kCarry),
+        static_cast<char>(kCarry), static_cast<char>(kCarry | kTooLarge),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000 | kSurrogate),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000),
+        static_cast<char>(kCarry | kTooLarge | kTooLarge1000));
+    const __m128i byte_2_high_table = _mm_setr_epi8(
+        kTooShort, kTooShort, kTooShort, kTooShort, kTooShort, kTooShort,
+        kTooShort, kTooShort,
+        static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kOverlong3 |
+                          kTooLarge1000 | kOverlong4),
+        static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kOverlong3 |
+                          kTooLarge),
+        static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kSurrogate |
+                          kTooLarge),
+        static_cast<char>(kTooLong | kOverlong2 | kTwoConts | kSurrogate |
+                          kTooLarge),
+        kTooShort, kTooShort, kTooShort, kTooShort);
+
+    __m128i byte_1_high =
+        _mm_shuffle_epi8(byte_1_high_table, HighNibble(prev1));
+    __m128i byte_1_low = _mm_shuffle_epi8(
+        byte_1_low_table, _mm_and_si128(prev1, _mm_set1_epi8(0x0F)));
+    __m128i byte_2_high =
+        _mm_shuffle_epi8(byte_2_high_table, HighNibble(input));
+    return _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+  }
+
+  NVM_UTF8_TARGET_SSSE3 void Check(__m128i input) noexcept {
+    if (_mm_movemask_epi8(input) == 0) {
+      // ASCII block, only a sequence left open by the previous block fails
+      error = _mm_or_si128(error, prev_incomplete);
+    } else {
+      __m128i prev1 = _mm_alignr_epi8(input, prev_input, 15);
+      __m128i prev2 = _mm_alignr_epi8(input, prev_input, 14);
+      __m128i prev3 = _mm_alignr_epi8(input, prev_input, 13);
+
+      __m128i special = SpecialCases(input, prev1);
+      // third and fourth bytes of a sequence must be continuations
+      __m128i is_third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+      __m128i is_fourth =
+          _mm_subs_epu8(prev3, _mm_set1_epi8(static_cast<char>(0xF0 - 0x80)));
+      __m128i must_be_cont = _mm_and_si128(_mm_or_si128(is_third, is_fourth),
+                                           _mm_set1_epi8(-128));
+      error = _mm_or_si128(error, _mm_xor_si128(must_be_cont, special));
+
+      // a lead byte in the last three positions continues in the next block
+      const __m128i max_value = _mm_setr_epi8(
+          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+          static_cast<char>(0xF0 - 1), static_cast<char>(0xE0 - 1),
+          static_cast<char>(0xC0 - 1));
+      prev_incomplete = _mm_subs_epu8(input, max_value);
+    }
+    prev_input = input;
+  }
+
+  NVM_UTF8_TARGET_SSSE3 bool HasError() const noexcept {
+    __m128i e = _mm_or_si128(error, prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(e, _mm_setzero_si128())) != 0xFFFF;
+  }
+};
+
+NVM_UTF8_TARGET_SSSE3 size_t CountLeadBytes16(__m128i v) noexcept {
+  // as signed bytes continuations are -128..-65
+  __m128i lead = _mm_cmpgt_epi8(v, _mm_set1_epi8(-65));
+  return static_cast<size_t>(__builtin_popcount(_mm_movemask_epi8(lead)));
+}
+
+NVM_UTF8_TARGET_SSSE3 bool ValidateSsse3(const uint8_t* data, size_t size,
+                                         uint8_t* dest,
+                                         size_t& codepoints) noexcept {
+  Utf8Checker checker;
+  size_t count = 0;
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (dest) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i), v);
+    }
+    checker.Check(v);
+    count += CountLeadBytes16(v);
+  }
+
+  if (i < size) {
+    // zero padding is ASCII, an open sequence at the end shows as too short
+    alignas(16) uint8_t tail[16] = {0};
+    std::memcpy(tail, data + i, size - i);
+    if (dest) {
+      std::memcpy(dest + i, data + i, size - i);
+    }
+    __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(tail));
+    checker.Check(v);
+    count += CountLeadBytes16(v) - (16 - (size - i));
+  }
+
+  codepoints = count;
+  return !checker.HasError();
+}
+
+inline bool HasSsse3() noexcept {
+  static const bool supported =
+      __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("popcnt");
+  return supported;
+}
+
+#endif  // NVM_UTF8_HAS_SSSE3
+
+}  // namespace
+
+bool ValidateScalar(const uint8_t* data, size_t size,
+                    size_t& codepoints) noexcept {
+  if (FindInvalidScalar(data, size) != size) {
+    codepoints = 0;
+    return false;
+  }
+  codepoints = CountLeadBytes(data, size);
+  return true;
+}
+
+bool Validate(const uint8_t* data, size_t size, size_t& codepoints) noexcept {
+  codepoints = 0;
+  if (size == 0) {
+    return true;
+  }
+  if (!data) {
+    return false;
+  }
+
+#if defined(NVM_UTF8_HAS_SSSE3)
+  if (HasSsse3()) {
+    return ValidateSsse3(data, size, nullptr, codepoints);
+  }
+#endif
+
+  return ValidateScalar(data, size, codepoints);
+}
+
+bool ValidateCopy(const uint8_t* data, size_t size, uint8_t* dest,
+                  size_t& codepoints) noexcept {
+  codepoints = 0;
+  if (size == 0) {
+    return true;
+  }
+  if (!data || !dest) {
+    return false;
+  }
+
+#if defined(NVM_UTF8_HAS_SSSE3)
+  if (HasSsse3()) {
+    return ValidateSsse3(data, size, dest, codepoints);
+  }
+#endif
+
+  std::memcpy(dest, data, size);
+  return ValidateScalar(dest, size, codepoints);
+}
+
+}  // namespace utf8
+}  // namespace details
+}  // namespace strings
+}  // namespace nvm
@@ -0,0 +1,54 @@
+/*
+ *  Copyright (c) 2024 Linggawasistha Djohari
+ * <linggawasistha.djohari@outlook.com> Licensed to Linggawasistha Djohari under
+ * one or more contributor license agreements. See the NOTICE file distributed
+ * with this work for additional information regarding copyright ownership.
+ *
+ *  Linggawasistha Djohari licenses this file to you under the Apache License,
+ *  Version 2.0 (the "License"); you may not use this file except in
+ *  compliance with the License. You may obtain a copy of the License at
+ *
+ *       http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#ifndef NVM_CORE_STRINGS_DETAILS_V2_INTERNAL_UTF8_H
+#define NVM_CORE_STRINGS_DETAILS_V2_INTERNAL_UTF8_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace nvm {
+namespace strings {
+namespace details {
+namespace utf8 {
+
+/// @brief Validate UTF-8 and count codepoints in one pass. Rejects overlong
+/// forms, surrogates and codepoints above U+10FFFF. Uses SSSE3 when the CPU
+/// supports it, scalar code otherwise.
+/// @param data
+/// @param size
+/// @param codepoints number of codepoints, only meaningful when valid
+/// @return true if data is valid UTF-8
+bool Validate(const uint8_t* data, size_t size, size_t& codepoints) noexcept;
+
+/// @brief Validate like Validate() while copying data to dest, so the input
+/// is read once. dest must hold size bytes and may not overlap data.
+bool ValidateCopy(const uint8_t* data, size_t size, uint8_t* dest,
+                  size_t& codepoints) noexcept;
+
+/// @brief Scalar reference implementation, exposed for tests.
+bool ValidateScalar(const uint8_t* data, size_t size,
+                    size_t& codepoints) noexcept;
+
+}  // namespace utf8
+}  // namespace details
+}  // namespace strings
+}  // namespace nvm
+
+#endif  // NVM_CORE_STRINGS_DETAILS_V2_INTERNAL_UTF8_H
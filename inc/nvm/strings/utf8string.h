@@ -20,8 +20,12 @@
 #ifndef NVM_CORE_V2_UTF8_STRING_H
 #define NVM_CORE_V2_UTF8_STRING_H
 
+#include <cstdint>
+#include <iterator>
 #include <string>
+#include <type_traits>
 
+#include "nvm/strings/details/internal_utf8.h"
 #include "utf8.h"
 
 namespace nvm {
@@ -69,18 +73,34 @@ class Ut8CodepointRange {
   };
 };
 
-/// @brief Utf8String implementations
+/// @brief Utf8String implementations. Validity and the codepoint count are
+/// computed once when the string is built.
 class Utf8String {
  private:
   std::string content_;
   bool is_utf8_;
+  size_t length_;
+
+  Utf8String(std::string&& content, bool is_utf8, size_t length) noexcept
+      : content_(std::move(content)), is_utf8_(is_utf8), length_(length) {}
+
+  void Validate() noexcept {
+    is_utf8_ = details::utf8::Validate(
+        reinterpret_cast<const uint8_t*>(content_.data()), content_.size(),
+        length_);
+  }
 
  public:
-  Utf8String() noexcept : content_(std::string()), is_utf8_(false){};
+  Utf8String() noexcept : content_(std::string()), is_utf8_(true), length_(0){};
+
+  explicit Utf8String(const std::string& content)
+      : content_(content), is_utf8_(false), length_(0) {
+    Validate();
+  };
 
-  explicit Utf8String(const std::string& content) noexcept
-      : content_(std::string()), is_utf8_(false) {
-    is_utf8_ = utf8::is_valid(content_.begin(), content_.end());
+  explicit Utf8String(std::string&& content) noexcept
+      : content_(std::move(content)), is_utf8_(false), length_(0) {
+    Validate();
   };
 
   ~Utf8String(){};
@@ -95,21 +115,20 @@ class Utf8String {
 
   /// @brief Return the character length of the string. Be careful on Utf8 it
   /// will return numbers of codepoints.
-  /// @return number of characters (num of codepoints in Utf8)
-  size_t Len() const {
-    if (is_utf8_) {
-      // If the string is valid UTF-8, return the number of code points
-      return utf8::distance(content_.begin(), content_.end());
-    } else {
-      // If the string is not valid UTF-8, return the number of bytes
-      return content_.size();
-    }
-  }
+  /// @return number of characters (num of codepoints in Utf8), bytes when the
+  /// string is not valid Utf8
+  size_t Len() const { return is_utf8_ ? length_ : content_.size(); }
 
   /// @brief Return the string content
   /// @return
   const std::string& Str() const { return content_; }
 
+  /// @brief Return the raw bytes
+  /// @return
+  const uint8_t* Data() const {
+    return reinterpret_cast<const uint8_t*>(content_.data());
+  }
+
   // /// @brief
   // /// @param range
   // /// @return
@@ -128,24 +147,58 @@ class Utf8String {
   //   return false;
   // }
 
+  /// @brief Copy and validate bytes in one pass. Invalid input is kept as is
+  /// and reported by IsUtf8().
+  /// @throw std::bad_alloc
   template <typename T>
-  static Utf8String MakeUtf8String(const T* bytes, size_t size) noexcept {
+  static Utf8String FromBytes(const T* bytes, size_t size) {
     static_assert(
         std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
         "T can only be char or uint8_t");
-    auto utf8_string = std::string(bytes, size);
-    utf8::replace_invalid(bytes, bytes + size, std::back_inserter(utf8_string));
-    return Utf8String(std::move(utf8_string));
+    std::string content;
+    if (!bytes || size == 0) {
+      return Utf8String();
+    }
+    content.resize(size);
+    size_t length = 0;
+    bool is_utf8 = details::utf8::ValidateCopy(
+        reinterpret_cast<const uint8_t*>(bytes), size,
+        reinterpret_cast<uint8_t*>(&content[0]), length);
+    return Utf8String(std::move(content), is_utf8, length);
   }
 
+  /// @brief Copy bytes, invalid sequences are replaced with U+FFFD.
   template <typename T>
-  static Utf8String MakeUtf8StringUnchecked(const T* bytes,
-                                            size_t size) noexcept {
+  static Utf8String MakeUtf8String(const T* bytes, size_t size) {
+    auto result = FromBytes(bytes, size);
+    if (result.is_utf8_) {
+      return result;
+    }
+
+    const char* begin = reinterpret_cast<const char*>(bytes);
+    std::string replaced;
+    replaced.reserve(size);
+    utf8::replace_invalid(begin, begin + size, std::back_inserter(replaced));
+    return Utf8String(std::move(replaced));
+  }
+
+  /// @brief Copy bytes without validation, the caller guarantees valid Utf8.
+  /// Only the codepoints are counted.
+  template <typename T>
+  static Utf8String MakeUtf8StringUnchecked(const T* bytes, size_t size) {
     static_assert(
         std::is_same<T, char>::value || std::is_same<T, uint8_t>::value,
         "T can only be char or uint8_t");
+    if (!bytes || size == 0) {
+      return Utf8String();
+    }
 
-    return Utf8String(std::move(std::string(bytes, size)));
+    std::string content(reinterpret_cast<const char*>(bytes), size);
+    size_t length = 0;
+    for (unsigned char c : content) {
+      length += (c & 0xC0) != 0x80;
+    }
+    return Utf8String(std::move(content), true, length);
   }
 };
 
@@ -100,6 +100,21 @@ class TaskPool final : public std::enable_shared_from_this<TaskPool> {
     return std::make_pair(std::move(res), cancel_flag);
   }
 
+  /// @brief Non-blocking variant of ExecuteTask for fire-and-forget work.
+  /// @return false when the queue is full or the pool is stopped, the task
+  /// was not queued
+  bool TryExecuteTask(std::function<void()> f) {
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      if (stop_ || tasks_.size() >= task_queue_limit_) {
+        return false;
+      }
+      tasks_.emplace(std::move(f), std::make_shared<std::atomic<bool>>(false));
+    }
+    condition_.notify_one();
+    return true;
+  }
+
  private:
   uint16_t thread_count_;
   uint16_t task_queue_limit_;
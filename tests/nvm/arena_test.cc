@@ -0,0 +1,189 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/memory/arena.h"
+#include "nvm/sqlbuilder/nv_select_builder.h"
+
+using namespace nvm;
+
+TEST_CASE("arena alignment and growth", "[memory][arena]") {
+  memory::Arena arena(64);
+  REQUIRE(arena.BlockCount() == 0);
+  REQUIRE(arena.BytesUsed() == 0);
+
+  auto* a = static_cast<char*>(arena.Allocate(3, 1));
+  auto* b = arena.Allocate(8, 8);
+  REQUIRE(reinterpret_cast<uintptr_t>(b) % 8 == 0);
+  REQUIRE(static_cast<char*>(b) >= a + 3);
+  REQUIRE(arena.BlockCount() == 1);
+
+  // larger than a block and over-aligned
+  auto* big = arena.Allocate(1000, 64);
+  REQUIRE(reinterpret_cast<uintptr_t>(big) % 64 == 0);
+  REQUIRE(arena.BlockCount() == 2);
+  REQUIRE(arena.BytesReserved() >= 1064);
+
+  auto* value = arena.Create<int64_t>(42);
+  REQUIRE(*value == 42);
+
+  auto text = arena.CopyString("equipment");
+  REQUIRE(text == "equipment");
+  REQUIRE(text.data()[text.size()] == '\0');
+}
+
+TEST_CASE("arena reset keeps the newest block", "[memory][arena]") {
+  memory::Arena arena(64);
+  for (int i = 0; i < 10; ++i) {
+    arena.Allocate(100);
+  }
+  REQUIRE(arena.BlockCount() > 1);
+
+  arena.Reset();
+  REQUIRE(arena.BlockCount() == 1);
+  REQUIRE(arena.BytesUsed() == 0);
+  size_t reserved = arena.BytesReserved();
+
+  // the kept block serves the next round without touching the system
+  for (int round = 0; round < 3; ++round) {
+    arena.Allocate(100);
+    arena.Reset();
+  }
+  REQUIRE(arena.BlockCount() == 1);
+  REQUIRE(arena.BytesReserved() == reserved);
+}
+
+TEST_CASE("arena allocator backs std containers", "[memory][arena]") {
+  memory::Arena arena;
+  std::vector<int, memory::ArenaAllocator<int>> values(
+      (memory::ArenaAllocator<int>(&arena)));
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(i);
+  }
+  REQUIRE(values.size() == 1000);
+  REQUIRE(values[999] == 999);
+  REQUIRE(arena.BytesUsed() >= 1000 * sizeof(int));
+}
+
+TEST_CASE("string interner deduplicates", "[memory][arena]") {
+  memory::Arena arena;
+  memory::StringInterner names(arena);
+
+  std::string table = "equipment";
+  auto a = names.Intern(table);
+  table[0] = 'X';
+  auto b = names.Intern("equipment");
+  REQUIRE(a == "equipment");
+  REQUIRE(a.data() == b.data());
+  REQUIRE(names.Size() == 1);
+
+  auto empty = names.Intern("");
+  REQUIRE(empty.empty());
+  REQUIRE(empty.data() != nullptr);
+  REQUIRE(names.Size() == 1);
+
+  // survives growing the table
+  std::vector<std::string_view> views;
+  for (int i = 0; i < 200; ++i) {
+    views.push_back(names.Intern("name_" + std::to_string(i)));
+  }
+  REQUIRE(names.Size() == 201);
+  for (int i = 0; i < 200; ++i) {
+    REQUIRE(names.Intern("name_" + std::to_string(i)).data() ==
+            views[i].data());
+  }
+
+  names.Clear();
+  arena.Reset();
+  REQUIRE(names.Size() == 0);
+  REQUIRE(names.Intern("equipment") == "equipment");
+}
+
+namespace {
+
+using NvSelect = sqlbuilder::NvSelect<>;
+using RecordKey = sqlbuilder::RecordKey;
+using SqlOperator = sqlbuilder::SqlOperator;
+
+void BuildListing(NvSelect& select) {
+  // clang-format off
+  select
+    .Field<int32_t>("equipment_id", "e")
+    .Field<std::string>("name", "c", "company_name")
+    .From()
+      .AddTable("equipment", "e")
+    .EndFromTableBlock()
+    .Join()
+      .InnerJoin(
+        RecordKey("equipment", "company_id", "e"),
+        RecordKey("company", "company_id", "c"))
+    .EndJoinBlock()
+    .Where()
+      .AddConditionIn<int32_t>("c.company_id", {1, 2, 3})
+      .And()
+      .AddCondition<std::string>("e.name", SqlOperator::kLike, "a%")
+    .EndWhereBlock()
+    .OrderBy()
+      .Asc("name", "c")
+    .EndOrderByBlock();
+  // clang-format on
+}
+
+}  // namespace
+
+TEST_CASE("query arena is reused across queries", "[sqlbuilder][arena]") {
+  std::string expected;
+  {
+    NvSelect select;
+    BuildListing(select);
+    expected = select.GenerateQuery();
+  }
+
+  auto arena = std::make_shared<sqlbuilder::QueryArena>();
+  size_t reserved = 0;
+  for (int round = 0; round < 4; ++round) {
+    {
+      NvSelect select(arena);
+      BuildListing(select);
+      REQUIRE(select.Arena() == arena);
+      REQUIRE(select.GenerateQuery() == expected);
+      REQUIRE(select.Values()->size() == 4);
+    }
+    // "e", "c", "company_id", ... are stored once
+    REQUIRE(arena->NameCount() < 16);
+    REQUIRE(arena->BytesUsed() > 0);
+    arena->Reset();
+    REQUIRE(arena->BytesUsed() == 0);
+    REQUIRE(arena->NameCount() == 0);
+    if (round == 1) {
+      reserved = arena->BytesReserved();
+    } else if (round > 1) {
+      REQUIRE(arena->BytesReserved() == reserved);
+    }
+  }
+
+  REQUIRE_THROWS_AS(NvSelect(std::shared_ptr<sqlbuilder::QueryArena>()),
+                    std::invalid_argument);
+}
+
+TEST_CASE("query arena names", "[sqlbuilder][arena]") {
+  sqlbuilder::QueryArena arena;
+
+  auto absent = arena.OptionalName(std::nullopt);
+  auto empty = arena.OptionalName(std::string_view());
+  REQUIRE_FALSE(sqlbuilder::HasName(absent));
+  REQUIRE(sqlbuilder::HasName(empty));
+  REQUIRE_FALSE(sqlbuilder::AsOptional(absent).has_value());
+  REQUIRE(sqlbuilder::AsOptional(empty).value().empty());
+
+  sqlbuilder::NameKey key(arena, RecordKey("equipment", "name", "e"));
+  REQUIRE(key.table.data() == arena.Name("equipment").data());
+  REQUIRE(key.table_alias == "e");
+
+  auto names = arena.Names({"a", "b", "a"});
+  REQUIRE(names.size() == 3);
+  REQUIRE(names[0].data() == names[2].data());
+}
@@ -0,0 +1,121 @@
+#define CATCH_CONFIG_MAIN
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/io/async_file.h"
+#include "nvm/io/byte_stream.h"
+
+using namespace nvm;
+
+namespace {
+
+std::vector<uint8_t> MakeContent(size_t size) {
+  std::vector<uint8_t> content(size);
+  for (size_t i = 0; i < size; ++i) {
+    content[i] = static_cast<uint8_t>(i * 31 + 7);
+  }
+  return content;
+}
+
+void RoundTrip(bool prefer_io_uring) {
+  std::string path = prefer_io_uring ? "/tmp/nvm_async_uring.bin"
+                                     : "/tmp/nvm_async_pool.bin";
+  auto content = MakeContent(300000);
+
+  io::AsyncFileOptions options;
+  options.queue_depth = 8;
+  options.prefer_io_uring = prefer_io_uring;
+  {
+    io::AsyncFile file(path, io::AsyncFileMode::Write, options);
+    if (!prefer_io_uring) {
+      REQUIRE(file.Backend() == io::AsyncIoBackend::ThreadPool);
+    }
+    // 5 chunks over a queue of 8, then 19 chunks to exercise refills
+    file.WriteAll(0, Span<const uint8_t>(content), 65536);
+    file.WriteAll(0, Span<const uint8_t>(content), 16000);
+  }
+
+  io::AsyncFile file(path, io::AsyncFileMode::Read, options);
+  REQUIRE(file.FileSize() == content.size());
+
+  auto loaded = file.ReadAll(40000);
+  REQUIRE(loaded == content);
+
+  io::ByteStream<std::vector<uint8_t>> stream(std::move(loaded));
+  uint8_t first = 0;
+  auto cursor = stream.ReadChainStart(0, 1);
+  stream.ReadChain(first, cursor);
+  REQUIRE(first == content[0]);
+
+  // registered buffers, read by index
+  std::vector<uint8_t> a(4096), b(100);
+  file.RegisterBuffers({Span<uint8_t>(a), Span<uint8_t>(b)});
+  io::AsyncIoRequest ra;
+  ra.offset = 1000;
+  ra.buffer_index = 0;
+  io::AsyncIoRequest rb;
+  rb.offset = content.size() - 50;
+  rb.buffer_index = 1;
+  auto futures = file.ReadBatch({ra, rb});
+  REQUIRE(futures[0].get() == 4096);
+  REQUIRE(futures[1].get() == 50);
+  REQUIRE(a[0] == content[1000]);
+  REQUIRE(b[49] == content.back());
+
+  // callback delivery
+  std::promise<int64_t> done;
+  std::vector<uint8_t> small(16);
+  file.Read(8, Span<uint8_t>(small),
+            [&done](int64_t res) { done.set_value(res); });
+  REQUIRE(done.get_future().get() == 16);
+  REQUIRE(small[0] == content[8]);
+
+  std::remove(path.c_str());
+}
+
+}  // namespace
+
+TEST_CASE("async-file thread pool backend", "[io][async-file]") {
+  RoundTrip(false);
+}
+
+TEST_CASE("async-file preferred backend", "[io][async-file]") {
+  RoundTrip(true);
+}
+
+TEST_CASE("async-file errors", "[io][async-file]") {
+  REQUIRE_THROWS_AS(
+      io::AsyncFile("/tmp/nvm_async_missing/x.bin", io::AsyncFileMode::Read),
+      IoException);
+}
+
+TEST_CASE("async-file callbacks with a saturated pool", "[io][async-file]") {
+  std::string path = "/tmp/nvm_async_saturated.bin";
+  auto content = MakeContent(4096);
+
+  io::AsyncFileOptions options;
+  options.queue_depth = 4;
+  // one worker and one queue slot, completions must not wait for the pool
+  options.pool = threads::TaskPool::Create(1, 1);
+  {
+    io::AsyncFile file(path, io::AsyncFileMode::Write, options);
+    file.WriteAll(0, Span<const uint8_t>(content), 512);
+  }
+
+  io::AsyncFile file(path, io::AsyncFileMode::Read, options);
+  std::vector<uint8_t> dest(16);
+  std::atomic<int64_t> total{0};
+  for (int i = 0; i < 64; ++i) {
+    file.Read(0, Span<uint8_t>(dest), [&total](int64_t res) { total += res; });
+  }
+  // Drain() also waits for callbacks still queued on the pool
+  file.Drain();
+  REQUIRE(total.load() == 64 * 16);
+
+  std::remove(path.c_str());
+}
@@ -0,0 +1,123 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/sqlbuilder/batch_insert.h"
+#include "nvm/sqlbuilder/operation.h"
+
+using namespace nvm;
+
+namespace {
+
+using sqlbuilder::CopyFormat;
+using RecordBatchInsert = sqlbuilder::RecordBatchInsert<>;
+
+}  // namespace
+
+TEST_CASE("batch-insert statements", "[sqlbuilder][batch-insert]") {
+  RecordBatchInsert batch("users", {"id", "name"});
+  batch.AddRow(1, std::string("ann")).AddRow(2, std::string("bob"));
+  batch.AddReturning("id");
+
+  REQUIRE(batch.RowCount() == 2);
+  REQUIRE(batch.RowsPerStatement() == 32767);
+  auto statements = batch.Statements();
+  REQUIRE(statements.size() == 1);
+  REQUIRE(*statements[0].sql ==
+          "INSERT INTO users (id, name) VALUES ($1, $2), ($3, $4) "
+          "RETURNING id");
+  REQUIRE(statements[0].values.Size() == 4);
+  REQUIRE(std::get<std::string>(statements[0].values[3]) == "bob");
+
+  REQUIRE_THROWS_AS(batch.AddRow(3), std::invalid_argument);
+  REQUIRE_THROWS_AS(RecordBatchInsert("t", {}), std::invalid_argument);
+  REQUIRE_THROWS_AS(RecordBatchInsert("t", {"a", "b", "c"}, 2),
+                    std::invalid_argument);
+}
+
+TEST_CASE("batch-insert chunks under the parameter limit",
+          "[sqlbuilder][batch-insert]") {
+  // 3 columns, 7 parameters allowed: 2 rows per statement
+  RecordBatchInsert batch("t", {"a", "b", "c"}, 7);
+  for (int i = 0; i < 5; ++i) {
+    batch.AddRow(std::vector<sqlbuilder::DefaultPostgresParamType>{i, i, i});
+  }
+  REQUIRE(batch.StatementCount() == 3);
+
+  auto statements = batch.Statements();
+  REQUIRE(statements.size() == 3);
+  // full chunks share the text
+  REQUIRE(statements[0].sql == statements[1].sql);
+  REQUIRE(*statements[0].sql ==
+          "INSERT INTO t (a, b, c) VALUES ($1, $2, $3), ($4, $5, $6)");
+  REQUIRE(*statements[2].sql == "INSERT INTO t (a, b, c) VALUES ($1, $2, $3)");
+  REQUIRE(statements[2].first_row == 4);
+  REQUIRE(statements[2].row_count == 1);
+  REQUIRE(std::get<int>(statements[2].values[0]) == 4);
+
+  // the real limit
+  RecordBatchInsert wide("t", {"a", "b", "c", "d", "e", "f", "g"});
+  REQUIRE(wide.RowsPerStatement() * wide.ColumnCount() <=
+          RecordBatchInsert::kMaxParameters);
+}
+
+TEST_CASE("batch-insert copy text", "[sqlbuilder][batch-insert]") {
+  using Nullable = std::variant<std::monostate, int, std::string, bool>;
+  sqlbuilder::RecordBatchInsert<Nullable> batch("t", {"id", "note", "ok"});
+  batch.AddRow(1, std::string("tab\there"), true);
+  batch.AddRow(2, std::monostate(), false);
+  batch.AddRow(3, std::string("back\\slash\nline"), true);
+
+  REQUIRE(batch.CopySql(CopyFormat::Text) ==
+          "COPY t (id, note, ok) FROM STDIN");
+  std::string data;
+  batch.WriteCopy(data, CopyFormat::Text);
+  REQUIRE(data ==
+          "1\ttab\\there\tt\n"
+          "2\t\\N\tf\n"
+          "3\tback\\\\slash\\nline\tt\n");
+
+  // streaming pieces gives the same bytes
+  std::string pieces;
+  batch.WriteCopyRows(pieces, CopyFormat::Text, 0, 2);
+  batch.WriteCopyRows(pieces, CopyFormat::Text, 2, 10);
+  REQUIRE(pieces == data);
+}
+
+TEST_CASE("batch-insert copy binary", "[sqlbuilder][batch-insert]") {
+  using Nullable = std::variant<std::monostate, int, std::string>;
+  sqlbuilder::RecordBatchInsert<Nullable> batch("t", {"id", "name"});
+  batch.AddRow(1, std::string("ab"));
+  batch.AddRow(2, std::monostate());
+
+  REQUIRE(batch.CopySql(CopyFormat::Binary) ==
+          "COPY t (id, name) FROM STDIN WITH (FORMAT binary)");
+  std::string data;
+  batch.WriteCopy(data, CopyFormat::Binary);
+
+  const std::string expected(
+      "PGCOPY\n\xff\r\n\0"      // signature
+      "\0\0\0\0\0\0\0\0"        // flags, extension length
+      "\0\x02"                  // 2 fields
+      "\0\0\0\x04\0\0\0\x01"    // id = 1
+      "\0\0\0\x02"
+      "ab"                      // name = ab
+      "\0\x02"                  // 2 fields
+      "\0\0\0\x04\0\0\0\x02"    // id = 2
+      "\xff\xff\xff\xff"        // name is NULL
+      "\xff\xff",               // trailer
+      19 + 2 + 8 + 6 + 2 + 8 + 4 + 2);
+  REQUIRE(data == expected);
+}
+
+TEST_CASE("record-insert appends columns", "[sqlbuilder][batch-insert]") {
+  sqlbuilder::RecordInsert<> insert("t");
+  for (int i = 0; i < 3; ++i) {
+    insert.AddValue("c" + std::to_string(i), i);
+  }
+  REQUIRE(insert.ToString() ==
+          "INSERT INTO t (c0, c1, c2) VALUES ($1, $2, $3)");
+}
@@ -0,0 +1,128 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/bit_stream.h"
+
+using namespace nvm;
+
+TEST_CASE("bit-reader msb first", "[byte][bit-stream]") {
+  // 101 | 10011 | 0000_1111_1111 | 1 (+ padding)
+  std::vector<uint8_t> data = {0xB3, 0x0F, 0xF8};
+  bytes::BitReader reader{Span<const uint8_t>(data)};
+
+  REQUIRE(reader.Read(3) == 0b101);
+  REQUIRE(reader.Peek(5) == 0b10011);
+  REQUIRE(reader.Read(5) == 0b10011);
+  REQUIRE(reader.Read(12) == 0x0FF);
+  REQUIRE(reader.ReadBool());
+  REQUIRE(reader.BitPosition() == 21);
+  REQUIRE(reader.BitsRemaining() == 3);
+  REQUIRE(reader.IsSuccess());
+
+  reader.Read(4);
+  REQUIRE_FALSE(reader.IsSuccess());
+}
+
+TEST_CASE("bit-reader lsb first and signed", "[byte][bit-stream]") {
+  std::vector<uint8_t> data = {0x2D, 0xFF, 0x01};
+  bytes::BitReader reader(Span<const uint8_t>(data), bytes::BitOrder::LsbFirst);
+
+  REQUIRE(reader.Read(3) == 0b101);
+  REQUIRE(reader.Read(5) == 0b00101);
+  REQUIRE(reader.ReadSigned(8) == -1);
+  reader.AlignToByte();
+  REQUIRE(reader.Read(8) == 1);
+}
+
+TEST_CASE("bit-writer round trip across refills", "[byte][bit-stream]") {
+  for (auto order : {bytes::BitOrder::MsbFirst, bytes::BitOrder::LsbFirst}) {
+    std::vector<uint8_t> buffer(260);
+    bytes::BitWriter writer(Span<uint8_t>(buffer), order);
+
+    // mixed widths so fields straddle every byte and cache boundary
+    for (unsigned i = 1; i <= 64; ++i) {
+      writer.Write(0xA5A5A5A5A5A5A5A5ULL ^ i, i);
+    }
+    size_t size = writer.Finish();
+    REQUIRE(writer.IsSuccess());
+    REQUIRE(size == (64 * 65 / 2 + 7) / 8);
+
+    bytes::BitReader reader(Span<const uint8_t>(buffer.data(), size), order);
+    for (unsigned i = 1; i <= 64; ++i) {
+      uint64_t expected = 0xA5A5A5A5A5A5A5A5ULL ^ i;
+      if (i < 64) {
+        expected &= (uint64_t(1) << i) - 1;
+      }
+      REQUIRE(reader.Read(i) == expected);
+    }
+    REQUIRE(reader.IsSuccess());
+  }
+
+  uint8_t small[1];
+  bytes::BitWriter writer{Span<uint8_t>(small)};
+  writer.Write(0x7F, 7).Write(0x3, 2);
+  REQUIRE_FALSE(writer.IsSuccess());
+}
+
+TEST_CASE("bit-writer leaves bytes after Finish alone", "[byte][bit-stream]") {
+  for (auto order : {bytes::BitOrder::MsbFirst, bytes::BitOrder::LsbFirst}) {
+    // a bit-packed header followed by data the caller already placed
+    for (unsigned fields : {1u, 3u, 9u, 13u}) {
+      std::vector<uint8_t> buffer(32, 0xAA);
+      bytes::BitWriter writer(Span<uint8_t>(buffer), order);
+      for (unsigned i = 0; i < fields; ++i) {
+        writer.Write(i, 7);
+      }
+      size_t size = writer.Finish();
+      REQUIRE(writer.IsSuccess());
+      REQUIRE(size == (fields * 7 + 7) / 8);
+      for (size_t i = size; i < buffer.size(); ++i) {
+        REQUIRE(buffer[i] == 0xAA);
+      }
+
+      bytes::BitReader reader(Span<const uint8_t>(buffer.data(), size), order);
+      for (unsigned i = 0; i < fields; ++i) {
+        REQUIRE(reader.Read(7) == i);
+      }
+    }
+  }
+}
+
+TEST_CASE("bit unpack 12-bit samples", "[byte][bit-stream]") {
+  for (auto order : {bytes::BitOrder::MsbFirst, bytes::BitOrder::LsbFirst}) {
+    // odd count exercises the vector body, pair loop and single tail
+    std::vector<uint16_t> samples(101);
+    for (size_t i = 0; i < samples.size(); ++i) {
+      samples[i] = static_cast<uint16_t>((i * 2654435761u) & 0x0FFF);
+    }
+
+    std::vector<uint8_t> packed((samples.size() * 12 + 7) / 8);
+    size_t written = 0;
+    REQUIRE(bytes::PackBits(samples.data(), samples.size(), 12,
+                            Span<uint8_t>(packed), written,
+                            order) == bytes::ByteOpResult::Ok);
+    REQUIRE(written == packed.size());
+
+    std::vector<uint16_t> unpacked(samples.size());
+    REQUIRE(bytes::UnpackBits(Span<const uint8_t>(packed), 12, unpacked.data(),
+                              unpacked.size(),
+                              order) == bytes::ByteOpResult::Ok);
+    REQUIRE(unpacked == samples);
+
+    // generic width goes through BitReader
+    std::vector<uint32_t> wide(10);
+    REQUIRE(bytes::UnpackBits(Span<const uint8_t>(packed), 24, wide.data(),
+                              wide.size(), order) == bytes::ByteOpResult::Ok);
+  }
+
+  std::vector<uint8_t> packed = {0xAB, 0xCD, 0xEF};
+  uint16_t out[2];
+  REQUIRE(bytes::UnpackBits(Span<const uint8_t>(packed), 12, out, 2) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(out[0] == 0xABC);
+  REQUIRE(out[1] == 0xDEF);
+  REQUIRE(bytes::UnpackBits(Span<const uint8_t>(packed), 12, out, 3) ==
+          bytes::ByteOpResult::SizeMismatch);
+}
@@ -0,0 +1,163 @@
+#define CATCH_CONFIG_MAIN
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/byte.h"
+#include "nvm/memory/buffer_pool.h"
+
+using namespace nvm;
+
+TEST_CASE("buffer-pool recycles slabs", "[memory][buffer-pool]") {
+  memory::BufferPool pool(256, 8);
+  REQUIRE(pool.SlabSize() == 256);
+
+  const uint8_t* first = nullptr;
+  {
+    auto buffer = pool.Allocate();
+    REQUIRE(buffer.Capacity() == 256);
+    first = buffer.Data();
+  }
+
+  // same thread gets the cached slab back
+  auto buffer = pool.Allocate();
+  REQUIRE(buffer.Data() == first);
+  REQUIRE(pool.SlabsCreated() == 1);
+
+  // slabs released on another thread land in the shared list at thread exit
+  std::thread worker([&pool] {
+    std::vector<memory::PooledBuffer> buffers;
+    for (int i = 0; i < 4; ++i) {
+      buffers.push_back(pool.Allocate());
+    }
+  });
+  worker.join();
+  REQUIRE(pool.FreeSlabs() == 4);
+  auto other = pool.Allocate();
+  REQUIRE(pool.SlabsCreated() == 5);
+}
+
+TEST_CASE("buffer-pool frees slabs cached by other threads",
+          "[memory][buffer-pool]") {
+  auto pool = std::make_unique<memory::BufferPool>(256, 8);
+  const size_t before = memory::BufferPool::SlabsAlive();
+
+  std::promise<void> cached, destroyed, touched, done;
+  std::thread worker([&] {
+    {
+      std::vector<memory::PooledBuffer> buffers;
+      for (int i = 0; i < 4; ++i) {
+        buffers.push_back(pool->Allocate());
+      }
+    }
+    cached.set_value();
+    destroyed.get_future().wait();
+
+    // any use of this thread's cache drops the slabs of the dead pool
+    {
+      memory::BufferPool other(64, 1);
+      other.Allocate();
+    }
+    touched.set_value();
+    done.get_future().wait();
+  });
+
+  cached.get_future().wait();
+  REQUIRE(memory::BufferPool::SlabsAlive() == before + 4);
+  pool.reset();
+  REQUIRE(memory::BufferPool::SlabsAlive() == before + 4);
+
+  destroyed.set_value();
+  touched.get_future().wait();
+  REQUIRE(memory::BufferPool::SlabsAlive() == before);
+
+  done.set_value();
+  worker.join();
+}
+
+TEST_CASE("buffer-pool slices share bytes", "[memory][buffer-pool]") {
+  memory::Slice tail;
+  {
+    memory::BufferPool pool(64);
+    auto buffer = pool.Allocate();
+    uint32_t value = 0xA1B2C3D4;
+    REQUIRE(bytes::ToBytes(value, buffer.Data(), buffer.Capacity(),
+                           bytes::EndianessType::BigEndian) ==
+            bytes::ByteOpResult::Ok);
+    std::memcpy(buffer.Data() + 4, "abcd", 4);
+    buffer.Resize(8);
+
+    auto slice = buffer.ToSlice();
+    REQUIRE(buffer.Empty());
+    REQUIRE(slice.Size() == 8);
+    REQUIRE(slice.Data()[0] == 0xA1);
+
+    auto copy = slice;
+    REQUIRE(slice.UseCount() == 2);
+    tail = slice.Subslice(4, 100);
+    REQUIRE(slice.UseCount() == 3);
+    REQUIRE(tail.Size() == 4);
+    REQUIRE(std::string(reinterpret_cast<const char*>(tail.Data()), 4) ==
+            "abcd");
+  }
+
+  // the pool is gone, the slice still owns its slab
+  REQUIRE(tail.UseCount() == 1);
+  REQUIRE(tail.Data()[3] == 'd');
+}
+
+TEST_CASE("buffer-chain writer and writev", "[memory][buffer-pool]") {
+  memory::BufferPool pool(16);
+  memory::ChainWriter writer(pool);
+
+  auto span = writer.Reserve(2);
+  REQUIRE(span.Size() == 2);
+  uint16_t length = 40;
+  bytes::ToBytes(length, span.Data(), span.Size(),
+                 bytes::EndianessType::BigEndian);
+  writer.Commit(2);
+
+  std::string payload(40, 'x');
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<char>('a' + i % 26);
+  }
+  writer.Write(reinterpret_cast<const uint8_t*>(payload.data()),
+               payload.size());
+  REQUIRE(writer.Size() == 42);
+  REQUIRE(writer.Reserve(17).Empty());
+
+  auto chain = writer.Finish();
+  REQUIRE(chain.Size() == 42);
+  REQUIRE(chain.SliceCount() == 3);
+
+  // forwarding shares, no copy
+  memory::BufferChain forwarded;
+  forwarded.Append(chain);
+  REQUIRE(forwarded.Slices()[0].UseCount() == 2);
+
+  auto flat = chain.Flatten();
+  REQUIRE(flat[0] == 0);
+  REQUIRE(flat[1] == 40);
+  REQUIRE(std::string(flat.begin() + 2, flat.end()) == payload);
+
+  chain.Consume(20);
+  REQUIRE(chain.Size() == 22);
+  REQUIRE(chain.Flatten()[0] == static_cast<uint8_t>(payload[18]));
+
+  int fds[2];
+  REQUIRE(::pipe(fds) == 0);
+  REQUIRE(forwarded.WriteTo(fds[1]) == 42);
+  REQUIRE(forwarded.Empty());
+  std::vector<uint8_t> received(42);
+  REQUIRE(::read(fds[0], received.data(), received.size()) == 42);
+  REQUIRE(received == flat);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
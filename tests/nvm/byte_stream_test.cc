@@ -0,0 +1,94 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/io/byte_stream.h"
+
+using namespace nvm;
+
+TEST_CASE("byte-stream write then chained read", "[io][byte-stream]") {
+  io::ByteStreamWriter<uint8_t> writer(64, bytes::EndianessType::BigEndian);
+  writer.WriteChain(uint16_t(0xCAFE))
+      .WriteChain(int32_t(-42))
+      .WriteChain(uint8_t(7))
+      .WriteChain(3.5)
+      .WriteChain(std::string_view("hello"))
+      .WriteChain(int64_t(1) << 40, bytes::EndianessType::LittleEndian);
+
+  REQUIRE(writer.IsSuccess());
+  REQUIRE(writer.Size() == 2 + 4 + 1 + 8 + 5 + 8);
+
+  auto buffer = writer.Release();
+  io::ByteStream<Span<const uint8_t>, uint8_t> stream(
+      Span<const uint8_t>(buffer), bytes::EndianessType::BigEndian);
+
+  uint16_t magic = 0;
+  int32_t value = 0;
+  uint8_t flag = 0;
+  double ratio = 0;
+  std::string_view name;
+  int64_t big = 0;
+
+  auto cursor = stream.ReadChainStart(0, buffer.size());
+  stream.ReadChain(magic, cursor)
+      .ReadChain(value, cursor)
+      .ReadChain(flag, cursor)
+      .ReadChain(ratio, cursor)
+      .ReadChain(name, 5, cursor)
+      .ReadChain(big, cursor, bytes::EndianessType::LittleEndian);
+
+  REQUIRE(cursor.IsSuccess());
+  REQUIRE(cursor.Remaining() == 0);
+  REQUIRE(magic == 0xCAFE);
+  REQUIRE(value == -42);
+  REQUIRE(flag == 7);
+  REQUIRE(ratio == 3.5);
+  REQUIRE(name == "hello");
+  REQUIRE(big == (int64_t(1) << 40));
+
+  // string_view references the buffer, no copy
+  REQUIRE(reinterpret_cast<const uint8_t*>(name.data()) ==
+          buffer.data() + 15);
+}
+
+TEST_CASE("byte-stream out of bound", "[io][byte-stream]") {
+  std::vector<uint8_t> buffer = {0x01, 0x02, 0x03};
+  io::ByteStream<std::vector<uint8_t>, uint8_t> stream(std::move(buffer));
+
+  auto bad = stream.ReadChainStart(2, 4);
+  REQUIRE_FALSE(bad.IsSuccess());
+
+  uint16_t a = 0;
+  uint32_t b = 0;
+  auto cursor = stream.ReadChainStart(0);
+  stream.ReadChain(a, cursor).ReadChain(b, cursor);
+  REQUIRE_FALSE(cursor.IsSuccess());
+  REQUIRE(a == 0x0201);
+  REQUIRE(cursor.FinalPosition() == 2);
+
+  // reads never go past the reserved window even if the source is larger
+  auto window = stream.ReadChainStart(0, 1);
+  stream.ReadChain(a, window);
+  REQUIRE_FALSE(window.IsSuccess());
+}
+
+TEST_CASE("byte-stream span and callback read", "[io][byte-stream]") {
+  std::vector<uint8_t> buffer = {0x00, 0x00, 0x80, 0x3F, 0xAA, 0xBB};
+  io::ByteStream<Span<const uint8_t>, uint8_t> stream{
+      Span<const uint8_t>(buffer)};
+
+  float got = 0.0f;
+  Span<const uint8_t> tail;
+  auto cursor = stream.ReadChainStart(0);
+  stream.ReadChain<float>(cursor, [&got](const float& v) { got = v; })
+      .ReadChain(tail, 2, cursor);
+
+  REQUIRE(cursor.IsSuccess());
+  REQUIRE(got == 1.0f);
+  REQUIRE(tail.Size() == 2);
+  REQUIRE(tail.Data() == buffer.data() + 4);
+  REQUIRE(tail[1] == 0xBB);
+}
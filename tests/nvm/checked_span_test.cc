@@ -0,0 +1,131 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/byte.h"
+#include "nvm/bytes/checked_span.h"
+
+using namespace nvm;
+
+namespace {
+
+// id u32, flags u16, value f64, tag char[4]
+std::vector<uint8_t> MakeRecord(uint32_t id, uint16_t flags, double value,
+                                bytes::EndianessType endianess) {
+  std::vector<uint8_t> out(18, 0);
+  REQUIRE(bytes::ToBytes(id, out.data(), 4, endianess) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(bytes::ToBytes(flags, out.data() + 4, 2, endianess) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(bytes::ToBytes(value, out.data() + 6, 8, endianess) ==
+          bytes::ByteOpResult::Ok);
+  out[14] = 'a';
+  out[15] = 'b';
+  return out;
+}
+
+struct Sample {
+  uint16_t channel;
+  int32_t reading;
+
+  using types = std::tuple<uint16_t, int32_t>;
+};
+
+}  // namespace
+
+TEST_CASE("checked-span validates once", "[byte][checked-span]") {
+  for (auto endianess :
+       {bytes::EndianessType::LittleEndian, bytes::EndianessType::BigEndian}) {
+    auto buffer = MakeRecord(0xA1B2C3D4, 0x0102, -12.25, endianess);
+
+    bytes::ByteOpResult err = bytes::ByteOpResult::None;
+    auto rec = bytes::CheckSpan<18>(buffer.data(), buffer.size(), err,
+                                    endianess);
+    REQUIRE(err == bytes::ByteOpResult::Ok);
+    REQUIRE(rec.has_value());
+    REQUIRE(rec->Size() == 18);
+    REQUIRE(rec->IsBigEndian() ==
+            (endianess == bytes::EndianessType::BigEndian));
+
+    // the checked reads agree with the per-field decoders
+    bytes::ByteOpResult r = bytes::ByteOpResult::None;
+    REQUIRE(rec->Get<uint32_t, 0>() ==
+            bytes::ToUint32(buffer.data(), 4, r, endianess));
+    REQUIRE(rec->Get<uint32_t, 0>() == 0xA1B2C3D4);
+    REQUIRE(rec->Get<uint16_t, 4>() == 0x0102);
+    REQUIRE(rec->Get<double, 6>() == -12.25);
+    REQUIRE(rec->Get<bytes::wire::FixedString<4>, 14>() == "ab");
+    REQUIRE(rec->GetUnchecked<uint16_t>(4) == 0x0102);
+
+    auto fields = rec->Unpack<uint32_t, uint16_t, double,
+                              bytes::wire::FixedString<4>>();
+    REQUIRE(std::get<0>(fields) == 0xA1B2C3D4);
+    REQUIRE(std::get<1>(fields) == 0x0102);
+    REQUIRE(std::get<2>(fields) == -12.25);
+    REQUIRE(std::get<3>(fields) == "ab");
+
+    auto tail = rec->Sub<4, 10>();
+    REQUIRE(tail.Size() == 10);
+    REQUIRE(tail.Get<uint16_t, 0>() == 0x0102);
+    REQUIRE(tail.ToSpan().Data() == buffer.data() + 4);
+  }
+
+  // markers override the span byte order
+  const uint8_t mixed[] = {0x00, 0x01, 0x01, 0x00};
+  auto span = bytes::CheckSpan<4>(Span<const uint8_t>(mixed));
+  REQUIRE(span.has_value());
+  REQUIRE(span->Get<bytes::wire::Be<uint16_t>, 0>() == 1);
+  REQUIRE(span->Get<bytes::wire::Le<uint16_t>, 2>() == 1);
+}
+
+TEST_CASE("checked-span rejects short input", "[byte][checked-span]") {
+  std::vector<uint8_t> buffer(17, 0);
+  bytes::ByteOpResult err = bytes::ByteOpResult::Ok;
+
+  REQUIRE_FALSE(bytes::CheckSpan<18>(buffer.data(), buffer.size(), err));
+  REQUIRE(err == bytes::ByteOpResult::SizeMismatch);
+
+  REQUIRE_FALSE(bytes::CheckSpan<18>(nullptr, 18, err));
+  REQUIRE(err == bytes::ByteOpResult::Nullptr);
+
+  REQUIRE_FALSE(bytes::CheckSpan<18>(Span<const uint8_t>(buffer)));
+  REQUIRE(bytes::CheckSpan<17>(Span<const uint8_t>(buffer)));
+}
+
+TEST_CASE("checked-span arrays", "[byte][checked-span]") {
+  std::vector<uint8_t> buffer;
+  for (uint16_t i = 0; i < 10; ++i) {
+    uint8_t record[6];
+    bytes::ToBytes(i, record, 2, bytes::EndianessType::BigEndian);
+    bytes::ToBytes(int32_t(-i * 1000), record + 2, 4,
+                   bytes::EndianessType::BigEndian);
+    buffer.insert(buffer.end(), record, record + 6);
+  }
+  buffer.push_back(0xFF);  // partial trailing record
+
+  auto records = bytes::CheckSpanArray<6>(Span<const uint8_t>(buffer),
+                                          bytes::EndianessType::BigEndian);
+  REQUIRE(records.has_value());
+  REQUIRE(records->Count() == 10);
+  for (size_t i = 0; i < records->Count(); ++i) {
+    auto rec = (*records)[i];
+    REQUIRE(rec.Get<uint16_t, 0>() == i);
+    REQUIRE(rec.Get<int32_t, 2>() == -static_cast<int32_t>(i) * 1000);
+
+    Sample sample = bytes::DecodeRecord<Sample>(rec);
+    REQUIRE(sample.channel == i);
+    REQUIRE(sample.reading == -static_cast<int32_t>(i) * 1000);
+  }
+  REQUIRE_THROWS_AS(records->At(10), std::out_of_range);
+
+  bytes::ByteOpResult err = bytes::ByteOpResult::None;
+  REQUIRE_FALSE(bytes::CheckSpanArray<6>(buffer.data(), buffer.size(), 11,
+                                         err));
+  REQUIRE(err == bytes::ByteOpResult::SizeMismatch);
+  REQUIRE(bytes::CheckSpanArray<6>(nullptr, 0, 0, err));
+  REQUIRE(err == bytes::ByteOpResult::Ok);
+}
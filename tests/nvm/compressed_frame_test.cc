@@ -0,0 +1,217 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/lz_block.h"
+#include "nvm/exceptions/exception.h"
+#include "nvm/io/byte_stream.h"
+#include "nvm/io/compressed_frame.h"
+#include "nvm/threads/task_pool.h"
+
+using namespace nvm;
+
+namespace {
+
+std::vector<uint8_t> RandomBytes(size_t size, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> out(size);
+  for (auto& b : out) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return out;
+}
+
+/// Record-like data, compressible but not trivial.
+std::vector<uint8_t> RecordBytes(size_t count) {
+  io::ByteStreamWriter<uint8_t> writer;
+  std::mt19937 rng(5);
+  for (size_t i = 0; i < count; ++i) {
+    writer.WriteChain(uint32_t(i))
+        .WriteChain(uint16_t(rng() % 16))
+        .WriteChain(std::string_view("sensor-reading"))
+        .WriteChain(double(i % 100) * 0.5);
+  }
+  return writer.Release();
+}
+
+std::vector<uint8_t> RoundTripBlock(const std::vector<uint8_t>& input) {
+  bytes::LzCompressor compressor;
+  std::vector<uint8_t> packed(bytes::LzCompressBound(input.size()));
+  size_t n = compressor.Compress(input.data(), input.size(), packed.data(),
+                                 packed.size());
+  REQUIRE(n > 0);
+
+  std::vector<uint8_t> out(input.size());
+  size_t written = 0;
+  auto r = bytes::LzDecompress(packed.data(), n, out.data(), out.size(),
+                               written);
+  REQUIRE(r == bytes::ByteOpResult::Ok);
+  REQUIRE(written == input.size());
+  return out;
+}
+
+}  // namespace
+
+TEST_CASE("lz block round trip", "[byte][lz]") {
+  for (size_t size : {0, 1, 5, 12, 13, 64, 1000, 70000}) {
+    INFO(size);
+    auto random = RandomBytes(size, 1);
+    REQUIRE(RoundTripBlock(random) == random);
+
+    std::vector<uint8_t> zeros(size, 0);
+    REQUIRE(RoundTripBlock(zeros) == zeros);
+  }
+
+  auto records = RecordBytes(2000);
+  REQUIRE(RoundTripBlock(records) == records);
+
+  bytes::LzCompressor compressor;
+  std::vector<uint8_t> packed(bytes::LzCompressBound(records.size()));
+  size_t n = compressor.Compress(records.data(), records.size(), packed.data(),
+                                 packed.size());
+  REQUIRE(n < records.size() / 2);
+
+  // too small output
+  REQUIRE(compressor.Compress(records.data(), records.size(), packed.data(),
+                              16) == 0);
+}
+
+TEST_CASE("lz decompress rejects malformed input", "[byte][lz]") {
+  uint8_t out[128];
+  size_t written = 0;
+
+  // literal run longer than the input
+  const uint8_t truncated[] = {0x50, 'a', 'b'};
+  REQUIRE(bytes::LzDecompress(truncated, sizeof(truncated), out, sizeof(out),
+                              written) == bytes::ByteOpResult::Truncated);
+
+  // match before the start of the output
+  const uint8_t bad_offset[] = {0x10, 'a', 0x05, 0x00, 0x00};
+  REQUIRE(bytes::LzDecompress(bad_offset, sizeof(bad_offset), out,
+                              sizeof(out), written) ==
+          bytes::ByteOpResult::None);
+
+  // output too small for the match
+  const uint8_t repeat[] = {0x1F, 'a', 0x01, 0x00, 0x40, 0x00};
+  REQUIRE(bytes::LzDecompress(repeat, sizeof(repeat), out, 8, written) ==
+          bytes::ByteOpResult::SizeMismatch);
+  REQUIRE(bytes::LzDecompress(repeat, sizeof(repeat), out, sizeof(out),
+                              written) == bytes::ByteOpResult::Ok);
+  REQUIRE(written == 1 + 15 + 64 + 4);
+}
+
+TEST_CASE("compressed frame round trip", "[io][compress]") {
+  auto records = RecordBytes(20000);
+  auto random = RandomBytes(100000, 3);
+
+  for (auto mode : {io::CompressionBlockMode::Independent,
+                    io::CompressionBlockMode::Linked}) {
+    for (bool checksum : {true, false}) {
+      io::CompressedFrameOptions options;
+      options.block_size = 4096;
+      options.mode = mode;
+      options.checksum = checksum;
+
+      for (const auto* input : {&records, &random}) {
+        auto frame = io::CompressFrame(Span<const uint8_t>(*input), options);
+        std::vector<uint8_t> out;
+        REQUIRE(io::DecompressFrame(Span<const uint8_t>(frame), out));
+        REQUIRE(out == *input);
+      }
+
+      auto frame = io::CompressFrame(Span<const uint8_t>(records), options);
+      REQUIRE(frame.size() < records.size() / 2);
+    }
+  }
+
+  // empty input still makes a valid frame
+  auto empty = io::CompressFrame(Span<const uint8_t>());
+  std::vector<uint8_t> out{1, 2, 3};
+  REQUIRE(io::DecompressFrame(Span<const uint8_t>(empty), out));
+  REQUIRE(out.empty());
+}
+
+TEST_CASE("compressed frame streaming api", "[io][compress]") {
+  auto records = RecordBytes(5000);
+
+  io::CompressedFrameOptions options;
+  options.block_size = 1024;
+  options.mode = io::CompressionBlockMode::Linked;
+  io::CompressedFrameWriter writer(options);
+
+  // odd write sizes cross block boundaries
+  for (size_t offset = 0; offset < records.size(); offset += 777) {
+    size_t n = std::min<size_t>(777, records.size() - offset);
+    writer.Write(records.data() + offset, n);
+  }
+  REQUIRE(writer.Bytes().Size() > 0);
+  auto frame = writer.Finish();
+  REQUIRE_THROWS_AS(writer.Write(records.data(), 1), RuntimeException);
+
+  io::CompressedFrameReader reader{Span<const uint8_t>(frame)};
+  REQUIRE(reader.IsSuccess());
+  REQUIRE(reader.Options().mode == io::CompressionBlockMode::Linked);
+  REQUIRE(reader.Options().block_size == 1024);
+
+  std::vector<uint8_t> out;
+  Span<const uint8_t> block;
+  size_t blocks = 0;
+  while (reader.NextBlock(block)) {
+    REQUIRE(block.Size() <= 1024);
+    out.insert(out.end(), block.Begin(), block.End());
+    ++blocks;
+  }
+  REQUIRE(reader.IsSuccess());
+  REQUIRE(blocks == (records.size() + 1023) / 1024);
+  REQUIRE(out == records);
+
+  // decoded bytes feed straight into a ByteStream
+  io::ByteStream<Span<const uint8_t>, uint8_t> stream{
+      Span<const uint8_t>(out)};
+  uint32_t id = 1;
+  auto cursor = stream.ReadChainStart(0, 4);
+  stream.ReadChain(id, cursor);
+  REQUIRE(cursor.IsSuccess());
+  REQUIRE(id == 0);
+}
+
+TEST_CASE("compressed frame parallel decode", "[io][compress]") {
+  auto records = RecordBytes(50000);
+  io::CompressedFrameOptions options;
+  options.block_size = 8192;
+  auto frame = io::CompressFrame(Span<const uint8_t>(records), options);
+
+  auto pool = threads::TaskPool::Create(4);
+  std::vector<uint8_t> out;
+  REQUIRE(io::DecompressFrame(Span<const uint8_t>(frame), out, pool));
+  REQUIRE(out == records);
+}
+
+TEST_CASE("compressed frame detects corruption", "[io][compress]") {
+  auto records = RecordBytes(3000);
+  io::CompressedFrameOptions options;
+  options.block_size = 2048;
+  auto frame = io::CompressFrame(Span<const uint8_t>(records), options);
+  std::vector<uint8_t> out;
+
+  auto damaged = frame;
+  damaged[damaged.size() / 2] ^= 0x01;
+  auto pool = threads::TaskPool::Create(2);
+  REQUIRE_FALSE(io::DecompressFrame(Span<const uint8_t>(damaged), out, pool));
+
+  auto truncated = frame;
+  truncated.resize(frame.size() - 10);
+  REQUIRE_FALSE(io::DecompressFrame(Span<const uint8_t>(truncated), out));
+
+  auto bad_magic = frame;
+  bad_magic[0] = 'X';
+  io::CompressedFrameReader reader{Span<const uint8_t>(bad_magic)};
+  REQUIRE_FALSE(reader.IsSuccess());
+
+  io::CompressedFrameOptions invalid;
+  invalid.block_size = 100;
+  REQUIRE_THROWS_AS(io::CompressedFrameWriter(invalid), InvalidArgException);
+}
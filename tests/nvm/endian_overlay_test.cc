@@ -0,0 +1,101 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/byte.h"
+#include "nvm/bytes/endian_overlay.h"
+
+using namespace nvm;
+
+namespace {
+
+struct PacketHeader {
+  bytes::BigEndian<uint16_t> magic;
+  uint8_t version;
+  uint8_t flags;
+  bytes::BigEndian<uint32_t> length;
+  bytes::LittleEndian<int16_t> offset;
+  bytes::BigEndian<double> timestamp;
+};
+
+struct Sample {
+  bytes::LittleEndian<uint16_t> channel;
+  bytes::LittleEndian<float> value;
+};
+
+}  // namespace
+
+static_assert(sizeof(PacketHeader) == 18, "overlay must not be padded");
+static_assert(sizeof(Sample) == 6, "overlay must not be padded");
+static_assert(bytes::IsOverlayable<PacketHeader>::value, "");
+
+TEST_CASE("endian overlay reads a header in place", "[byte][overlay]") {
+  std::vector<uint8_t> buffer(32, 0);
+  bytes::ByteOpResult r;
+  // start at an odd offset, fields are unaligned
+  uint8_t* p = buffer.data() + 1;
+  r = bytes::ToBytes(uint16_t(0xCAFE), p, 2, bytes::EndianessType::BigEndian);
+  p[2] = 3;
+  p[3] = 0x81;
+  r = bytes::ToBytes(uint32_t(123456789), p + 4, 4,
+                     bytes::EndianessType::BigEndian);
+  r = bytes::ToBytes(int16_t(-42), p + 8, 2,
+                     bytes::EndianessType::LittleEndian);
+  r = bytes::ToBytes(1.5e9, p + 10, 8, bytes::EndianessType::BigEndian);
+  REQUIRE(r == bytes::ByteOpResult::Ok);
+
+  Span<const uint8_t> view(buffer.data(), buffer.size());
+  auto header = bytes::Overlay<PacketHeader>(view, 1);
+  REQUIRE(header != nullptr);
+  REQUIRE(header->magic == 0xCAFE);
+  REQUIRE(header->version == 3);
+  REQUIRE(header->flags == 0x81);
+  REQUIRE(header->length.Get() == 123456789u);
+  REQUIRE(header->offset == -42);
+  REQUIRE(header->timestamp == 1.5e9);
+
+  // too short
+  REQUIRE(bytes::Overlay<PacketHeader>(view, 20) == nullptr);
+  REQUIRE(bytes::Overlay<PacketHeader>(view, 40) == nullptr);
+  REQUIRE(bytes::Overlay<PacketHeader>(Span<const uint8_t>()) == nullptr);
+}
+
+TEST_CASE("endian overlay writes through to the buffer", "[byte][overlay]") {
+  std::vector<uint8_t> buffer(18, 0);
+  auto header = bytes::Overlay<PacketHeader>(Span<uint8_t>(buffer));
+  REQUIRE(header != nullptr);
+  header->magic = 0x1234;
+  header->length = 0x01020304;
+  header->offset = int16_t(0x0506);
+
+  REQUIRE(buffer[0] == 0x12);
+  REQUIRE(buffer[1] == 0x34);
+  REQUIRE(buffer[4] == 0x01);
+  REQUIRE(buffer[7] == 0x04);
+  REQUIRE(buffer[8] == 0x06);
+  REQUIRE(buffer[9] == 0x05);
+
+  bytes::ByteOpResult r;
+  REQUIRE(bytes::ToUint32(buffer.data() + 4, 4, r,
+                          bytes::EndianessType::BigEndian) == 0x01020304u);
+}
+
+TEST_CASE("endian overlay array", "[byte][overlay]") {
+  std::vector<uint8_t> buffer(3 * sizeof(Sample) + 2);
+  auto samples = bytes::OverlayArray<Sample>(Span<uint8_t>(buffer));
+  REQUIRE(samples.Size() == 3);
+  for (size_t i = 0; i < samples.Size(); ++i) {
+    samples[i].channel = static_cast<uint16_t>(i + 1);
+    samples[i].value = 0.25f * i;
+  }
+
+  auto read = bytes::OverlayArray<Sample>(Span<const uint8_t>(buffer));
+  REQUIRE(read.Size() == 3);
+  REQUIRE(read[2].channel == 3);
+  REQUIRE(read[2].value == 0.5f);
+
+  bytes::ByteOpResult r;
+  REQUIRE(bytes::ToFloat(buffer.data() + 8, 4, r,
+                         bytes::EndianessType::LittleEndian) == 0.25f);
+}
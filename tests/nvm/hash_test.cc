@@ -0,0 +1,96 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/hash.h"
+
+using namespace nvm;
+
+TEST_CASE("hash64 is deterministic and seeded", "[byte][hash]") {
+  std::string key = "SELECT * FROM users WHERE id = $1";
+  REQUIRE(bytes::Hash64(key) == bytes::Hash64(key.data(), key.size()));
+  REQUIRE(bytes::Hash64(key) == bytes::Hash64(key, 0));
+  REQUIRE(bytes::Hash64(key, 1) != bytes::Hash64(key, 2));
+  REQUIRE(bytes::Hash64(key) != bytes::Hash64(key.data(), key.size() - 1));
+
+  // every length class differs from its neighbours
+  std::string text(200, 'a');
+  std::unordered_set<uint64_t> seen;
+  for (size_t n = 0; n <= text.size(); ++n) {
+    seen.insert(bytes::Hash64(text.data(), n));
+  }
+  REQUIRE(seen.size() == text.size() + 1);
+}
+
+TEST_CASE("hash64 has no collisions on sequential keys", "[byte][hash]") {
+  std::unordered_set<uint64_t> seen;
+  for (int i = 0; i < 100000; ++i) {
+    seen.insert(bytes::Hash64("key:" + std::to_string(i)));
+  }
+  REQUIRE(seen.size() == 100000);
+}
+
+TEST_CASE("streaming hash matches one shot", "[byte][hash]") {
+  std::mt19937 rng(99);
+  std::vector<uint8_t> data(1000);
+  for (auto& b : data) {
+    b = static_cast<uint8_t>(rng());
+  }
+
+  for (size_t len : {0, 1, 3, 4, 15, 16, 17, 47, 48, 49, 95, 96, 97, 144, 145,
+                     500, 1000}) {
+    uint64_t expected = bytes::Hash64(data.data(), len, 7);
+    auto expected128 = bytes::Hash128(data.data(), len, 7);
+
+    for (int round = 0; round < 20; ++round) {
+      bytes::Hasher64 hasher(7);
+      bytes::Hasher128 hasher128(7);
+      size_t offset = 0;
+      while (offset < len) {
+        size_t n = std::min<size_t>(rng() % 70, len - offset);
+        hasher.Update(data.data() + offset, n);
+        hasher128.Update(Span<const uint8_t>(data.data() + offset, n));
+        offset += n;
+      }
+      INFO(len);
+      REQUIRE(hasher.Digest() == expected);
+      REQUIRE(hasher128.Digest() == expected128);
+    }
+  }
+
+  bytes::Hasher64 hasher(3);
+  hasher.Update(std::string("abc"));
+  REQUIRE(hasher.Digest() == bytes::Hash64(std::string("abc"), 3));
+  hasher.Reset(3);
+  REQUIRE(hasher.Digest() == bytes::Hash64(nullptr, 0, 3));
+}
+
+TEST_CASE("hash128 lanes are independent", "[byte][hash]") {
+  std::string key = "fingerprint";
+  auto h = bytes::Hash128(key);
+  REQUIRE(h.low == bytes::Hash64(key));
+  REQUIRE(h.high != h.low);
+  REQUIRE(bytes::Hash128(key, 1) != h);
+}
+
+TEST_CASE("BytesHash works as unordered_map hasher", "[byte][hash]") {
+  std::unordered_map<std::string, int, bytes::BytesHash> map;
+  map["one"] = 1;
+  map["two"] = 2;
+  REQUIRE(map.at("one") == 1);
+  REQUIRE(map.at("two") == 2);
+
+  std::string value = "payload";
+  bytes::BytesHash hasher;
+  Span<const char> chars(value.data(), value.size());
+  Span<const uint8_t> raw(reinterpret_cast<const uint8_t*>(value.data()),
+                          value.size());
+  REQUIRE(hasher(value) == hasher(chars));
+  REQUIRE(hasher(value) == hasher(raw));
+  REQUIRE(hasher(value) == hasher("payload"));
+}
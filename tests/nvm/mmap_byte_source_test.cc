@@ -0,0 +1,115 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/io/byte_stream.h"
+#include "nvm/io/mmap_byte_source.h"
+
+using namespace nvm;
+
+namespace {
+
+std::string TempPath(const std::string& name) {
+  return "/tmp/nvm_mmap_" + name + ".bin";
+}
+
+void WriteFile(const std::string& path, Span<const uint8_t> content) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char*>(content.Data()), content.Size());
+}
+
+}  // namespace
+
+TEST_CASE("mmap-byte-source read through byte stream", "[io][mmap]") {
+  io::ByteStreamWriter<uint8_t> writer(0, bytes::EndianessType::BigEndian);
+  writer.WriteChain(uint32_t(0xDEADBEEF))
+      .WriteChain(int16_t(-3))
+      .WriteChain(std::string_view("mapped"));
+  auto path = TempPath("read");
+  WriteFile(path, writer.Bytes());
+
+  io::ByteStream<io::MmapByteSource> stream(io::MmapByteSource(path),
+                                            bytes::EndianessType::BigEndian);
+  REQUIRE(stream.Size() == 4 + 2 + 6);
+
+  uint32_t magic = 0;
+  int16_t value = 0;
+  std::string_view name;
+  auto cursor = stream.ReadChainStart(0);
+  stream.ReadChain(magic, cursor).ReadChain(value, cursor).ReadChain(name, 6,
+                                                                      cursor);
+  REQUIRE(cursor.IsSuccess());
+  REQUIRE(magic == 0xDEADBEEF);
+  REQUIRE(value == -3);
+  REQUIRE(name == "mapped");
+
+  std::remove(path.c_str());
+  REQUIRE_THROWS_AS(io::MmapByteSource(path), IoException);
+}
+
+TEST_CASE("mmap-byte-source windowed remap", "[io][mmap]") {
+  size_t page = io::MmapByteSource::PageSize();
+  std::vector<uint8_t> content(page * 3 + 100);
+  for (size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<uint8_t>(i * 7);
+  }
+  auto path = TempPath("window");
+  WriteFile(path, Span<const uint8_t>(content));
+
+  io::ByteStream<io::MmapByteSource> stream(
+      io::MmapByteSource(path, io::MmapAccessHint::Sequential, page));
+  auto& source = stream.Source();
+  REQUIRE(source.IsWindowed());
+  REQUIRE(source.FileSize() == content.size());
+  REQUIRE(stream.Size() == page);
+
+  // unaligned offset, the window starts mid-page
+  size_t offset = page * 2 + 10;
+  auto view = source.MapWindow(offset);
+  REQUIRE(source.WindowOffset() == offset);
+  REQUIRE(view.Size() == page - 10);
+  REQUIRE(view[0] == content[offset]);
+  REQUIRE(source.WillNeed(0, view.Size()));
+
+  // tail window is clamped to the end of the file
+  view = source.MapWindow(page * 3);
+  REQUIRE(view.Size() == 100);
+  uint8_t last = 0;
+  auto cursor = stream.ReadChainStart(99, 1);
+  stream.ReadChain(last, cursor);
+  REQUIRE(cursor.IsSuccess());
+  REQUIRE(last == content.back());
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("mmap-byte-sink write and trim", "[io][mmap]") {
+  auto path = TempPath("sink");
+  {
+    io::MmapByteSink sink(path, 4096);
+    REQUIRE(sink.Size() == 4096);
+
+    size_t written = 0;
+    auto dest = sink.Bytes();
+    REQUIRE(bytes::ToVarintBytes(uint64_t(300), dest.Data(), dest.Size(),
+                                 written) == bytes::ByteOpResult::Ok);
+    REQUIRE(written == 2);
+    sink.SetUsed(written);
+    REQUIRE(sink.Sync());
+    sink.Finish();
+  }
+
+  io::MmapByteSource source(path);
+  REQUIRE(source.Size() == 2);
+  size_t consumed = 0;
+  auto result = bytes::ByteOpResult::None;
+  REQUIRE(bytes::ToVarUint64(source.Data(), source.Size(), consumed, result) ==
+          300);
+  REQUIRE(result == bytes::ByteOpResult::Ok);
+
+  std::remove(path.c_str());
+}
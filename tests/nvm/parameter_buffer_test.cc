@@ -0,0 +1,187 @@
+#define CATCH_CONFIG_MAIN
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/span.h"
+#include "nvm/sqlbuilder/nv_select_builder.h"
+#include "nvm/sqlbuilder/parameter_buffer.h"
+
+using namespace nvm;
+
+namespace {
+
+using sqlbuilder::ParameterBuffer;
+using sqlbuilder::ParameterKind;
+
+std::chrono::system_clock::time_point FromMicros(int64_t micros) {
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::microseconds(micros)));
+}
+
+}  // namespace
+
+TEST_CASE("parameter-buffer text format", "[sqlbuilder][parameters]") {
+  // 2024-02-29 12:34:56.789012 UTC
+  const int64_t leap_day = 1709210096789012LL;
+  std::vector<sqlbuilder::DefaultPostgresParamType> values = {
+      42,
+      -7LL,
+      1.5f,
+      0.25,
+      std::string("dozer%"),
+      true,
+      FromMicros(leap_day),
+      std::vector<int>{1, -2, 3},
+      std::string(),
+  };
+
+  ParameterBuffer buffer;
+  buffer.Assign(values);
+  REQUIRE(buffer.Size() == values.size());
+
+  REQUIRE(buffer.Kind(0) == ParameterKind::kInt32);
+  REQUIRE(buffer.Kind(1) == ParameterKind::kInt64);
+  REQUIRE(buffer.Kind(2) == ParameterKind::kFloat32);
+  REQUIRE(buffer.Kind(3) == ParameterKind::kFloat64);
+  REQUIRE(buffer.Kind(4) == ParameterKind::kText);
+  REQUIRE(buffer.Kind(5) == ParameterKind::kBool);
+  REQUIRE(buffer.Kind(6) == ParameterKind::kTimestamp);
+  REQUIRE(buffer.Kind(7) == ParameterKind::kInt32Array);
+
+  REQUIRE(buffer.Value(0) == "42");
+  REQUIRE(buffer.Value(1) == "-7");
+  REQUIRE(buffer.Value(2) == "1.5");
+  REQUIRE(buffer.Value(3) == "0.25");
+  REQUIRE(buffer.Value(4) == "dozer%");
+  REQUIRE(buffer.Value(5) == "t");
+  REQUIRE(buffer.Value(6) == "2024-02-29 12:34:56.789012+00");
+  REQUIRE(buffer.Value(7) == "{1,-2,3}");
+  REQUIRE(buffer.Value(8).empty());
+
+  // one block, each value a C string inside it
+  auto data = buffer.Data();
+  for (size_t i = 0; i < buffer.Size(); ++i) {
+    const char* value = buffer.Values()[i];
+    REQUIRE(value == data.data() + buffer.Offsets()[i]);
+    REQUIRE(std::strlen(value) == static_cast<size_t>(buffer.Lengths()[i]));
+  }
+  REQUIRE(buffer.Values()[8] != nullptr);
+
+  // reuse keeps working with a shorter list
+  buffer.Assign(std::vector<sqlbuilder::DefaultPostgresParamType>{
+      FromMicros(-1), false});
+  REQUIRE(buffer.Size() == 2);
+  REQUIRE(buffer.Value(0) == "1969-12-31 23:59:59.999999+00");
+  REQUIRE(std::string(buffer.Values()[1]) == "f");
+}
+
+TEST_CASE("parameter-buffer bytes and null", "[sqlbuilder][parameters]") {
+  ParameterBuffer buffer;
+  buffer.Assign(std::vector<sqlbuilder::DefaultOracleParamType>{
+      std::vector<unsigned char>{0x0a, 0xff}});
+  REQUIRE(buffer.Kind(0) == ParameterKind::kBytes);
+  REQUIRE(buffer.Value(0) == "\\x0aff");
+
+  using Nullable = std::variant<std::monostate, int>;
+  buffer.Assign(std::vector<Nullable>{std::monostate(), 5});
+  REQUIRE(buffer.Kind(0) == ParameterKind::kNull);
+  REQUIRE(buffer.Values()[0] == nullptr);
+  REQUIRE(std::string(buffer.Values()[1]) == "5");
+
+  using Unknown = std::variant<int, std::vector<double>>;
+  REQUIRE_THROWS_AS(buffer.Assign(std::vector<Unknown>{std::vector<double>{}}),
+                    std::invalid_argument);
+}
+
+TEST_CASE("view parameters are not copied", "[sqlbuilder][parameters]") {
+  using ViewParam = sqlbuilder::DefaultPostgresViewParamType;
+  using NvSelect = sqlbuilder::NvSelect<ViewParam>;
+  using SqlOperator = sqlbuilder::SqlOperator;
+
+  const std::string name = "dozer%";
+  const std::vector<int> ids = {4, 5, 6};
+  const std::vector<std::string_view> codes = {"A1", "B2"};
+
+  NvSelect select;
+  // clang-format off
+  select
+    .Field<int32_t>("id")
+    .From()
+      .AddTable("equipment")
+    .EndFromTableBlock()
+    .Where()
+      .AddCondition<std::string_view>("name", SqlOperator::kLike, name)
+      .And()
+      .AddCondition("ids", SqlOperator::kEqual, Span<const int>(ids))
+      .And()
+      .AddConditionIn("code", codes)
+    .EndWhereBlock();
+  // clang-format on
+
+  auto values = select.Values();
+  REQUIRE(values->size() == 4);
+  REQUIRE(std::get<std::string_view>((*values)[0]).data() == name.data());
+  REQUIRE(std::get<Span<const int>>((*values)[1]).Data() == ids.data());
+  REQUIRE(std::get<std::string_view>((*values)[3]).data() ==
+          codes[1].data());
+
+  ParameterBuffer buffer;
+  buffer.Assign(*values);
+  REQUIRE(buffer.Value(0) == "dozer%");
+  REQUIRE(buffer.Value(1) == "{4,5,6}");
+  REQUIRE(buffer.Value(2) == "A1");
+  REQUIRE(buffer.Value(3) == "B2");
+
+  // the parser hands out the builder's list instead of a copy
+  sqlbuilder::PostgresDefaultParameterParser<ViewParam> parser(values);
+  REQUIRE(parser.Parse<ViewParam>().get() == values.get());
+  REQUIRE(parser.GetAllParameterValuesAsString().find("[4, 5, 6]") !=
+          std::string::npos);
+}
+
+TEST_CASE("view parameters copy temporaries", "[sqlbuilder][parameters]") {
+  using ViewParam = sqlbuilder::DefaultPostgresViewParamType;
+  using NvSelect = sqlbuilder::NvSelect<ViewParam>;
+  using SqlOperator = sqlbuilder::SqlOperator;
+
+  auto make_name = [](const char* base) {
+    // longer than any small string buffer, the heap block is freed after
+    // the call
+    return std::string(base) + std::string(40, '%');
+  };
+  const std::string kept = make_name("kept");
+
+  NvSelect select;
+  select.Where()
+      .AddCondition<std::string>("name", SqlOperator::kLike, make_name("a"))
+      .And()
+      .AddCondition("kept", SqlOperator::kEqual, kept)
+      .And()
+      .AddConditionBetween("code", make_name("b"), make_name("c"))
+      .And()
+      .AddConditionIn("tag", std::vector<std::string>{make_name("d")})
+      .And()
+      .AddCondition("ids", SqlOperator::kEqual, std::vector<int>{7, 8});
+
+  // overwrite freed heap memory before the values are read
+  std::vector<std::string> noise(16, std::string(64, '#'));
+
+  auto values = select.Values();
+  REQUIRE(values->size() == 6);
+  REQUIRE(std::get<std::string_view>((*values)[0]) == make_name("a"));
+  REQUIRE(std::get<std::string_view>((*values)[1]).data() == kept.data());
+  REQUIRE(std::get<std::string_view>((*values)[2]) == make_name("b"));
+  REQUIRE(std::get<std::string_view>((*values)[3]) == make_name("c"));
+  REQUIRE(std::get<std::string_view>((*values)[4]) == make_name("d"));
+
+  ParameterBuffer buffer;
+  buffer.Assign(*values);
+  REQUIRE(buffer.Value(5) == "{7,8}");
+}
@@ -0,0 +1,153 @@
+#define CATCH_CONFIG_MAIN
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/memory/buffer_pool.h"
+#include "nvm/sqlbuilder/pg_binary_parameters.h"
+
+using namespace nvm;
+
+namespace {
+
+using sqlbuilder::PostgresBinaryParameterParser;
+namespace pg_oid = sqlbuilder::pg_oid;
+
+std::vector<uint8_t> BytesOf(const char* value, int length) {
+  auto p = reinterpret_cast<const uint8_t*>(value);
+  return std::vector<uint8_t>(p, p + length);
+}
+
+std::chrono::system_clock::time_point FromUnixMicros(int64_t micros) {
+  return std::chrono::system_clock::time_point(
+      std::chrono::duration_cast<std::chrono::system_clock::duration>(
+          std::chrono::microseconds(micros)));
+}
+
+}  // namespace
+
+TEST_CASE("pg-binary scalar fixtures", "[sqlbuilder][parameters][binary]") {
+  auto values =
+      std::make_shared<std::vector<sqlbuilder::DefaultPostgresParamType>>();
+  values->push_back(1);
+  values->push_back(-2LL);
+  values->push_back(1.5f);
+  values->push_back(0.25);
+  values->push_back(true);
+  // one second after the PostgreSQL epoch
+  values->push_back(
+      FromUnixMicros(sqlbuilder::kPostgresEpochUnixMicros + 1000000));
+  values->push_back(std::string("ab"));
+  values->push_back(std::string());
+
+  PostgresBinaryParameterParser<> parser(values);
+  auto params = parser.Encode();
+  REQUIRE(params.Size() == 8);
+  REQUIRE_FALSE(params.IsPooled());
+
+  const std::vector<std::vector<uint8_t>> expected = {
+      {0x00, 0x00, 0x00, 0x01},
+      {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe},
+      {0x3f, 0xc0, 0x00, 0x00},
+      {0x3f, 0xd0, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+      {0x01},
+      {0x00, 0x00, 0x00, 0x00, 0x00, 0x0f, 0x42, 0x40},
+      {0x61, 0x62},
+      {},
+  };
+  const std::vector<uint32_t> types = {
+      pg_oid::kInt4, pg_oid::kInt8,       pg_oid::kFloat4, pg_oid::kFloat8,
+      pg_oid::kBool, pg_oid::kTimestampTz, pg_oid::kText,   pg_oid::kText,
+  };
+  for (size_t i = 0; i < expected.size(); ++i) {
+    REQUIRE(params.Types()[i] == types[i]);
+    REQUIRE(params.Formats()[i] == 1);
+    REQUIRE(params.Values()[i] != nullptr);
+    REQUIRE(BytesOf(params.Values()[i], params.Lengths()[i]) == expected[i]);
+  }
+
+  // all values share one buffer, back to back
+  REQUIRE(params.Data().Size() == 4 + 8 + 4 + 8 + 1 + 8 + 2);
+  REQUIRE(reinterpret_cast<const uint8_t*>(params.Values()[0]) ==
+          params.Data().Data());
+  REQUIRE(params.Values()[1] == params.Values()[0] + 4);
+}
+
+TEST_CASE("pg-binary arrays, bytes and null",
+          "[sqlbuilder][parameters][binary]") {
+  using Param = sqlbuilder::DefaultPostgresParamType;
+  auto values = std::make_shared<std::vector<Param>>(
+      std::vector<Param>{std::vector<int>{1, 2}, std::vector<int>{}});
+  auto params = PostgresBinaryParameterParser<>(values).Encode();
+  REQUIRE(params.Types()[0] == pg_oid::kInt4Array);
+  REQUIRE(BytesOf(params.Values()[0], params.Lengths()[0]) ==
+          std::vector<uint8_t>{
+              0, 0, 0, 1,              // ndim
+              0, 0, 0, 0,              // no nulls
+              0, 0, 0, 23,             // int4
+              0, 0, 0, 2, 0, 0, 0, 1,  // 2 elements from 1
+              0, 0, 0, 4, 0, 0, 0, 1,  // 1
+              0, 0, 0, 4, 0, 0, 0, 2,  // 2
+          });
+  REQUIRE(BytesOf(params.Values()[1], params.Lengths()[1]) ==
+          std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 23});
+
+  auto raw = std::make_shared<std::vector<sqlbuilder::DefaultOracleParamType>>(
+      std::vector<sqlbuilder::DefaultOracleParamType>{
+          std::vector<unsigned char>{0xde, 0xad}});
+  auto bytea = PostgresBinaryParameterParser<
+                   sqlbuilder::DefaultOracleParamType>(raw)
+                   .Encode();
+  REQUIRE(bytea.Types()[0] == pg_oid::kBytea);
+  REQUIRE(BytesOf(bytea.Values()[0], bytea.Lengths()[0]) ==
+          std::vector<uint8_t>{0xde, 0xad});
+
+  using Nullable = std::variant<std::monostate, int>;
+  auto nullable = std::make_shared<std::vector<Nullable>>(
+      std::vector<Nullable>{std::monostate(), 7});
+  auto with_null = PostgresBinaryParameterParser<Nullable>(nullable).Encode();
+  REQUIRE(with_null.Values()[0] == nullptr);
+  REQUIRE(with_null.Lengths()[0] == 0);
+  REQUIRE(with_null.Types()[0] == pg_oid::kUnspecified);
+  REQUIRE(with_null.At(1).bytes.Size() == 4);
+}
+
+TEST_CASE("pg-binary pooled buffer and parser interface",
+          "[sqlbuilder][parameters][binary]") {
+  using ViewParam = sqlbuilder::DefaultPostgresViewParamType;
+  const std::string name = "dozer";
+  const std::vector<int> ids = {3};
+  auto values = std::make_shared<std::vector<ViewParam>>(
+      std::vector<ViewParam>{std::string_view(name), Span<const int>(ids), 9});
+
+  auto pool = memory::BufferPool::Create(256, 4);
+  PostgresBinaryParameterParser<ViewParam> parser(values, pool);
+  {
+    auto params = parser.Encode();
+    REQUIRE(params.IsPooled());
+    REQUIRE(BytesOf(params.Values()[0], params.Lengths()[0]) ==
+            std::vector<uint8_t>{'d', 'o', 'z', 'e', 'r'});
+    REQUIRE(params.Lengths()[1] == 28);
+  }
+  // the slab went back to the pool
+  auto again = parser.Encode();
+  REQUIRE(pool->SlabsCreated() == 1);
+
+  auto parsed = parser.Parse<sqlbuilder::PostgresBinaryValue>();
+  REQUIRE(parsed->size() == 3);
+  REQUIRE((*parsed)[2].type == pg_oid::kInt4);
+  REQUIRE((*parsed)[2].bytes[3] == 9);
+  REQUIRE_FALSE((*parsed)[2].is_null);
+
+  // larger than a slab falls back to the heap
+  const std::string big(300, 'x');
+  values->push_back(std::string_view(big));
+  auto heap = parser.Encode();
+  REQUIRE_FALSE(heap.IsPooled());
+  REQUIRE(heap.Lengths()[3] == 300);
+}
@@ -0,0 +1,265 @@
+#define CATCH_CONFIG_MAIN
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <future>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/sqlbuilder/nv_select_builder.h"
+#include "nvm/sqlbuilder/query_cache.h"
+#include "nvm/threads/task_pool.h"
+
+using namespace nvm;
+
+namespace {
+
+using NvSelect = sqlbuilder::NvSelect<>;
+using SqlOperator = sqlbuilder::SqlOperator;
+using RecordKey = sqlbuilder::RecordKey;
+
+void BuildUserQuery(NvSelect& select, const std::vector<int32_t>& companies,
+                    const std::string& name) {
+  // clang-format off
+  select
+    .Field<int32_t>("user_id", "u")
+    .Field<std::string>("name", "c", "company_name")
+    .From()
+      .AddTable("users", "u")
+    .EndFromTableBlock()
+    .Join()
+      .InnerJoin(
+        RecordKey("users", "company_id", "u"),
+        RecordKey("company", "company_id", "c"))
+    .EndJoinBlock()
+    .Where()
+      .AddConditionIn<int32_t>("u.company_id", companies)
+      .And()
+      .AddCondition<std::string>("u.name", SqlOperator::kLike, name)
+    .EndWhereBlock()
+    .OrderBy()
+      .Asc("name", "u")
+    .EndOrderByBlock();
+  // clang-format on
+}
+
+}  // namespace
+
+TEST_CASE("query-shape-key", "[sqlbuilder][query-cache]") {
+  NvSelect a;
+  NvSelect b;
+  BuildUserQuery(a, {1, 2, 3}, "a%");
+  BuildUserQuery(b, {7, 8, 9}, "zz%");
+
+  // same structure, other values
+  REQUIRE(a.ShapeKey() == b.ShapeKey());
+  REQUIRE(a.GenerateQuery() == b.GenerateQuery());
+  REQUIRE(a.ShapeKey(false) != a.ShapeKey(true));
+
+  // the IN list size changes the placeholders
+  NvSelect c;
+  BuildUserQuery(c, {1, 2}, "a%");
+  REQUIRE(a.ShapeKey() != c.ShapeKey());
+
+  // one more field
+  NvSelect d;
+  BuildUserQuery(d, {1, 2, 3}, "a%");
+  d.Field<int32_t>("flags", "u");
+  REQUIRE(a.ShapeKey() != d.ShapeKey());
+
+  // same text split differently between alias and name
+  NvSelect e;
+  NvSelect f;
+  e.Field<int32_t>("ab", "c").From().AddTable("t").EndFromTableBlock();
+  f.Field<int32_t>("b", "ca").From().AddTable("t").EndFromTableBlock();
+  REQUIRE(e.ShapeKey() != f.ShapeKey());
+
+  // operator and dialect
+  NvSelect g;
+  NvSelect h;
+  NvSelect o(sqlbuilder::DatabaseDialect::Oracle);
+  for (auto* s : {&g, &h, &o}) {
+    s->Field<int32_t>("id").From().AddTable("t").EndFromTableBlock();
+  }
+  g.Where().AddCondition<int32_t>("id", SqlOperator::kEqual, 1);
+  h.Where().AddCondition<int32_t>("id", SqlOperator::kLess, 1);
+  o.Where().AddCondition<int32_t>("id", SqlOperator::kEqual, 1);
+  REQUIRE(g.ShapeKey() != h.ShapeKey());
+  REQUIRE(g.ShapeKey() != o.ShapeKey());
+
+  // subquery inside FROM
+  NvSelect s1;
+  NvSelect s2;
+  for (auto* s : {&s1, &s2}) {
+    // clang-format off
+    s->Field<int32_t>("id", "x")
+      .From()
+        .BeginSubquery("x")
+          .Field<int32_t>("id")
+          .From().AddTable("t").EndFromTableBlock()
+        .EndSubqueryInsideFrom()
+      .EndFromTableBlock();
+    // clang-format on
+  }
+  REQUIRE(s1.ShapeKey() == s2.ShapeKey());
+  s2.From().BeginSubquery("y").Field<int32_t>("id");
+  REQUIRE(s1.ShapeKey() != s2.ShapeKey());
+}
+
+TEST_CASE("query-shape-cache-lru", "[sqlbuilder][query-cache]") {
+  sqlbuilder::QueryShapeCache<> cache(2);
+  REQUIRE_THROWS_AS(sqlbuilder::QueryShapeCache<>(0), std::invalid_argument);
+
+  NvSelect a1;
+  NvSelect a2;
+  NvSelect b;
+  NvSelect c;
+  BuildUserQuery(a1, {1, 2, 3}, "a%");
+  BuildUserQuery(a2, {4, 5, 6}, "b%");
+  BuildUserQuery(b, {1}, "a%");
+  BuildUserQuery(c, {1, 2}, "a%");
+
+  auto t1 = cache.Acquire(a1);
+  REQUIRE(t1->Sql() == a1.GenerateQuery());
+  REQUIRE(t1->ParameterCount() == 4);
+  REQUIRE(t1->Key() == a1.ShapeKey());
+  REQUIRE(t1->Dialect() == sqlbuilder::DatabaseDialect::PostgreSQL);
+
+  auto t2 = cache.Acquire(a2);
+  REQUIRE(t2 == t1);
+  REQUIRE(cache.Stats().hits == 1);
+  REQUIRE(cache.Stats().misses == 1);
+
+  auto pretty = cache.Acquire(a1, true);
+  REQUIRE(pretty->Sql() == a1.GenerateQuery(true));
+  REQUIRE(pretty->PrettyPrint());
+
+  // a1 is the least recently used now, touching it evicts the pretty one
+  cache.Acquire(a2);
+  cache.Acquire(b);
+  REQUIRE(cache.Find(a1.ShapeKey()) != nullptr);
+  REQUIRE(cache.Find(a1.ShapeKey(true)) == nullptr);
+  REQUIRE(cache.Find(b.ShapeKey())->Sql() == b.GenerateQuery());
+
+  cache.Acquire(c);
+  auto stats = cache.Stats();
+  REQUIRE(stats.hits == 2);
+  REQUIRE(stats.misses == 4);
+  REQUIRE(stats.evictions == 2);
+  REQUIRE(stats.size == 2);
+  REQUIRE(stats.capacity == 2);
+  REQUIRE(std::abs(stats.HitRate() - 2.0 / 6.0) < 1e-9);
+
+  // handed out templates outlive eviction and Clear()
+  cache.Clear();
+  REQUIRE(cache.Size() == 0);
+  REQUIRE(cache.Stats().hits == 0);
+  REQUIRE(t1->Sql() == a1.GenerateQuery());
+}
+
+TEST_CASE("query-shape-cache-concurrent", "[sqlbuilder][query-cache]") {
+  sqlbuilder::QueryShapeCache<> cache(8);
+  constexpr int kThreads = 4;
+  constexpr int kIterations = 200;
+  std::atomic<int> mismatches(0);
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < kThreads; ++t) {
+    workers.emplace_back([&cache, &mismatches, t]() {
+      for (int i = 0; i < kIterations; ++i) {
+        NvSelect select;
+        // four shapes, IN lists of 1 to 4 ids
+        std::vector<int32_t> ids(1 + (i + t) % 4, i);
+        BuildUserQuery(select, ids, "n" + std::to_string(i));
+        auto statement = cache.Acquire(select);
+        if (statement->Sql() != select.GenerateQuery() ||
+            statement->ParameterCount() != select.Values()->size()) {
+          mismatches.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  auto stats = cache.Stats();
+  REQUIRE(mismatches.load() == 0);
+  REQUIRE(stats.hits + stats.misses == kThreads * kIterations);
+  REQUIRE(stats.size == 4);
+  REQUIRE(stats.evictions == 0);
+}
+
+TEST_CASE("frozen-select", "[sqlbuilder][query-cache]") {
+  auto select = std::make_unique<NvSelect>();
+  BuildUserQuery(*select, {1, 2}, "ann");
+  auto frozen = select->Freeze();
+  const std::string sql = select->GenerateQuery();
+  const uint64_t fingerprint = select->Fingerprint();
+
+  // the snapshot outlives the builder
+  select.reset();
+  REQUIRE(frozen->Sql() == sql);
+  REQUIRE(frozen->ParameterCount() == 3);
+  REQUIRE(frozen->Fingerprint() == fingerprint);
+
+  auto query = frozen->Instantiate();
+  REQUIRE(query.statement == frozen->Statement());
+  query.values[2] = std::string("bob");
+  REQUIRE(std::get<std::string>(frozen->Defaults()[2]) == "ann");
+
+  auto bound = frozen->Instantiate({7, 8, std::string("cy")});
+  REQUIRE(&bound.Sql() == &frozen->Sql());
+  REQUIRE(std::get<int>(bound.values[0]) == 7);
+  REQUIRE_THROWS_AS(frozen->Instantiate({7, 8}), std::invalid_argument);
+  REQUIRE_THROWS_AS(frozen->Instantiate({7, 8, 9}), std::invalid_argument);
+
+  // NULL fits any slot
+  using Nullable = std::variant<std::monostate, int>;
+  sqlbuilder::NvSelect<Nullable> nullable;
+  nullable.Field<int32_t>("id").From().AddTable("t").EndFromTableBlock();
+  nullable.Where().AddCondition<int>("id", SqlOperator::kEqual, 1);
+  auto frozen_nullable = nullable.Freeze();
+  REQUIRE(std::holds_alternative<std::monostate>(
+      frozen_nullable->Instantiate({std::monostate()}).values[0]));
+
+  // builders of one shape share the cached statement
+  sqlbuilder::QueryShapeCache<> cache(4);
+  NvSelect first;
+  BuildUserQuery(first, {1, 2}, "a");
+  NvSelect second;
+  BuildUserQuery(second, {3, 4}, "b");
+  REQUIRE(first.Freeze(cache)->Statement() ==
+          second.Freeze(cache)->Statement());
+}
+
+TEST_CASE("frozen-select-task-pool", "[sqlbuilder][query-cache]") {
+  NvSelect select;
+  BuildUserQuery(select, {1, 2}, "name");
+  auto frozen = select.Freeze();
+
+  constexpr int kTasks = 64;
+  auto pool = threads::TaskPool::Create(4);
+  std::vector<std::future<bool>> results;
+  for (int t = 0; t < kTasks; ++t) {
+    results.push_back(pool->ExecuteTask([frozen, t]() {
+                              bool ok = true;
+                              for (int i = 0; i < 100; ++i) {
+                                auto query = frozen->Instantiate(
+                                    {t, i, "n" + std::to_string(t)});
+                                ok = ok && &query.Sql() == &frozen->Sql() &&
+                                     std::get<int>(query.values[0]) == t &&
+                                     std::get<int>(query.values[1]) == i;
+                              }
+                              return ok;
+                            })
+                          .first);
+  }
+  for (auto& result : results) {
+    REQUIRE(result.get());
+  }
+  REQUIRE(std::get<int>(frozen->Defaults()[0]) == 1);
+}
@@ -4,6 +4,7 @@
 
 #include "catch2/catch_all.hpp"
 #include "nvm/sqlbuilder/nv_select_builder.h"
+#include "nvm/sqlbuilder/static_select.h"
 #include "nvm/strings/utility.h"
 using namespace nvm;
 
@@ -333,4 +334,375 @@ TEST_CASE("select-test-groupby-count", "[validator][normal-case]") {
   std::cout << parser.GetAllParameterValuesAsString() << std::endl;
 
   REQUIRE(true == true);
-}
\ No newline at end of file
+}
+TEST_CASE("select-render-single-buffer", "[sqlbuilder][render]") {
+  using NvSelect = nvm::sqlbuilder::NvSelect<>;
+  using SqlOperator = nvm::sqlbuilder::SqlOperator;
+  using RecordKey = nvm::sqlbuilder::RecordKey;
+  using Dialect = nvm::sqlbuilder::DatabaseDialect;
+  using SqlWriter = nvm::sqlbuilder::SqlWriter;
+
+  REQUIRE(nvm::sqlbuilder::DetermineParameterFormat(Dialect::PostgreSQL, 17) ==
+          "$17");
+  REQUIRE(nvm::sqlbuilder::DetermineParameterFormat(Dialect::Oracle, 17) ==
+          ":17");
+  REQUIRE(nvm::sqlbuilder::GenerateIndentation(3) == "      ");
+  REQUIRE(nvm::sqlbuilder::GenerateIndentation(0).empty());
+
+  NvSelect select;
+  // clang-format off
+  select
+    .Field<int32_t>("equipment_id", "e")
+    .Field<std::string>("name", "c", "company_name")
+    .Field<int32_t>("*", std::nullopt, nvm::sqlbuilder::SqlAggregateFunction::Count)
+    .From()
+      .AddTable("equipment", "e")
+    .EndFromTableBlock()
+    .Join()
+      .InnerJoin(
+        RecordKey("equipment", "service_id", "e"),
+        RecordKey("service", "service_id", "s"))
+      .InnerJoin(
+        RecordKey("service", "company_id", "s"),
+        RecordKey("company", "company_id", "c"))
+      .LeftJoin(
+        RecordKey("equipment", "add_by", "e"),
+        RecordKey("users", "user_id", "u"))
+    .EndJoinBlock()
+    .Where()
+      .AddConditionIn<int32_t>("c.company_id", {1, 2, 3})
+      .And()
+      .AddConditionBetween<int32_t>("e.status", 0, 1)
+      .And()
+      .AddCondition<std::string>("u.username", SqlOperator::kLike, "a%")
+    .EndWhereBlock()
+    .GroupBy()
+      .Field("equipment_id", "e")
+      .Field("name", "c")
+    .EndGroupByBlock()
+    .OrderBy()
+      .Asc("name", "c")
+      .Desc("equipment_id", "e")
+    .EndOrderByBlock();
+  // clang-format on
+
+  std::string sql = select.GenerateQuery();
+  REQUIRE(sql ==
+          "SELECT e.equipment_id, c.name AS company_name, COUNT(*) "
+          "FROM equipment AS e "
+          "INNER JOIN service AS s ON e.service_id = s.service_id "
+          "INNER JOIN company AS c ON s.company_id = c.company_id "
+          "LEFT JOIN users AS u ON e.add_by = u.user_id "
+          "WHERE c.company_id IN ($1, $2, $3) AND "
+          "e.status BETWEEN $4 AND $5 AND u.username LIKE $6 "
+          "GROUP BY e.equipment_id, c.name "
+          "ORDER BY c.name ASC, e.equipment_id DESC");
+  REQUIRE(select.Values()->size() == 6);
+
+  // the measuring pass predicts the exact length of both layouts
+  for (bool pretty : {false, true}) {
+    SqlWriter measure;
+    select.AppendQuery(measure, pretty);
+    REQUIRE(measure.IsMeasuring());
+    REQUIRE(measure.Size() == select.GenerateQuery(pretty).size());
+  }
+}
+
+TEST_CASE("select-in-list-modes", "[sqlbuilder][in-list]") {
+  using NvSelect = nvm::sqlbuilder::NvSelect<>;
+  using InListMode = nvm::sqlbuilder::InListMode;
+  using Dialect = nvm::sqlbuilder::DatabaseDialect;
+
+  auto where_of = [](const std::vector<int>& ids, InListMode mode,
+                     Dialect dialect = Dialect::PostgreSQL) {
+    auto select = std::make_shared<NvSelect>(dialect);
+    // clang-format off
+    select->Field<int32_t>("id")
+      .From()
+        .AddTable("t")
+      .EndFromTableBlock()
+      .Where()
+        .AddConditionIn("id", ids, mode)
+        .And()
+        .AddCondition<int32_t>("x", nvm::sqlbuilder::SqlOperator::kEqual, 0)
+      .EndWhereBlock();
+    // clang-format on
+    return select;
+  };
+
+  // one array parameter, the text does not depend on the list size
+  auto small = where_of({1, 2}, InListMode::kArray);
+  auto large = where_of(std::vector<int>(5000, 7), InListMode::kArray);
+  REQUIRE(small->GenerateQuery() ==
+          "SELECT id FROM t WHERE id = ANY($1) AND x = $2");
+  REQUIRE(large->GenerateQuery() == small->GenerateQuery());
+  REQUIRE(large->Values()->size() == 2);
+  REQUIRE(std::get<std::vector<int>>((*large->Values())[0]).size() == 5000);
+  REQUIRE(small->ShapeKey() == large->ShapeKey());
+
+  auto oracle = where_of({1, 2}, InListMode::kArray, Dialect::Oracle);
+  REQUIRE(oracle->GenerateQuery() ==
+          "SELECT id FROM t WHERE id IN (SELECT COLUMN_VALUE FROM TABLE(:1)) "
+          "AND x = :2");
+
+  // dense runs become ranges, duplicates and order do not matter
+  auto ranges = where_of({9, 1, 2, 3, 4, 20, 3, 7, 8, 15}, InListMode::kRanges);
+  REQUIRE(ranges->GenerateQuery() ==
+          "SELECT id FROM t WHERE (id BETWEEN $1 AND $2 OR id BETWEEN $3 AND "
+          "$4 OR id IN ($5, $6)) AND x = $7");
+  const auto& values = *ranges->Values();
+  REQUIRE(values.size() == 7);
+  REQUIRE(std::get<int>(values[0]) == 1);
+  REQUIRE(std::get<int>(values[1]) == 4);
+  REQUIRE(std::get<int>(values[2]) == 7);
+  REQUIRE(std::get<int>(values[3]) == 9);
+  REQUIRE(std::get<int>(values[4]) == 15);
+  REQUIRE(std::get<int>(values[5]) == 20);
+
+  auto ranges_array =
+      where_of({1, 2, 3, 10, 11, 12, 13, 50, 60}, InListMode::kRangesArray);
+  REQUIRE(ranges_array->GenerateQuery() ==
+          "SELECT id FROM t WHERE (id BETWEEN $1 AND $2 OR id BETWEEN $3 AND "
+          "$4 OR id = ANY($5)) AND x = $6");
+  REQUIRE(std::get<std::vector<int>>((*ranges_array->Values())[4]) ==
+          std::vector<int>{50, 60});
+
+  auto only_range = where_of({5, 6, 7}, InListMode::kRangesArray);
+  REQUIRE(only_range->GenerateQuery() ==
+          "SELECT id FROM t WHERE id BETWEEN $1 AND $2 AND x = $3");
+
+  auto empty = where_of({}, InListMode::kRanges);
+  REQUIRE(empty->GenerateQuery() == "SELECT id FROM t WHERE 1 = 0 AND x = $1");
+
+  // a view parameter type references the caller's list
+  const std::vector<int> ids = {4, 5};
+  nvm::sqlbuilder::NvSelect<nvm::sqlbuilder::DefaultPostgresViewParamType>
+      view;
+  view.Where().AddConditionIn("id", ids, InListMode::kArray);
+  REQUIRE(std::get<nvm::Span<const int>>((*view.Values())[0]).Data() ==
+          ids.data());
+  // the rest can not be viewed, the throw leaves the statement untouched
+  REQUIRE_THROWS_AS(view.Where().AddConditionIn("id",
+                                                std::vector<int>{1, 2, 3, 9},
+                                                InListMode::kRangesArray),
+                    std::invalid_argument);
+  REQUIRE(view.Values()->size() == 1);
+  REQUIRE(view.Where().GenerateQuery() == "WHERE id = ANY($1)");
+  // a temporary would dangle as a view
+  REQUIRE_THROWS_AS(view.Where().AddConditionIn("id", std::vector<int>{4, 5},
+                                                InListMode::kArray),
+                    std::invalid_argument);
+  REQUIRE(view.Values()->size() == 1);
+
+  // Oracle binds the list as one int collection
+  nvm::sqlbuilder::NvSelect<nvm::sqlbuilder::DefaultOracleParamType>
+      oracle_typed(Dialect::Oracle);
+  oracle_typed.Where().AddConditionIn("id", std::vector<int>{7, 8},
+                                      InListMode::kArray);
+  REQUIRE(oracle_typed.Where().GenerateQuery() ==
+          "WHERE id IN (SELECT COLUMN_VALUE FROM TABLE(:1))");
+  REQUIRE(std::get<std::vector<int>>((*oracle_typed.Values())[0]) ==
+          std::vector<int>{7, 8});
+
+  // no int64 array in the default parameter type
+  NvSelect wide;
+  REQUIRE_THROWS_AS(wide.Where().AddConditionIn(
+                        "id", std::vector<long long>{1}, InListMode::kArray),
+                    std::invalid_argument);
+}
+
+TEST_CASE("select-limit-offset", "[sqlbuilder][limit]") {
+  using NvSelect = nvm::sqlbuilder::NvSelect<>;
+  using SqlOperator = nvm::sqlbuilder::SqlOperator;
+  using Dialect = nvm::sqlbuilder::DatabaseDialect;
+
+  NvSelect postgres;
+  // clang-format off
+  postgres.Field<int32_t>("id")
+    .From()
+      .AddTable("users")
+    .EndFromTableBlock()
+    .Where()
+      .AddCondition<int>("status", SqlOperator::kEqual, 1)
+    .EndWhereBlock()
+    .LimitOffset()
+      .LimitOffset(30, 60)
+    .EndLimitOffsetBlock();
+  // clang-format on
+  REQUIRE(postgres.GenerateQuery() ==
+          "SELECT id FROM users WHERE status = $1 LIMIT $2 OFFSET $3");
+  REQUIRE(postgres.Values()->size() == 3);
+  REQUIRE(std::get<int>((*postgres.Values())[1]) == 30);
+  REQUIRE(std::get<long long>((*postgres.Values())[2]) == 60);
+  REQUIRE_THROWS_AS(postgres.LimitOffset().Limit(10), std::runtime_error);
+
+  NvSelect oracle(Dialect::Oracle);
+  oracle.Field<int32_t>("id").From().AddTable("users").EndFromTableBlock();
+  oracle.LimitOffset().LimitOffset(10, 20).EndLimitOffsetBlock();
+  REQUIRE(oracle.GenerateQuery() ==
+          "SELECT id FROM users OFFSET :2 ROWS FETCH NEXT :1 ROWS ONLY");
+
+  NvSelect limit_only(Dialect::Oracle);
+  limit_only.Field<int32_t>("id").From().AddTable("users").EndFromTableBlock();
+  limit_only.LimitOffset().Limit(5);
+  REQUIRE(limit_only.GenerateQuery() ==
+          "SELECT id FROM users FETCH FIRST :1 ROWS ONLY");
+
+  // the same text and bind order as StaticSelect
+  constexpr auto kStatic =
+      nvm::sqlbuilder::StaticSelect<Dialect::PostgreSQL, 128>()
+          .Field<int32_t>("id")
+          .From("users")
+          .LimitOffset();
+  NvSelect dynamic;
+  dynamic.Field<int32_t>("id").From().AddTable("users").EndFromTableBlock();
+  dynamic.LimitOffset().LimitOffset(1, 2);
+  REQUIRE(dynamic.GenerateQuery() == kStatic.Sql());
+}
+
+TEST_CASE("select-keyset-pagination", "[sqlbuilder][limit]") {
+  using Param = nvm::sqlbuilder::DefaultPostgresParamType;
+  using NvSelect = nvm::sqlbuilder::NvSelect<Param>;
+  using SqlOperator = nvm::sqlbuilder::SqlOperator;
+  using Dialect = nvm::sqlbuilder::DatabaseDialect;
+
+  auto page = [](const std::vector<Param>& last_row, bool mixed,
+                 Dialect dialect = Dialect::PostgreSQL) {
+    auto select = std::make_shared<NvSelect>(dialect);
+    // clang-format off
+    select->Field<int32_t>("id")
+      .From()
+        .AddTable("orders", "o")
+      .EndFromTableBlock()
+      .Where()
+        .AddCondition<int>("customer_id", SqlOperator::kEqual, 7)
+        .Or()
+        .AddCondition<int>("customer_id", SqlOperator::kEqual, 8)
+      .EndWhereBlock()
+      .OrderBy()
+        .Desc("created_at", "o")
+        .By("id", "o", mixed ? nvm::sqlbuilder::SortType::Ascending
+                             : nvm::sqlbuilder::SortType::Descending)
+      .EndOrderByBlock()
+      .LimitOffset()
+        .Keyset(50, last_row)
+      .EndLimitOffsetBlock();
+    // clang-format on
+    return select;
+  };
+
+  // the first page has nothing to seek from
+  auto first = page({}, false);
+  REQUIRE(first->GenerateQuery() ==
+          "SELECT id FROM orders AS o WHERE customer_id = $1 OR "
+          "customer_id = $2 ORDER BY o.created_at DESC, o.id DESC LIMIT $3");
+
+  auto next = page({100LL, 42}, false);
+  REQUIRE(next->GenerateQuery() ==
+          "SELECT id FROM orders AS o WHERE (customer_id = $1 OR "
+          "customer_id = $2) AND (o.created_at, o.id) < ($3, $4) "
+          "ORDER BY o.created_at DESC, o.id DESC LIMIT $5");
+  REQUIRE(next->Values()->size() == 5);
+  REQUIRE(std::get<int>((*next->Values())[3]) == 42);
+  REQUIRE(std::get<int>((*next->Values())[4]) == 50);
+
+  // page N shares the text of page 2
+  REQUIRE(page({9LL, 1}, false)->ShapeKey() == next->ShapeKey());
+
+  auto mixed = page({100LL, 42}, true);
+  REQUIRE(mixed->GenerateQuery() ==
+          "SELECT id FROM orders AS o WHERE (customer_id = $1 OR "
+          "customer_id = $2) AND (o.created_at < $3 OR "
+          "(o.created_at = $3 AND o.id > $4)) "
+          "ORDER BY o.created_at DESC, o.id ASC LIMIT $5");
+  REQUIRE(mixed->ShapeKey() != next->ShapeKey());
+
+  auto oracle = page({100LL, 42}, false, Dialect::Oracle);
+  REQUIRE(oracle->GenerateQuery() ==
+          "SELECT id FROM orders AS o WHERE (customer_id = :1 OR "
+          "customer_id = :2) AND (o.created_at < :3 OR "
+          "(o.created_at = :3 AND o.id < :4)) "
+          "ORDER BY o.created_at DESC, o.id DESC FETCH FIRST :5 ROWS ONLY");
+
+  REQUIRE_THROWS_AS(page({1}, false), std::invalid_argument);
+  NvSelect unordered;
+  REQUIRE_THROWS_AS(unordered.LimitOffset().Keyset(10), std::runtime_error);
+}
+
+TEST_CASE("select-fingerprint", "[sqlbuilder][fingerprint]") {
+  using NvSelect = nvm::sqlbuilder::NvSelect<>;
+  using SqlOperator = nvm::sqlbuilder::SqlOperator;
+
+  auto build = [](const std::vector<int>& ids, SqlOperator op,
+                  const std::string& table, int inner_status) {
+    auto select = std::make_shared<NvSelect>();
+    // clang-format off
+    select->Field<int32_t>("id")
+      .Field<std::string>("name")
+      .From()
+        .AddTable(table)
+      .EndFromTableBlock()
+      .Where()
+        .AddConditionIn("id", ids)
+        .And()
+        .AddCondition<int>("score", op, 10)
+        .And()
+        .AddSubquery("owner_id", SqlOperator::kIn, "")
+          .Field<int32_t>("id")
+          .From()
+            .AddTable("owners")
+          .EndFromTableBlock()
+          .Where()
+            .AddCondition<int>("status", inner_status > 0
+                                             ? SqlOperator::kEqual
+                                             : SqlOperator::kNotEqual,
+                               inner_status)
+          .EndWhereBlock()
+        .EndSubqueryInsideWhereCondition()
+      .EndWhereBlock()
+      .OrderBy()
+        .Asc("id")
+      .EndOrderByBlock()
+      .LimitOffset()
+        .LimitOffset(10, ids.size())
+      .EndLimitOffsetBlock();
+    // clang-format on
+    return select;
+  };
+
+  auto base = build({1, 2}, SqlOperator::kGreater, "users", 1);
+  uint64_t fingerprint = base->Fingerprint();
+  REQUIRE(fingerprint != 0);
+  REQUIRE(base->Fingerprint() == fingerprint);
+
+  // values and IN list sizes are not part of it, the text is
+  auto many = build({1, 2, 3, 4, 5, 6, 7}, SqlOperator::kGreater, "users", 9);
+  REQUIRE(many->Fingerprint() == fingerprint);
+  REQUIRE(many->GenerateQuery() != base->GenerateQuery());
+
+  // operators, tables and subqueries are
+  REQUIRE(build({1, 2}, SqlOperator::kLess, "users", 1)->Fingerprint() !=
+          fingerprint);
+  REQUIRE(build({1, 2}, SqlOperator::kGreater, "accounts", 1)
+              ->Fingerprint() != fingerprint);
+  REQUIRE(build({1, 2}, SqlOperator::kGreater, "users", -1)->Fingerprint() !=
+          fingerprint);
+
+  // clauses are kept apart, the order of the builder calls does not matter
+  NvSelect a;
+  a.Field<int32_t>("id").From().AddTable("t").EndFromTableBlock();
+  a.OrderBy().Asc("id");
+  a.Where().AddCondition<int>("x", SqlOperator::kEqual, 1);
+  NvSelect b;
+  b.Field<int32_t>("id").From().AddTable("t").EndFromTableBlock();
+  b.Where().AddCondition<int>("x", SqlOperator::kEqual, 2);
+  b.OrderBy().Asc("id");
+  REQUIRE(a.Fingerprint() == b.Fingerprint());
+
+  // the same names in another clause
+  NvSelect c;
+  c.Field<int32_t>("id").From().AddTable("t").EndFromTableBlock();
+  c.GroupBy().Field("id");
+  c.Where().AddCondition<int>("x", SqlOperator::kEqual, 1);
+  REQUIRE(c.Fingerprint() != a.Fingerprint());
+}
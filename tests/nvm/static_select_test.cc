@@ -0,0 +1,163 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <variant>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/sqlbuilder/nv_select_builder.h"
+#include "nvm/sqlbuilder/static_select.h"
+
+using namespace nvm;
+
+namespace {
+
+using sqlbuilder::DatabaseDialect;
+using sqlbuilder::SqlOperator;
+using sqlbuilder::StaticKey;
+using sqlbuilder::StaticSelect;
+
+// clang-format off
+constexpr auto kListing =
+    StaticSelect<>()
+        .Field<int32_t>("equipment_id", "e")
+        .Field<std::string>("name", "c", "company_name")
+        .Field<int64_t>("*", {}, sqlbuilder::SqlAggregateFunction::Count)
+        .From("equipment", "e")
+        .InnerJoin(
+            StaticKey("equipment", "service_id", "e"),
+            StaticKey("service", "service_id", "s"))
+        .InnerJoin(
+            StaticKey("service", "company_id", "s"),
+            StaticKey("company", "company_id", "c"))
+        .LeftJoin(
+            StaticKey("equipment", "add_by", "e"),
+            StaticKey("users", "user_id", "u"))
+        .AddConditionIn<int32_t, 3>("c.company_id")
+        .And()
+        .AddConditionBetween<int32_t>("e.status")
+        .And()
+        .AddCondition<std::string>("u.username", SqlOperator::kLike)
+        .GroupBy("equipment_id", "e")
+        .GroupBy("name", "c")
+        .Asc("name", "c")
+        .Desc("equipment_id", "e");
+// clang-format on
+
+constexpr std::string_view kListingSql =
+    "SELECT e.equipment_id, c.name AS company_name, COUNT(*) "
+    "FROM equipment AS e "
+    "INNER JOIN service AS s ON e.service_id = s.service_id "
+    "INNER JOIN company AS c ON s.company_id = c.company_id "
+    "LEFT JOIN users AS u ON e.add_by = u.user_id "
+    "WHERE c.company_id IN ($1, $2, $3) AND "
+    "e.status BETWEEN $4 AND $5 AND u.username LIKE $6 "
+    "GROUP BY e.equipment_id, c.name "
+    "ORDER BY c.name ASC, e.equipment_id DESC";
+
+// the whole text is a constant expression
+static_assert(kListing.Sql() == kListingSql);
+static_assert(decltype(kListing)::kParameterCount == 6);
+static_assert(kListing.NextParameterIndex() == 7);
+static_assert(
+    std::is_same_v<decltype(kListing)::Row,
+                   std::tuple<int32_t, std::string, int64_t>>);
+static_assert(std::is_same_v<decltype(kListing)::Binds,
+                             std::tuple<int32_t, int32_t, int32_t, int32_t,
+                                        int32_t, std::string>>);
+
+constexpr auto kOraclePage =
+    StaticSelect<DatabaseDialect::Oracle, 256>()
+        .Field<int32_t>("id")
+        .From("t")
+        .StartGroup()
+        .AddCondition<int32_t>("a", SqlOperator::kGreater)
+        .Or()
+        .AddCondition<int32_t>("b", SqlOperator::kNotEqual)
+        .EndGroup()
+        .Asc("id")
+        .LimitOffset();
+
+static_assert(kOraclePage.Sql() ==
+              "SELECT id FROM t WHERE (a > :1 OR b != :2) ORDER BY id ASC "
+              "OFFSET :4 ROWS FETCH NEXT :3 ROWS ONLY");
+
+constexpr auto kPostgresPage =
+    StaticSelect<DatabaseDialect::PostgreSQL, 128>()
+        .Field<int32_t>("id")
+        .From("t")
+        .Limit();
+
+static_assert(kPostgresPage.Sql() == "SELECT id FROM t LIMIT $1");
+
+}  // namespace
+
+TEST_CASE("static-select-matches-runtime-builder", "[sqlbuilder][static]") {
+  using NvSelect = sqlbuilder::NvSelect<>;
+  using RecordKey = sqlbuilder::RecordKey;
+
+  NvSelect select;
+  // clang-format off
+  select
+    .Field<int32_t>("equipment_id", "e")
+    .Field<std::string>("name", "c", "company_name")
+    .Field<int32_t>("*", std::nullopt, sqlbuilder::SqlAggregateFunction::Count)
+    .From()
+      .AddTable("equipment", "e")
+    .EndFromTableBlock()
+    .Join()
+      .InnerJoin(
+        RecordKey("equipment", "service_id", "e"),
+        RecordKey("service", "service_id", "s"))
+      .InnerJoin(
+        RecordKey("service", "company_id", "s"),
+        RecordKey("company", "company_id", "c"))
+      .LeftJoin(
+        RecordKey("equipment", "add_by", "e"),
+        RecordKey("users", "user_id", "u"))
+    .EndJoinBlock()
+    .Where()
+      .AddConditionIn<int32_t>("c.company_id", {1, 2, 3})
+      .And()
+      .AddConditionBetween<int32_t>("e.status", 0, 1)
+      .And()
+      .AddCondition<std::string>("u.username", SqlOperator::kLike, "a%")
+    .EndWhereBlock()
+    .GroupBy()
+      .Field("equipment_id", "e")
+      .Field("name", "c")
+    .EndGroupByBlock()
+    .OrderBy()
+      .Asc("name", "c")
+      .Desc("equipment_id", "e")
+    .EndOrderByBlock();
+  // clang-format on
+
+  REQUIRE(select.GenerateQuery() == std::string(kListing.Sql()));
+
+  auto params = kListing.Bind(1, 2, 3, 0, 1, "a%");
+  REQUIRE(params.size() == select.Values()->size());
+  for (size_t i = 0; i < params.size(); ++i) {
+    REQUIRE(params[i] == (*select.Values())[i]);
+  }
+  REQUIRE(std::get<std::string>(params[5]) == "a%");
+}
+
+TEST_CASE("static-select-bind", "[sqlbuilder][static]") {
+  auto page = kOraclePage.Bind<sqlbuilder::DefaultOracleParamType>(5, 6, 10,
+                                                                   20LL);
+  REQUIRE(page.size() == 4);
+  REQUIRE(std::get<int>(page[2]) == 10);
+  REQUIRE(std::get<long long>(page[3]) == 20);
+
+  // the same statement can be used at run time, mistakes throw there
+  auto runtime = StaticSelect<DatabaseDialect::PostgreSQL, 32>()
+                     .Field<int32_t>("id")
+                     .From("t");
+  REQUIRE(runtime.Sql() == "SELECT id FROM t");
+  REQUIRE_THROWS_AS(runtime.Field<int32_t>("late"), std::runtime_error);
+  REQUIRE_THROWS_AS(runtime.From("a_table_name_that_does_not_fit"),
+                    std::runtime_error);
+  REQUIRE_THROWS_AS(runtime.Limit().Limit(), std::runtime_error);
+}
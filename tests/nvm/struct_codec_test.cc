@@ -0,0 +1,111 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/struct_codec.h"
+
+using namespace nvm;
+
+struct SensorReading {
+  uint32_t sensor_id;
+  int16_t temperature;
+  std::string location;
+  double value;
+  bool valid;
+
+  using types = std::tuple<uint32_t, int16_t, std::string, double, bool>;
+  using wire_types = std::tuple<uint32_t, bytes::wire::Be<int16_t>,
+                                bytes::wire::FixedString<8>, double, bool>;
+
+  auto Tie() const {
+    return std::tie(sensor_id, temperature, location, value, valid);
+  }
+};
+
+struct Point {
+  int32_t x;
+  int32_t y;
+
+  using types = std::tuple<int32_t, int32_t>;
+
+  auto Tie() const { return std::tie(x, y); }
+};
+
+TEST_CASE("record-codec layout", "[byte][record-codec]") {
+  using Codec = bytes::RecordCodec<SensorReading>;
+  static_assert(Codec::kRecordSize == 4 + 2 + 8 + 8 + 1, "record size");
+  static_assert(Codec::Offset(2) == 6, "offset of location");
+  static_assert(bytes::RecordCodec<Point>::kRecordSize == 8, "point size");
+  REQUIRE(Codec::kFieldCount == 5);
+}
+
+TEST_CASE("record-codec round trip", "[byte][record-codec]") {
+  using Codec = bytes::RecordCodec<SensorReading>;
+  SensorReading in{42, -300, "dock-7", 21.5, true};
+
+  uint8_t buffer[Codec::kRecordSize];
+  REQUIRE(Codec::Encode(in, buffer, sizeof(buffer),
+                        bytes::EndianessType::BigEndian) ==
+          bytes::ByteOpResult::Ok);
+  // big endian record, int16 forced big endian, string NUL padded
+  REQUIRE(buffer[3] == 42);
+  REQUIRE(buffer[4] == 0xFE);
+  REQUIRE(buffer[5] == 0xD4);
+  REQUIRE(buffer[6] == 'd');
+  REQUIRE(buffer[12] == 0);
+  REQUIRE(buffer[22] == 1);
+
+  SensorReading out{};
+  REQUIRE(Codec::Decode(buffer, sizeof(buffer), out,
+                        bytes::EndianessType::BigEndian) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(out.sensor_id == 42);
+  REQUIRE(out.temperature == -300);
+  REQUIRE(out.location == "dock-7");
+  REQUIRE(out.value == 21.5);
+  REQUIRE(out.valid);
+
+  REQUIRE(Codec::Decode(buffer, sizeof(buffer) - 1, out) ==
+          bytes::ByteOpResult::SizeMismatch);
+  REQUIRE(Codec::Decode(nullptr, 0, out) == bytes::ByteOpResult::Nullptr);
+
+  // Le endianess, the Be field stays big endian
+  REQUIRE(Codec::Encode(in, buffer, sizeof(buffer)) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(buffer[0] == 42);
+  REQUIRE(buffer[4] == 0xFE);
+}
+
+TEST_CASE("record-codec bulk decode", "[byte][record-codec]") {
+  using Codec = bytes::RecordCodec<Point>;
+  std::vector<Point> points;
+  for (int32_t i = 0; i < 100; ++i) {
+    points.push_back(Point{i, -i * 3});
+  }
+
+  std::vector<uint8_t> encoded;
+  REQUIRE(Codec::EncodeArray(points.data(), points.size(), encoded,
+                             bytes::EndianessType::BigEndian) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(encoded.size() == 800);
+
+  // trailing partial record is ignored
+  encoded.push_back(0xFF);
+
+  std::vector<Point> decoded;
+  size_t consumed = 0;
+  REQUIRE(Codec::DecodeArray(encoded.data(), encoded.size(), decoded,
+                             consumed, bytes::EndianessType::BigEndian) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(consumed == 800);
+  REQUIRE(decoded.size() == 100);
+  REQUIRE(decoded[99].x == 99);
+  REQUIRE(decoded[99].y == -297);
+
+  REQUIRE(Codec::DecodeArray(encoded.data(), encoded.size(), 101, decoded) ==
+          bytes::ByteOpResult::SizeMismatch);
+  REQUIRE(decoded.size() == 100);
+}
@@ -0,0 +1,156 @@
+#define CATCH_CONFIG_MAIN
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/byte.h"
+#include "nvm/strings/details/internal_utf8.h"
+#include "nvm/strings/utf8string.h"
+
+using namespace nvm;
+
+namespace {
+
+bool IsValid(const std::string& s, size_t& count) {
+  return strings::details::utf8::Validate(
+      reinterpret_cast<const uint8_t*>(s.data()), s.size(), count);
+}
+
+}  // namespace
+
+TEST_CASE("utf8 validate accepts well formed input", "[utf8]") {
+  size_t count = 0;
+  REQUIRE(IsValid("", count));
+  REQUIRE(count == 0);
+
+  REQUIRE(IsValid("hello world", count));
+  REQUIRE(count == 11);
+
+  // 2, 3 and 4 byte sequences, boundary codepoints
+  std::string s = "\xC2\x80\xDF\xBF\xE0\xA0\x80\xEF\xBF\xBF\xF0\x90\x80\x80"
+                  "\xF4\x8F\xBF\xBF";
+  REQUIRE(IsValid(s, count));
+  REQUIRE(count == 6);
+
+  // long enough to cross several 16 byte blocks
+  std::string text;
+  for (int i = 0; i < 50; ++i) {
+    text += "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+  }
+  REQUIRE(IsValid(text, count));
+  REQUIRE(count == 200);
+}
+
+TEST_CASE("utf8 validate rejects malformed input", "[utf8]") {
+  size_t count = 0;
+  const char* bad[] = {
+      "\x80",                  // lone continuation
+      "\xC0\xAF",              // overlong 2 byte
+      "\xC1\xBF",              // overlong 2 byte
+      "\xE0\x80\xAF",          // overlong 3 byte
+      "\xF0\x80\x80\xAF",      // overlong 4 byte
+      "\xED\xA0\x80",          // surrogate
+      "\xF4\x90\x80\x80",      // above U+10FFFF
+      "\xF5\x80\x80\x80",      // invalid lead
+      "\xFF",                  // invalid lead
+      "\xC3",                  // truncated
+      "\xE2\x82",              // truncated
+      "\xF0\x9F\x98",          // truncated
+      "\xC3\x28",              // missing continuation
+      "\xE2\x28\xA1",          // missing continuation
+      "\xC3\xA9\xA9",          // too many continuations
+  };
+  for (auto s : bad) {
+    std::string str(s);
+    INFO(str.size());
+    REQUIRE_FALSE(IsValid(str, count));
+    REQUIRE_FALSE(strings::details::utf8::ValidateScalar(
+        reinterpret_cast<const uint8_t*>(str.data()), str.size(), count));
+
+    // the same error at the end of a longer block
+    std::string padded = std::string(29, 'x') + str;
+    REQUIRE_FALSE(IsValid(padded, count));
+    // and in the middle of one
+    padded = std::string(13, 'x') + str + std::string(20, 'y');
+    REQUIRE_FALSE(IsValid(padded, count));
+  }
+}
+
+TEST_CASE("utf8 validate matches scalar on random input", "[utf8]") {
+  std::mt19937 rng(1234);
+  const char* pieces[] = {"a", "\x7F", "\xC3\xA9", "\xE2\x82\xAC",
+                          "\xF0\x9F\x98\x80", "\xED\x9F\xBF", "\x80",
+                          "\xC0", "\xF4", "\xED\xA0", "\xE0\xA0"};
+  const size_t n_pieces = sizeof(pieces) / sizeof(pieces[0]);
+
+  for (int round = 0; round < 2000; ++round) {
+    std::string s;
+    size_t parts = rng() % 40;
+    for (size_t i = 0; i < parts; ++i) {
+      s += pieces[rng() % n_pieces];
+    }
+
+    size_t expected_count = 0;
+    size_t count = 0;
+    bool expected = strings::details::utf8::ValidateScalar(
+        reinterpret_cast<const uint8_t*>(s.data()), s.size(), expected_count);
+    REQUIRE(IsValid(s, count) == expected);
+    if (expected) {
+      REQUIRE(count == expected_count);
+    }
+
+    std::vector<uint8_t> copy(s.size());
+    bool copied = strings::details::utf8::ValidateCopy(
+        reinterpret_cast<const uint8_t*>(s.data()), s.size(), copy.data(),
+        count);
+    REQUIRE(copied == expected);
+    REQUIRE(std::string(copy.begin(), copy.end()) == s);
+  }
+}
+
+TEST_CASE("Utf8String caches validity and length", "[utf8]") {
+  strings::Utf8String empty;
+  REQUIRE(empty.IsUtf8());
+  REQUIRE(empty.Len() == 0);
+
+  std::string src = "caf\xC3\xA9 \xE2\x82\xAC";
+  strings::Utf8String str(src);
+  REQUIRE(str.Str() == src);
+  REQUIRE(str.IsUtf8());
+  REQUIRE(str.Size() == 9);
+  REQUIRE(str.Len() == 6);
+
+  strings::Utf8String moved(std::string("\xF0\x9F\x98\x80!"));
+  REQUIRE(moved.IsUtf8());
+  REQUIRE(moved.Len() == 2);
+
+  strings::Utf8String invalid(std::string("ab\xFF"));
+  REQUIRE_FALSE(invalid.IsUtf8());
+  REQUIRE(invalid.Len() == 3);
+}
+
+TEST_CASE("ToUtf8String and ToBytes round trip", "[utf8][byte]") {
+  const uint8_t data[] = {'h', 0xC3, 0xA9, 'l', 'l', 'o'};
+  auto str = bytes::ToUtf8String(data, sizeof(data));
+  REQUIRE(str.IsUtf8());
+  REQUIRE(str.Len() == 5);
+  REQUIRE(str.Size() == sizeof(data));
+
+  uint8_t out[8] = {0};
+  REQUIRE(bytes::ToBytes(str, out, sizeof(out)) == bytes::ByteOpResult::Ok);
+  REQUIRE(std::equal(data, data + sizeof(data), out));
+
+  REQUIRE(bytes::ToBytes(str, out, 3) == bytes::ByteOpResult::SizeMismatch);
+  REQUIRE(bytes::ToBytes(str, static_cast<uint8_t*>(nullptr), 8) ==
+          bytes::ByteOpResult::Nullptr);
+
+  const char bad[] = {'x', '\xC3'};
+  auto invalid = bytes::ToUtf8String(bad, sizeof(bad));
+  REQUIRE_FALSE(invalid.IsUtf8());
+  REQUIRE(invalid.Size() == 2);
+  REQUIRE(bytes::ToBytes(invalid, out, sizeof(out)) ==
+          bytes::ByteOpResult::None);
+}
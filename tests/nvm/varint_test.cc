@@ -0,0 +1,138 @@
+#define CATCH_CONFIG_MAIN
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "catch2/catch_all.hpp"
+#include "nvm/bytes/varint.h"
+
+using namespace nvm;
+
+TEST_CASE("varint encode known values", "[byte][varint]") {
+  uint8_t buf[10];
+  size_t written = 0;
+
+  auto err = bytes::ToVarintBytes(uint64_t(1), buf, sizeof(buf), written);
+  REQUIRE(err == bytes::ByteOpResult::Ok);
+  REQUIRE(written == 1);
+  REQUIRE(buf[0] == 0x01);
+
+  err = bytes::ToVarintBytes(uint64_t(300), buf, sizeof(buf), written);
+  REQUIRE(err == bytes::ByteOpResult::Ok);
+  REQUIRE(written == 2);
+  REQUIRE(buf[0] == 0xAC);
+  REQUIRE(buf[1] == 0x02);
+
+  err = bytes::ToVarintBytes(std::numeric_limits<uint64_t>::max(), buf,
+                             sizeof(buf), written);
+  REQUIRE(err == bytes::ByteOpResult::Ok);
+  REQUIRE(written == 10);
+  REQUIRE(buf[9] == 0x01);
+}
+
+TEST_CASE("varint zigzag", "[byte][varint][zigzag]") {
+  REQUIRE(bytes::ZigZagEncode64(0) == 0);
+  REQUIRE(bytes::ZigZagEncode64(-1) == 1);
+  REQUIRE(bytes::ZigZagEncode64(1) == 2);
+  REQUIRE(bytes::ZigZagEncode64(-2) == 3);
+  REQUIRE(bytes::ZigZagEncode32(std::numeric_limits<int32_t>::min()) ==
+          std::numeric_limits<uint32_t>::max());
+  REQUIRE(bytes::ZigZagDecode64(bytes::ZigZagEncode64(
+              std::numeric_limits<int64_t>::min())) ==
+          std::numeric_limits<int64_t>::min());
+
+  uint8_t buf[10];
+  size_t written = 0;
+  size_t consumed = 0;
+  bytes::ByteOpResult err;
+
+  REQUIRE(bytes::ToVarintBytes(int32_t(-64), buf, sizeof(buf), written) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(written == 1);
+  REQUIRE(bytes::ToVarInt32(buf, written, consumed, err) == -64);
+  REQUIRE(err == bytes::ByteOpResult::Ok);
+}
+
+TEST_CASE("varint round trip fast and slow path", "[byte][varint]") {
+  std::vector<uint64_t> values = {0,
+                                  127,
+                                  128,
+                                  16383,
+                                  16384,
+                                  (1ULL << 35) + 7,
+                                  (1ULL << 56) - 1,
+                                  1ULL << 56,
+                                  (1ULL << 63) - 1,
+                                  std::numeric_limits<uint64_t>::max()};
+
+  for (auto v : values) {
+    CAPTURE(v);
+    // padded buffer takes the 8-byte load path
+    uint8_t padded[16] = {0};
+    size_t written = 0;
+    REQUIRE(bytes::ToVarintBytes(v, padded, sizeof(padded), written) ==
+            bytes::ByteOpResult::Ok);
+    REQUIRE(written == bytes::VarintSize(v));
+
+    size_t consumed = 0;
+    bytes::ByteOpResult err;
+    REQUIRE(bytes::ToVarUint64(padded, sizeof(padded), consumed, err) == v);
+    REQUIRE(err == bytes::ByteOpResult::Ok);
+    REQUIRE(consumed == written);
+
+    // exact-size buffer takes the scalar path
+    REQUIRE(bytes::ToVarUint64(padded, written, consumed, err) == v);
+    REQUIRE(err == bytes::ByteOpResult::Ok);
+    REQUIRE(consumed == written);
+  }
+}
+
+TEST_CASE("varint truncated and overlong", "[byte][varint][error]") {
+  size_t consumed = 0;
+  bytes::ByteOpResult err;
+
+  uint8_t truncated[] = {0x80, 0x80};
+  bytes::ToVarUint64(truncated, sizeof(truncated), consumed, err);
+  REQUIRE(err == bytes::ByteOpResult::Truncated);
+  REQUIRE(consumed == 0);
+
+  uint8_t overlong[12];
+  std::fill(std::begin(overlong), std::end(overlong), 0xFF);
+  bytes::ToVarUint64(overlong, sizeof(overlong), consumed, err);
+  REQUIRE(err == bytes::ByteOpResult::Overlong);
+
+  bytes::ToVarUint64(overlong, 10, consumed, err);
+  REQUIRE(err == bytes::ByteOpResult::Overlong);
+
+  // 2^32 does not fit a 32-bit varint
+  uint8_t too_big[] = {0x80, 0x80, 0x80, 0x80, 0x10};
+  bytes::ToVarUint32(too_big, sizeof(too_big), consumed, err);
+  REQUIRE(err == bytes::ByteOpResult::Overlong);
+
+  uint8_t buf[1];
+  size_t written = 0;
+  REQUIRE(bytes::ToVarintBytes(uint32_t(128), buf, sizeof(buf), written) ==
+          bytes::ByteOpResult::SizeMismatch);
+}
+
+TEST_CASE("varint bulk array", "[byte][varint][array]") {
+  std::vector<int64_t> values = {0, -1, 1, -300, 300, 1LL << 40, -(1LL << 50)};
+  std::vector<char> buf(values.size() * bytes::kMaxVarint64Size);
+
+  size_t written = 0;
+  REQUIRE(bytes::ToVarintBytesArray(values.data(), values.size(), buf.data(),
+                                    buf.size(), written) ==
+          bytes::ByteOpResult::Ok);
+
+  std::vector<int64_t> decoded(values.size());
+  size_t consumed = 0;
+  REQUIRE(bytes::ToVarintArray(buf.data(), written, decoded.data(),
+                               decoded.size(), consumed) ==
+          bytes::ByteOpResult::Ok);
+  REQUIRE(consumed == written);
+  REQUIRE(decoded == values);
+
+  REQUIRE(bytes::ToVarintArray(buf.data(), written - 1, decoded.data(),
+                               decoded.size(), consumed) ==
+          bytes::ByteOpResult::Truncated);
+}